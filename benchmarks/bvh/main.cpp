@@ -0,0 +1,216 @@
+#include <stdio.h>
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <atomic>
+#include <libs/glm/glm.hpp>
+#include <libs/glm/gtc/constants.hpp>
+#include <framework/core/vertexAttributes.h>
+#include <framework/utils/objectParser.h>
+#include <framework/utils/jobSystem.h>
+#include <framework/utils/bvh.h>
+
+using namespace std;
+using namespace framework;
+
+constexpr uint32_t RAYS = 1000000;
+constexpr uint32_t VERIFIED_RAYS = 2000;
+constexpr uint32_t REFITS = 100;
+constexpr uint32_t RAYS_GRAIN = 4096;
+
+// Sphere with noisy radius, comparable to the sample rock when the model is not available
+void generateMesh(vector<glm::vec3> &positions, vector<uint32_t> &indices)
+{
+    constexpr uint32_t RINGS = 64, SEGMENTS = 128;
+    mt19937 generator(42);
+    uniform_real_distribution<float> noise(0.9f, 1.1f);
+
+    for (uint32_t r = 0; r <= RINGS; r++)
+    {
+        float theta = glm::pi<float>() * r / RINGS;
+        for (uint32_t s = 0; s <= SEGMENTS; s++)
+        {
+            float phi = 2.0f * glm::pi<float>() * s / SEGMENTS;
+            positions.push_back(noise(generator) * glm::vec3(sin(theta) * cos(phi), cos(theta), sin(theta) * sin(phi)));
+        }
+    }
+
+    for (uint32_t r = 0; r < RINGS; r++)
+    {
+        for (uint32_t s = 0; s < SEGMENTS; s++)
+        {
+            uint32_t a = r * (SEGMENTS + 1) + s, b = a + SEGMENTS + 1;
+            indices.insert(indices.end(), {a, b, a + 1, a + 1, b, b + 1});
+        }
+    }
+}
+
+bool loadMesh(const char *path, vector<glm::vec3> &positions, vector<uint32_t> &indices)
+{
+    ObjectParserConfiguration config;
+    config.has_texture = false;
+    config.has_normals = false;
+    vector<string> textures;
+
+    try
+    {
+        for (const auto &element : parseObjFile(path, config, textures))
+        {
+            uint32_t stride = 0;
+            for (auto attribute : element->getVertexAttributes())
+            {
+                stride += (VertexAttributes::getAttributeSize(attribute) + 3) / 4;
+            }
+
+            uint32_t first_vertex = positions.size();
+            const auto &vertices = element->getVertices();
+            for (size_t v = 0; v + 2 < vertices.size(); v += stride)
+            {
+                positions.push_back({vertices[v], vertices[v + 1], vertices[v + 2]});
+            }
+
+            for (uint32_t index : element->getIndices())
+            {
+                indices.push_back(first_vertex + index);
+            }
+        }
+    }
+    catch (const exception &e)
+    {
+        cout << e.what() << endl;
+        return false;
+    }
+
+    return !indices.empty();
+}
+
+// Reference closest hit, every triangle tested
+float bruteForce(const Ray &ray, const vector<glm::vec3> &positions, const vector<uint32_t> &indices)
+{
+    float closest = ray.t_max;
+    bool hit = false;
+
+    for (size_t t = 0; t < indices.size(); t += 3)
+    {
+        glm::vec3 v0 = positions[indices[t]];
+        glm::vec3 edge1 = positions[indices[t + 1]] - v0, edge2 = positions[indices[t + 2]] - v0;
+        glm::vec3 p = glm::cross(ray.direction, edge2);
+        float determinant = glm::dot(edge1, p);
+        if (abs(determinant) < 1e-12f)
+        {
+            continue;
+        }
+
+        glm::vec3 s = ray.origin - v0;
+        float u = glm::dot(s, p) / determinant;
+        glm::vec3 q = glm::cross(s, edge1);
+        float v = glm::dot(ray.direction, q) / determinant;
+        float distance = glm::dot(edge2, q) / determinant;
+
+        if (u >= 0 && v >= 0 && u + v <= 1 && distance >= ray.t_min && distance <= closest)
+        {
+            closest = distance;
+            hit = true;
+        }
+    }
+
+    return hit ? closest : -1.0f;
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = argc > 1 ? argv[1] : "examples/OBJeffect/models/Rock_5.obj";
+
+    vector<glm::vec3> positions;
+    vector<uint32_t> indices;
+    if (!loadMesh(path, positions, indices))
+    {
+        cout << "Unable to load " << path << ", using a generated mesh" << endl;
+        positions.clear();
+        indices.clear();
+        generateMesh(positions, indices);
+    }
+
+    Bvh bvh;
+    auto start = chrono::steady_clock::now();
+    bvh.build(positions, indices);
+    double build_time = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    // Mesh bounds to aim the rays
+    glm::vec3 min(FLT_MAX), max(-FLT_MAX);
+    for (const auto &position : positions)
+    {
+        min = glm::min(min, position);
+        max = glm::max(max, position);
+    }
+    glm::vec3 center = (min + max) * 0.5f;
+    float radius = glm::length(max - min) * 0.5f;
+
+    // Rays from a sphere around the mesh towards random points of its bounds
+    mt19937 generator(42);
+    uniform_real_distribution<float> unit(0.0f, 1.0f);
+    vector<Ray> rays(RAYS);
+    for (auto &ray : rays)
+    {
+        glm::vec3 direction = glm::normalize(glm::vec3(unit(generator), unit(generator), unit(generator)) * 2.0f - 1.0f);
+        glm::vec3 target = min + glm::vec3(unit(generator), unit(generator), unit(generator)) * (max - min);
+        ray.origin = center + direction * radius * 2.0f;
+        ray.direction = glm::normalize(target - ray.origin);
+    }
+
+    // Single thread throughput
+    vector<RayHit> hits(RAYS);
+    start = chrono::steady_clock::now();
+    for (uint32_t i = 0; i < RAYS; i++)
+    {
+        bvh.intersectRay(rays[i], hits[i]);
+    }
+    double single_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // Job system throughput
+    start = chrono::steady_clock::now();
+    JobSystem::getInstance().parallelFor(RAYS, RAYS_GRAIN, [&](size_t begin, size_t end)
+                                          {
+        for (size_t i = begin; i < end; i++)
+        {
+            bvh.intersectRay(rays[i], hits[i]);
+        } });
+    double parallel_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    uint32_t hit_count = 0;
+    for (const auto &hit : hits)
+    {
+        hit_count += hit.primitive != Bvh::INVALID_PRIMITIVE;
+    }
+
+    // Compare a subset against the brute force distances
+    uint32_t mismatches = 0;
+    for (uint32_t i = 0; i < VERIFIED_RAYS; i++)
+    {
+        float expected = bruteForce(rays[i], positions, indices);
+        float distance = hits[i].primitive != Bvh::INVALID_PRIMITIVE ? hits[i].distance : -1.0f;
+        mismatches += abs(expected - distance) > 1e-4f * std::max(1.0f, abs(expected));
+    }
+
+    // Refit after a small deformation
+    vector<glm::vec3> deformed = positions;
+    for (auto &position : deformed)
+    {
+        position *= 1.01f;
+    }
+    start = chrono::steady_clock::now();
+    for (uint32_t r = 0; r < REFITS; r++)
+    {
+        bvh.refit(r % 2 == 0 ? deformed : positions);
+    }
+    double refit_time = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / REFITS;
+
+    printf("Triangles: %zu, nodes: %zu\n", indices.size() / 3, bvh.getNodes().size());
+    printf("Build: %.3f ms, refit: %.3f ms\n", build_time, refit_time);
+    printf("Rays: %u, hits: %u, mismatches: %u/%u\n", RAYS, hit_count, mismatches, VERIFIED_RAYS);
+    printf("Single thread: %.2f Mrays/s\n", RAYS / single_time * 1e-6);
+    printf("Job system (%u workers): %.2f Mrays/s\n", JobSystem::getInstance().getWorkersNumber(), RAYS / parallel_time * 1e-6);
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <fstream>
+#include <string>
+#include <map>
+#include <cstdlib>
+#include <libs/json.hpp>
+
+using namespace std;
+
+constexpr double DEFAULT_THRESHOLD = 5;
+
+struct Measurement
+{
+    double min_ns = 0;
+    double median_ns = 0;
+};
+
+bool loadResults(const char *path, map<string, Measurement> &results)
+{
+    ifstream file(path);
+    if (!file)
+    {
+        printf("Impossible to open %s\n", path);
+        return false;
+    }
+
+    nlohmann::json report = nlohmann::json::parse(file, nullptr, false);
+    if (report.is_discarded() || !report.contains("benchmarks"))
+    {
+        printf("%s is not a framework_bench report\n", path);
+        return false;
+    }
+
+    for (const auto &benchmark : report["benchmarks"])
+    {
+        results[benchmark["name"].get<string>()] = {benchmark["min_ns"].get<double>(), benchmark["median_ns"].get<double>()};
+    }
+
+    return true;
+}
+
+/**
+ * Compares the medians of two framework_bench reports. A benchmark is flagged only when its median changed more than the
+ * threshold and the fastest sample of the slower run is still behind the median of the other one, so that noisy benchmarks
+ * are not reported. Returns 1 if any benchmark regressed
+ */
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        printf("Usage: %s baseline.json current.json [threshold percentage, default %.0f]\n", argv[0], DEFAULT_THRESHOLD);
+        return 2;
+    }
+
+    double threshold = (argc > 3 ? atof(argv[3]) : DEFAULT_THRESHOLD) / 100.0;
+
+    map<string, Measurement> baseline, current;
+    if (!loadResults(argv[1], baseline) || !loadResults(argv[2], current))
+    {
+        return 2;
+    }
+
+    uint32_t regressions = 0, improvements = 0;
+
+    printf("%-50s %14s %14s %9s\n", "benchmark", "baseline ns", "current ns", "change");
+
+    for (const auto &[name, before] : baseline)
+    {
+        auto after = current.find(name);
+        if (after == current.end())
+        {
+            printf("%-50s %14.1f %14s\n", name.c_str(), before.median_ns, "missing");
+            continue;
+        }
+
+        double change = after->second.median_ns / before.median_ns - 1.0;
+        const char *verdict = "";
+
+        if (change > threshold && after->second.min_ns > before.median_ns)
+        {
+            verdict = "REGRESSION";
+            regressions++;
+        }
+        else if (change < -threshold && before.min_ns > after->second.median_ns)
+        {
+            verdict = "improvement";
+            improvements++;
+        }
+
+        printf("%-50s %14.1f %14.1f %+8.1f%% %s\n", name.c_str(), before.median_ns, after->second.median_ns, change * 100.0, verdict);
+    }
+
+    for (const auto &[name, after] : current)
+    {
+        if (baseline.find(name) == baseline.end())
+        {
+            printf("%-50s %14s %14.1f\n", name.c_str(), "new", after.median_ns);
+        }
+    }
+
+    printf("%u regressions, %u improvements (threshold %.1f%%)\n", regressions, improvements, threshold * 100.0);
+
+    return regressions > 0 ? 1 : 0;
+}
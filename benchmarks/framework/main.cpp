@@ -0,0 +1,654 @@
+#include <stdio.h>
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <string>
+#include <functional>
+#include <filesystem>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <libs/glm/glm.hpp>
+#include <libs/glm/gtc/constants.hpp>
+#include <libs/json.hpp>
+#include <libs/tiny_obj_loader.h>
+#include <libs/stb_image.h>
+#include <libs/stb_image_write.h>
+#include <framework/core/vulkan.h>
+#include <framework/core/commandPool.h>
+#include <framework/core/drawableCollection.h>
+#include <framework/core/texture.h>
+#include <framework/core/vertexAttributes.h>
+#include <framework/utils/camera.h>
+#include <framework/utils/objectParser.h>
+#include <framework/utils/gltfParser.h>
+
+using namespace std;
+using namespace framework;
+
+// Mesh and image sizes, fixed so that the results of two runs are comparable
+constexpr uint32_t RINGS = 128;
+constexpr uint32_t SEGMENTS = 256;
+constexpr uint32_t PATCH_SIZE = 16;
+constexpr uint32_t PATCHES = 512;
+constexpr uint32_t IMAGE_SIZE = 1024;
+constexpr uint32_t DEFAULT_SAMPLES = 15;
+constexpr double DEFAULT_SAMPLE_MS = 20;
+
+struct BenchmarkOptions
+{
+    string output = "framework_bench.json";
+    string filter;
+    uint32_t samples = DEFAULT_SAMPLES;
+    double sample_ms = DEFAULT_SAMPLE_MS;
+    // Software ICD (CPU device) by default, the first device without it
+    int device_index = -1;
+    bool use_device = true;
+};
+
+struct BenchmarkResult
+{
+    string name;
+    uint64_t iterations = 0;
+    double min_ns = 0;
+    double median_ns = 0;
+    double mean_ns = 0;
+    double p95_ns = 0;
+    double stddev_ns = 0;
+};
+
+// Keeps the results of the measured code alive
+volatile float sink = 0;
+
+/**
+ * Runs the benchmarks matching the filter. The body executes the passed iterations and returns the nanoseconds it measured,
+ * so that the setup of every iteration can stay out of the timing. The iterations are doubled until a batch lasts the sample
+ * time (the calibration is the warmup), then every sample is a batch of that size
+ */
+class BenchmarkRunner
+{
+public:
+    BenchmarkRunner(const BenchmarkOptions &options) : options(options) {}
+
+    void run(const string &name, const function<uint64_t(uint64_t)> &body)
+    {
+        if (!options.filter.empty() && name.find(options.filter) == string::npos)
+        {
+            return;
+        }
+
+        uint64_t iterations = 1;
+        while (body(iterations) < options.sample_ms * 1e6 && iterations < (1ull << 30))
+        {
+            iterations *= 2;
+        }
+
+        vector<double> samples;
+        for (uint32_t s = 0; s < options.samples; s++)
+        {
+            samples.push_back(static_cast<double>(body(iterations)) / iterations);
+        }
+
+        sort(samples.begin(), samples.end());
+
+        BenchmarkResult result;
+        result.name = name;
+        result.iterations = iterations;
+        result.min_ns = samples.front();
+        result.median_ns = samples[samples.size() / 2];
+        result.p95_ns = samples[(samples.size() - 1) * 95 / 100];
+
+        for (double sample : samples)
+        {
+            result.mean_ns += sample;
+        }
+        result.mean_ns /= samples.size();
+
+        for (double sample : samples)
+        {
+            result.stddev_ns += (sample - result.mean_ns) * (sample - result.mean_ns);
+        }
+        result.stddev_ns = sqrt(result.stddev_ns / samples.size());
+
+        printf("%-50s %12.1f ns  (min %12.1f, p95 %12.1f, +-%5.1f%%, %llu iterations)\n", name.c_str(), result.median_ns, result.min_ns, result.p95_ns,
+               100.0 * result.stddev_ns / result.mean_ns, static_cast<unsigned long long>(iterations));
+        results.push_back(result);
+    }
+
+    /**
+     * Times every iteration of the body as a whole
+     */
+    void run(const string &name, const function<void()> &body)
+    {
+        run(name, [&](uint64_t iterations)
+            {
+                auto start = chrono::steady_clock::now();
+                for (uint64_t i = 0; i < iterations; i++)
+                {
+                    body();
+                }
+                return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count()); });
+    }
+
+    const vector<BenchmarkResult> &getResults() { return results; }
+
+private:
+    BenchmarkOptions options;
+    vector<BenchmarkResult> results;
+};
+
+// Drawable element whose vertices can be flagged again as changed
+class PatchElement : public DrawableElement
+{
+public:
+    PatchElement(const glm::vec3 &offset)
+    {
+        for (uint32_t z = 0; z <= PATCH_SIZE; z++)
+        {
+            for (uint32_t x = 0; x <= PATCH_SIZE; x++)
+            {
+                vertices.insert(vertices.end(), {offset.x + x, offset.y, offset.z + z, 0.0f, 1.0f, 0.0f});
+            }
+        }
+
+        for (uint32_t z = 0; z < PATCH_SIZE; z++)
+        {
+            for (uint32_t x = 0; x < PATCH_SIZE; x++)
+            {
+                uint32_t a = z * (PATCH_SIZE + 1) + x, b = a + PATCH_SIZE + 1;
+                indices.insert(indices.end(), {a, b, a + 1, a + 1, b, b + 1});
+            }
+        }
+
+        vertex_attributes.push_back(VertexAttributes::DrawableAttribute::F3);
+        vertex_attributes.push_back(VertexAttributes::DrawableAttribute::F3);
+    }
+
+    void update() override
+    {
+    }
+
+    void touch() { updated = true; }
+};
+
+/**
+ * Noisy sphere with normals and texture coordinates, the material makes it look like a textured model to the parser
+ */
+void writeObjFile(const filesystem::path &folder)
+{
+    mt19937 generator(42);
+    uniform_real_distribution<float> noise(0.95f, 1.05f);
+
+    ofstream material(folder / "bench.mtl");
+    material << "newmtl bench\nKd 1 1 1\nd 1\nmap_Kd bench.png\n";
+
+    ofstream obj(folder / "bench.obj");
+    obj << "mtllib bench.mtl\n";
+
+    for (uint32_t r = 0; r <= RINGS; r++)
+    {
+        float theta = glm::pi<float>() * r / RINGS;
+        for (uint32_t s = 0; s <= SEGMENTS; s++)
+        {
+            float phi = 2.0f * glm::pi<float>() * s / SEGMENTS;
+            glm::vec3 normal(sin(theta) * cos(phi), cos(theta), sin(theta) * sin(phi));
+            glm::vec3 position = noise(generator) * normal;
+
+            obj << "v " << position.x << " " << position.y << " " << position.z << "\n";
+            obj << "vn " << normal.x << " " << normal.y << " " << normal.z << "\n";
+            obj << "vt " << static_cast<float>(s) / SEGMENTS << " " << static_cast<float>(r) / RINGS << "\n";
+        }
+    }
+
+    obj << "usemtl bench\n";
+
+    for (uint32_t r = 0; r < RINGS; r++)
+    {
+        for (uint32_t s = 0; s < SEGMENTS; s++)
+        {
+            // OBJ indices start from 1
+            uint32_t a = r * (SEGMENTS + 1) + s + 1, b = a + SEGMENTS + 1;
+            obj << "f " << a << "/" << a << "/" << a << " " << b << "/" << b << "/" << b << " " << a + 1 << "/" << a + 1 << "/" << a + 1 << "\n";
+            obj << "f " << a + 1 << "/" << a + 1 << "/" << a + 1 << " " << b << "/" << b << "/" << b << " " << b + 1 << "/" << b + 1 << "/" << b + 1 << "\n";
+        }
+    }
+}
+
+/**
+ * Same noisy sphere as a glTF file with an external buffer: float positions and normals, normalized unsigned short texture
+ * coordinates (as exported by quantizing tools) and a material sampling the benchmark image
+ */
+void writeGltfFile(const filesystem::path &folder)
+{
+    mt19937 generator(42);
+    uniform_real_distribution<float> noise(0.95f, 1.05f);
+
+    uint32_t vertices_number = (RINGS + 1) * (SEGMENTS + 1);
+    vector<float> positions, normals;
+    vector<uint16_t> uvs;
+    vector<uint32_t> indices;
+
+    for (uint32_t r = 0; r <= RINGS; r++)
+    {
+        float theta = glm::pi<float>() * r / RINGS;
+        for (uint32_t s = 0; s <= SEGMENTS; s++)
+        {
+            float phi = 2.0f * glm::pi<float>() * s / SEGMENTS;
+            glm::vec3 normal(sin(theta) * cos(phi), cos(theta), sin(theta) * sin(phi));
+            glm::vec3 position = noise(generator) * normal;
+
+            positions.insert(positions.end(), {position.x, position.y, position.z});
+            normals.insert(normals.end(), {normal.x, normal.y, normal.z});
+            uvs.insert(uvs.end(), {static_cast<uint16_t>(65535u * s / SEGMENTS), static_cast<uint16_t>(65535u * r / RINGS)});
+        }
+    }
+
+    for (uint32_t r = 0; r < RINGS; r++)
+    {
+        for (uint32_t s = 0; s < SEGMENTS; s++)
+        {
+            uint32_t a = r * (SEGMENTS + 1) + s, b = a + SEGMENTS + 1;
+            indices.insert(indices.end(), {a, b, a + 1, a + 1, b, b + 1});
+        }
+    }
+
+    // Every block size is a multiple of 4, so that all the accessors stay aligned
+    size_t positions_size = positions.size() * sizeof(float);
+    size_t normals_size = normals.size() * sizeof(float);
+    size_t uvs_size = uvs.size() * sizeof(uint16_t);
+    size_t indices_size = indices.size() * sizeof(uint32_t);
+
+    ofstream buffer(folder / "bench.bin", ios::binary);
+    buffer.write(reinterpret_cast<const char *>(positions.data()), positions_size);
+    buffer.write(reinterpret_cast<const char *>(normals.data()), normals_size);
+    buffer.write(reinterpret_cast<const char *>(uvs.data()), uvs_size);
+    buffer.write(reinterpret_cast<const char *>(indices.data()), indices_size);
+
+    nlohmann::json gltf;
+    gltf["asset"] = {{"version", "2.0"}};
+    gltf["scene"] = 0;
+    gltf["scenes"] = {{{"nodes", {0}}}};
+    gltf["nodes"] = {{{"mesh", 0}}};
+    gltf["meshes"] = {{{"primitives", {{{"attributes", {{"POSITION", 0}, {"NORMAL", 1}, {"TEXCOORD_0", 2}}}, {"indices", 3}, {"material", 0}}}}}};
+    gltf["materials"] = {{{"pbrMetallicRoughness", {{"baseColorTexture", {{"index", 0}}}}}}};
+    gltf["textures"] = {{{"source", 0}}};
+    gltf["images"] = {{{"uri", "bench.png"}}};
+    gltf["buffers"] = {{{"uri", "bench.bin"}, {"byteLength", positions_size + normals_size + uvs_size + indices_size}}};
+    gltf["bufferViews"] = {{{"buffer", 0}, {"byteOffset", 0}, {"byteLength", positions_size}},
+                           {{"buffer", 0}, {"byteOffset", positions_size}, {"byteLength", normals_size}},
+                           {{"buffer", 0}, {"byteOffset", positions_size + normals_size}, {"byteLength", uvs_size}},
+                           {{"buffer", 0}, {"byteOffset", positions_size + normals_size + uvs_size}, {"byteLength", indices_size}}};
+
+    // 5126 float, 5123 unsigned short, 5125 unsigned int. Positions need their bounds
+    gltf["accessors"] = {{{"bufferView", 0}, {"componentType", 5126}, {"count", vertices_number}, {"type", "VEC3"}, {"min", {-1.05f, -1.05f, -1.05f}}, {"max", {1.05f, 1.05f, 1.05f}}},
+                         {{"bufferView", 1}, {"componentType", 5126}, {"count", vertices_number}, {"type", "VEC3"}},
+                         {{"bufferView", 2}, {"componentType", 5123}, {"normalized", true}, {"count", vertices_number}, {"type", "VEC2"}},
+                         {{"bufferView", 3}, {"componentType", 5125}, {"count", indices.size()}, {"type", "SCALAR"}}};
+
+    ofstream file(folder / "bench.gltf");
+    file << gltf.dump();
+}
+
+/**
+ * Smooth gradient with noise, so that the PNG does not compress to nothing
+ */
+void writeImageFile(const filesystem::path &path)
+{
+    mt19937 generator(42);
+    uniform_int_distribution<int> noise(-16, 16);
+    vector<uint8_t> pixels(IMAGE_SIZE * IMAGE_SIZE * 4);
+
+    for (uint32_t y = 0; y < IMAGE_SIZE; y++)
+    {
+        for (uint32_t x = 0; x < IMAGE_SIZE; x++)
+        {
+            uint8_t *pixel = &pixels[(y * IMAGE_SIZE + x) * 4];
+            pixel[0] = static_cast<uint8_t>(clamp<int>(x * 255 / IMAGE_SIZE + noise(generator), 0, 255));
+            pixel[1] = static_cast<uint8_t>(clamp<int>(y * 255 / IMAGE_SIZE + noise(generator), 0, 255));
+            pixel[2] = static_cast<uint8_t>(clamp<int>(128 + noise(generator), 0, 255));
+            pixel[3] = 255;
+        }
+    }
+
+    stbi_write_png(path.string().c_str(), IMAGE_SIZE, IMAGE_SIZE, 4, pixels.data(), IMAGE_SIZE * 4);
+}
+
+void cameraBenchmarks(BenchmarkRunner &runner)
+{
+    Camera camera{45, 0.1f, 100.0f};
+    float angle = 0;
+
+    runner.run("camera/look_at", [&]()
+               {
+                   angle += 0.01f;
+                   camera.setPosition({10 * cos(angle), 5, 10 * sin(angle)});
+                   camera.lookAt({0, 0, 0});
+                   sink = sink + camera.getLookAtMatrix()[3][0]; });
+
+    runner.run("camera/perspective", [&]()
+               {
+                   angle += 0.01f;
+                   camera.setFovY(45 + sin(angle));
+                   sink = sink + camera.getPerspectiveMatrix(1920, 1080)[0][0]; });
+
+    runner.run("camera/view_projection", [&]()
+               {
+                   angle += 0.01f;
+                   camera.setPosition({10 * cos(angle), 5, 10 * sin(angle)});
+                   glm::mat4 view_projection = camera.getPerspectiveMatrix(1920, 1080) * camera.getLookAtMatrix();
+                   sink = sink + view_projection[2][2]; });
+
+    runner.run("camera/frustum", [&]()
+               {
+                   angle += 0.01f;
+                   camera.setPosition({10 * cos(angle), 5, 10 * sin(angle)});
+                   Frustum frustum = camera.getFrustum(1920, 1080);
+                   sink = sink + frustum.intersectsBox({-1, -1, -1}, {1, 1, 1}); });
+}
+
+void vertexAttributesBenchmarks(BenchmarkRunner &runner)
+{
+    using Attribute = VertexAttributes::DrawableAttribute;
+
+    // Pipelines compare the attributes of every added element with the collection ones
+    VertexAttributes attributes({Attribute::F3, Attribute::F2, Attribute::F3, Attribute::I1});
+    vector<Attribute> same = {Attribute::F3, Attribute::F2, Attribute::F3, Attribute::I1};
+    vector<Attribute> last_different = {Attribute::F3, Attribute::F2, Attribute::F3, Attribute::F1};
+    vector<Attribute> shorter = {Attribute::F3, Attribute::F2};
+
+    runner.run("vertex_attributes/equal", [&]()
+               { sink = sink + (attributes == same); });
+
+    runner.run("vertex_attributes/last_different", [&]()
+               { sink = sink + (attributes == last_different); });
+
+    runner.run("vertex_attributes/different_size", [&]()
+               { sink = sink + (attributes == shorter); });
+
+    runner.run("vertex_attributes/stride", [&]()
+               { sink = sink + attributes.getStride(); });
+}
+
+void objectParserBenchmarks(BenchmarkRunner &runner, const filesystem::path &folder)
+{
+    string filename = (folder / "bench.obj").string();
+    vector<string> textures;
+
+    ObjectParserConfiguration config;
+    ObjectParserConfiguration compressed;
+    compressed.position_format = VertexAttributes::DrawableAttribute::H4;
+    compressed.texture_format = VertexAttributes::DrawableAttribute::U16N2;
+    compressed.normal_format = VertexAttributes::DrawableAttribute::S16N2;
+
+    runner.run("object_parser/parse_obj_file", [&]()
+               { sink = sink + parseObjFile(filename.c_str(), config, textures).size(); });
+
+    // The shape parsing alone, on the loaded tinyobj data
+    tinyobj::attrib_t attrib;
+    vector<tinyobj::shape_t> shapes;
+    vector<tinyobj::material_t> materials;
+    string warn, err;
+
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filename.c_str(), (folder.string() + "/").c_str()) || shapes.empty())
+    {
+        printf("Skipped getParsedDrawableElement benchmarks: %s%s\n", warn.c_str(), err.c_str());
+        return;
+    }
+
+    runner.run("object_parser/get_parsed_drawable_element", [&]()
+               { sink = sink + getParsedDrawableElement(shapes[0], attrib, materials, config)->getVertices().size(); });
+
+    runner.run("object_parser/get_parsed_drawable_element_compressed", [&]()
+               { sink = sink + getParsedDrawableElement(shapes[0], attrib, materials, compressed)->getVertices().size(); });
+}
+
+void gltfParserBenchmarks(BenchmarkRunner &runner, const filesystem::path &folder)
+{
+    string filename = (folder / "bench.gltf").string();
+    vector<string> textures;
+
+    GltfParserConfiguration config;
+    GltfParserConfiguration float_config;
+    float_config.keep_accessor_formats = false;
+
+    runner.run("gltf_parser/parse_gltf_file", [&]()
+               {
+                   textures.clear();
+                   sink = sink + parseGltfFile(filename.c_str(), config, textures)[0]->getVertices().size(); });
+
+    runner.run("gltf_parser/parse_gltf_file_float", [&]()
+               {
+                   textures.clear();
+                   sink = sink + parseGltfFile(filename.c_str(), float_config, textures)[0]->getVertices().size(); });
+}
+
+void decodeBenchmarks(BenchmarkRunner &runner, const filesystem::path &folder)
+{
+    ifstream file(folder / "bench.png", ios::binary);
+    vector<uint8_t> png((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+
+    runner.run("texture/stb_decode", [&]()
+               {
+                   int width, height, channels;
+                   stbi_uc *pixels = stbi_load_from_memory(png.data(), png.size(), &width, &height, &channels, STBI_rgb_alpha);
+                   sink = sink + pixels[0];
+                   stbi_image_free(pixels); });
+}
+
+/**
+ * Collection and texture benchmarks, on a headless device
+ */
+void deviceBenchmarks(BenchmarkRunner &runner, const filesystem::path &folder, const shared_ptr<LogicalDevice> &l_device,
+                      const shared_ptr<CommandPool> &command_pool)
+{
+    vector<shared_ptr<PatchElement>> patches;
+    for (uint32_t i = 0; i < PATCHES; i++)
+    {
+        patches.push_back(make_shared<PatchElement>(glm::vec3((i % 32) * PATCH_SIZE, 0, (i / 32) * PATCH_SIZE)));
+    }
+
+    auto createCollection = [&]()
+    {
+        unique_ptr<DrawableCollection> collection = make_unique<DrawableCollection>(l_device, nullptr, command_pool->getCommandPool(), vector<shared_ptr<Shader>>{});
+
+        for (const auto &patch : patches)
+        {
+            patch->touch();
+            collection->addElement(patch);
+        }
+
+        return collection;
+    };
+
+    // Creation and destruction of the collection stay out of the timing
+    runner.run("drawable_collection/allocate", [&](uint64_t iterations)
+               {
+                   uint64_t elapsed = 0;
+                   for (uint64_t i = 0; i < iterations; i++)
+                   {
+                       unique_ptr<DrawableCollection> collection = createCollection();
+
+                       auto start = chrono::steady_clock::now();
+                       collection->allocate();
+                       elapsed += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+                   }
+                   return elapsed; });
+
+    unique_ptr<DrawableCollection> collection = createCollection();
+    collection->allocate();
+
+    for (uint32_t stride : {1u, 10u})
+    {
+        string name = stride == 1 ? "drawable_collection/update_elements_all" : "drawable_collection/update_elements_10_percent";
+
+        runner.run(name, [&](uint64_t iterations)
+                   {
+                       uint64_t elapsed = 0;
+                       for (uint64_t i = 0; i < iterations; i++)
+                       {
+                           for (uint32_t p = i % stride; p < PATCHES; p += stride)
+                           {
+                               patches[p]->touch();
+                           }
+
+                           auto start = chrono::steady_clock::now();
+                           collection->updateElements();
+                           elapsed += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+                       }
+                       return elapsed; });
+    }
+
+    string image = (folder / "bench.png").string();
+
+    runner.run("texture/decode_upload", [&]()
+               {
+                   Texture texture(l_device, command_pool->getCommandPool(), image.c_str(), 0);
+                   sink = sink + 1; });
+}
+
+/**
+ * Index of the first CPU device (software ICD such as lavapipe), 0 if there is none
+ */
+uint32_t findSoftwareDevice(VkInstance instance)
+{
+    uint32_t count = 0;
+    vkEnumeratePhysicalDevices(instance, &count, nullptr);
+    vector<VkPhysicalDevice> devices(count);
+    vkEnumeratePhysicalDevices(instance, &count, devices.data());
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(devices[i], &properties);
+
+        if (properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU)
+        {
+            return i;
+        }
+    }
+
+    return 0;
+}
+
+bool parseOptions(int argc, char **argv, BenchmarkOptions &options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        string argument = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (argument == "--output" && has_value)
+        {
+            options.output = argv[++i];
+        }
+        else if (argument == "--filter" && has_value)
+        {
+            options.filter = argv[++i];
+        }
+        else if (argument == "--samples" && has_value)
+        {
+            options.samples = max(1, atoi(argv[++i]));
+        }
+        else if (argument == "--sample-ms" && has_value)
+        {
+            options.sample_ms = max(0.1, atof(argv[++i]));
+        }
+        else if (argument == "--device" && has_value)
+        {
+            options.device_index = atoi(argv[++i]);
+        }
+        else if (argument == "--no-device")
+        {
+            options.use_device = false;
+        }
+        else
+        {
+            printf("Usage: %s [--output file.json] [--filter text] [--samples n] [--sample-ms ms] [--device index] [--no-device]\n", argv[0]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    BenchmarkOptions options;
+    if (!parseOptions(argc, argv, options))
+    {
+        return 1;
+    }
+
+    // Inputs generated at every run with fixed seeds. The folder is relative, the parsers look for the materials and buffers next to the model
+    filesystem::path folder = "framework_bench_data";
+    filesystem::create_directories(folder);
+    writeObjFile(folder);
+    writeGltfFile(folder);
+    writeImageFile(folder / "bench.png");
+
+    BenchmarkRunner runner(options);
+    cameraBenchmarks(runner);
+    vertexAttributesBenchmarks(runner);
+    objectParserBenchmarks(runner, folder);
+    gltfParserBenchmarks(runner, folder);
+    decodeBenchmarks(runner, folder);
+
+    string device_name;
+
+    if (options.use_device)
+    {
+        try
+        {
+            std::vector<const char *> extensions;
+            shared_ptr<Vulkan> vulkan = make_shared<Vulkan>("Framework benchmark", "No Engine", extensions, false, true);
+
+            uint32_t index = options.device_index >= 0 ? options.device_index : findSoftwareDevice(vulkan->getInstance());
+            unique_ptr<PhysicalDevice> p_device = make_unique<PhysicalDevice>(vulkan->getInstance(), VK_NULL_HANDLE, index);
+            device_name = p_device->getProperties().deviceName;
+            printf("Device: %s\n", device_name.c_str());
+
+            shared_ptr<LogicalDevice> l_device = make_shared<LogicalDevice>(move(p_device), VK_NULL_HANDLE);
+            shared_ptr<CommandPool> command_pool = make_shared<CommandPool>(l_device, VK_NULL_HANDLE);
+
+            deviceBenchmarks(runner, folder, l_device, command_pool);
+            l_device->waitIdle();
+        }
+        catch (const exception &e)
+        {
+            printf("Skipped device benchmarks: %s\n", e.what());
+        }
+    }
+
+    nlohmann::json report;
+    report["version"] = 1;
+    report["device"] = device_name.empty() ? nlohmann::json() : nlohmann::json(device_name);
+    report["samples"] = options.samples;
+    report["sample_ms"] = options.sample_ms;
+    report["benchmarks"] = nlohmann::json::array();
+
+    for (const BenchmarkResult &result : runner.getResults())
+    {
+        report["benchmarks"].push_back({{"name", result.name},
+                                        {"iterations", result.iterations},
+                                        {"min_ns", result.min_ns},
+                                        {"median_ns", result.median_ns},
+                                        {"mean_ns", result.mean_ns},
+                                        {"p95_ns", result.p95_ns},
+                                        {"stddev_ns", result.stddev_ns}});
+    }
+
+    ofstream output(options.output);
+    if (!output)
+    {
+        printf("Impossible to write %s\n", options.output.c_str());
+        return 1;
+    }
+
+    output << report.dump(2) << endl;
+    printf("Results: %s\n", options.output.c_str());
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+#include <stdio.h>
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <libs/glm/glm.hpp>
+#include <framework/utils/camera.h>
+#include <framework/utils/frustum.h>
+
+using namespace std;
+using namespace framework;
+
+constexpr uint32_t BOXES = 100000;
+constexpr uint32_t REPETITIONS = 100;
+
+int main()
+{
+    // Random boxes scattered around the camera
+    mt19937 generator(42);
+    uniform_real_distribution<float> position(-500.0f, 500.0f);
+    uniform_real_distribution<float> extent(0.5f, 5.0f);
+
+    BoundingBoxes boxes;
+    for (uint32_t i = 0; i < BOXES; i++)
+    {
+        glm::vec3 center(position(generator), position(generator), position(generator));
+        glm::vec3 half(extent(generator), extent(generator), extent(generator));
+
+        boxes.min_x.push_back(center.x - half.x);
+        boxes.min_y.push_back(center.y - half.y);
+        boxes.min_z.push_back(center.z - half.z);
+        boxes.max_x.push_back(center.x + half.x);
+        boxes.max_y.push_back(center.y + half.y);
+        boxes.max_z.push_back(center.z + half.z);
+    }
+
+    Camera camera{45, 0.1f, 400.0f};
+    camera.setPosition({0, 0, 0});
+    camera.lookAt({1, 0.2f, 1});
+    Frustum frustum = camera.getFrustum(1920, 1080);
+
+    vector<uint8_t> scalar_visibility(BOXES), batch_visibility(BOXES);
+    uint32_t scalar_visible = 0, batch_visible = 0;
+
+    // Reference implementation, one box at a time
+    auto start = chrono::steady_clock::now();
+    for (uint32_t r = 0; r < REPETITIONS; r++)
+    {
+        scalar_visible = 0;
+        for (uint32_t i = 0; i < BOXES; i++)
+        {
+            scalar_visibility[i] = frustum.intersectsBox({boxes.min_x[i], boxes.min_y[i], boxes.min_z[i]},
+                                                         {boxes.max_x[i], boxes.max_y[i], boxes.max_z[i]});
+            scalar_visible += scalar_visibility[i];
+        }
+    }
+    double scalar_time = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / REPETITIONS;
+
+    // SoA batch test
+    start = chrono::steady_clock::now();
+    for (uint32_t r = 0; r < REPETITIONS; r++)
+    {
+        batch_visible = cullBoxes(frustum, boxes, batch_visibility.data());
+    }
+    double batch_time = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count() / REPETITIONS;
+
+    uint32_t mismatches = 0;
+    for (uint32_t i = 0; i < BOXES; i++)
+    {
+        mismatches += scalar_visibility[i] != batch_visibility[i];
+    }
+
+    printf("Boxes: %u, visible: %u (scalar %u), mismatches: %u\n", BOXES, batch_visible, scalar_visible, mismatches);
+    printf("Batch kernel: %s\n", getCullBoxesKernel());
+    printf("Scalar: %.3f ms (%.2f ns/box)\n", scalar_time, scalar_time * 1e6 / BOXES);
+    printf("Batch:  %.3f ms (%.2f ns/box), speedup %.2fx\n", batch_time, batch_time * 1e6 / BOXES, scalar_time / batch_time);
+
+    return mismatches == 0 ? 0 : 1;
+}
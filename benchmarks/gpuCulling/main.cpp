@@ -0,0 +1,213 @@
+#include <stdio.h>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cstdlib>
+#include <libs/glm/glm.hpp>
+#include <libs/glm/gtc/matrix_transform.hpp>
+#include <framework/core/vulkan.h>
+#include <framework/devices/physicalDevice.h>
+#include <framework/devices/logicalDevice.h>
+#include <framework/core/commandPool.h>
+#include <framework/core/commandBuffer.h>
+#include <framework/core/fence.h>
+#include <framework/core/offscreenTarget.h>
+#include <framework/core/renderPass.h>
+#include <framework/core/pipeline.h>
+#include <framework/core/uniformBuffer.h>
+#include <framework/core/storageBuffer.h>
+#include <framework/utils/camera.h>
+#include <framework/utils/frustum.h>
+#include <framework/utils/gpuCulling.h>
+
+using namespace std;
+using namespace framework;
+
+constexpr uint32_t WIDTH = 1920;
+constexpr uint32_t HEIGHT = 1080;
+constexpr uint32_t DEFAULT_ELEMENTS = 100000;
+constexpr uint32_t VIEWS = 16;
+// Plane distance margin of the CPU bounds, boxes touching a plane may be classified differently by the two implementations
+constexpr float MARGIN = 1e-4f;
+
+struct GlobalUniformBuffer
+{
+    alignas(16) glm::mat4 model;
+    alignas(16) glm::mat4 view;
+    alignas(16) glm::mat4 projection;
+};
+
+// Colored box of random center and size, one element of the culled collection
+class Box : public DrawableElement
+{
+public:
+    Box(const glm::vec3 &center, const glm::vec3 &half)
+    {
+        for (uint32_t v = 0; v < 8; v++)
+        {
+            glm::vec3 corner = center + half * glm::vec3(v & 1 ? 1 : -1, v & 2 ? 1 : -1, v & 4 ? 1 : -1);
+            vertices.insert(vertices.end(), {corner.x, corner.y, corner.z, (v & 1) * 1.0f, (v & 2) * 0.5f, (v & 4) * 0.25f});
+        }
+
+        indices = {0, 2, 1, 1, 2, 3, 4, 5, 6, 5, 7, 6, 0, 1, 4, 1, 5, 4, 2, 6, 3, 3, 6, 7, 0, 4, 2, 2, 4, 6, 1, 3, 5, 3, 7, 5};
+
+        this->vertex_attributes.push_back(VertexAttributes::DrawableAttribute::F3);
+        this->vertex_attributes.push_back(VertexAttributes::DrawableAttribute::F3);
+    }
+
+    void update() override
+    {
+    }
+};
+
+/**
+ * Culls the same boxes with the compute shader and with cullBoxes from several views, reading back the GPU count buffer.
+ * The GPU count must lie between the CPU counts of the frustum shrunk and enlarged by the margin. Returns 1 otherwise
+ */
+int main(int argc, char **argv)
+{
+    uint32_t element_count = argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : DEFAULT_ELEMENTS;
+    uint32_t device_index = argc > 2 ? static_cast<uint32_t>(atoi(argv[2])) : 0;
+
+    // Headless instance and device, no window system involved
+    std::vector<const char *> extensions;
+    shared_ptr<Vulkan> vulkan = make_shared<Vulkan>("GPU culling benchmark", "No Engine", extensions, false, true);
+
+    unique_ptr<PhysicalDevice> p_device = make_unique<PhysicalDevice>(vulkan->getInstance(), VK_NULL_HANDLE, device_index);
+    printf("Device: %s\n", p_device->getProperties().deviceName);
+    shared_ptr<LogicalDevice> l_device = make_shared<LogicalDevice>(move(p_device), VK_NULL_HANDLE);
+    printf("Draw indirect count: %s\n", l_device->getDrawIndexedIndirectCount() != nullptr ? "yes" : "no");
+
+    shared_ptr<CommandPool> command_pool = make_shared<CommandPool>(l_device, VK_NULL_HANDLE);
+    unique_ptr<CommandBuffer> command_buffer = make_unique<CommandBuffer>(l_device, command_pool->getCommandPool());
+    unique_ptr<Fence> fence = make_unique<Fence>(l_device, false);
+
+    // The pipeline is never drawn, the render pass is only needed to create it
+    unique_ptr<OffscreenTarget> target = make_unique<OffscreenTarget>(l_device, VkExtent2D{WIDTH, HEIGHT}, OffscreenTargetConfiguration{});
+    unique_ptr<RenderPass> render_pass = make_unique<RenderPass>(l_device, target->getExtent(), target->getFormat(), DepthTestType::DEPTH_32,
+                                                                 VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+
+    vector<shared_ptr<Shader>> shaders;
+    shaders.push_back(make_shared<Shader>(l_device, "examples/cube/shaders/vert.spv", ShaderType::VERTEX));
+    shaders.push_back(make_shared<Shader>(l_device, "examples/cube/shaders/frag.spv", ShaderType::FRAGMENT));
+
+    UniformBufferConfiguration gubo_config;
+    gubo_config.binding_index = 0;
+    gubo_config.stage_flags = VK_SHADER_STAGE_VERTEX_BIT;
+    shared_ptr<UniformBuffer<GlobalUniformBuffer>> gubo = make_shared<UniformBuffer<GlobalUniformBuffer>>(l_device, gubo_config);
+
+    std::vector<shared_ptr<DescriptorElement>> elements;
+    elements.push_back(gubo);
+
+    unique_ptr<DrawableCollection> collection = make_unique<DrawableCollection>(l_device, make_unique<DescriptorSet>(l_device, elements),
+                                                                                command_pool->getCommandPool(), shaders);
+
+    // Random boxes scattered around the origin
+    mt19937 generator(42);
+    uniform_real_distribution<float> position(-500.0f, 500.0f);
+    uniform_real_distribution<float> extent(0.5f, 5.0f);
+
+    for (uint32_t i = 0; i < element_count; i++)
+    {
+        collection->addElement(make_shared<Box>(glm::vec3(position(generator), position(generator), position(generator)),
+                                                glm::vec3(extent(generator), extent(generator), extent(generator))));
+    }
+    collection->allocate();
+
+    shared_ptr<Pipeline> pipeline = make_shared<Pipeline>(l_device, move(collection), render_pass->getDepthTestType(), render_pass->getRenderPass(),
+                                                          PipelineConfiguration{});
+
+    // The planes are moved in the model space by both implementations
+    pipeline->setModelMatrix(glm::rotate(glm::mat4(1.0f), glm::radians(30.0f), glm::vec3(0, 1, 0)));
+
+    shared_ptr<GpuCulling> culling = make_shared<GpuCulling>(l_device, pipeline, GpuCullingConfiguration{});
+
+    StorageBufferConfiguration readback_config;
+    readback_config.additional_usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    shared_ptr<StorageBuffer<uint32_t>> readback = make_shared<StorageBuffer<uint32_t>>(l_device, readback_config);
+
+    vector<uint8_t> visibility(element_count);
+    uint32_t failures = 0;
+    double gpu_time = 0, cpu_time = 0;
+
+    for (uint32_t v = 0; v < VIEWS; v++)
+    {
+        Camera camera{45, 0.1f, 400.0f};
+        camera.setPosition({0, 0, 0});
+        float angle = glm::radians(360.0f * v / VIEWS);
+        camera.lookAt({glm::cos(angle), 0.2f, glm::sin(angle)});
+        Frustum frustum = camera.getFrustum(WIDTH, HEIGHT);
+
+        // Culling dispatch and count copy, each frame waits the previous one so the time is a full round trip
+        auto start = chrono::steady_clock::now();
+
+        command_buffer->beginRecording();
+        culling->recordCulling(command_buffer->getCommandBuffer(), &frustum);
+
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+        vkCmdPipelineBarrier(command_buffer->getCommandBuffer(), VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        VkBufferCopy region{};
+        region.size = sizeof(uint32_t);
+        vkCmdCopyBuffer(command_buffer->getCommandBuffer(), culling->getCountBuffer(), readback->getStorageBuffer(), 1, &region);
+
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+        vkCmdPipelineBarrier(command_buffer->getCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+        command_buffer->stopRecording();
+
+        VkSubmitInfo submit_info{};
+        submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit_info.commandBufferCount = 1;
+        submit_info.pCommandBuffers = &command_buffer->getCommandBuffer();
+
+        if (vkQueueSubmit(l_device->getGraphicsQueue(), 1, &submit_info, fence->getFence()) != VK_SUCCESS)
+        {
+            printf("Failed to submit the culling\n");
+            return 1;
+        }
+
+        fence->waitFor(1);
+        fence->reset(1);
+
+        gpu_time += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+        uint32_t gpu_visible = *readback->getMappedData();
+
+        // Reference count, as the renderer computes it for the CPU culled pipelines
+        Frustum local_frustum = frustum.transform(pipeline->getModelMatrix());
+
+        start = chrono::steady_clock::now();
+        uint32_t cpu_visible = cullBoxes(local_frustum, pipeline->getElementBounds(), visibility.data());
+        cpu_time += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+        Frustum shrunk = local_frustum, enlarged = local_frustum;
+        for (int i = 0; i < 6; i++)
+        {
+            float scale = glm::length(glm::vec3(local_frustum.planes[i]));
+            shrunk.planes[i].w -= MARGIN * scale;
+            enlarged.planes[i].w += MARGIN * scale;
+        }
+
+        uint32_t min_visible = cullBoxes(shrunk, pipeline->getElementBounds(), visibility.data());
+        uint32_t max_visible = cullBoxes(enlarged, pipeline->getElementBounds(), visibility.data());
+
+        bool valid = gpu_visible >= min_visible && gpu_visible <= max_visible;
+        failures += !valid;
+
+        printf("View %2u: GPU %u visible, CPU %u visible (%u-%u with margin) %s\n", v, gpu_visible, cpu_visible, min_visible, max_visible,
+               valid ? "" : "MISMATCH");
+    }
+
+    l_device->waitIdle();
+
+    printf("Elements: %u, views: %u, failures: %u\n", element_count, VIEWS, failures);
+    printf("GPU culling round trip: %.3f ms, CPU cullBoxes: %.3f ms\n", gpu_time / VIEWS, cpu_time / VIEWS);
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,228 @@
+#include <stdio.h>
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <libs/glm/glm.hpp>
+#include <libs/glm/gtc/matrix_transform.hpp>
+#include <framework/core/vulkan.h>
+#include <framework/utils/camera.h>
+#include <framework/core/uniformBuffer.h>
+#include <framework/utils/defaultRenderer.h>
+
+using namespace std;
+using namespace framework;
+
+constexpr uint32_t WIDTH = 1920;
+constexpr uint32_t HEIGHT = 1080;
+constexpr uint32_t GRID = 32;
+constexpr uint32_t WARMUP_FRAMES = 60;
+constexpr uint32_t DEFAULT_FRAMES = 1000;
+
+struct GlobalUniformBuffer
+{
+    alignas(16) glm::mat4 model;
+    alignas(16) glm::mat4 view;
+    alignas(16) glm::mat4 projection;
+};
+
+// Colored cube of the cube example, translated to its grid cell
+class Cube : public DrawableElement
+{
+public:
+    Cube(const glm::vec3 &offset)
+    {
+        // Corners and outward normal axis of every face, colored by axis
+        const float faces[6][4][3] = {
+            {{-1, -1, -1}, {1, -1, -1}, {-1, 1, -1}, {1, 1, -1}},
+            {{-1, -1, -1}, {-1, -1, 1}, {-1, 1, -1}, {-1, 1, 1}},
+            {{1, -1, -1}, {1, -1, 1}, {1, 1, -1}, {1, 1, 1}},
+            {{-1, 1, -1}, {1, 1, -1}, {-1, 1, 1}, {1, 1, 1}},
+            {{-1, -1, -1}, {1, -1, -1}, {-1, -1, 1}, {1, -1, 1}},
+            {{-1, -1, 1}, {1, -1, 1}, {-1, 1, 1}, {1, 1, 1}}};
+        const glm::vec3 colors[6] = {{1, 0, 0}, {0, 1, 0}, {0, 1, 0}, {0, 0, 1}, {0, 0, 1}, {1, 0, 0}};
+        // Winding of the two triangles, flipped on the faces seen from the other side
+        const bool flipped[6] = {true, false, true, true, false, false};
+
+        for (uint32_t f = 0; f < 6; f++)
+        {
+            uint32_t base = f * 4;
+
+            for (uint32_t v = 0; v < 4; v++)
+            {
+                vertices.insert(vertices.end(), {faces[f][v][0] * 0.4f + offset.x, faces[f][v][1] * 0.4f + offset.y, faces[f][v][2] * 0.4f + offset.z,
+                                                 colors[f].r, colors[f].g, colors[f].b});
+            }
+
+            if (flipped[f])
+            {
+                indices.insert(indices.end(), {base + 2, base + 1, base + 0, base + 1, base + 2, base + 3});
+            }
+            else
+            {
+                indices.insert(indices.end(), {base + 0, base + 1, base + 2, base + 3, base + 2, base + 1});
+            }
+        }
+
+        this->vertex_attributes.push_back(VertexAttributes::DrawableAttribute::F3);
+        this->vertex_attributes.push_back(VertexAttributes::DrawableAttribute::F3);
+    }
+
+    void update() override
+    {
+    }
+};
+
+int main(int argc, char **argv)
+{
+    uint32_t frames = argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : DEFAULT_FRAMES;
+    uint32_t device_index = argc > 2 ? static_cast<uint32_t>(atoi(argv[2])) : 0;
+    // Optional capture of the measured frames: png, raw or y4m
+    const char *capture_format = argc > 3 ? argv[3] : nullptr;
+
+    // Headless instance and device, no window system involved
+    std::vector<const char *> extensions;
+    shared_ptr<Vulkan> vulkan = make_shared<Vulkan>("Headless benchmark", "No Engine", extensions, false, true);
+
+    unique_ptr<PhysicalDevice> p_device = make_unique<PhysicalDevice>(vulkan->getInstance(), VK_NULL_HANDLE, device_index);
+    printf("Device: %s\n", p_device->getProperties().deviceName);
+    shared_ptr<LogicalDevice> l_device = make_shared<LogicalDevice>(move(p_device), VK_NULL_HANDLE);
+
+    shared_ptr<CommandPool> command_pool = make_shared<CommandPool>(l_device, VK_NULL_HANDLE);
+    unique_ptr<CommandBuffer> command_buffer = make_unique<CommandBuffer>(l_device, command_pool->getCommandPool());
+
+    // Offscreen color images in place of the swap chain ones, the render pass owns the depth image
+    unique_ptr<OffscreenTarget> target = make_unique<OffscreenTarget>(l_device, VkExtent2D{WIDTH, HEIGHT}, OffscreenTargetConfiguration{});
+    unique_ptr<RenderPass> render_pass = make_unique<RenderPass>(l_device, target->getExtent(), target->getFormat(), DepthTestType::DEPTH_32,
+                                                                 VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+    unique_ptr<FrameBufferCollection> frame_buffer_collection = make_unique<FrameBufferCollection>(l_device, target->getImageViews(), target->getExtent(),
+                                                                                                   render_pass->getDepthTestType(), render_pass->getDepthImageView(), render_pass->getRenderPass());
+
+    // Grid of cubes drawn by a single pipeline
+    vector<shared_ptr<Shader>> shaders;
+    shaders.push_back(make_shared<Shader>(l_device, "examples/cube/shaders/vert.spv", ShaderType::VERTEX));
+    shaders.push_back(make_shared<Shader>(l_device, "examples/cube/shaders/frag.spv", ShaderType::FRAGMENT));
+
+    UniformBufferConfiguration gubo_config;
+    gubo_config.binding_index = 0;
+    gubo_config.stage_flags = VK_SHADER_STAGE_VERTEX_BIT;
+    shared_ptr<UniformBuffer<GlobalUniformBuffer>> gubo = make_shared<UniformBuffer<GlobalUniformBuffer>>(l_device, gubo_config);
+
+    std::vector<shared_ptr<DescriptorElement>> elements;
+    elements.push_back(gubo);
+
+    unique_ptr<DrawableCollection> collection = make_unique<DrawableCollection>(l_device, make_unique<DescriptorSet>(l_device, elements),
+                                                                                command_pool->getCommandPool(), shaders);
+
+    for (uint32_t x = 0; x < GRID; x++)
+    {
+        for (uint32_t z = 0; z < GRID; z++)
+        {
+            collection->addElement(make_shared<Cube>(glm::vec3(x - GRID / 2.0f, 0, z - GRID / 2.0f)));
+        }
+    }
+    collection->allocate();
+
+    unique_ptr<DefaultRenderer> renderer = make_unique<DefaultRenderer>();
+    renderer->addPipeline(make_shared<Pipeline>(l_device, move(collection), render_pass->getDepthTestType(), render_pass->getRenderPass(), PipelineConfiguration{}));
+    renderer->selectInstance(vulkan);
+    renderer->selectLogicalDevice(l_device);
+    renderer->selectOffscreenTarget(move(target));
+    renderer->selectRenderPass(move(render_pass));
+    renderer->selectFrameBufferCollection(move(frame_buffer_collection));
+    renderer->selectCommandBuffer(move(command_buffer));
+
+    shared_ptr<FrameCapture> capture;
+
+    if (capture_format != nullptr)
+    {
+        FrameCaptureConfiguration capture_config;
+        capture_config.format = strcmp(capture_format, "raw") == 0 ? FrameCaptureFormat::RAW : strcmp(capture_format, "y4m") == 0 ? FrameCaptureFormat::Y4M
+                                                                                                                                  : FrameCaptureFormat::PNG;
+        capture_config.path = capture_config.format == FrameCaptureFormat::PNG ? "headless" : string("headless.") + capture_format;
+
+        capture = make_shared<FrameCapture>(l_device, capture_config);
+        renderer->setFrameCapture(capture);
+    }
+
+    Camera camera{45, 0.1f, 100.0f};
+    camera.setPosition({0, 20.0f, -30.0f});
+    camera.lookAt({0, 0, 0});
+
+    GlobalUniformBuffer buf{};
+    buf.view = camera.getLookAtMatrix();
+    buf.projection = camera.getPerspectiveMatrix(WIDTH, HEIGHT);
+
+    // Frame times include the wait of the previous frame, so they measure the GPU throughput once the pipeline is full
+    vector<double> frame_times;
+    TimingMeasurement totals{};
+
+    for (uint32_t i = 0; i < WARMUP_FRAMES + frames; i++)
+    {
+        buf.model = glm::rotate(glm::mat4(1.0f), i * glm::radians(0.5f), glm::vec3(0, 1, 0));
+        gubo->setData(buf);
+
+        // Only the measured frames are captured
+        if (i == WARMUP_FRAMES && capture != nullptr)
+        {
+            capture->start();
+        }
+
+        auto start = chrono::steady_clock::now();
+        renderer->draw({0.0f, 0.0f, 0.0f, 1.0f});
+
+        if (i < WARMUP_FRAMES)
+        {
+            continue;
+        }
+
+        frame_times.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+
+        const TimingMeasurement &timings = renderer->getTimings();
+        totals.time_to_wait_fence += timings.time_to_wait_fence;
+        totals.time_to_update_pipelines += timings.time_to_update_pipelines;
+        totals.time_to_record_command_buffer += timings.time_to_record_command_buffer;
+    }
+
+    if (capture != nullptr)
+    {
+        capture->stop();
+    }
+
+    l_device->waitIdle();
+
+    if (frame_times.empty())
+    {
+        return 0;
+    }
+
+    double total = 0;
+    for (double time : frame_times)
+    {
+        total += time;
+    }
+
+    sort(frame_times.begin(), frame_times.end());
+    double average = total / frame_times.size();
+
+    printf("Frames: %zu at %ux%u, %u cubes\n", frame_times.size(), WIDTH, HEIGHT, GRID * GRID);
+    printf("Throughput: %.1f frames/s\n", 1000.0 / average);
+    printf("Frame time: avg %.3f ms, min %.3f ms, median %.3f ms, p99 %.3f ms, max %.3f ms\n", average, frame_times.front(),
+           frame_times[frame_times.size() / 2], frame_times[frame_times.size() * 99 / 100], frame_times.back());
+    printf("Per frame: fence wait %.3f ms, pipelines update %.3f ms, recording %.3f ms\n", totals.time_to_wait_fence / frame_times.size(),
+           totals.time_to_update_pipelines / frame_times.size(), totals.time_to_record_command_buffer / frame_times.size());
+
+
+    if (capture != nullptr)
+    {
+        FrameCaptureStatistics statistics = capture->getStatistics();
+        printf("Capture: %llu captured, %llu dropped, %llu written, %llu errors, submit %.3f ms, encode %.3f ms/frame on the workers\n",
+               static_cast<unsigned long long>(statistics.captured_frames), static_cast<unsigned long long>(statistics.dropped_frames),
+               static_cast<unsigned long long>(statistics.written_frames), static_cast<unsigned long long>(statistics.write_errors),
+               statistics.time_to_submit, statistics.time_to_encode);
+    }
+
+    return 0;
+}
@@ -0,0 +1,166 @@
+#include <stdio.h>
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <cmath>
+#include <framework/utils/jobSystem.h>
+
+using namespace std;
+using namespace framework;
+
+constexpr uint32_t EMPTY_JOBS = 200000;
+constexpr uint32_t CHAINED_JOBS = 20000;
+constexpr uint32_t EMPTY_LOOPS = 20000;
+constexpr uint32_t MAIN_THREAD_JOBS = 10000;
+constexpr uint32_t ELEMENTS = 1 << 20;
+constexpr uint32_t NESTED_OUTER = 64;
+constexpr uint32_t REPETITIONS = 5;
+
+// Some arithmetic per element so that the loops are compute bound
+float work(uint32_t i)
+{
+    float x = i * 1e-6f;
+    for (uint32_t k = 0; k < 16; k++)
+    {
+        x = std::sin(x) + 0.5f * x;
+    }
+    return x;
+}
+
+template <typename F>
+double measure(F function)
+{
+    double best = 1e30;
+    for (uint32_t r = 0; r < REPETITIONS; r++)
+    {
+        auto start = chrono::steady_clock::now();
+        function();
+        best = std::min(best, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+int main()
+{
+    JobSystem &jobs = JobSystem::getInstance();
+    uint32_t threads = jobs.getWorkersNumber() + 1;
+    bool valid = true;
+
+    printf("Workers: %u (+ calling thread)\n", jobs.getWorkersNumber());
+
+    // Scheduling overhead: independent empty jobs
+    atomic<uint32_t> executed = 0;
+    double empty_time = measure([&]
+                                {
+        JobCounter counter;
+        for (uint32_t i = 0; i < EMPTY_JOBS; i++)
+        {
+            jobs.run([&executed]
+                     { executed++; },
+                     &counter);
+        }
+        jobs.wait(counter); });
+    valid &= executed == EMPTY_JOBS * REPETITIONS;
+    printf("Empty jobs: %.1f ns/job\n", empty_time / EMPTY_JOBS * 1e9);
+
+    // Dependency overhead: every job starts once the previous one completed
+    vector<uint32_t> order;
+    double chain_time = measure([&]
+                                {
+        order.clear();
+        vector<unique_ptr<JobCounter>> counters;
+        for (uint32_t i = 0; i < CHAINED_JOBS; i++)
+        {
+            counters.push_back(make_unique<JobCounter>());
+        }
+
+        jobs.run([&order]
+                 { order.push_back(0); },
+                 counters[0].get());
+        for (uint32_t i = 1; i < CHAINED_JOBS; i++)
+        {
+            jobs.run([&order, i]
+                     { order.push_back(i); },
+                     counters[i].get(), *counters[i - 1]);
+        }
+        jobs.wait(*counters.back()); });
+    for (uint32_t i = 0; i < order.size(); i++)
+    {
+        valid &= order[i] == i;
+    }
+    valid &= order.size() == CHAINED_JOBS;
+    printf("Chained jobs: %.1f ns/job\n", chain_time / CHAINED_JOBS * 1e9);
+
+    // Fork/join latency of a loop with a single element per thread
+    double loop_time = measure([&]
+                               {
+        for (uint32_t i = 0; i < EMPTY_LOOPS; i++)
+        {
+            jobs.parallelFor(threads, 1, [](size_t, size_t) {});
+        } });
+    printf("Empty parallelFor: %.2f us/loop\n", loop_time / EMPTY_LOOPS * 1e6);
+
+    // Main thread affinity: jobs queued by the workers and pumped by the main thread
+    uint32_t main_executed = 0;
+    bool main_only = true;
+    double main_time = measure([&]
+                               {
+        JobCounter counter;
+        jobs.parallelFor(MAIN_THREAD_JOBS, 0, [&](size_t begin, size_t end)
+                         {
+            for (size_t i = begin; i < end; i++)
+            {
+                jobs.runOnMainThread([&]
+                                     {
+                    main_only &= jobs.isMainThread();
+                    main_executed++; },
+                                     &counter);
+            } });
+        jobs.wait(counter); });
+    valid &= main_only && main_executed == MAIN_THREAD_JOBS * REPETITIONS;
+    printf("Main thread jobs: %.1f ns/job\n", main_time / MAIN_THREAD_JOBS * 1e9);
+
+    // Scaling of a compute bound loop
+    vector<float> reference(ELEMENTS), output(ELEMENTS);
+    double single_time = measure([&]
+                                 {
+        for (uint32_t i = 0; i < ELEMENTS; i++)
+        {
+            reference[i] = work(i);
+        } });
+
+    double parallel_time = measure([&]
+                                   { jobs.parallelFor(ELEMENTS, 0, [&](size_t begin, size_t end)
+                                                      {
+            for (size_t i = begin; i < end; i++)
+            {
+                output[i] = work(i);
+            } }); });
+    valid &= output == reference;
+
+    // Nested loops, the waiting threads execute the inner chunks
+    std::fill(output.begin(), output.end(), 0.0f);
+    double nested_time = measure([&]
+                                 { jobs.parallelFor(NESTED_OUTER, 1, [&](size_t outer_begin, size_t outer_end)
+                                                    {
+            for (size_t outer = outer_begin; outer < outer_end; outer++)
+            {
+                size_t first = outer * (ELEMENTS / NESTED_OUTER);
+                jobs.parallelFor(ELEMENTS / NESTED_OUTER, 0, [&](size_t begin, size_t end)
+                                 {
+                    for (size_t i = first + begin; i < first + end; i++)
+                    {
+                        output[i] = work(i);
+                    } });
+            } }); });
+    valid &= output == reference;
+
+    printf("Single thread: %.2f ms\n", single_time * 1e3);
+    printf("parallelFor: %.2f ms, speedup %.2fx, efficiency %.0f%%\n", parallel_time * 1e3, single_time / parallel_time, single_time / parallel_time / threads * 100);
+    printf("Nested parallelFor: %.2f ms, speedup %.2fx\n", nested_time * 1e3, single_time / nested_time);
+    printf("Results: %s\n", valid ? "valid" : "INVALID");
+
+    return valid ? 0 : 1;
+}
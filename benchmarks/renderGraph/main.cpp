@@ -0,0 +1,206 @@
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <framework/core/vulkan.h>
+#include <framework/devices/physicalDevice.h>
+#include <framework/devices/logicalDevice.h>
+#include <framework/core/commandPool.h>
+#include <framework/core/commandBuffer.h>
+#include <framework/core/fence.h>
+#include <framework/core/offscreenTarget.h>
+#include <framework/core/renderGraph.h>
+
+using namespace std;
+using namespace framework;
+
+constexpr uint32_t WIDTH = 1920;
+constexpr uint32_t HEIGHT = 1080;
+constexpr uint32_t COMPILATIONS = 100;
+constexpr uint32_t WARMUP_FRAMES = 60;
+constexpr uint32_t DEFAULT_FRAMES = 1000;
+
+/**
+ * Deferred shading frame without draws: every pass only clears its attachments, so the frame measures the barriers, the
+ * load and store operations and the recording of the graph. The passes with disjoint lifetimes let the graph alias their
+ * images, the debug pass writes an image no one reads and has to be culled. Returns 1 if the statistics do not match
+ */
+int main(int argc, char **argv)
+{
+    uint32_t frames = argc > 1 ? static_cast<uint32_t>(atoi(argv[1])) : DEFAULT_FRAMES;
+    uint32_t device_index = argc > 2 ? static_cast<uint32_t>(atoi(argv[2])) : 0;
+
+    // Headless instance and device, no window system involved
+    std::vector<const char *> extensions;
+    shared_ptr<Vulkan> vulkan = make_shared<Vulkan>("Render graph benchmark", "No Engine", extensions, false, true);
+
+    unique_ptr<PhysicalDevice> p_device = make_unique<PhysicalDevice>(vulkan->getInstance(), VK_NULL_HANDLE, device_index);
+    printf("Device: %s\n", p_device->getProperties().deviceName);
+    shared_ptr<LogicalDevice> l_device = make_shared<LogicalDevice>(move(p_device), VK_NULL_HANDLE);
+
+    shared_ptr<CommandPool> command_pool = make_shared<CommandPool>(l_device, VK_NULL_HANDLE);
+    unique_ptr<CommandBuffer> command_buffer = make_unique<CommandBuffer>(l_device, command_pool->getCommandPool());
+    unique_ptr<Fence> fence = make_unique<Fence>(l_device, false);
+
+    // The graph output is the offscreen image, left ready to be read back
+    unique_ptr<OffscreenTarget> target = make_unique<OffscreenTarget>(l_device, VkExtent2D{WIDTH, HEIGHT}, OffscreenTargetConfiguration{});
+
+    RenderGraph graph(l_device);
+    graph.setExtent(target->getExtent());
+
+    RenderGraphImageConfiguration color_config;
+    color_config.format = VK_FORMAT_R8G8B8A8_UNORM;
+
+    RenderGraphImageConfiguration hdr_config;
+    hdr_config.format = VK_FORMAT_R16G16B16A16_SFLOAT;
+
+    RenderGraphImageConfiguration bloom_config = hdr_config;
+    bloom_config.extent = {WIDTH / 2, HEIGHT / 2};
+
+    RenderGraphImageConfiguration depth_config;
+    depth_config.format = VK_FORMAT_D32_SFLOAT;
+    depth_config.aspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+
+    RenderGraphImageConfiguration output_config;
+    output_config.format = target->getFormat().format;
+    output_config.initial_stages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+    output_config.final_layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+    uint32_t albedo = graph.createImage("albedo", color_config);
+    uint32_t normal = graph.createImage("normal", hdr_config);
+    uint32_t depth = graph.createImage("depth", depth_config);
+    uint32_t hdr = graph.createImage("hdr", hdr_config);
+    uint32_t bloom_down = graph.createImage("bloom down", bloom_config);
+    uint32_t bloom_up = graph.createImage("bloom up", bloom_config);
+    uint32_t debug_view = graph.createImage("debug view", color_config);
+    uint32_t output = graph.importImage("output", output_config);
+
+    auto record = [](const VkCommandBuffer &) {};
+
+    RenderGraphPassConfiguration gbuffer_config;
+    gbuffer_config.writes = {{albedo, RenderGraphUsage::COLOR_ATTACHMENT}, {normal, RenderGraphUsage::COLOR_ATTACHMENT}, {depth, RenderGraphUsage::DEPTH_ATTACHMENT}};
+    graph.addPass("gbuffer", gbuffer_config, record);
+
+    RenderGraphPassConfiguration lighting_config;
+    lighting_config.reads = {{albedo, RenderGraphUsage::SAMPLED}, {normal, RenderGraphUsage::SAMPLED}, {depth, RenderGraphUsage::DEPTH_READ}};
+    lighting_config.writes = {{hdr, RenderGraphUsage::COLOR_ATTACHMENT}};
+    graph.addPass("lighting", lighting_config, record);
+
+    RenderGraphPassConfiguration bloom_down_config;
+    bloom_down_config.reads = {{hdr, RenderGraphUsage::SAMPLED}};
+    bloom_down_config.writes = {{bloom_down, RenderGraphUsage::COLOR_ATTACHMENT}};
+    graph.addPass("bloom down", bloom_down_config, record);
+
+    RenderGraphPassConfiguration bloom_up_config;
+    bloom_up_config.reads = {{bloom_down, RenderGraphUsage::SAMPLED}};
+    bloom_up_config.writes = {{bloom_up, RenderGraphUsage::COLOR_ATTACHMENT}};
+    graph.addPass("bloom up", bloom_up_config, record);
+
+    RenderGraphPassConfiguration composite_config;
+    composite_config.reads = {{hdr, RenderGraphUsage::SAMPLED}, {bloom_up, RenderGraphUsage::SAMPLED}};
+    composite_config.writes = {{output, RenderGraphUsage::COLOR_ATTACHMENT}};
+    composite_config.clear_color = {{0.25f, 0.5f, 0.75f, 1.0f}};
+    graph.addPass("composite", composite_config, record);
+
+    RenderGraphPassConfiguration debug_config;
+    debug_config.reads = {{normal, RenderGraphUsage::SAMPLED}};
+    debug_config.writes = {{debug_view, RenderGraphUsage::COLOR_ATTACHMENT}};
+    uint32_t debug_pass = graph.addPass("debug", debug_config, record);
+
+    graph.markOutput(output);
+
+    // Nothing is running on the device, every compilation can destroy the resources of the previous one
+    vector<double> compile_times;
+
+    for (uint32_t i = 0; i < COMPILATIONS; i++)
+    {
+        auto start = chrono::steady_clock::now();
+        graph.compile();
+        compile_times.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+    }
+
+    // Normal and the bloom images have the same format and disjoint lifetimes, they share the same memory at least
+    const RenderGraphStatistics &statistics = graph.getStatistics();
+    bool valid = true;
+
+    if (statistics.passes != 6 || statistics.culled_passes != 1 || !graph.isPassCulled(debug_pass))
+    {
+        printf("Expected only the debug pass culled, %u of %u passes culled\n", statistics.culled_passes, statistics.passes);
+        valid = false;
+    }
+
+    if (statistics.transient_images != 6)
+    {
+        printf("Expected 6 transient images, %u allocated\n", statistics.transient_images);
+        valid = false;
+    }
+
+    if (statistics.allocated_memory >= statistics.requested_memory)
+    {
+        printf("Expected aliased transient images, %llu bytes allocated for %llu requested\n", static_cast<unsigned long long>(statistics.allocated_memory),
+               static_cast<unsigned long long>(statistics.requested_memory));
+        valid = false;
+    }
+
+    // Frame times include the wait of the GPU, every frame is submitted and completed before the next one
+    vector<double> record_times, frame_times;
+
+    graph.setImportedImage(output, target->getImages()[0], target->getImageViews()[0]);
+
+    for (uint32_t i = 0; i < WARMUP_FRAMES + frames; i++)
+    {
+        auto start = chrono::steady_clock::now();
+
+        command_buffer->beginRecording();
+        graph.execute(command_buffer->getCommandBuffer());
+        command_buffer->stopRecording();
+
+        auto recorded = chrono::steady_clock::now();
+
+        VkSubmitInfo submit_info{};
+        submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit_info.commandBufferCount = 1;
+        submit_info.pCommandBuffers = &command_buffer->getCommandBuffer();
+
+        if (vkQueueSubmit(l_device->getGraphicsQueue(), 1, &submit_info, fence->getFence()) != VK_SUCCESS)
+        {
+            printf("Failed to submit the frame\n");
+            return 1;
+        }
+
+        fence->waitFor(1);
+        fence->reset(1);
+
+        if (i < WARMUP_FRAMES)
+        {
+            continue;
+        }
+
+        record_times.push_back(chrono::duration<double, milli>(recorded - start).count());
+        frame_times.push_back(chrono::duration<double, milli>(chrono::steady_clock::now() - start).count());
+    }
+
+    l_device->waitIdle();
+
+    sort(compile_times.begin(), compile_times.end());
+    printf("Graph: %u passes, %u culled, %u barriers, %u transient images\n", statistics.passes, statistics.culled_passes, statistics.barriers,
+           statistics.transient_images);
+    printf("Transient memory: %.1f MB allocated, %.1f MB requested (%.1f%% saved by aliasing)\n", statistics.allocated_memory / 1048576.0,
+           statistics.requested_memory / 1048576.0, statistics.requested_memory > 0 ? 100.0 * (1.0 - static_cast<double>(statistics.allocated_memory) / statistics.requested_memory) : 0.0);
+    printf("Compilation: min %.3f ms, median %.3f ms, max %.3f ms\n", compile_times.front(), compile_times[compile_times.size() / 2], compile_times.back());
+
+    if (!frame_times.empty())
+    {
+        sort(record_times.begin(), record_times.end());
+        sort(frame_times.begin(), frame_times.end());
+
+        printf("Frames: %zu at %ux%u\n", frame_times.size(), WIDTH, HEIGHT);
+        printf("Recording: min %.3f ms, median %.3f ms, p99 %.3f ms\n", record_times.front(), record_times[record_times.size() / 2],
+               record_times[record_times.size() * 99 / 100]);
+        printf("Frame time: min %.3f ms, median %.3f ms, p99 %.3f ms, max %.3f ms\n", frame_times.front(), frame_times[frame_times.size() / 2],
+               frame_times[frame_times.size() * 99 / 100], frame_times.back());
+    }
+
+    return valid ? 0 : 1;
+}
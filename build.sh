@@ -5,6 +5,8 @@ glslc examples/cube/shaders/cube.frag -o examples/cube/shaders/frag.spv
 glslc examples/OBJeffect/shaders/OBJeffect.vert -o examples/OBJeffect/shaders/vert.spv
 glslc examples/OBJeffect/shaders/OBJeffect.frag -o examples/OBJeffect/shaders/frag.spv
 
+glslc framework/shaders/frustumCulling.comp -o framework/shaders/frustumCulling.spv
+
 # Create the build directory where to put all the cmake stuff
 mkdir build
 
@@ -0,0 +1,171 @@
+#include "attachment.h"
+#include <stdexcept>
+
+namespace framework
+{
+    Attachment::Attachment(const std::shared_ptr<LogicalDevice> &l_device, const VkExtent2D &extent, const AttachmentConfiguration &config)
+    {
+        if (l_device == nullptr)
+        {
+            throw std::runtime_error("[Attachment] Null device instance");
+        }
+
+        this->l_device = l_device;
+        this->config = config;
+        this->extent = extent;
+
+        // Check that the format can be rendered to
+        VkFormatProperties props;
+        vkGetPhysicalDeviceFormatProperties(l_device->getPhysicalDevice()->getDevice(), config.format, &props);
+
+        VkFormatFeatureFlags needed = (config.usage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT) ? VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT
+                                                                                                   : VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT;
+
+        if ((props.optimalTilingFeatures & needed) == 0)
+        {
+            throw std::runtime_error("[Attachment] Format not supported as attachment");
+        }
+
+        createImage();
+    }
+
+    Attachment::~Attachment()
+    {
+        retireImage();
+    }
+
+    void Attachment::resize(const VkExtent2D &extent)
+    {
+        if (extent.width == this->extent.width && extent.height == this->extent.height)
+        {
+            return;
+        }
+
+        retireImage();
+
+        this->extent = extent;
+        createImage();
+    }
+
+    AttachmentConfiguration Attachment::depthConfiguration(DepthTestType depth)
+    {
+        if (depth == NONE)
+        {
+            throw std::runtime_error("[Attachment] No depth test type");
+        }
+
+        AttachmentConfiguration config;
+        config.format = static_cast<VkFormat>(depth);
+        config.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        config.aspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+
+        return config;
+    }
+
+    VkImageAspectFlags Attachment::getFormatAspects()
+    {
+        switch (config.format)
+        {
+        case VK_FORMAT_D32_SFLOAT:
+        case VK_FORMAT_D16_UNORM:
+            return VK_IMAGE_ASPECT_DEPTH_BIT;
+        case VK_FORMAT_D32_SFLOAT_S8_UINT:
+        case VK_FORMAT_D24_UNORM_S8_UINT:
+        case VK_FORMAT_D16_UNORM_S8_UINT:
+            return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+        default:
+            return config.aspect;
+        }
+    }
+
+    void Attachment::createImage()
+    {
+        if (extent.width == 0 || extent.height == 0)
+        {
+            throw std::runtime_error("[Attachment] Null extent");
+        }
+
+        VkImageCreateInfo image_info{};
+        image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        image_info.imageType = VK_IMAGE_TYPE_2D;
+        image_info.extent.width = extent.width;
+        image_info.extent.height = extent.height;
+        image_info.extent.depth = 1;
+        image_info.mipLevels = 1;
+        image_info.arrayLayers = 1;
+        image_info.format = config.format;
+        image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+        image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        image_info.usage = config.usage;
+        image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+        image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateImage(l_device->getDevice(), &image_info, nullptr, &image) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[Attachment] Failed to create image");
+        }
+
+        VkMemoryRequirements mem_requirements;
+        vkGetImageMemoryRequirements(l_device->getDevice(), image, &mem_requirements);
+
+        VkMemoryAllocateInfo alloc_info{};
+        alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        alloc_info.allocationSize = mem_requirements.size;
+        alloc_info.memoryTypeIndex = findMemoryType(mem_requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        if (vkAllocateMemory(l_device->getDevice(), &alloc_info, nullptr, &image_memory) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[Attachment] Failed to allocate image memory");
+        }
+
+        vkBindImageMemory(l_device->getDevice(), image, image_memory, 0);
+
+        VkImageViewCreateInfo view_info{};
+        view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        view_info.image = image;
+        view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        view_info.format = config.format;
+        view_info.subresourceRange.aspectMask = config.aspect;
+        view_info.subresourceRange.baseMipLevel = 0;
+        view_info.subresourceRange.levelCount = 1;
+        view_info.subresourceRange.baseArrayLayer = 0;
+        view_info.subresourceRange.layerCount = 1;
+
+        if (vkCreateImageView(l_device->getDevice(), &view_info, nullptr, &image_view) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[Attachment] Error creating the image view");
+        }
+    }
+
+    void Attachment::retireImage()
+    {
+        // Frames in flight may still render to the image
+        l_device->destroyDeferred([image = image, image_memory = image_memory, image_view = image_view](VkDevice device)
+                                  {
+            vkDestroyImageView(device, image_view, nullptr);
+            vkDestroyImage(device, image, nullptr);
+            vkFreeMemory(device, image_memory, nullptr); });
+
+        image = VK_NULL_HANDLE;
+        image_memory = VK_NULL_HANDLE;
+        image_view = VK_NULL_HANDLE;
+    }
+
+    uint32_t Attachment::findMemoryType(uint32_t type_filter, VkMemoryPropertyFlags properties)
+    {
+        VkPhysicalDeviceMemoryProperties memory_properties;
+
+        // Enumerate the memory properties
+        vkGetPhysicalDeviceMemoryProperties(l_device->getPhysicalDevice()->getDevice(), &memory_properties);
+
+        for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++)
+        {
+            if ((type_filter & (1 << i)) && (memory_properties.memoryTypes[i].propertyFlags & properties) == properties)
+            {
+                return i;
+            }
+        }
+
+        throw std::runtime_error("[Attachment] Unable to find a suitable memory type");
+    }
+}
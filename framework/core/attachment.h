@@ -0,0 +1,81 @@
+#pragma once
+
+#include <devices/logicalDevice.h>
+#include <core/renderPass.h>
+
+#include <vulkan/vulkan.h>
+#include <memory>
+
+namespace framework
+{
+    /**
+     * @brief Formats of the attachments a pipeline renders to with dynamic rendering, in place of a render pass
+     */
+    struct AttachmentFormats
+    {
+        VkFormat color = VK_FORMAT_B8G8R8A8_SRGB;
+        DepthTestType depth = DepthTestType::NONE;
+    };
+
+    struct AttachmentConfiguration
+    {
+        VkFormat format = VK_FORMAT_D32_SFLOAT;
+        VkImageUsageFlags usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+        // Aspect of the view, the barriers use every aspect of the format
+        VkImageAspectFlags aspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+    };
+
+    /**
+     * @brief Device local image with its view, rendered to with dynamic rendering (e.g. the depth buffer). It does not depend on
+     * any render pass or frame buffer object, a resize only reallocates the image
+     */
+    class Attachment
+    {
+    public:
+        Attachment(const std::shared_ptr<LogicalDevice> &l_device, const VkExtent2D &extent, const AttachmentConfiguration &config);
+        ~Attachment();
+
+        /**
+         * @brief Reallocates the image with the new extent (if different). The previous one is destroyed through the device
+         * deletion queue, since frames in flight may still use it
+         */
+        void resize(const VkExtent2D &extent);
+
+        /**
+         * @brief Attachment configuration of the passed depth test, whose format includes a stencil component for the stencil types
+         */
+        static AttachmentConfiguration depthConfiguration(DepthTestType depth);
+
+        // Getters
+        const VkImage &getImage() { return image; }
+        const VkImageView &getImageView() { return image_view; }
+        VkFormat getFormat() { return config.format; }
+        const VkExtent2D &getExtent() { return extent; }
+        // Every aspect of the format, to be used by the layout transitions
+        VkImageAspectFlags getFormatAspects();
+
+    private:
+        /**
+         * @brief Creates the image, its memory and its view with the current extent
+         */
+        void createImage();
+
+        /**
+         * @brief Destroys the image, its memory and its view through the device deletion queue
+         */
+        void retireImage();
+
+        /**
+         * @brief Looks for the memory on the GPU that suits the passed parameters
+         */
+        uint32_t findMemoryType(uint32_t type_filter, VkMemoryPropertyFlags properties);
+
+        std::shared_ptr<LogicalDevice> l_device;
+        AttachmentConfiguration config;
+        VkExtent2D extent;
+
+        VkImage image = VK_NULL_HANDLE;
+        VkDeviceMemory image_memory = VK_NULL_HANDLE;
+        VkImageView image_view = VK_NULL_HANDLE;
+    };
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <vector>
+#include <stddef.h>
+
+namespace framework
+{
+    /**
+     * @brief Axis aligned boxes stored as structure of arrays, so that several boxes can be tested at once with SIMD
+     */
+    struct BoundingBoxes
+    {
+        std::vector<float> min_x, min_y, min_z;
+        std::vector<float> max_x, max_y, max_z;
+
+        inline size_t size() const { return min_x.size(); }
+    };
+}
@@ -3,7 +3,7 @@
 
 namespace framework
 {
-    CommandBuffer::CommandBuffer(const std::shared_ptr<LogicalDevice> &l_device, const VkCommandPool &pool)
+    CommandBuffer::CommandBuffer(const std::shared_ptr<LogicalDevice> &l_device, const VkCommandPool &pool, VkCommandBufferLevel level)
     {
         if (l_device == nullptr)
         {
@@ -16,13 +16,14 @@ namespace framework
         }
 
         this->l_device = l_device;
+        this->level = level;
 
         // Create the command buffer using the created command pool
         VkCommandBufferAllocateInfo alloc_info{};
 
         alloc_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
         alloc_info.commandPool = pool;
-        alloc_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        alloc_info.level = level;
         alloc_info.commandBufferCount = 1;
 
         if (vkAllocateCommandBuffers(l_device->getDevice(), &alloc_info, &buffer) != VK_SUCCESS)
@@ -45,6 +46,57 @@ namespace framework
         }
     }
 
+    void CommandBuffer::beginRecording(const VkRenderPass &render_pass, uint32_t subpass, const VkFramebuffer &frame_buffer)
+    {
+        if (level != VK_COMMAND_BUFFER_LEVEL_SECONDARY)
+        {
+            throw std::runtime_error("[CommandBuffer] Render pass inheritance requires a secondary command buffer");
+        }
+
+        VkCommandBufferInheritanceInfo inheritance_info{};
+
+        inheritance_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritance_info.renderPass = render_pass;
+        inheritance_info.subpass = subpass;
+        inheritance_info.framebuffer = frame_buffer;
+
+        VkCommandBufferBeginInfo begin_info{};
+
+        begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        begin_info.pInheritanceInfo = &inheritance_info;
+
+        if (vkBeginCommandBuffer(buffer, &begin_info) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[CommandBuffer] Impossible to begin recording");
+        }
+    }
+
+    void CommandBuffer::beginRecording(const VkCommandBufferInheritanceRenderingInfoKHR &rendering_info)
+    {
+        if (level != VK_COMMAND_BUFFER_LEVEL_SECONDARY)
+        {
+            throw std::runtime_error("[CommandBuffer] Rendering inheritance requires a secondary command buffer");
+        }
+
+        // No render pass nor frame buffer, the attachment formats are chained instead
+        VkCommandBufferInheritanceInfo inheritance_info{};
+
+        inheritance_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritance_info.pNext = &rendering_info;
+
+        VkCommandBufferBeginInfo begin_info{};
+
+        begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        begin_info.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        begin_info.pInheritanceInfo = &inheritance_info;
+
+        if (vkBeginCommandBuffer(buffer, &begin_info) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[CommandBuffer] Impossible to begin recording");
+        }
+    }
+
     void CommandBuffer::stopRecording()
     {
         if (vkEndCommandBuffer(buffer) != VK_SUCCESS)
@@ -14,13 +14,26 @@ namespace framework
     class CommandBuffer
     {
     public:
-        CommandBuffer(const std::shared_ptr<LogicalDevice> &l_device, const VkCommandPool &pool);
+        CommandBuffer(const std::shared_ptr<LogicalDevice> &l_device, const VkCommandPool &pool, VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
 
         /**
          * @brief Starts the recording of commands to store into the command buffer
          */
         void beginRecording();
 
+        /**
+         * @brief Starts the recording of a secondary command buffer executed inside the passed render pass subpass. Secondaries are
+         * not one time submit, the primary executing them can be submitted again while they are not recorded again
+         * @throws Runtime Exception if the command buffer is a primary one
+         */
+        void beginRecording(const VkRenderPass &render_pass, uint32_t subpass, const VkFramebuffer &frame_buffer);
+
+        /**
+         * @brief Starts the recording of a secondary command buffer executed inside a dynamic rendering with the passed formats
+         * @throws Runtime Exception if the command buffer is a primary one
+         */
+        void beginRecording(const VkCommandBufferInheritanceRenderingInfoKHR &rendering_info);
+
         /**
          * @brief Stops the recording of commands into the command buffer
          */
@@ -32,6 +45,8 @@ namespace framework
     private:
         std::shared_ptr<LogicalDevice> l_device;
 
+        VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+
         VkCommandBuffer buffer = VK_NULL_HANDLE;
     };
 }
\ No newline at end of file
@@ -35,4 +35,12 @@ namespace framework
             vkDestroyCommandPool(l_device->getDevice(), pool, nullptr);
         }
     }
-}
\ No newline at end of file
+
+    void CommandPool::reset()
+    {
+        if (vkResetCommandPool(l_device->getDevice(), pool, 0) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[CommandPool] Error resetting the command pool");
+        }
+    }
+}
@@ -16,6 +16,11 @@ namespace framework
         CommandPool(const std::shared_ptr<LogicalDevice> &l_device, const VkSurfaceKHR &surface);
         ~CommandPool();
 
+        /**
+         * @brief Resets all the command buffers allocated from the pool at once, they must not be pending
+         */
+        void reset();
+
         // Getters
         const VkCommandPool &getCommandPool() { return pool; }
 
@@ -0,0 +1,96 @@
+#include "computePipeline.h"
+#include <utils/traceProfiler.h>
+
+#include <stdexcept>
+
+namespace framework
+{
+    ComputePipeline::ComputePipeline(const std::shared_ptr<LogicalDevice> &l_device, const std::shared_ptr<Shader> &shader,
+                                     std::unique_ptr<DescriptorSet> descriptor_set, const ComputePipelineConfiguration &config)
+        : config(config)
+    {
+        TraceZone zone("ComputePipeline::ComputePipeline");
+
+        if (l_device == nullptr)
+        {
+            throw std::runtime_error("[ComputePipeline] Null logical device instance");
+        }
+
+        if (shader == nullptr || shader->getShaderStage() != VK_SHADER_STAGE_COMPUTE_BIT)
+        {
+            throw std::runtime_error("[ComputePipeline] A compute shader is needed");
+        }
+
+        if (descriptor_set == nullptr)
+        {
+            throw std::runtime_error("[ComputePipeline] Null descriptor set instance");
+        }
+
+        this->l_device = l_device;
+        this->shader = shader;
+        this->descriptor_set = std::move(descriptor_set);
+
+        // Layout with the single descriptor set and the optional push constants
+        VkPushConstantRange push_constant_range{};
+        push_constant_range.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        push_constant_range.offset = 0;
+        push_constant_range.size = config.push_constants_size;
+
+        VkPipelineLayoutCreateInfo layout_info{};
+        layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        layout_info.setLayoutCount = 1;
+        layout_info.pSetLayouts = &this->descriptor_set->getDescriptorSetLayout();
+        layout_info.pushConstantRangeCount = config.push_constants_size > 0 ? 1 : 0;
+        layout_info.pPushConstantRanges = config.push_constants_size > 0 ? &push_constant_range : nullptr;
+
+        if (vkCreatePipelineLayout(l_device->getDevice(), &layout_info, nullptr, &layout) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ComputePipeline] Error creating the pipeline layout");
+        }
+
+        VkPipelineShaderStageCreateInfo stage_info{};
+        stage_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stage_info.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        stage_info.module = shader->getShader();
+        stage_info.pName = "main";
+
+        VkComputePipelineCreateInfo pipeline_info{};
+        pipeline_info.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipeline_info.stage = stage_info;
+        pipeline_info.layout = layout;
+
+        if (vkCreateComputePipelines(l_device->getDevice(), VK_NULL_HANDLE, 1, &pipeline_info, nullptr, &pipeline) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[ComputePipeline] Error creating the pipeline");
+        }
+    }
+
+    ComputePipeline::~ComputePipeline()
+    {
+        // Dispatches of the frames in flight may still use the pipeline
+        l_device->destroyDeferred([layout = layout, pipeline = pipeline](VkDevice device)
+                                  {
+            if (pipeline != VK_NULL_HANDLE)
+            {
+                vkDestroyPipeline(device, pipeline, nullptr);
+            }
+
+            if (layout != VK_NULL_HANDLE)
+            {
+                vkDestroyPipelineLayout(device, layout, nullptr);
+            } });
+    }
+
+    void ComputePipeline::dispatch(const VkCommandBuffer &command_buffer, uint32_t groups_x, uint32_t groups_y, uint32_t groups_z, const void *push_constants)
+    {
+        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, layout, 0, 1, &descriptor_set->getDescriptorSet(), 0, nullptr);
+
+        if (config.push_constants_size > 0 && push_constants != nullptr)
+        {
+            vkCmdPushConstants(command_buffer, layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, config.push_constants_size, push_constants);
+        }
+
+        vkCmdDispatch(command_buffer, groups_x, groups_y, groups_z);
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <devices/logicalDevice.h>
+#include <core/shader.h>
+#include <core/descriptorSet.h>
+
+#include <vulkan/vulkan.h>
+#include <memory>
+
+namespace framework
+{
+    struct ComputePipelineConfiguration
+    {
+        // Size in bytes of the push constants block (0 means no push constants), 128 bytes are always available
+        uint32_t push_constants_size = 0;
+    };
+
+    class ComputePipeline
+    {
+    public:
+        /**
+         * @throws Runtime Exception if the shader is not a compute one or the pipeline cannot be created
+         */
+        ComputePipeline(const std::shared_ptr<LogicalDevice> &l_device, const std::shared_ptr<Shader> &shader,
+                        std::unique_ptr<DescriptorSet> descriptor_set, const ComputePipelineConfiguration &config);
+        ~ComputePipeline();
+
+        /**
+         * @brief Binds the pipeline with its descriptor set and records the dispatch of the passed work groups.
+         * Push constants (if configured) are copied from the passed pointer
+         */
+        void dispatch(const VkCommandBuffer &command_buffer, uint32_t groups_x, uint32_t groups_y = 1, uint32_t groups_z = 1, const void *push_constants = nullptr);
+
+        // Getters
+        const VkPipeline &getPipeline() { return pipeline; }
+        const VkPipelineLayout &getLayout() { return layout; }
+        const VkDescriptorSet &getDescriptorSet() { return descriptor_set->getDescriptorSet(); }
+
+    private:
+        ComputePipelineConfiguration config;
+
+        std::shared_ptr<LogicalDevice> l_device;
+        std::shared_ptr<Shader> shader;
+        std::unique_ptr<DescriptorSet> descriptor_set;
+
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        VkPipelineLayout layout = VK_NULL_HANDLE;
+    };
+}
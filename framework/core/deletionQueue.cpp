@@ -0,0 +1,80 @@
+#include "deletionQueue.h"
+
+namespace framework
+{
+    DeletionQueue::~DeletionQueue()
+    {
+        flushAll();
+    }
+
+    void DeletionQueue::push(uint64_t frame, std::function<void()> deleter)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.push_back({frame, std::move(deleter)});
+    }
+
+    void DeletionQueue::flush(uint64_t completed_frame)
+    {
+        // Deleters are moved out before running, so that they can safely push new ones
+        std::vector<std::function<void()>> ready;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (entries.empty())
+            {
+                return;
+            }
+
+            std::vector<Entry> pending;
+
+            for (Entry &entry : entries)
+            {
+                if (entry.frame <= completed_frame)
+                {
+                    ready.push_back(std::move(entry.deleter));
+                }
+                else
+                {
+                    pending.push_back(std::move(entry));
+                }
+            }
+
+            entries.swap(pending);
+        }
+
+        for (auto &deleter : ready)
+        {
+            deleter();
+        }
+    }
+
+    void DeletionQueue::flushAll()
+    {
+        while (true)
+        {
+            std::vector<Entry> ready;
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ready.swap(entries);
+            }
+
+            if (ready.empty())
+            {
+                return;
+            }
+
+            for (Entry &entry : ready)
+            {
+                entry.deleter();
+            }
+        }
+    }
+
+    size_t DeletionQueue::size()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries.size();
+    }
+}
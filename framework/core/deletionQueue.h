@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <mutex>
+#include <stdint.h>
+
+namespace framework
+{
+    /**
+     * @brief Defers the destruction of vulkan objects that may still be used by submitted frames. Every deleter is tagged with
+     * the last frame (or timeline value) that may use the object and it is executed once that frame is known to be completed.
+     * The remaining ones are executed at destruction, when the device is expected to be idle. Deleters can be pushed by any thread
+     */
+    class DeletionQueue
+    {
+    public:
+        DeletionQueue() = default;
+        ~DeletionQueue();
+
+        DeletionQueue(const DeletionQueue &) = delete;
+        DeletionQueue &operator=(const DeletionQueue &) = delete;
+
+        /**
+         * @brief Queues the deleter until the passed frame is completed
+         */
+        void push(uint64_t frame, std::function<void()> deleter);
+
+        /**
+         * @brief Executes, in the push order, the deleters of the frames up to the completed one
+         */
+        void flush(uint64_t completed_frame);
+
+        /**
+         * @brief Executes every deleter, the device must not be using any of the queued objects
+         */
+        void flushAll();
+
+        // Getters
+        size_t size();
+
+    private:
+        struct Entry
+        {
+            uint64_t frame;
+            std::function<void()> deleter;
+        };
+
+        std::mutex mutex;
+        std::vector<Entry> entries;
+    };
+}
@@ -79,15 +79,18 @@ namespace framework
 
     DescriptorSet::~DescriptorSet()
     {
-        if (pool != VK_NULL_HANDLE)
-        {
-            vkDestroyDescriptorPool(l_device->getDevice(), pool, nullptr);
-        }
-
-        if (descriptor_set_layout != VK_NULL_HANDLE)
-        {
-            vkDestroyDescriptorSetLayout(l_device->getDevice(), descriptor_set_layout, nullptr);
-        }
+        // The descriptor sets may still be bound by frames in flight
+        l_device->destroyDeferred([pool = pool, descriptor_set_layout = descriptor_set_layout](VkDevice device)
+                                  {
+            if (pool != VK_NULL_HANDLE)
+            {
+                vkDestroyDescriptorPool(device, pool, nullptr);
+            }
+
+            if (descriptor_set_layout != VK_NULL_HANDLE)
+            {
+                vkDestroyDescriptorSetLayout(device, descriptor_set_layout, nullptr);
+            } });
     }
 
 }
\ No newline at end of file
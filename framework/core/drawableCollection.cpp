@@ -1,7 +1,13 @@
 #include "drawableCollection.h"
+#include <utils/gpuProfiler.h>
+#include <utils/traceProfiler.h>
 
 #include <stdexcept>
 #include <cstring>
+#include <algorithm>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
 
 namespace framework
 {
@@ -36,83 +42,172 @@ namespace framework
 
     DrawableCollection::~DrawableCollection()
     {
-        if (vertex_staging_buffer != VK_NULL_HANDLE)
+        // Buffers and memory of the streams and of the indices, the collection may be dropped while frames using it are in flight
+        std::vector<VkBuffer> buffers = {index_staging_buffer, index_buffer};
+        std::vector<VkDeviceMemory> memories = {index_staging_buffer_memory, index_buffer_memory};
+
+        for (VertexStream &stream : streams)
         {
-            vkDestroyBuffer(l_device->getDevice(), vertex_staging_buffer, nullptr);
+            buffers.push_back(stream.staging_buffer);
+            buffers.push_back(stream.buffer);
+            memories.push_back(stream.staging_buffer_memory);
+            memories.push_back(stream.buffer_memory);
         }
 
-        if (vertex_staging_buffer_memory != VK_NULL_HANDLE)
+        l_device->destroyDeferred([buffers, memories, copy_fence = copy_fence](VkDevice device)
+                                  {
+            for (VkBuffer buffer : buffers)
+            {
+                if (buffer != VK_NULL_HANDLE)
+                {
+                    vkDestroyBuffer(device, buffer, nullptr);
+                }
+            }
+
+            for (VkDeviceMemory memory : memories)
+            {
+                if (memory != VK_NULL_HANDLE)
+                {
+                    vkFreeMemory(device, memory, nullptr);
+                }
+            }
+
+            if (copy_fence != VK_NULL_HANDLE)
+            {
+                vkDestroyFence(device, copy_fence, nullptr);
+            } });
+    }
+
+    void DrawableCollection::addElement(const std::shared_ptr<DrawableElement> &element)
+    {
+        if (element == nullptr)
         {
-            vkFreeMemory(l_device->getDevice(), vertex_staging_buffer_memory, nullptr);
+            throw std::runtime_error("[DrawableCollection] Null element");
         }
 
-        if (index_staging_buffer != VK_NULL_HANDLE)
+        if (!allocated)
+        {
+            // In case of empty vertex attributes, use the ones with the new element
+            if (elements.size() == 0)
+            {
+                attributes = std::make_unique<VertexAttributes>(element->getVertexAttributes());
+            }
+
+            // Check that the new element has the same vertex attributes of the other ones in the collection
+            if (!(*attributes.get() == element->getVertexAttributes()))
+            {
+                throw std::runtime_error("[DrawableCollection] New element vertex attributes differ from exsiting elements inside the collection");
+            }
+
+            elements.push_back(element);
+            computeElementBounds(elements.size() - 1);
+
+            // Increase the counters
+            vertices_size += element->getVertices().size();
+            indices_size += element->getIndices().size();
+        }
+        else
         {
-            vkDestroyBuffer(l_device->getDevice(), index_staging_buffer, nullptr);
+            throw std::runtime_error("[DrawableCollection] The buffer has already been allocated");
         }
+    }
 
-        if (index_staging_buffer_memory != VK_NULL_HANDLE)
+    void DrawableCollection::setAttributeStreams(const std::vector<uint32_t> &streams)
+    {
+        if (allocated)
         {
-            vkFreeMemory(l_device->getDevice(), index_staging_buffer_memory, nullptr);
+            throw std::runtime_error("[DrawableCollection] The buffer has already been allocated");
         }
 
-        if (vertex_buffer != VK_NULL_HANDLE)
+        attribute_streams = streams;
+    }
+
+    void DrawableCollection::setInstanceAttributes(const std::vector<VertexAttributes::DrawableAttribute> &attributes)
+    {
+        if (allocated)
         {
-            vkDestroyBuffer(l_device->getDevice(), vertex_buffer, nullptr);
+            throw std::runtime_error("[DrawableCollection] The buffer has already been allocated");
         }
 
-        if (vertex_buffer_memory != VK_NULL_HANDLE)
+        if (attributes.size() == 0)
         {
-            vkFreeMemory(l_device->getDevice(), vertex_buffer_memory, nullptr);
+            throw std::runtime_error("[DrawableCollection] Empty instance attributes");
         }
 
-        if (index_buffer != VK_NULL_HANDLE)
+        instance_attributes = attributes;
+        instance_stride = VertexAttributes(attributes).getStride();
+    }
+
+    void DrawableCollection::setInstances(const void *data, uint32_t count)
+    {
+        if (!hasInstanceData())
         {
-            vkDestroyBuffer(l_device->getDevice(), index_buffer, nullptr);
+            throw std::runtime_error("[DrawableCollection] No instance attributes set");
         }
 
-        if (index_buffer_memory != VK_NULL_HANDLE)
+        if (data == nullptr && count > 0)
         {
-            vkFreeMemory(l_device->getDevice(), index_buffer_memory, nullptr);
+            throw std::runtime_error("[DrawableCollection] Null instance data");
         }
 
-        if (copy_fence != VK_NULL_HANDLE)
+        instance_data.resize(static_cast<size_t>(count) * instance_stride);
+
+        if (count > 0)
         {
-            vkDestroyFence(l_device->getDevice(), copy_fence, nullptr);
+            memcpy(instance_data.data(), data, instance_data.size());
         }
+
+        number_of_instances = count;
+        dirty_instances_begin = 0;
+        dirty_instances_end = count;
     }
 
-    void DrawableCollection::addElement(const std::shared_ptr<DrawableElement> &element)
+    void DrawableCollection::updateInstances(const void *data, uint32_t count, uint32_t first)
     {
-        if (element == nullptr)
+        if (!hasInstanceData())
         {
-            throw std::runtime_error("[DrawableCollection] Null element");
+            throw std::runtime_error("[DrawableCollection] No instance attributes set");
         }
 
-        if (!allocated)
+        if (static_cast<size_t>(first) + count > instance_data.size() / instance_stride)
         {
-            // In case of empty vertex attributes, use the ones with the new element
-            if (elements.size() == 0)
-            {
-                attributes = std::make_unique<VertexAttributes>(element->getVertexAttributes());
-            }
+            throw std::runtime_error("[DrawableCollection] Instances out of range");
+        }
 
-            // Check that the new element has the same vertex attributes of the other ones in the collection
-            if (!(*attributes.get() == element->getVertexAttributes()))
-            {
-                throw std::runtime_error("[DrawableCollection] New element vertex attributes differ from exsiting elements inside the collection");
-            }
+        if (count == 0)
+        {
+            return;
+        }
 
-            elements.push_back(element);
+        memcpy(&instance_data[static_cast<size_t>(first) * instance_stride], data, static_cast<size_t>(count) * instance_stride);
 
-            // Increase the counters
-            vertices_size += element->getVertices().size();
-            indices_size += element->getIndices().size();
+        // Extend the pending range, a single copy is done at upload time
+        if (dirty_instances_begin == dirty_instances_end)
+        {
+            dirty_instances_begin = first;
+            dirty_instances_end = first + count;
         }
         else
         {
-            throw std::runtime_error("[DrawableCollection] The buffer has already been allocated");
+            dirty_instances_begin = std::min(dirty_instances_begin, first);
+            dirty_instances_end = std::max(dirty_instances_end, first + count);
+        }
+    }
+
+    void DrawableCollection::flushInstances()
+    {
+        if (!hasInstanceData() || dirty_instances_begin == dirty_instances_end)
+        {
+            return;
         }
+
+        // Called once the previous frame is completed, growing the buffer is safe
+        instance_buffer->reserve(instance_data.size() / instance_stride);
+
+        size_t offset = static_cast<size_t>(dirty_instances_begin) * instance_stride;
+        memcpy(instance_buffer->getMappedData() + offset, &instance_data[offset], static_cast<size_t>(dirty_instances_end - dirty_instances_begin) * instance_stride);
+
+        dirty_instances_begin = dirty_instances_end = 0;
     }
 
     void DrawableCollection::allocate()
@@ -130,80 +225,159 @@ namespace framework
         // Set the allocated flag
         allocated = true;
 
-        // Get the size in bytes of the struct
+        // Get the size in words of the struct
         int size_of_struct = getAttributesSum();
         int vertex_index = 0;
 
+        // Split the attributes into the streams
+        computeStreamsLayout();
+        vertices_number = vertices_size / size_of_struct;
+
+        for (VertexStream &stream : streams)
+        {
+            stream.vertices.resize(vertices_number * stream.stride);
+        }
+
+        // 16 bit indices are used unless an element addresses more vertices than a segment can
+        index_type = VK_INDEX_TYPE_UINT16;
+        for (int i = 0; i < elements.size(); i++)
+        {
+            if (elements[i]->getVertices().size() / size_of_struct > MAX_SHORT_INDEXED_VERTICES)
+            {
+                index_type = VK_INDEX_TYPE_UINT32;
+                break;
+            }
+        }
+
+        if (index_type == VK_INDEX_TYPE_UINT16)
+        {
+            short_indices.reserve(indices_size);
+        }
+        else
+        {
+            indices.reserve(indices_size);
+        }
+
+        DrawRange range{};
+
         // Allocate the vectors befor creating the Vulkan buffer
         for (int i = 0; i < elements.size(); i++)
         {
             auto &vertex = elements[i]->getVertices();
             auto &index = elements[i]->getIndices();
+            uint32_t first_vertex = vertex_index / size_of_struct;
+            uint32_t element_vertices = vertex.size() / size_of_struct;
+
+            // Add the vertices on the bottom of the streams
+            scatterVertices(vertex, first_vertex);
+
+            // Start a new 16 bit addressable segment if the element does not fit the current one
+            if (index_type == VK_INDEX_TYPE_UINT16 && first_vertex + element_vertices - range.vertex_offset > MAX_SHORT_INDEXED_VERTICES)
+            {
+                draw_ranges.push_back(range);
+
+                range.first_index = range.first_index + range.index_count;
+                range.index_count = 0;
+                range.vertex_offset = first_vertex;
+            }
 
-            // Add the vertices on the bottom of the vector
-            vertices.insert(vertices.end(), vertex.begin(), vertex.end());
+            DrawRange element_range{};
+            element_range.first_index = range.first_index + range.index_count;
+            element_range.index_count = index.size();
+            element_range.vertex_offset = range.vertex_offset;
+            element_ranges.push_back(element_range);
 
             // Manipulate the indices before inserting them into the vector
             for (int j = 0; j < index.size(); j++)
             {
-                indices.push_back(index[j] + vertex_index / size_of_struct);
+                if (index_type == VK_INDEX_TYPE_UINT16)
+                {
+                    short_indices.push_back(static_cast<uint16_t>(index[j] + first_vertex - range.vertex_offset));
+                }
+                else
+                {
+                    indices.push_back(index[j] + first_vertex);
+                }
             }
+            range.index_count += index.size();
 
             // Update the indices
             vertex_index += vertex.size();
         }
 
-        VkDeviceSize vertex_buffer_size = sizeof(vertices[0]) * vertices.size();
-        VkDeviceSize index_buffer_size = sizeof(indices[0]) * indices.size();
+        draw_ranges.push_back(range);
 
-        createBuffer(vertex_buffer_size,
-                     VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                     vertex_staging_buffer, vertex_staging_buffer_memory);
+        VkDeviceSize index_buffer_size = index_type == VK_INDEX_TYPE_UINT16 ? sizeof(short_indices[0]) * short_indices.size()
+                                                                             : sizeof(indices[0]) * indices.size();
+        const void *index_data = index_type == VK_INDEX_TYPE_UINT16 ? static_cast<const void *>(short_indices.data())
+                                                                     : static_cast<const void *>(indices.data());
 
         createBuffer(index_buffer_size,
                      VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
                      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
                      index_staging_buffer, index_staging_buffer_memory);
 
-        createBuffer(vertex_buffer_size,
-                     VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-                     vertex_buffer, vertex_buffer_memory);
-
         createBuffer(index_buffer_size,
                      VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
                      index_buffer, index_buffer_memory);
 
-        // Fill the vertex buffer
         void *data;
 
-        // Map the GPU memory into the RAM
-        vkMapMemory(l_device->getDevice(), vertex_staging_buffer_memory, 0, vertex_buffer_size, 0, &data);
+        // Every stream has its own buffer
+        for (VertexStream &stream : streams)
+        {
+            VkDeviceSize vertex_buffer_size = sizeof(stream.vertices[0]) * stream.vertices.size();
 
-        // Copy the data to the shared memory
-        memcpy(data, vertices.data(), (size_t)vertex_buffer_size);
+            createBuffer(vertex_buffer_size,
+                         VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         stream.staging_buffer, stream.staging_buffer_memory);
 
-        // Unmap the shared memory
-        vkUnmapMemory(l_device->getDevice(), vertex_staging_buffer_memory);
+            createBuffer(vertex_buffer_size,
+                         VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                         stream.buffer, stream.buffer_memory);
+
+            // Map the GPU memory into the RAM
+            vkMapMemory(l_device->getDevice(), stream.staging_buffer_memory, 0, vertex_buffer_size, 0, &data);
+
+            // Copy the data to the shared memory
+            memcpy(data, stream.vertices.data(), (size_t)vertex_buffer_size);
+
+            // Unmap the shared memory
+            vkUnmapMemory(l_device->getDevice(), stream.staging_buffer_memory);
+
+            // Transfer the data from staging area to the GPU memory
+            transferMemoryToGPU(vertex_buffer_size, stream.staging_buffer, stream.buffer, 0, 0);
+        }
 
         // Fill the index buffer
         vkMapMemory(l_device->getDevice(), index_staging_buffer_memory, 0, index_buffer_size, 0, &data);
 
         // Copy the data to the shared memory
-        memcpy(data, indices.data(), (size_t)index_buffer_size);
+        memcpy(data, index_data, (size_t)index_buffer_size);
 
         // Unmap the shared memory
         vkUnmapMemory(l_device->getDevice(), index_staging_buffer_memory);
 
         // Transfer the data from staging area to the GPU memory
-        transferMemoryToGPU(vertex_buffer_size, vertex_staging_buffer, vertex_buffer, 0, 0);
         transferMemoryToGPU(index_buffer_size, index_staging_buffer, index_buffer, 0, 0);
+
+        // Per instance binding
+        if (hasInstanceData())
+        {
+            instance_buffer = std::make_unique<InstanceBuffer>(l_device, instance_stride, std::max<uint32_t>(INITIAL_INSTANCES, instance_data.size() / instance_stride));
+            flushInstances();
+        }
     }
 
     void DrawableCollection::updateElements()
     {
+        TraceZone zone("DrawableCollection::updateElements");
+
+        flushInstances();
+
         int vertex_index = 0;
         int element_index = 0;
         int size_of_attributes = getAttributesSum();
@@ -218,33 +392,38 @@ namespace framework
 
             if (elements[i]->isUpdated())
             {
-                // Save the reference of the two vectors
+                // Save the reference of the vector
                 const std::vector<float> &v = elements[i]->getVertices();
+                uint32_t first_vertex = vertex_index / size_of_attributes;
+                uint32_t element_vertices = v.size() / size_of_attributes;
 
-                // Copy the new changed vertices inside the vertex vector
-                for (int j = 0; j < v.size(); j++)
+                // Copy the new changed vertices inside the streams
+                scatterVertices(v, first_vertex);
+
+                for (VertexStream &stream : streams)
                 {
-                    vertices[j + vertex_index] = v[j];
-                }
+                    // Compute the byte offset
+                    VkDeviceSize verticesOffset = first_vertex * stream.stride * sizeof(float);
+                    VkDeviceSize verticesSize = element_vertices * stream.stride * sizeof(float);
 
-                // Compute the byte offset
-                VkDeviceSize verticesOffset = vertex_index * sizeof(float);
-                VkDeviceSize verticesSize = v.size() * sizeof(float);
+                    // Map the changes inside the staging buffer
+                    void *data;
 
-                // Map the changes inside the staging buffer
-                void *data;
+                    // Map the GPU memory into the RAM
+                    vkMapMemory(l_device->getDevice(), stream.staging_buffer_memory, verticesOffset, verticesSize, 0, &data);
 
-                // Map the GPU memory into the RAM
-                vkMapMemory(l_device->getDevice(), vertex_staging_buffer_memory, verticesOffset, verticesSize, 0, &data);
+                    // Copy the data to the GPU memory
+                    memcpy(data, &stream.vertices.data()[first_vertex * stream.stride], (size_t)verticesSize);
 
-                // Copy the data to the GPU memory
-                memcpy(data, &vertices.data()[vertex_index], (size_t)verticesSize);
+                    // Unmap the GPU memory
+                    vkUnmapMemory(l_device->getDevice(), stream.staging_buffer_memory);
 
-                // Unmap the GPU memory
-                vkUnmapMemory(l_device->getDevice(), vertex_staging_buffer_memory);
+                    // Transfer the change into the GPU memory
+                    transferMemoryToGPU(verticesSize, stream.staging_buffer, stream.buffer, verticesOffset, verticesOffset);
+                }
 
-                // Transfer the change into the GPU memory
-                transferMemoryToGPU(verticesSize, vertex_staging_buffer, vertex_buffer, verticesOffset, verticesOffset);
+                // Vertices may have moved
+                computeElementBounds(i);
 
                 // Flag the element as updated
                 elements[i]->setUpdated();
@@ -261,20 +440,34 @@ namespace framework
         }
     }
 
-    VkVertexInputBindingDescription DrawableCollection::getBindingDescription()
+    std::vector<VkVertexInputBindingDescription> DrawableCollection::getBindingDescriptions()
     {
-        VkVertexInputBindingDescription result{};
-
-        // Collect the size of the overall struct
-        int size_of_struct = getAttributesSum();
+        std::vector<VkVertexInputBindingDescription> result{};
 
         // Data is populated only if the buffer has been allocated
         if (allocated)
         {
-            result.binding = 0;
-            result.stride = size_of_struct * sizeof(float);
-            // TODO make this configurable ?
-            result.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+            for (uint32_t i = 0; i < streams.size(); i++)
+            {
+                VkVertexInputBindingDescription description{};
+
+                description.binding = i;
+                description.stride = streams[i].stride * sizeof(float);
+                description.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+                result.push_back(description);
+            }
+
+            if (hasInstanceData())
+            {
+                VkVertexInputBindingDescription description{};
+
+                description.binding = getInstanceBinding();
+                description.stride = instance_stride;
+                description.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+                result.push_back(description);
+            }
         }
 
         return result;
@@ -287,66 +480,203 @@ namespace framework
         // Data is populated only if the buffer has been allocated
         if (allocated)
         {
-            uint32_t offset = 0;
             for (int i = 0; i < attributes->getVertexAttributes().size(); i++)
             {
                 VkVertexInputAttributeDescription description{};
 
-                description.binding = 0;
+                // Every attribute is placed at its (byte exact) offset inside the stream
+                description.binding = attribute_streams[i];
                 description.location = i;
                 description.format = static_cast<VkFormat>(attributes->getVertexAttributes()[i]);
-                description.offset = offset;
-
-                // Update the offset
-                switch (attributes->getVertexAttributes()[i])
-                {
-                case VertexAttributes::DrawableAttribute::F1:
-                case VertexAttributes::DrawableAttribute::I1:
-                    offset += 1 * sizeof(float);
-                    break;
-                case VertexAttributes::DrawableAttribute::F2:
-                    offset += 2 * sizeof(float);
-                    break;
-                case VertexAttributes::DrawableAttribute::F3:
-                    offset += 3 * sizeof(float);
-                    break;
-                case VertexAttributes::DrawableAttribute::F4:
-                    offset += 4 * sizeof(float);
-                    break;
-                }
+                description.offset = attribute_stream_offsets[i] * sizeof(float);
 
                 // Add the description at the end
                 descriptions.push_back(description);
             }
+
+            // Instance attributes follow the vertex ones, tightly packed inside the instance binding
+            uint32_t offset = 0;
+            for (size_t i = 0; i < instance_attributes.size(); i++)
+            {
+                VkVertexInputAttributeDescription description{};
+
+                description.binding = getInstanceBinding();
+                description.location = attributes->getVertexAttributes().size() + i;
+                description.format = static_cast<VkFormat>(instance_attributes[i]);
+                description.offset = offset;
+
+                offset += VertexAttributes::getAttributeSize(instance_attributes[i]);
+                descriptions.push_back(description);
+            }
         }
 
         return descriptions;
     }
 
-    int DrawableCollection::getAttributesSum()
+    void DrawableCollection::computeElementBounds(uint32_t element_index)
     {
-        int size_of_struct = 0;
-        for (int i = 0; i < attributes->getVertexAttributes().size(); i++)
+        const std::vector<float> &vertices = elements[element_index]->getVertices();
+        VertexAttributes::DrawableAttribute format = attributes->getVertexAttributes().at(0);
+        uint32_t stride = getAttributesSum();
+
+        glm::vec3 min(UNBOUNDED_EXTENT), max(-UNBOUNDED_EXTENT);
+        bool decodable = true;
+
+        for (size_t v = 0; v + stride <= vertices.size() && decodable; v += stride)
         {
-            switch (attributes->getVertexAttributes()[i])
+            const float *words = &vertices[v];
+            uint32_t packed[2];
+            memcpy(packed, words, std::min<uint32_t>(VertexAttributes::getAttributeSize(format), sizeof(packed)));
+
+            glm::vec3 position(0.0f);
+
+            switch (format)
             {
             case VertexAttributes::DrawableAttribute::F1:
-            case VertexAttributes::DrawableAttribute::I1:
-                size_of_struct += 1;
+                position.x = words[0];
                 break;
             case VertexAttributes::DrawableAttribute::F2:
-                size_of_struct += 2;
+                position = glm::vec3(words[0], words[1], 0.0f);
                 break;
             case VertexAttributes::DrawableAttribute::F3:
-                size_of_struct += 3;
-                break;
             case VertexAttributes::DrawableAttribute::F4:
-                size_of_struct += 4;
+                position = glm::vec3(words[0], words[1], words[2]);
+                break;
+            case VertexAttributes::DrawableAttribute::H2:
+                position = glm::vec3(glm::unpackHalf2x16(packed[0]), 0.0f);
+                break;
+            case VertexAttributes::DrawableAttribute::H4:
+                position = glm::vec3(glm::unpackHalf2x16(packed[0]), glm::unpackHalf2x16(packed[1]).x);
+                break;
+            case VertexAttributes::DrawableAttribute::S16N2:
+                position = glm::vec3(glm::unpackSnorm2x16(packed[0]), 0.0f);
+                break;
+            case VertexAttributes::DrawableAttribute::S16N4:
+                position = glm::vec3(glm::unpackSnorm2x16(packed[0]), glm::unpackSnorm2x16(packed[1]).x);
+                break;
+            case VertexAttributes::DrawableAttribute::U16N2:
+                position = glm::vec3(glm::unpackUnorm2x16(packed[0]), 0.0f);
+                break;
+            case VertexAttributes::DrawableAttribute::U16N4:
+                position = glm::vec3(glm::unpackUnorm2x16(packed[0]), glm::unpackUnorm2x16(packed[1]).x);
+                break;
+            case VertexAttributes::DrawableAttribute::U8N4:
+                position = glm::vec3(glm::unpackUnorm4x8(packed[0]));
+                break;
+            case VertexAttributes::DrawableAttribute::S8N4:
+                position = glm::vec3(glm::unpackSnorm4x8(packed[0]));
                 break;
+            default:
+                // Integer and packed formats are not positions
+                decodable = false;
+                continue;
             }
+
+            min = glm::min(min, position);
+            max = glm::max(max, position);
+        }
+
+        if (!decodable)
+        {
+            min = glm::vec3(-UNBOUNDED_EXTENT);
+            max = glm::vec3(UNBOUNDED_EXTENT);
         }
 
-        return size_of_struct;
+        if (element_index >= element_bounds.size())
+        {
+            element_bounds.min_x.resize(element_index + 1);
+            element_bounds.min_y.resize(element_index + 1);
+            element_bounds.min_z.resize(element_index + 1);
+            element_bounds.max_x.resize(element_index + 1);
+            element_bounds.max_y.resize(element_index + 1);
+            element_bounds.max_z.resize(element_index + 1);
+        }
+
+        element_bounds.min_x[element_index] = min.x;
+        element_bounds.min_y[element_index] = min.y;
+        element_bounds.min_z[element_index] = min.z;
+        element_bounds.max_x[element_index] = max.x;
+        element_bounds.max_y[element_index] = max.y;
+        element_bounds.max_z[element_index] = max.z;
+    }
+
+    int DrawableCollection::getAttributesSum()
+    {
+        // Every format is a multiple of a 32 bit word
+        return attributes->getStride() / sizeof(float);
+    }
+
+    void DrawableCollection::computeStreamsLayout()
+    {
+        const std::vector<VertexAttributes::DrawableAttribute> &vertex_attributes = attributes->getVertexAttributes();
+
+        // In case of no streams configuration, all the attributes are interleaved inside the first stream
+        if (attribute_streams.size() == 0)
+        {
+            attribute_streams.resize(vertex_attributes.size(), 0);
+        }
+
+        if (attribute_streams.size() != vertex_attributes.size())
+        {
+            throw std::runtime_error("[DrawableCollection] The number of attribute streams differs from the number of vertex attributes");
+        }
+
+        uint32_t streams_number = *std::max_element(attribute_streams.begin(), attribute_streams.end()) + 1;
+        streams.resize(streams_number);
+
+        uint32_t element_offset = 0;
+        for (size_t i = 0; i < vertex_attributes.size(); i++)
+        {
+            uint32_t words = VertexAttributes::getAttributeSize(vertex_attributes[i]) / sizeof(float);
+            VertexStream &stream = streams[attribute_streams[i]];
+
+            attribute_element_offsets.push_back(element_offset);
+            attribute_stream_offsets.push_back(stream.stride);
+
+            element_offset += words;
+            stream.stride += words;
+        }
+
+        // Empty streams would produce zero sized buffers
+        for (const VertexStream &stream : streams)
+        {
+            if (stream.stride == 0)
+            {
+                throw std::runtime_error("[DrawableCollection] Vertex streams must be contiguous");
+            }
+        }
+    }
+
+    void DrawableCollection::scatterVertices(const std::vector<float> &element_vertices, uint32_t first_vertex)
+    {
+        const std::vector<VertexAttributes::DrawableAttribute> &vertex_attributes = attributes->getVertexAttributes();
+        uint32_t size_of_struct = getAttributesSum();
+        uint32_t element_vertices_number = element_vertices.size() / size_of_struct;
+
+        if (element_vertices_number == 0)
+        {
+            return;
+        }
+
+        // Single interleaved stream, the layout is the same of the element
+        if (streams.size() == 1)
+        {
+            memcpy(&streams[0].vertices[first_vertex * size_of_struct], element_vertices.data(), element_vertices.size() * sizeof(float));
+            return;
+        }
+
+        for (size_t a = 0; a < vertex_attributes.size(); a++)
+        {
+            VertexStream &stream = streams[attribute_streams[a]];
+            uint32_t words = VertexAttributes::getAttributeSize(vertex_attributes[a]) / sizeof(float);
+            const float *src = &element_vertices[attribute_element_offsets[a]];
+            float *dst = &stream.vertices[first_vertex * stream.stride + attribute_stream_offsets[a]];
+
+            for (uint32_t v = 0; v < element_vertices_number; v++)
+            {
+                memcpy(dst + v * stream.stride, src + v * size_of_struct, words * sizeof(float));
+            }
+        }
     }
 
     uint32_t DrawableCollection::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
@@ -404,6 +734,10 @@ namespace framework
 
     void DrawableCollection::transferMemoryToGPU(VkDeviceSize size, VkBuffer src, VkBuffer dst, VkDeviceSize src_offset, VkDeviceSize dst_offset)
     {
+        TraceZone zone("DrawableCollection::transferMemoryToGPU");
+
+        uploaded_bytes += size;
+
         // Reset the fence
         vkResetFences(l_device->getDevice(), 1, &copy_fence);
 
@@ -413,6 +747,11 @@ namespace framework
         // Record the command buffer to transfer the memory
         command_buffer->beginRecording();
 
+        if (gpu_profiler != nullptr)
+        {
+            gpu_profiler->beginImmediateScope(command_buffer->getCommandBuffer(), upload_scope);
+        }
+
         VkBufferCopy copy_region{};
         copy_region.srcOffset = src_offset;
         copy_region.dstOffset = dst_offset;
@@ -420,6 +759,11 @@ namespace framework
 
         vkCmdCopyBuffer(command_buffer->getCommandBuffer(), src, dst, 1, &copy_region);
 
+        if (gpu_profiler != nullptr)
+        {
+            gpu_profiler->endImmediateScope(command_buffer->getCommandBuffer(), upload_scope);
+        }
+
         // End the command buffer recording
         command_buffer->stopRecording();
 
@@ -434,5 +778,10 @@ namespace framework
 
         // Wait for copy to be completed
         vkWaitForFences(l_device->getDevice(), 1, &copy_fence, VK_TRUE, UINT64_MAX);
+
+        if (gpu_profiler != nullptr)
+        {
+            gpu_profiler->resolveImmediateScope(upload_scope);
+        }
     }
 }
\ No newline at end of file
@@ -9,6 +9,8 @@
 #include <core/descriptorSet.h>
 #include <core/commandBuffer.h>
 #include <core/vertexAttributes.h>
+#include <core/boundingBoxes.h>
+#include <core/instanceBuffer.h>
 #include <devices/logicalDevice.h>
 #include <devices/physicalDevice.h>
 
@@ -17,6 +19,30 @@
 
 namespace framework
 {
+    /**
+     * @brief Portion of the index buffer drawn with a single indexed draw call. With 16 bit indices
+     * every range addresses at most 65536 vertices starting from its vertex offset.
+     */
+    struct DrawRange
+    {
+        uint32_t first_index = 0;
+        uint32_t index_count = 0;
+        int32_t vertex_offset = 0;
+    };
+
+    /**
+     * @brief Per instance data of the default instance attributes: model matrix (column major, 4 locations), color and
+     * material index. Only 32 bit members, so that the struct is tightly packed like the instance buffer
+     */
+    struct InstanceData
+    {
+        float transform[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+        float color[4] = {1, 1, 1, 1};
+        uint32_t material = 0;
+    };
+
+    class GpuProfiler;
+
     class DrawableCollection
     {
     public:
@@ -29,6 +55,37 @@ namespace framework
          */
         void addElement(const std::shared_ptr<DrawableElement> &element);
 
+        /**
+         * @brief Assigns every vertex attribute (by position) to a vertex stream. Attributes of the same stream are interleaved
+         * while every stream is stored inside its own device buffer and bound to the binding with the same index.
+         * By default every attribute belongs to stream 0. Streams must be contiguous starting from 0.
+         * @throws Runtime Exception if the buffer has already been allocated
+         */
+        void setAttributeStreams(const std::vector<uint32_t> &streams);
+
+        /**
+         * @brief Adds a binding read per instance (VK_VERTEX_INPUT_RATE_INSTANCE) after the vertex streams. Its attributes
+         * follow the vertex ones in location order. The default layout matches InstanceData
+         * @throws Runtime Exception if the buffer has already been allocated or the attributes are empty
+         */
+        void setInstanceAttributes(const std::vector<VertexAttributes::DrawableAttribute> &attributes = {
+                                       VertexAttributes::DrawableAttribute::F4, VertexAttributes::DrawableAttribute::F4,
+                                       VertexAttributes::DrawableAttribute::F4, VertexAttributes::DrawableAttribute::F4,
+                                       VertexAttributes::DrawableAttribute::F4, VertexAttributes::DrawableAttribute::I1});
+
+        /**
+         * @brief Replaces the per instance data with count instances (getInstanceStride bytes each) and sets the number of instances.
+         * The data is copied and uploaded with updateElements, so it can be called at any moment of the frame
+         * @throws Runtime Exception if no instance attributes are set
+         */
+        void setInstances(const void *data, uint32_t count);
+
+        /**
+         * @brief Overwrites the instances [first, first + count) with the passed data, only the modified range is uploaded
+         * @throws Runtime Exception if the range exceeds the number of instances
+         */
+        void updateInstances(const void *data, uint32_t count, uint32_t first);
+
         /**
          * @brief Allocates the buffer inside the GPU memory if not already done
          * @throws Runtime Exception if the buffer is already allocated
@@ -37,19 +94,33 @@ namespace framework
 
         /**
          * @brief Updates the elements inside the vertex and indices vectors and transfers the modifications
-         * into the GPU memory
+         * into the GPU memory, together with the modified instances. The instances are written straight into the mapped
+         * instance buffer, the previous frame must be completed
          */
         void updateElements();
 
         // Getters
-        VkVertexInputBindingDescription getBindingDescription();
+        std::vector<VkVertexInputBindingDescription> getBindingDescriptions();
         std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions();
-        const VkBuffer &getVertexBuffer() { return vertex_buffer; }
+        const VkBuffer &getVertexBuffer(uint32_t stream = 0) { return streams.at(stream).buffer; }
         const VkBuffer &getIndexBuffer() { return index_buffer; }
-        uint32_t getVerticesNumber() { return vertices.size() / getAttributesSum(); }
-        uint32_t getIndexSize() { return indices.size(); }
+        uint32_t getStreamsNumber() { return streams.size(); }
+        uint32_t getVerticesNumber() { return vertices_number; }
+        uint32_t getIndexSize() { return indices_size; }
+        VkIndexType getIndexType() { return index_type; }
+        const std::vector<DrawRange> &getDrawRanges() { return draw_ranges; }
+        const std::vector<DrawRange> &getElementRanges() { return element_ranges; }
+        const BoundingBoxes &getElementBounds() { return element_bounds; }
+        uint32_t getElementsNumber() { return elements.size(); }
         uint32_t getNumberOfInstances() { return number_of_instances; }
+        bool hasInstanceData() { return instance_attributes.size() > 0; }
+        // The instance binding follows the vertex streams ones
+        uint32_t getInstanceBinding() { return streams.size(); }
+        const VkBuffer &getInstanceBuffer() { return instance_buffer->getBuffer(); }
+        uint32_t getInstanceStride() { return instance_stride; }
         bool isAllocated() { return allocated; }
+        // Bytes copied to the GPU since the collection creation
+        uint64_t getUploadedBytes() { return uploaded_bytes; }
         const std::vector<std::shared_ptr<Shader>> &getShaders() { return shaders; }
         inline const VkDescriptorPool &getDescriptorPool() { return descriptor_set->getDescriptorPool(); }
         inline const VkDescriptorSet &getDescriptorSet() { return descriptor_set->getDescriptorSet(); }
@@ -58,10 +129,60 @@ namespace framework
 
         // Setters
         void setNumberOfInstances(uint32_t instances) { number_of_instances = instances; }
+        // Measures every upload with the immediate scope of the profiler, nullptr disables it
+        void setGpuProfiler(const std::shared_ptr<GpuProfiler> &profiler, uint32_t scope)
+        {
+            gpu_profiler = profiler;
+            upload_scope = scope;
+        }
 
     private:
+        // Maximum number of vertices addressable by a 16 bit index segment
+        static constexpr uint32_t MAX_SHORT_INDEXED_VERTICES = 65536;
+
+        // Initial capacity of the instance buffer, it grows with the number of instances
+        static constexpr uint32_t INITIAL_INSTANCES = 64;
+
+        // Extent of the elements whose position format cannot be decoded (never culled). Finite so that plane tests do not produce NaNs
+        static constexpr float UNBOUNDED_EXTENT = 1e30f;
+
+        struct VertexStream
+        {
+            // Interleaved words of the attributes assigned to the stream
+            std::vector<float> vertices;
+            // Stream vertex size in 32 bit words
+            uint32_t stride = 0;
+
+            VkBuffer staging_buffer = VK_NULL_HANDLE;
+            VkDeviceMemory staging_buffer_memory = VK_NULL_HANDLE;
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkDeviceMemory buffer_memory = VK_NULL_HANDLE;
+        };
+
         /**
-         * @brief Sums the number of floats per vertex
+         * @brief Creates the streams and computes where every attribute is placed inside its stream
+         * @throws Runtime Exception if the streams are not contiguous or the number of streams differs from the attributes one
+         */
+        void computeStreamsLayout();
+
+        /**
+         * @brief Copies the element interleaved vertices inside the streams, starting from the passed vertex
+         */
+        void scatterVertices(const std::vector<float> &element_vertices, uint32_t first_vertex);
+
+        /**
+         * @brief Uploads the modified instances, growing the instance buffer if needed. The instance buffer is rewritten in
+         * place, so no submitted frame may still be reading it (single frame in flight, as in DefaultRenderer)
+         */
+        void flushInstances();
+
+        /**
+         * @brief Computes the local space bounding box of the element from its first (position) attribute
+         */
+        void computeElementBounds(uint32_t element_index);
+
+        /**
+         * @brief Sums the number of 32 bit words per vertex (compressed formats are packed inside words)
          */
         int getAttributesSum();
 
@@ -82,6 +203,7 @@ namespace framework
 
         int vertices_size = 0;
         int indices_size = 0;
+        uint32_t vertices_number = 0;
 
         // Instance number of the same objects that we want to draw
         uint32_t number_of_instances = 1;
@@ -97,11 +219,33 @@ namespace framework
         // List of drawable elements
         std::vector<std::shared_ptr<DrawableElement>> elements;
 
-        // Vector of vertices
-        std::vector<float> vertices;
+        // Stream index of every attribute, and word offsets of the attribute inside the element vertex and its stream vertex
+        std::vector<uint32_t> attribute_streams;
+        std::vector<uint32_t> attribute_element_offsets;
+        std::vector<uint32_t> attribute_stream_offsets;
 
-        // Vector of indices
+        // Vertex streams (one binding each)
+        std::vector<VertexStream> streams;
+
+        // Vector of indices (only one of the two is populated depending on the index type)
         std::vector<uint32_t> indices;
+        std::vector<uint16_t> short_indices;
+
+        // Index type chosen at allocation time and draw ranges needed to address all the vertices
+        VkIndexType index_type = VK_INDEX_TYPE_UINT32;
+        std::vector<DrawRange> draw_ranges;
+
+        // Index range of every element (same order of the elements) and their bounding boxes
+        std::vector<DrawRange> element_ranges;
+        BoundingBoxes element_bounds;
+
+        // Per instance attributes and data, with the range of instances modified since the last upload
+        std::vector<VertexAttributes::DrawableAttribute> instance_attributes;
+        uint32_t instance_stride = 0;
+        std::vector<uint8_t> instance_data;
+        uint32_t dirty_instances_begin = 0;
+        uint32_t dirty_instances_end = 0;
+        std::unique_ptr<InstanceBuffer> instance_buffer;
 
         // Shaders for the pipeline
         const std::vector<std::shared_ptr<Shader>> shaders;
@@ -109,15 +253,16 @@ namespace framework
         // Allocated state. Represents if the buffers have already been allocated
         bool allocated = false;
 
+        // Upload timings and amount
+        std::shared_ptr<GpuProfiler> gpu_profiler;
+        uint32_t upload_scope = 0;
+        uint64_t uploaded_bytes = 0;
+
         // Vulkan objects
         VkFence copy_fence = VK_NULL_HANDLE;
 
-        VkBuffer vertex_staging_buffer = VK_NULL_HANDLE;
-        VkDeviceMemory vertex_staging_buffer_memory = VK_NULL_HANDLE;
         VkBuffer index_staging_buffer = VK_NULL_HANDLE;
         VkDeviceMemory index_staging_buffer_memory = VK_NULL_HANDLE;
-        VkBuffer vertex_buffer = VK_NULL_HANDLE;
-        VkDeviceMemory vertex_buffer_memory = VK_NULL_HANDLE;
         VkBuffer index_buffer = VK_NULL_HANDLE;
         VkDeviceMemory index_buffer_memory = VK_NULL_HANDLE;
     };
@@ -65,10 +65,23 @@ namespace framework
     }
 
     void FrameBufferCollection::recreateFrameBuffer(const std::vector<VkImageView> &image_views, const VkExtent2D &extent,
-                                                    const DepthTestType &dept_test_type, const VkImageView &depth_image_view, const VkRenderPass &render_pass)
+                                                    const DepthTestType &dept_test_type, const VkImageView &depth_image_view, const VkRenderPass &render_pass,
+                                                    bool deferred)
     {
-        // Clean the previous
-        cleanup();
+        // Clean the previous, or queue them if they may still be used by the submitted frames
+        if (deferred)
+        {
+            l_device->destroyDeferred([old_frame_buffers = frame_buffers](VkDevice device)
+                                      {
+                for (VkFramebuffer buffer : old_frame_buffers)
+                {
+                    vkDestroyFramebuffer(device, buffer, nullptr);
+                } });
+        }
+        else
+        {
+            cleanup();
+        }
 
         // Create the new frame buffer
         createFrameBuffer(image_views, extent, dept_test_type, depth_image_view, render_pass);
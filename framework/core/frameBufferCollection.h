@@ -18,10 +18,12 @@ namespace framework
         ~FrameBufferCollection();
 
         /**
-         * @brief Recreates the frame buffer (usually called after window resize)
+         * @brief Recreates the frame buffer (usually called after window resize). When deferred, the previous frame buffers are
+         * destroyed through the device deletion queue instead of immediately
          */
         void recreateFrameBuffer(const std::vector<VkImageView> &image_views, const VkExtent2D &extent,
-                                 const DepthTestType &depth_test_type, const VkImageView &depth_image_view, const VkRenderPass &render_pass);
+                                 const DepthTestType &depth_test_type, const VkImageView &depth_image_view, const VkRenderPass &render_pass,
+                                 bool deferred = false);
 
         // Getter
         const std::vector<VkFramebuffer> &getFrameBuffers() { return frame_buffers; }
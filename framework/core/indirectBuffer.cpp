@@ -0,0 +1,124 @@
+#include "indirectBuffer.h"
+
+#include <stdexcept>
+
+namespace framework
+{
+    IndirectBuffer::IndirectBuffer(const std::shared_ptr<LogicalDevice> &l_device, uint32_t capacity)
+    {
+        if (l_device == nullptr)
+        {
+            throw std::runtime_error("[IndirectBuffer] Null logical device instance");
+        }
+
+        if (capacity == 0)
+        {
+            throw std::runtime_error("[IndirectBuffer] Zero commands capacity");
+        }
+
+        this->l_device = l_device;
+        this->capacity = capacity;
+
+        createBuffer();
+    }
+
+    IndirectBuffer::~IndirectBuffer()
+    {
+        destroyBuffer();
+    }
+
+    void IndirectBuffer::reserve(uint32_t commands)
+    {
+        if (commands <= capacity)
+        {
+            return;
+        }
+
+        // Geometric growth to avoid reallocating every frame while the draw count increases
+        while (capacity < commands)
+        {
+            capacity *= 2;
+        }
+
+        destroyBuffer();
+        createBuffer();
+    }
+
+    void IndirectBuffer::createBuffer()
+    {
+        VkDeviceSize size = sizeof(VkDrawIndexedIndirectCommand) * capacity;
+
+        VkBufferCreateInfo buffer_info{};
+
+        buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        buffer_info.size = size;
+        buffer_info.usage = VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+        buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateBuffer(l_device->getDevice(), &buffer_info, nullptr, &buffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[IndirectBuffer] Impossible to create the buffer");
+        }
+
+        // Enumerate the memory requirements
+        VkMemoryRequirements memory_requirements;
+        vkGetBufferMemoryRequirements(l_device->getDevice(), buffer, &memory_requirements);
+
+        // Allocate the memory on GPU
+        VkMemoryAllocateInfo alloc_info{};
+
+        alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        alloc_info.allocationSize = memory_requirements.size;
+        alloc_info.memoryTypeIndex = findMemoryType(memory_requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+        if (vkAllocateMemory(l_device->getDevice(), &alloc_info, nullptr, &buffer_memory) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[IndirectBuffer] Impossible to allocate the required memory on the GPU");
+        }
+
+        // Associate the buffer to the memory
+        vkBindBufferMemory(l_device->getDevice(), buffer, buffer_memory, 0);
+
+        // Persistent memory mapping
+        vkMapMemory(l_device->getDevice(), buffer_memory, 0, size, 0, &mapped_memory);
+    }
+
+    void IndirectBuffer::destroyBuffer()
+    {
+        // The commands may still be read by frames in flight (also when growing)
+        l_device->destroyDeferred([buffer = buffer, buffer_memory = buffer_memory](VkDevice device)
+                                  {
+            if (buffer_memory != VK_NULL_HANDLE)
+            {
+                vkUnmapMemory(device, buffer_memory);
+                vkFreeMemory(device, buffer_memory, nullptr);
+            }
+
+            if (buffer != VK_NULL_HANDLE)
+            {
+                vkDestroyBuffer(device, buffer, nullptr);
+            } });
+
+        buffer = VK_NULL_HANDLE;
+        buffer_memory = VK_NULL_HANDLE;
+        mapped_memory = nullptr;
+    }
+
+    uint32_t IndirectBuffer::findMemoryType(uint32_t type_filter, VkMemoryPropertyFlags properties)
+    {
+        VkPhysicalDeviceMemoryProperties memory_properties;
+
+        // Enumerate the memory properties
+        vkGetPhysicalDeviceMemoryProperties(l_device->getPhysicalDevice()->getDevice(), &memory_properties);
+
+        for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++)
+        {
+            if ((type_filter & (1 << i)) && (memory_properties.memoryTypes[i].propertyFlags & properties) == properties)
+            {
+                return i;
+            }
+        }
+
+        throw std::runtime_error("[IndirectBuffer] Unable to find a suitable memory type");
+    }
+}
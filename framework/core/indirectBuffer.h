@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <devices/logicalDevice.h>
+
+#include <memory>
+
+namespace framework
+{
+    /**
+     * @brief Host visible and persistently mapped buffer of indexed indirect draw commands, written by the CPU
+     * every frame and consumed by vkCmdDrawIndexedIndirect
+     */
+    class IndirectBuffer
+    {
+    public:
+        IndirectBuffer(const std::shared_ptr<LogicalDevice> &l_device, uint32_t capacity);
+        ~IndirectBuffer();
+
+        /**
+         * @brief Grows the buffer (discarding its content) if it cannot hold the passed number of commands.
+         * The old buffer is destroyed, so it must not be referenced by pending command buffers
+         */
+        void reserve(uint32_t commands);
+
+        // Getters
+        inline const VkBuffer &getBuffer() { return buffer; }
+        inline VkDrawIndexedIndirectCommand *getCommands() { return static_cast<VkDrawIndexedIndirectCommand *>(mapped_memory); }
+        inline uint32_t getCapacity() { return capacity; }
+
+    private:
+        /**
+         * @brief Creates, allocates and maps the buffer with the current capacity
+         */
+        void createBuffer();
+
+        /**
+         * @brief Unmaps and destroys the buffer
+         */
+        void destroyBuffer();
+
+        uint32_t findMemoryType(uint32_t type_filter, VkMemoryPropertyFlags properties);
+
+        std::shared_ptr<LogicalDevice> l_device;
+
+        uint32_t capacity = 0;
+
+        // Vulkan objects
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory buffer_memory = VK_NULL_HANDLE;
+        void *mapped_memory = nullptr;
+    };
+}
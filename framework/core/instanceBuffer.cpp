@@ -0,0 +1,137 @@
+#include "instanceBuffer.h"
+
+#include <stdexcept>
+#include <cstring>
+#include <vector>
+
+namespace framework
+{
+    InstanceBuffer::InstanceBuffer(const std::shared_ptr<LogicalDevice> &l_device, uint32_t stride, uint32_t capacity)
+    {
+        if (l_device == nullptr)
+        {
+            throw std::runtime_error("[InstanceBuffer] Null logical device instance");
+        }
+
+        if (stride == 0)
+        {
+            throw std::runtime_error("[InstanceBuffer] Zero instance stride");
+        }
+
+        if (capacity == 0)
+        {
+            throw std::runtime_error("[InstanceBuffer] Zero instances capacity");
+        }
+
+        this->l_device = l_device;
+        this->stride = stride;
+        this->capacity = capacity;
+
+        createBuffer();
+    }
+
+    InstanceBuffer::~InstanceBuffer()
+    {
+        destroyBuffer();
+    }
+
+    void InstanceBuffer::reserve(uint32_t instances)
+    {
+        if (instances <= capacity)
+        {
+            return;
+        }
+
+        // Keep the content, the mapped memory is host visible so it is simply copied to the new buffer
+        std::vector<uint8_t> content(getMappedData(), getMappedData() + static_cast<size_t>(stride) * capacity);
+
+        // Geometric growth to avoid reallocating every frame while the instances increase
+        while (capacity < instances)
+        {
+            capacity *= 2;
+        }
+
+        destroyBuffer();
+        createBuffer();
+
+        memcpy(mapped_memory, content.data(), content.size());
+    }
+
+    void InstanceBuffer::createBuffer()
+    {
+        VkDeviceSize size = static_cast<VkDeviceSize>(stride) * capacity;
+
+        VkBufferCreateInfo buffer_info{};
+
+        buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        buffer_info.size = size;
+        buffer_info.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+        buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateBuffer(l_device->getDevice(), &buffer_info, nullptr, &buffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[InstanceBuffer] Impossible to create the buffer");
+        }
+
+        // Enumerate the memory requirements
+        VkMemoryRequirements memory_requirements;
+        vkGetBufferMemoryRequirements(l_device->getDevice(), buffer, &memory_requirements);
+
+        // Allocate the memory on GPU
+        VkMemoryAllocateInfo alloc_info{};
+
+        alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        alloc_info.allocationSize = memory_requirements.size;
+        alloc_info.memoryTypeIndex = findMemoryType(memory_requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+        if (vkAllocateMemory(l_device->getDevice(), &alloc_info, nullptr, &buffer_memory) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[InstanceBuffer] Impossible to allocate the required memory on the GPU");
+        }
+
+        // Associate the buffer to the memory
+        vkBindBufferMemory(l_device->getDevice(), buffer, buffer_memory, 0);
+
+        // Persistent memory mapping
+        vkMapMemory(l_device->getDevice(), buffer_memory, 0, size, 0, &mapped_memory);
+    }
+
+    void InstanceBuffer::destroyBuffer()
+    {
+        // The buffer may still be read by frames in flight (also when growing)
+        l_device->destroyDeferred([buffer = buffer, buffer_memory = buffer_memory](VkDevice device)
+                                  {
+            if (buffer_memory != VK_NULL_HANDLE)
+            {
+                vkUnmapMemory(device, buffer_memory);
+                vkFreeMemory(device, buffer_memory, nullptr);
+            }
+
+            if (buffer != VK_NULL_HANDLE)
+            {
+                vkDestroyBuffer(device, buffer, nullptr);
+            } });
+
+        buffer = VK_NULL_HANDLE;
+        buffer_memory = VK_NULL_HANDLE;
+        mapped_memory = nullptr;
+    }
+
+    uint32_t InstanceBuffer::findMemoryType(uint32_t type_filter, VkMemoryPropertyFlags properties)
+    {
+        VkPhysicalDeviceMemoryProperties memory_properties;
+
+        // Enumerate the memory properties
+        vkGetPhysicalDeviceMemoryProperties(l_device->getPhysicalDevice()->getDevice(), &memory_properties);
+
+        for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++)
+        {
+            if ((type_filter & (1 << i)) && (memory_properties.memoryTypes[i].propertyFlags & properties) == properties)
+            {
+                return i;
+            }
+        }
+
+        throw std::runtime_error("[InstanceBuffer] Unable to find a suitable memory type");
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+#include <devices/logicalDevice.h>
+
+#include <memory>
+#include <stdint.h>
+
+namespace framework
+{
+    /**
+     * @brief Host visible and persistently mapped vertex buffer read with VK_VERTEX_INPUT_RATE_INSTANCE, every
+     * instance occupies stride bytes. The buffer grows geometrically keeping its content.
+     * The mapped memory is not double buffered: it must be written only when no submitted frame can still read it
+     * (DefaultRenderer keeps a single frame in flight and updates the collections after waiting for it)
+     */
+    class InstanceBuffer
+    {
+    public:
+        InstanceBuffer(const std::shared_ptr<LogicalDevice> &l_device, uint32_t stride, uint32_t capacity);
+        ~InstanceBuffer();
+
+        /**
+         * @brief Grows the buffer if it cannot hold the passed number of instances, copying the old content.
+         * The old buffer is released through LogicalDevice::destroyDeferred, so pending command buffers can still read it, but
+         * the new handle must be bound again (the release moves the device resource generation, which the renderer command
+         * buffer cache hashes)
+         */
+        void reserve(uint32_t instances);
+
+        // Getters
+        inline const VkBuffer &getBuffer() { return buffer; }
+        inline uint8_t *getMappedData() { return static_cast<uint8_t *>(mapped_memory); }
+        inline uint32_t getStride() { return stride; }
+        inline uint32_t getCapacity() { return capacity; }
+
+    private:
+        /**
+         * @brief Creates, allocates and maps the buffer with the current capacity
+         */
+        void createBuffer();
+
+        /**
+         * @brief Unmaps and destroys the buffer
+         */
+        void destroyBuffer();
+
+        uint32_t findMemoryType(uint32_t type_filter, VkMemoryPropertyFlags properties);
+
+        std::shared_ptr<LogicalDevice> l_device;
+
+        uint32_t stride = 0;
+        uint32_t capacity = 0;
+
+        // Vulkan objects
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory buffer_memory = VK_NULL_HANDLE;
+        void *mapped_memory = nullptr;
+    };
+}
@@ -0,0 +1,187 @@
+#include "offscreenTarget.h"
+#include <stdexcept>
+
+namespace framework
+{
+    OffscreenTarget::OffscreenTarget(const std::shared_ptr<LogicalDevice> &l_device, const VkExtent2D &extent, const OffscreenTargetConfiguration &config)
+    {
+        if (l_device == nullptr)
+        {
+            throw std::runtime_error("[OffscreenTarget] Null device instance");
+        }
+
+        if (config.images_number == 0)
+        {
+            throw std::runtime_error("[OffscreenTarget] At least one image is needed");
+        }
+
+        this->l_device = l_device;
+        this->config = config;
+        this->extent = extent;
+
+        // Offscreen images are not presented, the color space is only needed to match the swap chain format struct
+        surface_format.format = config.format;
+        surface_format.colorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+
+        // Check that the format can be rendered to
+        VkFormatProperties props;
+        vkGetPhysicalDeviceFormatProperties(l_device->getPhysicalDevice()->getDevice(), config.format, &props);
+
+        if ((props.optimalTilingFeatures & VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT) == 0)
+        {
+            throw std::runtime_error("[OffscreenTarget] Format not supported as color attachment");
+        }
+
+        createImages();
+    }
+
+    OffscreenTarget::~OffscreenTarget()
+    {
+        cleanup();
+    }
+
+    void OffscreenTarget::recreateOffscreenTarget(const VkExtent2D &extent, bool deferred)
+    {
+        if (deferred)
+        {
+            l_device->destroyDeferred([old_images = images, old_images_memory = images_memory, old_image_views = image_views](VkDevice device)
+                                      {
+                for (size_t i = 0; i < old_images.size(); i++)
+                {
+                    vkDestroyImageView(device, old_image_views[i], nullptr);
+                    vkDestroyImage(device, old_images[i], nullptr);
+                    vkFreeMemory(device, old_images_memory[i], nullptr);
+                } });
+
+            images.clear();
+            images_memory.clear();
+            image_views.clear();
+        }
+        else
+        {
+            cleanup();
+        }
+
+        this->extent = extent;
+        createImages();
+    }
+
+    uint32_t OffscreenTarget::acquireNextImage()
+    {
+        current_image = acquired_images++ % images.size();
+        return current_image;
+    }
+
+    void OffscreenTarget::createImages()
+    {
+        if (extent.width == 0 || extent.height == 0)
+        {
+            throw std::runtime_error("[OffscreenTarget] Null extent");
+        }
+
+        images.resize(config.images_number, VK_NULL_HANDLE);
+        images_memory.resize(config.images_number, VK_NULL_HANDLE);
+        image_views.resize(config.images_number, VK_NULL_HANDLE);
+
+        for (uint32_t i = 0; i < config.images_number; i++)
+        {
+            VkImageCreateInfo image_info{};
+            image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            image_info.imageType = VK_IMAGE_TYPE_2D;
+            image_info.extent.width = extent.width;
+            image_info.extent.height = extent.height;
+            image_info.extent.depth = 1;
+            image_info.mipLevels = 1;
+            image_info.arrayLayers = 1;
+            image_info.format = config.format;
+            image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+            image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            image_info.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | config.usage;
+            image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+            image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+            if (vkCreateImage(l_device->getDevice(), &image_info, nullptr, &images[i]) != VK_SUCCESS)
+            {
+                throw std::runtime_error("[OffscreenTarget] Failed to create image");
+            }
+
+            VkMemoryRequirements mem_requirements;
+            vkGetImageMemoryRequirements(l_device->getDevice(), images[i], &mem_requirements);
+
+            VkMemoryAllocateInfo alloc_info{};
+            alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            alloc_info.allocationSize = mem_requirements.size;
+            alloc_info.memoryTypeIndex = findMemoryType(mem_requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+            if (vkAllocateMemory(l_device->getDevice(), &alloc_info, nullptr, &images_memory[i]) != VK_SUCCESS)
+            {
+                throw std::runtime_error("[OffscreenTarget] Failed to allocate image memory");
+            }
+
+            vkBindImageMemory(l_device->getDevice(), images[i], images_memory[i], 0);
+
+            VkImageViewCreateInfo view_info{};
+            view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            view_info.image = images[i];
+            view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            view_info.format = config.format;
+            view_info.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+            view_info.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+            view_info.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+            view_info.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+            view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            view_info.subresourceRange.baseMipLevel = 0;
+            view_info.subresourceRange.levelCount = 1;
+            view_info.subresourceRange.baseArrayLayer = 0;
+            view_info.subresourceRange.layerCount = 1;
+
+            if (vkCreateImageView(l_device->getDevice(), &view_info, nullptr, &image_views[i]) != VK_SUCCESS)
+            {
+                throw std::runtime_error("[OffscreenTarget] Error creating the image views");
+            }
+        }
+    }
+
+    void OffscreenTarget::cleanup()
+    {
+        for (size_t i = 0; i < images.size(); i++)
+        {
+            if (image_views[i] != VK_NULL_HANDLE)
+            {
+                vkDestroyImageView(l_device->getDevice(), image_views[i], nullptr);
+            }
+
+            if (images[i] != VK_NULL_HANDLE)
+            {
+                vkDestroyImage(l_device->getDevice(), images[i], nullptr);
+            }
+
+            if (images_memory[i] != VK_NULL_HANDLE)
+            {
+                vkFreeMemory(l_device->getDevice(), images_memory[i], nullptr);
+            }
+        }
+
+        images.clear();
+        images_memory.clear();
+        image_views.clear();
+    }
+
+    uint32_t OffscreenTarget::findMemoryType(uint32_t type_filter, VkMemoryPropertyFlags properties)
+    {
+        VkPhysicalDeviceMemoryProperties memory_properties;
+
+        // Enumerate the memory properties
+        vkGetPhysicalDeviceMemoryProperties(l_device->getPhysicalDevice()->getDevice(), &memory_properties);
+
+        for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++)
+        {
+            if ((type_filter & (1 << i)) && (memory_properties.memoryTypes[i].propertyFlags & properties) == properties)
+            {
+                return i;
+            }
+        }
+
+        throw std::runtime_error("[OffscreenTarget] Unable to find a suitable memory type");
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <devices/logicalDevice.h>
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <memory>
+
+namespace framework
+{
+    struct OffscreenTargetConfiguration
+    {
+        VkFormat format = VK_FORMAT_R8G8B8A8_UNORM;
+        // Images rendered in round robin, more than one lets the previous frame be read while the next one is drawn
+        uint32_t images_number = 1;
+        // Usages on top of the color attachment one (e.g. TRANSFER_SRC to read the frames back, SAMPLED to use them as textures)
+        VkImageUsageFlags usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    };
+
+    /**
+     * @brief Color images rendered in place of the swap chain ones, for headless rendering (batch renders, benchmarks, regression
+     * frames) on devices without a surface. It exposes the same getters of the swap chain, so that render pass and frame buffer
+     * collection are created the same way (the render pass provides the depth image as for the swap chain)
+     */
+    class OffscreenTarget
+    {
+    public:
+        OffscreenTarget(const std::shared_ptr<LogicalDevice> &l_device, const VkExtent2D &extent, const OffscreenTargetConfiguration &config);
+        ~OffscreenTarget();
+
+        /**
+         * @brief Recreates the images with a different extent. If not deferred (destroyed through the device deletion queue)
+         * the device must not be using them
+         */
+        void recreateOffscreenTarget(const VkExtent2D &extent, bool deferred = false);
+
+        /**
+         * @brief Returns the index of the image to be rendered next, the images are used in round robin
+         */
+        uint32_t acquireNextImage();
+
+        // Getters
+        const std::vector<VkImage> &getImages() { return images; }
+        const std::vector<VkImageView> &getImageViews() { return image_views; }
+        const VkSurfaceFormatKHR &getFormat() { return surface_format; }
+        const VkExtent2D &getExtent() { return extent; }
+        // Index of the last acquired image
+        uint32_t getCurrentImage() { return current_image; }
+
+    private:
+        /**
+         * @brief Creates the images, their memory and views (called by constructor and re-creation method)
+         */
+        void createImages();
+
+        /**
+         * @brief Destroys the images, their memory and views
+         */
+        void cleanup();
+
+        /**
+         * @brief Looks for the memory on the GPU that suits the passed parameters
+         */
+        uint32_t findMemoryType(uint32_t type_filter, VkMemoryPropertyFlags flags);
+
+        std::shared_ptr<LogicalDevice> l_device;
+        OffscreenTargetConfiguration config;
+
+        std::vector<VkImage> images;
+        std::vector<VkDeviceMemory> images_memory;
+        std::vector<VkImageView> image_views;
+
+        // Format wrapped as a surface one to be passed to the render pass as the swap chain format
+        VkSurfaceFormatKHR surface_format{};
+        VkExtent2D extent{};
+        uint32_t current_image = 0;
+        uint64_t acquired_images = 0;
+    };
+}
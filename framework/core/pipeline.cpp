@@ -1,21 +1,60 @@
 #include "pipeline.h"
+#include <utils/traceProfiler.h>
 #include <stdexcept>
+#include <algorithm>
 
 namespace framework
 {
     Pipeline::Pipeline(const std::shared_ptr<LogicalDevice> &l_device,
-                       std::unique_ptr<DrawableCollection> drawable_collection,
+                       std::shared_ptr<DrawableCollection> drawable_collection,
                        const DepthTestType &depth_test_type, const VkRenderPass &render_pass,
                        const PipelineConfiguration &config)
+    {
+        if (render_pass == nullptr)
+        {
+            throw std::runtime_error("[Pipeline] Null render pass instance");
+        }
+
+        createPipeline(l_device, std::move(drawable_collection), depth_test_type, render_pass, nullptr, config);
+    }
+
+    Pipeline::Pipeline(const std::shared_ptr<LogicalDevice> &l_device,
+                       std::shared_ptr<DrawableCollection> drawable_collection,
+                       const AttachmentFormats &formats,
+                       const PipelineConfiguration &config)
     {
         if (l_device == nullptr)
         {
             throw std::runtime_error("[Pipeline] Null device instance");
         }
 
-        if (render_pass == nullptr)
+        if (!l_device->isDynamicRenderingEnabled())
         {
-            throw std::runtime_error("[Pipeline] Null render pass instance");
+            throw std::runtime_error("[Pipeline] Dynamic rendering not supported by the device");
+        }
+
+        // The attachment formats replace the render pass
+        VkPipelineRenderingCreateInfoKHR rendering_info{};
+
+        rendering_info.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+        rendering_info.colorAttachmentCount = 1;
+        rendering_info.pColorAttachmentFormats = &formats.color;
+        rendering_info.depthAttachmentFormat = formats.depth != NONE ? static_cast<VkFormat>(formats.depth) : VK_FORMAT_UNDEFINED;
+        rendering_info.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+
+        createPipeline(l_device, std::move(drawable_collection), formats.depth, VK_NULL_HANDLE, &rendering_info, config);
+    }
+
+    void Pipeline::createPipeline(const std::shared_ptr<LogicalDevice> &l_device,
+                                  std::shared_ptr<DrawableCollection> drawable_collection,
+                                  const DepthTestType &depth_test_type, const VkRenderPass &render_pass, const void *rendering_info,
+                                  const PipelineConfiguration &config)
+    {
+        TraceZone zone("Pipeline::createPipeline");
+
+        if (l_device == nullptr)
+        {
+            throw std::runtime_error("[Pipeline] Null device instance");
         }
 
         if (drawable_collection == nullptr)
@@ -36,8 +75,32 @@ namespace framework
         // In case of a depth buffer
         VkPipelineDepthStencilStateCreateInfo depth_stencil{};
 
+        // Use the configuration shaders if specified
+        const std::vector<std::shared_ptr<Shader>> &shaders = config.shaders.size() > 0 ? config.shaders : collection->getShaders();
+
+        // Select the vertex streams to be bound
+        if (config.vertex_streams.size() == 0)
+        {
+            for (uint32_t i = 0; i < collection->getStreamsNumber(); i++)
+            {
+                vertex_streams.push_back(i);
+            }
+        }
+        else
+        {
+            for (uint32_t stream : config.vertex_streams)
+            {
+                if (stream >= collection->getStreamsNumber())
+                {
+                    throw std::runtime_error("[Pipeline] Vertex stream not present inside the drawable collection");
+                }
+            }
+
+            vertex_streams = config.vertex_streams;
+        }
+
         // For every shader create its stage
-        for (std::shared_ptr<Shader> shader : collection->getShaders())
+        for (std::shared_ptr<Shader> shader : shaders)
         {
             VkPipelineShaderStageCreateInfo createInfo{};
 
@@ -65,12 +128,35 @@ namespace framework
         // Vertex input buffer (TODO configure this to have a mutable vertex buffer)
         VkPipelineVertexInputStateCreateInfo vertex_info{};
 
-        VkVertexInputBindingDescription binding_description = collection->getBindingDescription();
-        std::vector<VkVertexInputAttributeDescription> attribute_descriptions = collection->getAttributeDescriptions();
+        std::vector<VkVertexInputBindingDescription> binding_descriptions;
+        std::vector<VkVertexInputAttributeDescription> attribute_descriptions;
+
+        // Keep only the bindings and attributes of the selected streams, the instance binding is always consumed
+        auto is_bound = [&](uint32_t binding)
+        {
+            return std::find(vertex_streams.begin(), vertex_streams.end(), binding) != vertex_streams.end() ||
+                   (collection->hasInstanceData() && binding == collection->getInstanceBinding());
+        };
+
+        for (const VkVertexInputBindingDescription &description : collection->getBindingDescriptions())
+        {
+            if (is_bound(description.binding))
+            {
+                binding_descriptions.push_back(description);
+            }
+        }
+
+        for (const VkVertexInputAttributeDescription &description : collection->getAttributeDescriptions())
+        {
+            if (is_bound(description.binding))
+            {
+                attribute_descriptions.push_back(description);
+            }
+        }
 
         vertex_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-        vertex_info.vertexBindingDescriptionCount = 1;
-        vertex_info.pVertexBindingDescriptions = &binding_description;
+        vertex_info.vertexBindingDescriptionCount = static_cast<uint32_t>(binding_descriptions.size());
+        vertex_info.pVertexBindingDescriptions = binding_descriptions.data();
         vertex_info.vertexAttributeDescriptionCount = static_cast<uint32_t>(attribute_descriptions.size());
         vertex_info.pVertexAttributeDescriptions = attribute_descriptions.data();
 
@@ -162,7 +248,8 @@ namespace framework
         VkGraphicsPipelineCreateInfo pipeline_info{};
 
         pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-        pipeline_info.stageCount = static_cast<uint32_t>(collection->getShaders().size());
+        pipeline_info.pNext = rendering_info;
+        pipeline_info.stageCount = static_cast<uint32_t>(shaders.size());
         pipeline_info.pStages = shader_stages.data();
         pipeline_info.pVertexInputState = &vertex_info;
         pipeline_info.pInputAssemblyState = &input_assembly;
@@ -199,14 +286,31 @@ namespace framework
 
     Pipeline::~Pipeline()
     {
-        if (layout != VK_NULL_HANDLE)
-        {
-            vkDestroyPipelineLayout(l_device->getDevice(), layout, nullptr);
-        }
+        // The pipeline may be dropped while the last frames using it are in flight
+        l_device->destroyDeferred([layout = layout, pipeline = pipeline](VkDevice device)
+                                  {
+            if (layout != VK_NULL_HANDLE)
+            {
+                vkDestroyPipelineLayout(device, layout, nullptr);
+            }
+
+            if (pipeline != VK_NULL_HANDLE)
+            {
+                vkDestroyPipeline(device, pipeline, nullptr);
+            } });
+    }
 
-        if (pipeline != VK_NULL_HANDLE)
+    void Pipeline::setDrawList(const std::vector<uint32_t> &elements)
+    {
+        for (uint32_t element : elements)
         {
-            vkDestroyPipeline(l_device->getDevice(), pipeline, nullptr);
+            if (element >= collection->getElementsNumber())
+            {
+                throw std::runtime_error("[Pipeline] Draw list element out of range");
+            }
         }
+
+        draw_list = elements;
+        draw_list_active = true;
     }
 }
\ No newline at end of file
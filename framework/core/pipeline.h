@@ -2,11 +2,13 @@
 
 #include <devices/logicalDevice.h>
 #include <core/renderPass.h>
+#include <core/attachment.h>
 #include <core/shader.h>
 #include <core/drawableCollection.h>
 #include <core/descriptorSet.h>
 
 #include <vulkan/vulkan.h>
+#include <glm/glm.hpp>
 #include <vector>
 #include <memory>
 
@@ -18,15 +20,30 @@ namespace framework
         VkPolygonMode polygon_mode = VK_POLYGON_MODE_FILL;
         VkCullModeFlagBits cull_mode = VK_CULL_MODE_BACK_BIT;
         VkFrontFace front_face = VK_FRONT_FACE_CLOCKWISE;
+
+        // Vertex streams (bindings) consumed by the shaders, empty means all the collection streams
+        std::vector<uint32_t> vertex_streams;
+        // Shaders used instead of the collection ones (e.g. depth only pass sharing the collection), empty means collection shaders
+        std::vector<std::shared_ptr<Shader>> shaders;
     };
 
     class Pipeline
     {
     public:
         Pipeline(const std::shared_ptr<LogicalDevice> &l_device,
-                 std::unique_ptr<DrawableCollection> drawable_collection,
+                 std::shared_ptr<DrawableCollection> drawable_collection,
                  const DepthTestType &depth_test_type, const VkRenderPass &render_pass,
                  const PipelineConfiguration &config);
+
+        /**
+         * @brief Construct a new Pipeline object rendering with dynamic rendering to attachments of the passed formats,
+         * without any render pass
+         * @throws Runtime Exception if the device does not support VK_KHR_dynamic_rendering
+         */
+        Pipeline(const std::shared_ptr<LogicalDevice> &l_device,
+                 std::shared_ptr<DrawableCollection> drawable_collection,
+                 const AttachmentFormats &formats,
+                 const PipelineConfiguration &config);
         ~Pipeline();
 
         /**
@@ -34,28 +51,78 @@ namespace framework
          */
         inline void updateCollection() { collection->updateElements(); }
 
+        /**
+         * @brief Restricts the draw to the passed subset of collection elements (indices in the collection order).
+         * Elements are drawn in the list order, consecutive entries contiguous inside the index buffer are merged
+         * @throws Runtime Exception if an element index is out of range
+         */
+        void setDrawList(const std::vector<uint32_t> &elements);
+
+        /**
+         * @brief Goes back to drawing all the collection elements
+         */
+        void clearDrawList()
+        {
+            draw_list.clear();
+            draw_list_active = false;
+        }
+
         // Getters
         const VkPipeline &getPipeline() { return pipeline; }
         const VkPipelineLayout &getLayout() { return layout; }
-        const VkBuffer &getVertexBuffer() { return collection->getVertexBuffer(); }
+        const VkBuffer &getVertexBuffer(uint32_t stream = 0) { return collection->getVertexBuffer(stream); }
+        const std::vector<uint32_t> &getVertexStreams() { return vertex_streams; }
         const VkBuffer &getIndexBuffer() { return collection->getIndexBuffer(); }
         const VkDescriptorSet &getDescriptorSet() { return collection->getDescriptorSet(); }
         uint32_t getVerticesNumber() { return collection->getVerticesNumber(); }
         uint32_t getIndexSize() { return collection->getIndexSize(); }
+        VkIndexType getIndexType() { return collection->getIndexType(); }
+        const std::vector<DrawRange> &getDrawRanges() { return collection->getDrawRanges(); }
         uint32_t getNumberOfInstances() { return collection->getNumberOfInstances(); }
+        bool hasInstanceData() { return collection->hasInstanceData(); }
+        uint32_t getInstanceBinding() { return collection->getInstanceBinding(); }
+        const VkBuffer &getInstanceBuffer() { return collection->getInstanceBuffer(); }
+        const std::vector<DrawRange> &getElementRanges() { return collection->getElementRanges(); }
+        const BoundingBoxes &getElementBounds() { return collection->getElementBounds(); }
+        const glm::mat4 &getModelMatrix() { return model_matrix; }
+        const std::vector<uint32_t> &getDrawList() { return draw_list; }
+        bool hasDrawList() { return draw_list_active; }
         bool isVisible() { return visible; }
+        bool isFrustumCullingEnabled() { return frustum_culling; }
         bool hasDescriptorSet() { return collection->hasDescriptorSet(); }
+        const std::shared_ptr<DrawableCollection> &getCollection() { return collection; }
 
         // Setters
         void setVisibility(bool v) { visible = v; }
+        // Model matrix applied by the shaders, used to cull the local space element bounds
+        void setModelMatrix(const glm::mat4 &model) { model_matrix = model; }
+        void setFrustumCulling(bool enabled) { frustum_culling = enabled; }
 
     private:
+        /**
+         * @brief Creates the pipeline for the render pass or, if null, for the dynamic rendering info chained to the create info
+         */
+        void createPipeline(const std::shared_ptr<LogicalDevice> &l_device,
+                            std::shared_ptr<DrawableCollection> drawable_collection,
+                            const DepthTestType &depth_test_type, const VkRenderPass &render_pass, const void *rendering_info,
+                            const PipelineConfiguration &config);
+
         bool visible = true;
+        bool frustum_culling = true;
+
+        glm::mat4 model_matrix{1.0f};
+
+        // Drawn subset of elements, an active empty list draws nothing
+        std::vector<uint32_t> draw_list;
+        bool draw_list_active = false;
+
+        // Streams bound during the draw
+        std::vector<uint32_t> vertex_streams;
 
         VkPipeline pipeline = VK_NULL_HANDLE;
         VkPipelineLayout layout = VK_NULL_HANDLE;
 
         std::shared_ptr<LogicalDevice> l_device;
-        std::unique_ptr<DrawableCollection> collection;
+        std::shared_ptr<DrawableCollection> collection;
     };
 }
\ No newline at end of file
@@ -0,0 +1,1003 @@
+#include "renderGraph.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace framework
+{
+    RenderGraph::RenderGraph(const std::shared_ptr<LogicalDevice> &l_device)
+    {
+        if (l_device == nullptr)
+        {
+            throw std::runtime_error("[RenderGraph] Null logical device instance");
+        }
+
+        this->l_device = l_device;
+    }
+
+    RenderGraph::~RenderGraph()
+    {
+        cleanup();
+    }
+
+    uint32_t RenderGraph::createImage(const std::string &name, const RenderGraphImageConfiguration &config)
+    {
+        Image image;
+        image.name = name;
+        image.config = config;
+        images.push_back(image);
+
+        compiled = false;
+        return images.size() - 1;
+    }
+
+    uint32_t RenderGraph::importImage(const std::string &name, const RenderGraphImageConfiguration &config)
+    {
+        Image image;
+        image.name = name;
+        image.config = config;
+        image.imported = true;
+        image.output = config.final_layout != VK_IMAGE_LAYOUT_UNDEFINED;
+        images.push_back(image);
+
+        compiled = false;
+        return images.size() - 1;
+    }
+
+    uint32_t RenderGraph::addPass(const std::string &name, const RenderGraphPassConfiguration &config, std::function<void(const VkCommandBuffer &)> record)
+    {
+        for (const RenderGraphAccess &access : config.reads)
+        {
+            if (access.image >= images.size())
+            {
+                throw std::runtime_error("[RenderGraph] Invalid image index read by pass " + name);
+            }
+
+            if (isWriteUsage(access.usage))
+            {
+                throw std::runtime_error("[RenderGraph] Write usage declared as read by pass " + name);
+            }
+        }
+
+        for (const RenderGraphAccess &access : config.writes)
+        {
+            if (access.image >= images.size())
+            {
+                throw std::runtime_error("[RenderGraph] Invalid image index written by pass " + name);
+            }
+
+            if (!isWriteUsage(access.usage))
+            {
+                throw std::runtime_error("[RenderGraph] Read usage declared as write by pass " + name);
+            }
+        }
+
+        uint32_t depth_attachments = 0;
+
+        for (const auto *accesses : {&config.reads, &config.writes})
+        {
+            for (const RenderGraphAccess &access : *accesses)
+            {
+                depth_attachments += access.usage == RenderGraphUsage::DEPTH_ATTACHMENT || access.usage == RenderGraphUsage::DEPTH_READ;
+            }
+        }
+
+        if (depth_attachments > 1)
+        {
+            throw std::runtime_error("[RenderGraph] More than one depth attachment used by pass " + name);
+        }
+
+        Pass pass;
+        pass.name = name;
+        pass.config = config;
+        pass.record = std::move(record);
+        passes.push_back(std::move(pass));
+
+        compiled = false;
+        return passes.size() - 1;
+    }
+
+    void RenderGraph::markOutput(uint32_t image)
+    {
+        images.at(image).output = true;
+        compiled = false;
+    }
+
+    void RenderGraph::setImportedImage(uint32_t image, const VkImage &handle, const VkImageView &view)
+    {
+        Image &imported = images.at(image);
+
+        if (!imported.imported)
+        {
+            throw std::runtime_error("[RenderGraph] Binding a transient image " + imported.name);
+        }
+
+        imported.image = handle;
+        imported.view = view;
+    }
+
+    void RenderGraph::invalidateImportedImages()
+    {
+        std::vector<VkFramebuffer> frame_buffers;
+
+        for (Pass &pass : passes)
+        {
+            for (auto &frame_buffer : pass.frame_buffers)
+            {
+                frame_buffers.push_back(frame_buffer.second);
+            }
+
+            pass.frame_buffers.clear();
+        }
+
+        // Recycled view handles must not find the frame buffers of the destroyed views
+        for (Image &image : images)
+        {
+            if (image.imported)
+            {
+                image.image = VK_NULL_HANDLE;
+                image.view = VK_NULL_HANDLE;
+            }
+        }
+
+        l_device->destroyDeferred([frame_buffers](VkDevice device)
+                                  {
+            for (VkFramebuffer frame_buffer : frame_buffers)
+            {
+                vkDestroyFramebuffer(device, frame_buffer, nullptr);
+            } });
+    }
+
+    void RenderGraph::compile()
+    {
+        cleanup();
+
+        for (Image &image : images)
+        {
+            image.extent = image.config.extent.width != 0 ? image.config.extent : extent;
+
+            if (image.extent.width == 0 || image.extent.height == 0)
+            {
+                throw std::runtime_error("[RenderGraph] Image " + image.name + " without extent");
+            }
+        }
+
+        cullPasses();
+        allocateImages();
+
+        for (uint32_t i = 0; i < passes.size(); i++)
+        {
+            if (passes[i].alive)
+            {
+                createRenderPass(i);
+            }
+        }
+
+        computeBarriers();
+
+        statistics.passes = passes.size();
+        statistics.culled_passes = std::count_if(passes.begin(), passes.end(), [](const Pass &pass)
+                                                 { return !pass.alive; });
+        statistics.barriers = final_barriers.size();
+
+        for (const Pass &pass : passes)
+        {
+            statistics.barriers += pass.barriers.size();
+        }
+
+        compiled = true;
+    }
+
+    void RenderGraph::execute(const VkCommandBuffer &cmd)
+    {
+        if (!compiled)
+        {
+            throw std::runtime_error("[RenderGraph] Executing a graph not compiled");
+        }
+
+        for (const Image &image : images)
+        {
+            if (image.imported && image.used && (image.image == VK_NULL_HANDLE || image.view == VK_NULL_HANDLE))
+            {
+                throw std::runtime_error("[RenderGraph] Imported image " + image.name + " not bound");
+            }
+        }
+
+        for (Pass &pass : passes)
+        {
+            if (!pass.alive)
+            {
+                continue;
+            }
+
+            recordBarriers(cmd, pass.barriers);
+
+            if (pass.render_pass == VK_NULL_HANDLE)
+            {
+                pass.record(cmd);
+                continue;
+            }
+
+            VkRenderPassBeginInfo begin_info{};
+            begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+            begin_info.renderPass = pass.render_pass;
+            begin_info.framebuffer = getFrameBuffer(pass);
+            begin_info.renderArea.offset = {0, 0};
+            begin_info.renderArea.extent = pass.extent;
+            begin_info.clearValueCount = static_cast<uint32_t>(pass.clear_values.size());
+            begin_info.pClearValues = pass.clear_values.data();
+
+            vkCmdBeginRenderPass(cmd, &begin_info, VK_SUBPASS_CONTENTS_INLINE);
+            pass.record(cmd);
+            vkCmdEndRenderPass(cmd);
+        }
+
+        recordBarriers(cmd, final_barriers);
+    }
+
+    RenderGraph::UsageState RenderGraph::getUsageState(RenderGraphUsage usage)
+    {
+        switch (usage)
+        {
+        case RenderGraphUsage::COLOR_ATTACHMENT:
+            return {VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+                    VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT};
+        case RenderGraphUsage::DEPTH_ATTACHMENT:
+            return {VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+                    VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT};
+        case RenderGraphUsage::STORAGE_WRITE:
+            return {VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                    VK_ACCESS_2_SHADER_READ_BIT, VK_ACCESS_2_SHADER_WRITE_BIT, VK_IMAGE_USAGE_STORAGE_BIT};
+        case RenderGraphUsage::TRANSFER_DST:
+            return {VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                    0, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_USAGE_TRANSFER_DST_BIT};
+        case RenderGraphUsage::DEPTH_READ:
+            return {VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+                    VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT, 0, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT};
+        case RenderGraphUsage::SAMPLED:
+            return {VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+                    VK_ACCESS_2_SHADER_READ_BIT, 0, VK_IMAGE_USAGE_SAMPLED_BIT};
+        case RenderGraphUsage::STORAGE_READ:
+            return {VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                    VK_ACCESS_2_SHADER_READ_BIT, 0, VK_IMAGE_USAGE_STORAGE_BIT};
+        case RenderGraphUsage::TRANSFER_SRC:
+            return {VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+                    VK_ACCESS_2_TRANSFER_READ_BIT, 0, VK_IMAGE_USAGE_TRANSFER_SRC_BIT};
+        }
+
+        throw std::runtime_error("[RenderGraph] Unknown image usage");
+    }
+
+    bool RenderGraph::isWriteUsage(RenderGraphUsage usage)
+    {
+        return usage == RenderGraphUsage::COLOR_ATTACHMENT || usage == RenderGraphUsage::DEPTH_ATTACHMENT ||
+               usage == RenderGraphUsage::STORAGE_WRITE || usage == RenderGraphUsage::TRANSFER_DST;
+    }
+
+    bool RenderGraph::isAttachmentUsage(RenderGraphUsage usage)
+    {
+        return usage == RenderGraphUsage::COLOR_ATTACHMENT || usage == RenderGraphUsage::DEPTH_ATTACHMENT || usage == RenderGraphUsage::DEPTH_READ;
+    }
+
+    void RenderGraph::cullPasses()
+    {
+        // Images whose current content is needed by the following passes (or the outputs)
+        std::vector<bool> needed(images.size());
+
+        for (uint32_t i = 0; i < images.size(); i++)
+        {
+            needed[i] = images[i].output;
+        }
+
+        for (int32_t i = static_cast<int32_t>(passes.size()) - 1; i >= 0; i--)
+        {
+            Pass &pass = passes[i];
+            pass.alive = pass.config.side_effects;
+
+            for (const RenderGraphAccess &access : pass.config.writes)
+            {
+                pass.alive |= needed[access.image];
+            }
+
+            if (!pass.alive)
+            {
+                continue;
+            }
+
+            // Cleared attachments do not depend on the previous content, partial writes (loads, storage, transfers) do
+            for (const RenderGraphAccess &access : pass.config.writes)
+            {
+                needed[access.image] = !(isAttachmentUsage(access.usage) && pass.config.clear);
+            }
+
+            for (const RenderGraphAccess &access : pass.config.reads)
+            {
+                needed[access.image] = true;
+            }
+        }
+
+        // Lifetimes and usages of the images used by the alive passes
+        for (uint32_t i = 0; i < passes.size(); i++)
+        {
+            if (!passes[i].alive)
+            {
+                continue;
+            }
+
+            for (const auto *accesses : {&passes[i].config.reads, &passes[i].config.writes})
+            {
+                for (const RenderGraphAccess &access : *accesses)
+                {
+                    Image &image = images[access.image];
+
+                    if (!image.used)
+                    {
+                        image.first_pass = i;
+                        image.used = true;
+                    }
+
+                    image.last_pass = i;
+                    image.usage |= getUsageState(access.usage).image_usage;
+                }
+            }
+        }
+    }
+
+    void RenderGraph::allocateImages()
+    {
+        std::vector<uint32_t> transients;
+        std::vector<int32_t> memory_types(images.size(), -1);
+
+        for (uint32_t i = 0; i < images.size(); i++)
+        {
+            Image &image = images[i];
+
+            if (image.imported || !image.used)
+            {
+                continue;
+            }
+
+            // Images used only as attachments never leave the tile memory on tiled GPUs, lazily allocated memory may not even be backed
+            VkImageUsageFlags attachment_usages = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+            bool lazy = (image.usage & ~attachment_usages) == 0;
+
+            VkImageCreateInfo image_info{};
+            image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            image_info.imageType = VK_IMAGE_TYPE_2D;
+            image_info.extent.width = image.extent.width;
+            image_info.extent.height = image.extent.height;
+            image_info.extent.depth = 1;
+            image_info.mipLevels = 1;
+            image_info.arrayLayers = 1;
+            image_info.format = image.config.format;
+            image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+            image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            image_info.usage = image.usage | (lazy ? VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT : 0);
+            image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+            image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+            if (vkCreateImage(l_device->getDevice(), &image_info, nullptr, &image.image) != VK_SUCCESS)
+            {
+                throw std::runtime_error("[RenderGraph] Failed to create image " + image.name);
+            }
+
+            vkGetImageMemoryRequirements(l_device->getDevice(), image.image, &image.requirements);
+
+            if (lazy)
+            {
+                memory_types[i] = findMemoryType(image.requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
+            }
+
+            if (memory_types[i] < 0)
+            {
+                memory_types[i] = findMemoryType(image.requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+            }
+
+            if (memory_types[i] < 0)
+            {
+                throw std::runtime_error("[RenderGraph] Unable to find a suitable memory type for image " + image.name);
+            }
+
+            transients.push_back(i);
+            statistics.requested_memory += image.requirements.size;
+        }
+
+        // Largest images first, every one goes in the first block of the same memory type whose images have disjoint lifetimes
+        std::sort(transients.begin(), transients.end(), [this](uint32_t a, uint32_t b)
+                  { return images[a].requirements.size > images[b].requirements.size; });
+
+        for (uint32_t index : transients)
+        {
+            Image &image = images[index];
+            bool placed = false;
+
+            for (uint32_t b = 0; b < memory_blocks.size() && !placed; b++)
+            {
+                MemoryBlock &block = memory_blocks[b];
+
+                if (block.memory_type != static_cast<uint32_t>(memory_types[index]))
+                {
+                    continue;
+                }
+
+                bool disjoint = std::all_of(block.images.begin(), block.images.end(), [&](uint32_t other)
+                                            { return images[other].last_pass < image.first_pass || image.last_pass < images[other].first_pass; });
+
+                if (disjoint)
+                {
+                    block.images.push_back(index);
+                    block.size = std::max(block.size, image.requirements.size);
+                    image.memory_block = b;
+                    placed = true;
+                }
+            }
+
+            if (!placed)
+            {
+                MemoryBlock block;
+                block.memory_type = memory_types[index];
+                block.size = image.requirements.size;
+                block.images.push_back(index);
+                image.memory_block = memory_blocks.size();
+                memory_blocks.push_back(block);
+            }
+        }
+
+        for (MemoryBlock &block : memory_blocks)
+        {
+            VkMemoryAllocateInfo alloc_info{};
+            alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+            alloc_info.allocationSize = block.size;
+            alloc_info.memoryTypeIndex = block.memory_type;
+
+            if (vkAllocateMemory(l_device->getDevice(), &alloc_info, nullptr, &block.memory) != VK_SUCCESS)
+            {
+                throw std::runtime_error("[RenderGraph] Failed to allocate transient memory");
+            }
+
+            statistics.allocated_memory += block.size;
+
+            // Every image starts at the beginning of the block, in lifetime order so that each one waits for the previous
+            std::sort(block.images.begin(), block.images.end(), [this](uint32_t a, uint32_t b)
+                      { return images[a].first_pass < images[b].first_pass; });
+
+            for (uint32_t i = 0; i < block.images.size(); i++)
+            {
+                Image &image = images[block.images[i]];
+                image.aliased_image = i > 0 ? static_cast<int32_t>(block.images[i - 1]) : -1;
+
+                vkBindImageMemory(l_device->getDevice(), image.image, block.memory, 0);
+            }
+        }
+
+        for (uint32_t index : transients)
+        {
+            Image &image = images[index];
+
+            VkImageViewCreateInfo view_info{};
+            view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            view_info.image = image.image;
+            view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            view_info.format = image.config.format;
+            view_info.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+            view_info.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+            view_info.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+            view_info.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+            view_info.subresourceRange.aspectMask = image.config.aspect;
+            view_info.subresourceRange.baseMipLevel = 0;
+            view_info.subresourceRange.levelCount = 1;
+            view_info.subresourceRange.baseArrayLayer = 0;
+            view_info.subresourceRange.layerCount = 1;
+
+            if (vkCreateImageView(l_device->getDevice(), &view_info, nullptr, &image.view) != VK_SUCCESS)
+            {
+                throw std::runtime_error("[RenderGraph] Failed to create the view of image " + image.name);
+            }
+        }
+
+        statistics.transient_images = transients.size();
+    }
+
+    void RenderGraph::computeBarriers()
+    {
+        std::vector<ImageState> states(images.size());
+
+        for (uint32_t i = 0; i < images.size(); i++)
+        {
+            if (images[i].imported)
+            {
+                // Content produced outside of the graph has to be made available before the first access
+                states[i].layout = images[i].config.initial_layout;
+                states[i].write_stages = images[i].config.initial_stages;
+                states[i].write_access = images[i].config.initial_layout != VK_IMAGE_LAYOUT_UNDEFINED ? VK_ACCESS_2_MEMORY_WRITE_BIT : 0;
+            }
+        }
+
+        for (uint32_t i = 0; i < passes.size(); i++)
+        {
+            Pass &pass = passes[i];
+
+            if (!pass.alive)
+            {
+                continue;
+            }
+
+            for (const auto *accesses : {&pass.config.reads, &pass.config.writes})
+            {
+                for (const RenderGraphAccess &access : *accesses)
+                {
+                    const Image &image = images[access.image];
+
+                    // The first access to an aliased image waits for the last accesses to the previous image on the same memory
+                    ImageState &state = states[access.image];
+
+                    if (image.aliased_image >= 0 && image.first_pass == i && state.write_stages == 0 && state.read_stages == 0)
+                    {
+                        const ImageState &previous = states[image.aliased_image];
+                        state.write_stages = previous.write_stages | previous.read_stages;
+                        state.write_access = previous.write_access;
+                    }
+
+                    addAccess(pass.barriers, states, access.image, getUsageState(access.usage));
+                }
+            }
+        }
+
+        for (uint32_t i = 0; i < images.size(); i++)
+        {
+            const Image &image = images[i];
+            const ImageState &state = states[i];
+
+            if (!image.imported || image.config.final_layout == VK_IMAGE_LAYOUT_UNDEFINED || image.config.final_layout == state.layout)
+            {
+                continue;
+            }
+
+            // Presentation is synchronized by the semaphores, other layouts are left for any later command
+            bool present = image.config.final_layout == VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+            Barrier barrier{};
+            barrier.image = i;
+            barrier.src_stages = state.write_stages | state.read_stages;
+            barrier.src_access = state.write_access;
+            barrier.dst_stages = present ? VK_PIPELINE_STAGE_2_NONE : VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+            barrier.dst_access = present ? 0 : VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+            barrier.old_layout = state.layout;
+            barrier.new_layout = image.config.final_layout;
+            final_barriers.push_back(barrier);
+        }
+    }
+
+    void RenderGraph::addAccess(std::vector<Barrier> &barriers, std::vector<ImageState> &states, uint32_t image, const UsageState &usage)
+    {
+        ImageState &state = states[image];
+        bool write = usage.write_access != 0;
+        bool transition = state.layout != usage.layout;
+
+        Barrier barrier{};
+        barrier.image = image;
+        barrier.dst_stages = usage.stages;
+        barrier.dst_access = usage.read_access | usage.write_access;
+        barrier.old_layout = state.layout;
+        barrier.new_layout = usage.layout;
+
+        if (transition || write)
+        {
+            // Layout transitions and writes wait for every previous access (write after read included) and make the last write available
+            barrier.src_stages = state.write_stages | state.read_stages;
+            barrier.src_access = state.write_access;
+
+            if (transition || barrier.src_stages != 0)
+            {
+                barriers.push_back(barrier);
+            }
+
+            // The transition is ordered before the pass stages, later accesses only need an execution dependency on them
+            state.layout = usage.layout;
+            state.write_stages = usage.stages;
+            state.write_access = usage.write_access;
+            state.read_stages = write ? 0 : usage.stages;
+            state.read_access = write ? 0 : usage.read_access;
+            return;
+        }
+
+        // Reads in the same layout need a barrier only if the last write is not yet visible to their stages
+        if ((usage.stages & ~state.read_stages) == 0 && (usage.read_access & ~state.read_access) == 0)
+        {
+            return;
+        }
+
+        if (state.write_stages != 0)
+        {
+            barrier.src_stages = state.write_stages;
+            barrier.src_access = state.write_access;
+            barriers.push_back(barrier);
+        }
+
+        state.read_stages |= usage.stages;
+        state.read_access |= usage.read_access;
+    }
+
+    bool RenderGraph::hasContentBefore(uint32_t image, uint32_t pass_index)
+    {
+        if (images[image].imported && images[image].config.initial_layout != VK_IMAGE_LAYOUT_UNDEFINED)
+        {
+            return true;
+        }
+
+        for (uint32_t i = 0; i < pass_index; i++)
+        {
+            if (!passes[i].alive)
+            {
+                continue;
+            }
+
+            for (const RenderGraphAccess &access : passes[i].config.writes)
+            {
+                if (access.image == image)
+                {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    bool RenderGraph::isContentNeededAfter(uint32_t image, uint32_t pass_index)
+    {
+        for (uint32_t i = pass_index + 1; i < passes.size(); i++)
+        {
+            const Pass &pass = passes[i];
+
+            if (!pass.alive)
+            {
+                continue;
+            }
+
+            for (const RenderGraphAccess &access : pass.config.reads)
+            {
+                if (access.image == image)
+                {
+                    return true;
+                }
+            }
+
+            for (const RenderGraphAccess &access : pass.config.writes)
+            {
+                if (access.image == image)
+                {
+                    // A cleared attachment discards the content
+                    return !(isAttachmentUsage(access.usage) && pass.config.clear);
+                }
+            }
+        }
+
+        return images[image].output;
+    }
+
+    void RenderGraph::createRenderPass(uint32_t pass_index)
+    {
+        Pass &pass = passes[pass_index];
+
+        // Color attachments in declaration order, then the depth one
+        std::vector<RenderGraphAccess> attachments;
+
+        for (const RenderGraphAccess &access : pass.config.writes)
+        {
+            if (access.usage == RenderGraphUsage::COLOR_ATTACHMENT)
+            {
+                attachments.push_back(access);
+            }
+        }
+
+        uint32_t color_attachments = attachments.size();
+
+        for (const auto *accesses : {&pass.config.reads, &pass.config.writes})
+        {
+            for (const RenderGraphAccess &access : *accesses)
+            {
+                if (access.usage == RenderGraphUsage::DEPTH_ATTACHMENT || access.usage == RenderGraphUsage::DEPTH_READ)
+                {
+                    attachments.push_back(access);
+                }
+            }
+        }
+
+        if (attachments.empty())
+        {
+            return;
+        }
+
+        std::vector<VkAttachmentDescription> descriptions;
+        std::vector<VkAttachmentReference> references;
+        pass.extent = images[attachments[0].image].extent;
+
+        for (const RenderGraphAccess &access : attachments)
+        {
+            const Image &image = images[access.image];
+
+            if (image.extent.width != pass.extent.width || image.extent.height != pass.extent.height)
+            {
+                throw std::runtime_error("[RenderGraph] Attachments with different extents in pass " + pass.name);
+            }
+
+            bool read_only = !isWriteUsage(access.usage);
+            VkImageLayout layout = getUsageState(access.usage).layout;
+
+            // Load only the content that exists, store only the one that is needed: the main bandwidth saving of the graph
+            VkAttachmentDescription description{};
+            description.format = image.config.format;
+            description.samples = VK_SAMPLE_COUNT_1_BIT;
+
+            if (!read_only && pass.config.clear)
+            {
+                description.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+            }
+            else
+            {
+                description.loadOp = hasContentBefore(access.image, pass_index) ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            }
+
+            description.storeOp = isContentNeededAfter(access.image, pass_index) ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+
+            // The graph barriers perform the transitions outside of the render pass
+            description.initialLayout = layout;
+            description.finalLayout = layout;
+            descriptions.push_back(description);
+
+            VkAttachmentReference reference{};
+            reference.attachment = references.size();
+            reference.layout = layout;
+            references.push_back(reference);
+
+            VkClearValue clear_value{};
+
+            if (access.usage == RenderGraphUsage::COLOR_ATTACHMENT)
+            {
+                clear_value.color = pass.config.clear_color;
+            }
+            else
+            {
+                clear_value.depthStencil = {1.0f, 0};
+            }
+
+            pass.clear_values.push_back(clear_value);
+            pass.attachments.push_back(access.image);
+        }
+
+        VkSubpassDescription subpass{};
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.colorAttachmentCount = color_attachments;
+        subpass.pColorAttachments = references.data();
+        subpass.pDepthStencilAttachment = attachments.size() > color_attachments ? &references[color_attachments] : nullptr;
+
+        VkRenderPassCreateInfo create_info{};
+        create_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        create_info.attachmentCount = static_cast<uint32_t>(descriptions.size());
+        create_info.pAttachments = descriptions.data();
+        create_info.subpassCount = 1;
+        create_info.pSubpasses = &subpass;
+
+        if (vkCreateRenderPass(l_device->getDevice(), &create_info, nullptr, &pass.render_pass) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[RenderGraph] Impossible to create the render pass of pass " + pass.name);
+        }
+    }
+
+    VkFramebuffer RenderGraph::getFrameBuffer(Pass &pass)
+    {
+        std::vector<VkImageView> views;
+
+        for (uint32_t image : pass.attachments)
+        {
+            views.push_back(images[image].view);
+        }
+
+        auto found = pass.frame_buffers.find(views);
+
+        if (found != pass.frame_buffers.end())
+        {
+            return found->second;
+        }
+
+        VkFramebufferCreateInfo create_info{};
+        create_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        create_info.renderPass = pass.render_pass;
+        create_info.attachmentCount = static_cast<uint32_t>(views.size());
+        create_info.pAttachments = views.data();
+        create_info.width = pass.extent.width;
+        create_info.height = pass.extent.height;
+        create_info.layers = 1;
+
+        VkFramebuffer frame_buffer = VK_NULL_HANDLE;
+
+        if (vkCreateFramebuffer(l_device->getDevice(), &create_info, nullptr, &frame_buffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[RenderGraph] Impossible to create the frame buffer of pass " + pass.name);
+        }
+
+        pass.frame_buffers[views] = frame_buffer;
+        return frame_buffer;
+    }
+
+    void RenderGraph::recordBarriers(const VkCommandBuffer &cmd, const std::vector<Barrier> &barriers)
+    {
+        if (barriers.empty())
+        {
+            return;
+        }
+
+        PFN_vkCmdPipelineBarrier2KHR pipeline_barrier2 = l_device->getPipelineBarrier2();
+
+        if (pipeline_barrier2 != nullptr)
+        {
+            std::vector<VkImageMemoryBarrier2> image_barriers;
+
+            for (const Barrier &barrier : barriers)
+            {
+                VkImageMemoryBarrier2 image_barrier{};
+                image_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+                image_barrier.srcStageMask = barrier.src_stages;
+                image_barrier.srcAccessMask = barrier.src_access;
+                image_barrier.dstStageMask = barrier.dst_stages;
+                image_barrier.dstAccessMask = barrier.dst_access;
+                image_barrier.oldLayout = barrier.old_layout;
+                image_barrier.newLayout = barrier.new_layout;
+                image_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                image_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                image_barrier.image = images[barrier.image].image;
+                image_barrier.subresourceRange = {images[barrier.image].config.aspect, 0, 1, 0, 1};
+                image_barriers.push_back(image_barrier);
+            }
+
+            VkDependencyInfo dependency_info{};
+            dependency_info.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+            dependency_info.imageMemoryBarrierCount = static_cast<uint32_t>(image_barriers.size());
+            dependency_info.pImageMemoryBarriers = image_barriers.data();
+
+            pipeline_barrier2(cmd, &dependency_info);
+            return;
+        }
+
+        // The stage and access bits used by the graph have the same value of the legacy ones, but the stages are shared by the whole call
+        VkPipelineStageFlags src_stages = 0;
+        VkPipelineStageFlags dst_stages = 0;
+        std::vector<VkImageMemoryBarrier> image_barriers;
+
+        for (const Barrier &barrier : barriers)
+        {
+            src_stages |= static_cast<VkPipelineStageFlags>(barrier.src_stages);
+            dst_stages |= static_cast<VkPipelineStageFlags>(barrier.dst_stages);
+
+            VkImageMemoryBarrier image_barrier{};
+            image_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            image_barrier.srcAccessMask = static_cast<VkAccessFlags>(barrier.src_access);
+            image_barrier.dstAccessMask = static_cast<VkAccessFlags>(barrier.dst_access);
+            image_barrier.oldLayout = barrier.old_layout;
+            image_barrier.newLayout = barrier.new_layout;
+            image_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            image_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            image_barrier.image = images[barrier.image].image;
+            image_barrier.subresourceRange = {images[barrier.image].config.aspect, 0, 1, 0, 1};
+            image_barriers.push_back(image_barrier);
+        }
+
+        vkCmdPipelineBarrier(cmd, src_stages != 0 ? src_stages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, dst_stages != 0 ? dst_stages : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                             0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(image_barriers.size()), image_barriers.data());
+    }
+
+    int32_t RenderGraph::findMemoryType(uint32_t type_filter, VkMemoryPropertyFlags properties)
+    {
+        VkPhysicalDeviceMemoryProperties memory_properties;
+
+        // Enumerate the memory properties
+        vkGetPhysicalDeviceMemoryProperties(l_device->getPhysicalDevice()->getDevice(), &memory_properties);
+
+        for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++)
+        {
+            if ((type_filter & (1 << i)) && (memory_properties.memoryTypes[i].propertyFlags & properties) == properties)
+            {
+                return i;
+            }
+        }
+
+        return -1;
+    }
+
+    void RenderGraph::cleanup()
+    {
+        std::vector<VkFramebuffer> frame_buffers;
+        std::vector<VkRenderPass> render_passes;
+        std::vector<VkImageView> views;
+        std::vector<VkImage> vk_images;
+        std::vector<VkDeviceMemory> memories;
+
+        for (Pass &pass : passes)
+        {
+            for (auto &frame_buffer : pass.frame_buffers)
+            {
+                frame_buffers.push_back(frame_buffer.second);
+            }
+
+            if (pass.render_pass != VK_NULL_HANDLE)
+            {
+                render_passes.push_back(pass.render_pass);
+            }
+
+            pass.alive = false;
+            pass.barriers.clear();
+            pass.attachments.clear();
+            pass.clear_values.clear();
+            pass.frame_buffers.clear();
+            pass.render_pass = VK_NULL_HANDLE;
+        }
+
+        for (Image &image : images)
+        {
+            // Imported images keep the bound handles
+            if (!image.imported)
+            {
+                if (image.view != VK_NULL_HANDLE)
+                {
+                    views.push_back(image.view);
+                }
+
+                if (image.image != VK_NULL_HANDLE)
+                {
+                    vk_images.push_back(image.image);
+                }
+
+                image.view = VK_NULL_HANDLE;
+                image.image = VK_NULL_HANDLE;
+            }
+
+            image.used = false;
+            image.usage = 0;
+            image.aliased_image = -1;
+        }
+
+        for (MemoryBlock &block : memory_blocks)
+        {
+            if (block.memory != VK_NULL_HANDLE)
+            {
+                memories.push_back(block.memory);
+            }
+        }
+
+        // The frame in flight may still be executing the previous compilation
+        l_device->destroyDeferred([frame_buffers, render_passes, views, vk_images, memories](VkDevice device)
+                                  {
+            for (VkFramebuffer frame_buffer : frame_buffers)
+            {
+                vkDestroyFramebuffer(device, frame_buffer, nullptr);
+            }
+
+            for (VkRenderPass render_pass : render_passes)
+            {
+                vkDestroyRenderPass(device, render_pass, nullptr);
+            }
+
+            for (VkImageView view : views)
+            {
+                vkDestroyImageView(device, view, nullptr);
+            }
+
+            for (VkImage image : vk_images)
+            {
+                vkDestroyImage(device, image, nullptr);
+            }
+
+            for (VkDeviceMemory memory : memories)
+            {
+                vkFreeMemory(device, memory, nullptr);
+            } });
+
+        memory_blocks.clear();
+        final_barriers.clear();
+        statistics = RenderGraphStatistics{};
+        compiled = false;
+    }
+}
@@ -0,0 +1,296 @@
+#pragma once
+
+#include <devices/logicalDevice.h>
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <map>
+#include <string>
+#include <functional>
+#include <memory>
+
+namespace framework
+{
+    /**
+     * @brief How a pass accesses an image. Every usage implies the layout, the pipeline stages and the accesses the graph synchronizes
+     */
+    enum class RenderGraphUsage : uint32_t
+    {
+        // Writes
+        COLOR_ATTACHMENT,
+        DEPTH_ATTACHMENT,
+        STORAGE_WRITE,
+        TRANSFER_DST,
+        // Reads
+        DEPTH_READ,
+        SAMPLED,
+        STORAGE_READ,
+        TRANSFER_SRC
+    };
+
+    struct RenderGraphImageConfiguration
+    {
+        VkFormat format = VK_FORMAT_R8G8B8A8_UNORM;
+        // A zero extent follows the graph one (see RenderGraph::setExtent)
+        VkExtent2D extent = {0, 0};
+        VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+        // Imported images only: layout and stages of the image before the graph execution (e.g. UNDEFINED and
+        // COLOR_ATTACHMENT_OUTPUT for an acquired swap chain image, matching the semaphore wait stage)
+        VkImageLayout initial_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        VkPipelineStageFlags2 initial_stages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        // Imported images only: layout the image is left in after the execution. Images with a final layout are graph outputs
+        VkImageLayout final_layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    };
+
+    struct RenderGraphAccess
+    {
+        uint32_t image;
+        RenderGraphUsage usage;
+    };
+
+    struct RenderGraphPassConfiguration
+    {
+        std::vector<RenderGraphAccess> reads;
+        std::vector<RenderGraphAccess> writes;
+        // Clears the written attachments instead of loading their previous content
+        bool clear = true;
+        VkClearColorValue clear_color = {{0.0f, 0.0f, 0.0f, 1.0f}};
+        // Passes with side effects outside of the graph (e.g. readbacks) are never culled
+        bool side_effects = false;
+    };
+
+    struct RenderGraphStatistics
+    {
+        uint32_t passes = 0;
+        uint32_t culled_passes = 0;
+        uint32_t barriers = 0;
+        uint32_t transient_images = 0;
+        // Transient memory actually allocated and the one needed without aliasing
+        VkDeviceSize allocated_memory = 0;
+        VkDeviceSize requested_memory = 0;
+    };
+
+    /**
+     * @brief Frame described as a sequence of passes declaring the images they read and write. Once compiled, the graph culls
+     * the passes that do not contribute to an output, aliases the transient images with disjoint lifetimes on the same memory
+     * and computes the minimal barriers (synchronization2 when available) between the passes. Passes writing attachments
+     * are recorded inside a render pass created by the graph, with load and store operations derived from the image usages.
+     * Pipelines can be created with getRenderPass, render passes of different compilations stay compatible as long as the
+     * attachment formats are the same.
+     */
+    class RenderGraph
+    {
+    public:
+        RenderGraph(const std::shared_ptr<LogicalDevice> &l_device);
+        ~RenderGraph();
+
+        /**
+         * @brief Declares an image allocated by the graph, valid only during the execution of the passes using it
+         * @return The image index
+         */
+        uint32_t createImage(const std::string &name, const RenderGraphImageConfiguration &config);
+
+        /**
+         * @brief Declares an image owned by someone else (e.g. the swap chain images), bound with setImportedImage before every execution
+         * @return The image index
+         */
+        uint32_t importImage(const std::string &name, const RenderGraphImageConfiguration &config);
+
+        /**
+         * @brief Adds a pass recorded by the passed function, in execution order. The graph has to be compiled again
+         * @return The pass index
+         * @throws Runtime Exception if an image index is invalid or a read uses a write usage (or vice versa)
+         */
+        uint32_t addPass(const std::string &name, const RenderGraphPassConfiguration &config, std::function<void(const VkCommandBuffer &)> record);
+
+        /**
+         * @brief Marks the image as output, the passes writing it are not culled even if no other pass reads it
+         */
+        void markOutput(uint32_t image);
+
+        /**
+         * @brief Culls the passes, allocates the transient images and computes the barriers. The previous compilation
+         * resources are destroyed through the device deletion queue, once the frames using them are completed
+         * @throws Runtime Exception if the attachments of a pass have different extents or a Vulkan object cannot be created
+         */
+        void compile();
+
+        /**
+         * @brief Records the barriers and the alive passes inside the command buffer
+         * @throws Runtime Exception if the graph is not compiled or an imported image is not bound
+         */
+        void execute(const VkCommandBuffer &cmd);
+
+        /**
+         * @brief Drops the frame buffers built on the imported views and unbinds them. To be called when the imported images
+         * are recreated (e.g. swap chain resize), since the new views can recycle the destroyed handles
+         */
+        void invalidateImportedImages();
+
+        // Setters
+        void setImportedImage(uint32_t image, const VkImage &handle, const VkImageView &view);
+        // Extent of the images without one, the graph has to be compiled again
+        void setExtent(const VkExtent2D &extent) { this->extent = extent; }
+
+        // Getters
+        const VkRenderPass &getRenderPass(uint32_t pass) { return passes.at(pass).render_pass; }
+        const VkImage &getImage(uint32_t image) { return images.at(image).image; }
+        const VkImageView &getImageView(uint32_t image) { return images.at(image).view; }
+        bool isPassCulled(uint32_t pass) { return !passes.at(pass).alive; }
+        const RenderGraphStatistics &getStatistics() { return statistics; }
+
+    private:
+        // Image state transition recorded before a pass
+        struct Barrier
+        {
+            uint32_t image;
+            VkPipelineStageFlags2 src_stages;
+            VkAccessFlags2 src_access;
+            VkPipelineStageFlags2 dst_stages;
+            VkAccessFlags2 dst_access;
+            VkImageLayout old_layout;
+            VkImageLayout new_layout;
+        };
+
+        struct Image
+        {
+            std::string name;
+            RenderGraphImageConfiguration config;
+            bool imported = false;
+            bool output = false;
+
+            // Compilation results: passes range using the image, usage flags and memory block (transient images only)
+            VkExtent2D extent = {0, 0};
+            uint32_t first_pass = 0;
+            uint32_t last_pass = 0;
+            bool used = false;
+            VkImageUsageFlags usage = 0;
+            VkMemoryRequirements requirements{};
+            uint32_t memory_block = 0;
+            // Previous image on the same memory, its last accesses have to complete before the first use of this one
+            int32_t aliased_image = -1;
+
+            VkImage image = VK_NULL_HANDLE;
+            VkImageView view = VK_NULL_HANDLE;
+        };
+
+        struct Pass
+        {
+            std::string name;
+            RenderGraphPassConfiguration config;
+            std::function<void(const VkCommandBuffer &)> record;
+
+            // Compilation results
+            bool alive = false;
+            std::vector<Barrier> barriers;
+            std::vector<uint32_t> attachments;
+            std::vector<VkClearValue> clear_values;
+            VkExtent2D extent = {0, 0};
+            VkRenderPass render_pass = VK_NULL_HANDLE;
+            // Frame buffers per attachment views, imported images change view every frame (one entry per swap chain image
+            // until invalidateImportedImages)
+            std::map<std::vector<VkImageView>, VkFramebuffer> frame_buffers;
+        };
+
+        struct MemoryBlock
+        {
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            VkDeviceSize size = 0;
+            uint32_t memory_type = 0;
+            std::vector<uint32_t> images;
+        };
+
+        // Last accesses of an image while computing the barriers
+        struct ImageState
+        {
+            VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+            VkPipelineStageFlags2 write_stages = 0;
+            VkAccessFlags2 write_access = 0;
+            VkPipelineStageFlags2 read_stages = 0;
+            VkAccessFlags2 read_access = 0;
+        };
+
+        // Layout, stages and accesses implied by a usage
+        struct UsageState
+        {
+            VkImageLayout layout;
+            VkPipelineStageFlags2 stages;
+            VkAccessFlags2 read_access;
+            VkAccessFlags2 write_access;
+            VkImageUsageFlags image_usage;
+        };
+
+        static UsageState getUsageState(RenderGraphUsage usage);
+        static bool isWriteUsage(RenderGraphUsage usage);
+        static bool isAttachmentUsage(RenderGraphUsage usage);
+
+        /**
+         * @brief Marks as alive the passes contributing to the outputs, walking them in reverse order
+         */
+        void cullPasses();
+
+        /**
+         * @brief Creates the transient images, assigning to the same memory block the ones with disjoint lifetimes
+         */
+        void allocateImages();
+
+        /**
+         * @brief Computes the barriers before every alive pass and the final transitions of the imported images
+         */
+        void computeBarriers();
+
+        /**
+         * @brief Adds the barrier needed to access the image with the passed usage, if any, and updates its state
+         */
+        void addAccess(std::vector<Barrier> &barriers, std::vector<ImageState> &states, uint32_t image, const UsageState &usage);
+
+        /**
+         * @brief Creates the render pass of an alive pass writing attachments, with load and store operations derived from the neighbour passes
+         */
+        void createRenderPass(uint32_t pass_index);
+
+        /**
+         * @brief Checks if an alive pass before the passed one (or the importer) produced the image content
+         */
+        bool hasContentBefore(uint32_t image, uint32_t pass_index);
+
+        /**
+         * @brief Checks if an alive pass after the passed one (or the graph output) needs the image content
+         */
+        bool isContentNeededAfter(uint32_t image, uint32_t pass_index);
+
+        /**
+         * @brief Returns the frame buffer of the pass for the currently bound attachment views, creating it if needed
+         */
+        VkFramebuffer getFrameBuffer(Pass &pass);
+
+        /**
+         * @brief Records the barriers with vkCmdPipelineBarrier2 or, without synchronization2, with a single legacy barrier
+         */
+        void recordBarriers(const VkCommandBuffer &cmd, const std::vector<Barrier> &barriers);
+
+        /**
+         * @brief Looks for the memory on the GPU that suits the passed parameters
+         * @return the memory type index or -1 if none is found
+         */
+        int32_t findMemoryType(uint32_t type_filter, VkMemoryPropertyFlags flags);
+
+        /**
+         * @brief Destroys the compilation resources once the submitted frames are completed
+         */
+        void cleanup();
+
+        std::shared_ptr<LogicalDevice> l_device;
+
+        std::vector<Image> images;
+        std::vector<Pass> passes;
+        std::vector<MemoryBlock> memory_blocks;
+
+        // Transitions of the imported images to their final layout
+        std::vector<Barrier> final_barriers;
+
+        VkExtent2D extent = {0, 0};
+        bool compiled = false;
+        RenderGraphStatistics statistics;
+    };
+}
@@ -3,7 +3,7 @@
 
 namespace framework
 {
-    RenderPass::RenderPass(const std::shared_ptr<LogicalDevice> &l_device, const VkExtent2D &extent, const VkSurfaceFormatKHR &format, DepthTestType depth)
+    RenderPass::RenderPass(const std::shared_ptr<LogicalDevice> &l_device, const VkExtent2D &extent, const VkSurfaceFormatKHR &format, DepthTestType depth, VkImageLayout color_final_layout)
     {
         if (l_device == nullptr)
         {
@@ -12,8 +12,12 @@ namespace framework
 
         this->l_device = l_device;
         this->depth = depth;
+        this->color_final_layout = color_final_layout;
+        this->extent = extent;
+        this->format = format;
 
-        createRenderPass(extent, format);
+        createDepthImage();
+        createRenderPass();
     }
 
     RenderPass::~RenderPass()
@@ -21,7 +25,29 @@ namespace framework
         cleanup();
     }
 
-    void RenderPass::createRenderPass(const VkExtent2D &extent, const VkSurfaceFormatKHR &format)
+    void RenderPass::createDepthImage()
+    {
+        if (depth == NONE)
+        {
+            return;
+        }
+
+        VkFormat depthFormat = static_cast<VkFormat>(depth);
+
+        // Check that the requested depth buffering is supported
+        checkFormat(depthFormat,
+                    VK_IMAGE_TILING_OPTIMAL,
+                    VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
+
+        // Create the depth buffer image
+        createImage(extent.width, extent.height,
+                    depthFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, depth_image, depth_image_memory);
+
+        createImageView(depth_image, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, depth_image_view);
+    }
+
+    void RenderPass::createRenderPass()
     {
         // Structs to be used in case of a depth buffer active
         VkAttachmentDescription depth_attachment{};
@@ -32,18 +58,6 @@ namespace framework
         {
             VkFormat depthFormat = static_cast<VkFormat>(depth);
 
-            // Check that the requested depth buffering is supported
-            checkFormat(depthFormat,
-                        VK_IMAGE_TILING_OPTIMAL,
-                        VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
-
-            // Create the depth buffer image
-            createImage(extent.width, extent.height,
-                        depthFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
-                        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, depth_image, depth_image_memory);
-
-            createImageView(depth_image, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, depth_image_view);
-
             // Populate the attachment
             depth_attachment.format = depthFormat;
             depth_attachment.samples = VK_SAMPLE_COUNT_1_BIT;
@@ -68,9 +82,9 @@ namespace framework
         color_attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         color_attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 
-        // The images are presented for a swap chain
+        // The images are presented for a swap chain (or left for the offscreen target users)
         color_attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        color_attachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        color_attachment.finalLayout = color_final_layout;
 
         // Setup subpass
         VkAttachmentReference color_attachment_ref{};
@@ -160,16 +174,62 @@ namespace framework
         }
     }
 
-    void RenderPass::recreateRenderPass(const VkExtent2D &extent, const VkSurfaceFormatKHR &format)
+    void RenderPass::recreateRenderPass(const VkExtent2D &extent, const VkSurfaceFormatKHR &format, bool deferred)
     {
-        // Remove the previously created one
-        cleanup();
+        bool extent_changed = extent.width != this->extent.width || extent.height != this->extent.height;
+        bool format_changed = format.format != this->format.format;
+
+        this->extent = extent;
+        this->format = format;
+
+        // Only the depth image depends on the extent, the render pass only on the color format
+        if (extent_changed && depth != NONE)
+        {
+            retireDepthImage(deferred);
+            createDepthImage();
+        }
+
+        if (format_changed)
+        {
+            if (deferred)
+            {
+                l_device->destroyDeferred([old_render_pass = render_pass](VkDevice device)
+                                          { vkDestroyRenderPass(device, old_render_pass, nullptr); });
+            }
+            else
+            {
+                vkDestroyRenderPass(l_device->getDevice(), render_pass, nullptr);
+            }
+
+            render_pass = VK_NULL_HANDLE;
+            createRenderPass();
+        }
+    }
+
+    void RenderPass::retireDepthImage(bool deferred)
+    {
+        auto destroy = [view = depth_image_view, image = depth_image, memory = depth_image_memory](VkDevice device)
+        {
+            vkDestroyImageView(device, view, nullptr);
+            vkDestroyImage(device, image, nullptr);
+            vkFreeMemory(device, memory, nullptr);
+        };
+
+        if (deferred)
+        {
+            l_device->destroyDeferred(destroy);
+        }
+        else
+        {
+            destroy(l_device->getDevice());
+        }
 
-        // Recreate the render pass
-        createRenderPass(extent, format);
+        depth_image_view = VK_NULL_HANDLE;
+        depth_image = VK_NULL_HANDLE;
+        depth_image_memory = VK_NULL_HANDLE;
     }
 
-    void RenderPass::begin(const VkCommandBuffer &cmd_buffer, const VkFramebuffer &frame_buffer, const VkExtent2D &extent, const VkClearValue &clear_color)
+    void RenderPass::begin(const VkCommandBuffer &cmd_buffer, const VkFramebuffer &frame_buffer, const VkExtent2D &extent, const VkClearValue &clear_color, VkSubpassContents contents)
     {
         // Start the render pass
         VkRenderPassBeginInfo render_pass_info{};
@@ -188,7 +248,7 @@ namespace framework
         render_pass_info.clearValueCount = static_cast<uint32_t>(clear_values.size());
         render_pass_info.pClearValues = clear_values.data();
 
-        vkCmdBeginRenderPass(cmd_buffer, &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdBeginRenderPass(cmd_buffer, &render_pass_info, contents);
     }
 
     void RenderPass::end(const VkCommandBuffer &cmd_buffer)
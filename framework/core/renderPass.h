@@ -18,22 +18,31 @@ namespace framework
     class RenderPass
     {
     public:
-        RenderPass(const std::shared_ptr<LogicalDevice> &l_device, const VkExtent2D &extent, const VkSurfaceFormatKHR &format, DepthTestType depth = DepthTestType::NONE);
+        /**
+         * @brief Construct a new Render Pass object. The color attachment is left in color_final_layout at the end of the pass:
+         * PRESENT_SRC for a swap chain, TRANSFER_SRC (read back) or SHADER_READ_ONLY (sampled) for an offscreen target
+         */
+        RenderPass(const std::shared_ptr<LogicalDevice> &l_device, const VkExtent2D &extent, const VkSurfaceFormatKHR &format, DepthTestType depth = DepthTestType::NONE,
+                   VkImageLayout color_final_layout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
         ~RenderPass();
 
         /**
-         * @brief Recreates the render pass cleaning up the previous one. Usually due to a window resize
+         * @brief Recreates what depends on the changed parameters: the depth image on extent changes, the render pass on format
+         * changes. Usually due to a window resize. When deferred, the replaced objects are destroyed through the device deletion queue
+         * instead of immediately (which requires the device to be idle)
          */
-        void recreateRenderPass(const VkExtent2D &extent, const VkSurfaceFormatKHR &format);
+        void recreateRenderPass(const VkExtent2D &extent, const VkSurfaceFormatKHR &format, bool deferred = false);
 
-        // Render pass functions
-        void begin(const VkCommandBuffer &cmd_buffer, const VkFramebuffer &frame_buffer, const VkExtent2D &extent, const VkClearValue &clear_color);
+        // Render pass functions, the contents are VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS when the subpass is recorded in secondary command buffers
+        void begin(const VkCommandBuffer &cmd_buffer, const VkFramebuffer &frame_buffer, const VkExtent2D &extent, const VkClearValue &clear_color,
+                   VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
         void end(const VkCommandBuffer &cmd_buffer);
 
         // Getters
         const VkRenderPass &getRenderPass() { return render_pass; }
         const VkImageView &getDepthImageView() { return depth_image_view; }
         const DepthTestType &getDepthTestType() { return depth; }
+        VkImageLayout getColorFinalLayout() { return color_final_layout; }
 
     private:
         /**
@@ -42,9 +51,19 @@ namespace framework
         void cleanup();
 
         /**
-         * @brief Creates the vulkan instance of the render pass with also the image view in case of depth buffer
+         * @brief Creates the vulkan instance of the render pass for the current format
+         */
+        void createRenderPass();
+
+        /**
+         * @brief Creates the depth image and its view with the current extent, if the depth test is enabled
+         */
+        void createDepthImage();
+
+        /**
+         * @brief Destroys the depth image, immediately or through the device deletion queue
          */
-        void createRenderPass(const VkExtent2D &extent, const VkSurfaceFormatKHR &format);
+        void retireDepthImage(bool deferred);
 
         /**
          * @brief Checks that the format is valid and throws an exception if not
@@ -68,6 +87,9 @@ namespace framework
 
         std::shared_ptr<LogicalDevice> l_device;
         DepthTestType depth;
+        VkImageLayout color_final_layout;
+        VkExtent2D extent;
+        VkSurfaceFormatKHR format;
 
         VkRenderPass render_pass = VK_NULL_HANDLE;
 
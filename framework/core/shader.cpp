@@ -72,6 +72,9 @@ namespace framework
         case FRAGMENT:
             return VK_SHADER_STAGE_FRAGMENT_BIT;
             break;
+        case COMPUTE:
+            return VK_SHADER_STAGE_COMPUTE_BIT;
+            break;
         default:
             throw std::runtime_error("[Shader] Shader type not listed");
         }
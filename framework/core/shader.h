@@ -14,6 +14,7 @@ namespace framework
         TESSELLATION,
         GEOMETRY,
         FRAGMENT,
+        COMPUTE,
     };
 
     class Shader
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <devices/physicalDevice.h>
+#include <devices/logicalDevice.h>
+#include <core/descriptorElement.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <memory>
+
+namespace framework
+{
+    struct StorageBufferConfiguration
+    {
+        uint32_t binding_index = 0;
+        VkShaderStageFlags stage_flags = VK_SHADER_STAGE_VERTEX_BIT;
+        // Number of T elements inside the buffer
+        uint32_t elements = 1;
+        // Usages added to the storage one (e.g. indirect buffer written by a compute shader)
+        VkBufferUsageFlags additional_usage = 0;
+        // Host visible buffers are persistently mapped, device local ones can only be written by the GPU
+        bool host_visible = true;
+    };
+
+    template <typename T>
+    class StorageBuffer : public DescriptorElement
+    {
+    public:
+        StorageBuffer(const std::shared_ptr<LogicalDevice> &l_device, const StorageBufferConfiguration &config);
+        ~StorageBuffer();
+
+        /**
+         * @brief Copies count elements inside the buffer starting from the first element index
+         * @throws Runtime Exception if the range exceeds the buffer size or the buffer is not host visible
+         */
+        void setData(const T *data, uint32_t count, uint32_t first = 0);
+
+        // Getters
+        const VkDescriptorSetLayoutBinding getDescriptorSetLayoutBinding() override;
+        const VkDescriptorPoolSize getPoolSize() override;
+        const VkWriteDescriptorSet getWriteDescriptorSet() override;
+        inline const VkBuffer &getStorageBuffer() { return storage_buffer; }
+        // Persistently mapped elements (nullptr if not host visible), results can be written directly inside the GPU visible memory
+        inline T *getMappedData() { return static_cast<T *>(mapped_memory); }
+        inline uint32_t getElementsNumber() { return config.elements; }
+
+    private:
+        /**
+         * @brief Allocates a buffer of memory depending on the passed parameters
+         */
+        void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer, VkDeviceMemory &buffer_memory);
+
+        uint32_t findMemoryType(uint32_t type_filter, VkMemoryPropertyFlags properties);
+
+        std::shared_ptr<LogicalDevice> l_device;
+
+        StorageBufferConfiguration config;
+
+        // SSBO
+        VkBuffer storage_buffer = VK_NULL_HANDLE;
+        VkDeviceMemory storage_buffer_memory = VK_NULL_HANDLE;
+        VkDescriptorBufferInfo buffer_info{};
+        void *mapped_memory = nullptr;
+    };
+
+    template <typename T>
+    StorageBuffer<T>::StorageBuffer(const std::shared_ptr<LogicalDevice> &l_device, const StorageBufferConfiguration &config)
+        : DescriptorElement(config.binding_index), config(config)
+    {
+        if (l_device == nullptr)
+        {
+            throw std::runtime_error("[StorageBuffer] Null logical device instance");
+        }
+
+        this->l_device = l_device;
+
+        if (config.elements == 0)
+        {
+            throw std::runtime_error("[StorageBuffer] Zero elements buffer");
+        }
+
+        VkDeviceSize buffer_size = sizeof(T) * config.elements;
+
+        createBuffer(buffer_size,
+                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | config.additional_usage,
+                     config.host_visible ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+                                         : VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                     storage_buffer, storage_buffer_memory);
+
+        // Persistent memory mapping
+        if (config.host_visible)
+        {
+            vkMapMemory(l_device->getDevice(), storage_buffer_memory, 0, buffer_size, 0, &mapped_memory);
+        }
+
+        buffer_info.buffer = storage_buffer;
+        buffer_info.offset = 0;
+        buffer_info.range = buffer_size;
+    }
+
+    template <typename T>
+    StorageBuffer<T>::~StorageBuffer()
+    {
+        // The buffer may still be bound by frames in flight
+        l_device->destroyDeferred([buffer = storage_buffer, memory = storage_buffer_memory](VkDevice device)
+                                  {
+            if (buffer != VK_NULL_HANDLE)
+            {
+                vkDestroyBuffer(device, buffer, nullptr);
+            }
+
+            if (memory != VK_NULL_HANDLE)
+            {
+                vkFreeMemory(device, memory, nullptr);
+            } });
+    }
+
+    template <typename T>
+    void StorageBuffer<T>::setData(const T *data, uint32_t count, uint32_t first)
+    {
+        if (static_cast<uint64_t>(first) + count > config.elements)
+        {
+            throw std::runtime_error("[StorageBuffer] Data exceeds the buffer size");
+        }
+
+        if (mapped_memory == nullptr)
+        {
+            throw std::runtime_error("[StorageBuffer] The buffer is not host visible");
+        }
+
+        // Copy the data inside the shared memory
+        memcpy(static_cast<T *>(mapped_memory) + first, data, sizeof(T) * count);
+    }
+
+    template <typename T>
+    const VkDescriptorSetLayoutBinding StorageBuffer<T>::getDescriptorSetLayoutBinding()
+    {
+        VkDescriptorSetLayoutBinding ssbo_layout_binding{};
+
+        ssbo_layout_binding.binding = config.binding_index;
+        ssbo_layout_binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        ssbo_layout_binding.descriptorCount = 1;
+        ssbo_layout_binding.stageFlags = config.stage_flags;
+        ssbo_layout_binding.pImmutableSamplers = nullptr;
+
+        return ssbo_layout_binding;
+    }
+
+    template <typename T>
+    const VkDescriptorPoolSize StorageBuffer<T>::getPoolSize()
+    {
+        VkDescriptorPoolSize pool_size{};
+
+        pool_size.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        pool_size.descriptorCount = 1;
+
+        return pool_size;
+    }
+
+    template <typename T>
+    const VkWriteDescriptorSet StorageBuffer<T>::getWriteDescriptorSet()
+    {
+        VkWriteDescriptorSet descriptor_write{};
+
+        descriptor_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptor_write.dstBinding = config.binding_index;
+        descriptor_write.dstArrayElement = 0;
+        descriptor_write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptor_write.descriptorCount = 1;
+        descriptor_write.pBufferInfo = &buffer_info;
+        descriptor_write.pImageInfo = nullptr;
+        descriptor_write.pTexelBufferView = nullptr;
+
+        return descriptor_write;
+    }
+
+    template <typename T>
+    void StorageBuffer<T>::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer &buffer, VkDeviceMemory &buffer_memory)
+    {
+        // Create storage buffer
+        VkBufferCreateInfo buffer_info{};
+
+        buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        buffer_info.size = size;
+        buffer_info.usage = usage;
+        buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateBuffer(l_device->getDevice(), &buffer_info, nullptr, &buffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[StorageBuffer] Impossible to create the buffer");
+        }
+
+        // Enumerate the memory requirements
+        VkMemoryRequirements memory_requirements;
+        vkGetBufferMemoryRequirements(l_device->getDevice(), buffer, &memory_requirements);
+
+        // Allocate the memory on GPU
+        VkMemoryAllocateInfo alloc_info{};
+
+        alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        alloc_info.allocationSize = memory_requirements.size;
+        alloc_info.memoryTypeIndex = findMemoryType(memory_requirements.memoryTypeBits, properties);
+
+        if (vkAllocateMemory(l_device->getDevice(), &alloc_info, nullptr, &buffer_memory) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[StorageBuffer] Impossible to allocate the required memory on the GPU");
+        }
+
+        // Associate the buffer to the memory
+        vkBindBufferMemory(l_device->getDevice(), buffer, buffer_memory, 0);
+    }
+
+    template <typename T>
+    uint32_t StorageBuffer<T>::findMemoryType(uint32_t type_filter, VkMemoryPropertyFlags properties)
+    {
+        VkPhysicalDeviceMemoryProperties memory_properties;
+
+        // Enumerate the memory properties
+        vkGetPhysicalDeviceMemoryProperties(l_device->getPhysicalDevice()->getDevice(), &memory_properties);
+
+        for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++)
+        {
+            if ((type_filter & (1 << i)) && (memory_properties.memoryTypes[i].propertyFlags & properties) == properties)
+            {
+                return i;
+            }
+        }
+
+        throw std::runtime_error("[StorageBuffer] Unable to find a suitable memory type");
+    }
+
+}
\ No newline at end of file
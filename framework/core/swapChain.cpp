@@ -51,19 +51,42 @@ namespace framework
         }
     }
 
-    void SwapChain::recreateSwapChain(const std::shared_ptr<Window> &window, const VkSurfaceKHR &surface)
+    void SwapChain::recreateSwapChain(const std::shared_ptr<Window> &window, const VkSurfaceKHR &surface, bool deferred)
     {
-        // Clean the swap chain and image views
-        cleanup();
+        if (!deferred)
+        {
+            // Clean the swap chain and image views
+            cleanup();
+            swap_chain = VK_NULL_HANDLE;
 
-        // Create the swap chain
-        createSwapChain(window, surface);
+            // Create the swap chain
+            createSwapChain(window, surface);
 
-        // Create the corresponding image views
+            // Create the corresponding image views
+            createImageViews();
+            return;
+        }
+
+        // The old swap chain images may still be rendered or presented, its handles are destroyed once the submitted frames complete.
+        // It is kept one more frame, since the fences do not track its last presentation
+        VkSwapchainKHR old_swap_chain = swap_chain;
+        std::vector<VkImageView> old_image_views = image_views;
+
+        createSwapChain(window, surface, old_swap_chain);
         createImageViews();
+
+        l_device->destroyDeferred([old_swap_chain, old_image_views](VkDevice device)
+                                  {
+            for (VkImageView view : old_image_views)
+            {
+                vkDestroyImageView(device, view, nullptr);
+            }
+
+            vkDestroySwapchainKHR(device, old_swap_chain, nullptr); },
+                                  1);
     }
 
-    void SwapChain::createSwapChain(const std::shared_ptr<Window> &window, const VkSurfaceKHR &surface)
+    void SwapChain::createSwapChain(const std::shared_ptr<Window> &window, const VkSurfaceKHR &surface, const VkSwapchainKHR &old_swap_chain)
     {
         // Get the support details
         swap_chain_support = l_device->getPhysicalDevice()->getSwapChainSupportDetails();
@@ -94,6 +117,14 @@ namespace framework
         create_info.imageArrayLayers = 1;
         create_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
 
+        // Transfer source allows the frame capture to copy the presented images, when the surface supports it
+        transfer_source = (swap_chain_support.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) != 0;
+
+        if (transfer_source)
+        {
+            create_info.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        }
+
         // Configure family indices
         QueueFamilyIndices indices = l_device->findQueueFamilies(surface);
 
@@ -115,8 +146,8 @@ namespace framework
         create_info.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
         create_info.presentMode = present_mode;
         create_info.clipped = VK_TRUE;
-        // TODO to consider for window resizing
-        create_info.oldSwapchain = VK_NULL_HANDLE;
+        // The old swap chain lets the presentation engine reuse its resources and keeps presenting its images meanwhile
+        create_info.oldSwapchain = old_swap_chain;
 
         if (vkCreateSwapchainKHR(l_device->getDevice(), &create_info, nullptr, &swap_chain) != VK_SUCCESS)
         {
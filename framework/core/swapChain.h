@@ -29,9 +29,11 @@ namespace framework
         ~SwapChain();
 
         /**
-         * @brief Recreates the swap chain (usually called after a window resize)
+         * @brief Recreates the swap chain (usually called after a window resize), passing the current one as old swap chain.
+         * When deferred, the old swap chain and its image views are destroyed through the device deletion queue instead of
+         * immediately (which requires the device to be idle)
          */
-        void recreateSwapChain(const std::shared_ptr<Window> &window, const VkSurfaceKHR &surface);
+        void recreateSwapChain(const std::shared_ptr<Window> &window, const VkSurfaceKHR &surface, bool deferred = false);
 
         // Getters
         const VkSwapchainKHR &getSwapChain() { return swap_chain; }
@@ -40,6 +42,8 @@ namespace framework
         const VkSurfaceFormatKHR &getFormat() { return surface_format; }
         const VkPresentModeKHR &getPresentMode() { return present_mode; }
         const VkExtent2D &getExtent() { return extent; }
+        // Whether the images can be copied (created with the transfer source usage)
+        bool isTransferSource() { return transfer_source; }
 
     private:
         /**
@@ -48,9 +52,10 @@ namespace framework
         void cleanup();
 
         /**
-         * @brief Creates the swap chain itself (called by constructor and re-creation method)
+         * @brief Creates the swap chain itself (called by constructor and re-creation method). The old swap chain, if any, is retired
+         * by the creation but still has to be destroyed by the caller
          */
-        void createSwapChain(const std::shared_ptr<Window> &window, const VkSurfaceKHR &surface);
+        void createSwapChain(const std::shared_ptr<Window> &window, const VkSurfaceKHR &surface, const VkSwapchainKHR &old_swap_chain = VK_NULL_HANDLE);
 
         /**
          * @brief Creates the corresponding image views for the created images
@@ -87,5 +92,6 @@ namespace framework
         VkSurfaceFormatKHR surface_format;
         VkPresentModeKHR present_mode;
         VkExtent2D extent;
+        bool transfer_source = false;
     };
 }
\ No newline at end of file
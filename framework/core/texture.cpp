@@ -1,4 +1,5 @@
 #include "texture.h"
+#include <utils/traceProfiler.h>
 
 #include <stdexcept>
 #include <cstring>
@@ -13,6 +14,8 @@ namespace framework
     Texture::Texture(const std::shared_ptr<LogicalDevice> &l_device, const VkCommandPool &pool, const char *filename, uint32_t binding_index)
         : DescriptorElement(binding_index)
     {
+        TraceZone zone("Texture::Texture");
+
         if (l_device == nullptr)
         {
             throw std::runtime_error("[Texture] Null logical device instance");
@@ -89,35 +92,40 @@ namespace framework
 
     Texture::~Texture()
     {
-        if (staging_buffer != VK_NULL_HANDLE)
-        {
-            vkDestroyBuffer(l_device->getDevice(), staging_buffer, nullptr);
-        }
+        // The texture may be dropped while frames sampling it are in flight
+        l_device->destroyDeferred([staging_buffer = staging_buffer, staging_buffer_memory = staging_buffer_memory, texture_image = texture_image,
+                                   texture_image_memory = texture_image_memory, texture_image_view = texture_image_view,
+                                   texture_sampler = texture_sampler](VkDevice device)
+                                  {
+            if (staging_buffer != VK_NULL_HANDLE)
+            {
+                vkDestroyBuffer(device, staging_buffer, nullptr);
+            }
 
-        if (staging_buffer_memory != VK_NULL_HANDLE)
-        {
-            vkFreeMemory(l_device->getDevice(), staging_buffer_memory, nullptr);
-        }
+            if (staging_buffer_memory != VK_NULL_HANDLE)
+            {
+                vkFreeMemory(device, staging_buffer_memory, nullptr);
+            }
 
-        if (texture_image != VK_NULL_HANDLE)
-        {
-            vkDestroyImage(l_device->getDevice(), texture_image, nullptr);
-        }
+            if (texture_image_view != VK_NULL_HANDLE)
+            {
+                vkDestroyImageView(device, texture_image_view, nullptr);
+            }
 
-        if (texture_image_memory != VK_NULL_HANDLE)
-        {
-            vkFreeMemory(l_device->getDevice(), texture_image_memory, nullptr);
-        }
+            if (texture_image != VK_NULL_HANDLE)
+            {
+                vkDestroyImage(device, texture_image, nullptr);
+            }
 
-        if (texture_image_view != VK_NULL_HANDLE)
-        {
-            vkDestroyImageView(l_device->getDevice(), texture_image_view, nullptr);
-        }
+            if (texture_image_memory != VK_NULL_HANDLE)
+            {
+                vkFreeMemory(device, texture_image_memory, nullptr);
+            }
 
-        if (texture_sampler != VK_NULL_HANDLE)
-        {
-            vkDestroySampler(l_device->getDevice(), texture_sampler, nullptr);
-        }
+            if (texture_sampler != VK_NULL_HANDLE)
+            {
+                vkDestroySampler(device, texture_sampler, nullptr);
+            } });
     }
 
     const VkDescriptorSetLayoutBinding Texture::getDescriptorSetLayoutBinding()
@@ -1,4 +1,6 @@
 #include "textureCollection.h"
+#include <utils/jobSystem.h>
+#include <utils/traceProfiler.h>
 
 #include <stdexcept>
 #include <cstring>
@@ -14,6 +16,8 @@ namespace framework
     TextureCollection::TextureCollection(const std::shared_ptr<LogicalDevice> &l_device, const VkCommandPool &pool, const std::vector<std::string> &filenames, uint32_t binding_index)
         : DescriptorElement(binding_index)
     {
+        TraceZone zone("TextureCollection::TextureCollection");
+
         if (l_device == nullptr)
         {
             throw std::runtime_error("[Texture] Null logical device instance");
@@ -39,46 +43,69 @@ namespace framework
             image_infos.push_back(VkDescriptorImageInfo{});
         }
 
+        // Decode the images in parallel, the GPU upload stays on the calling thread
+        struct DecodedImage
+        {
+            stbi_uc *pixels = nullptr;
+            int width = 0, height = 0, channels = 0;
+        };
+
+        std::vector<DecodedImage> images(filenames.size());
+        JobSystem::getInstance().parallelFor(filenames.size(), 1, [&](size_t begin, size_t end)
+                                             {
+            for (size_t i = begin; i < end; i++)
+            {
+                TraceZone decode_zone("TextureCollection::decodeImage");
+                DecodedImage &image = images[i];
+                image.pixels = stbi_load(filenames[i].c_str(), &image.width, &image.height, &image.channels, STBI_rgb_alpha);
+            } });
+
+        for (const DecodedImage &image : images)
+        {
+            if (!image.pixels)
+            {
+                for (const DecodedImage &decoded : images)
+                {
+                    stbi_image_free(decoded.pixels);
+                }
+
+                throw std::runtime_error("[Texture] Error opening texture image");
+            }
+        }
+
+        // Staging buffers of every texture, uploaded all together
+        std::vector<VkBuffer> staging_buffers(filenames.size(), VK_NULL_HANDLE);
+        std::vector<VkDeviceMemory> staging_buffers_memory(filenames.size(), VK_NULL_HANDLE);
+        std::vector<VkExtent2D> extents(filenames.size());
+
         // Create and store the textures on the GPU
         for (size_t i = 0; i < filenames.size(); i++)
         {
-            const std::string &name = filenames[i];
             TextureDescriptor &descriptor = textures[i];
-            VkDescriptorImageInfo &image_info = image_infos[i];
 
-            // Open the image
-            stbi_uc *pixels = stbi_load(name.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+            stbi_uc *pixels = images[i].pixels;
+            width = images[i].width;
+            height = images[i].height;
+            channels = images[i].channels;
+            extents[i] = {static_cast<uint32_t>(width), static_cast<uint32_t>(height)};
 
             // 4 = RGB + Alpha
             VkDeviceSize image_size = width * height * 4;
 
-            if (!pixels)
-            {
-                throw std::runtime_error("[Texture] Error opening texture image");
-            }
-
-            // Buffer to transfer the image to the GPU
-            VkBuffer staging_buffer;
-            VkDeviceMemory staging_buffer_memory;
-
-            // Image structs
-            VkImageView texture_image_view;
-            VkSampler texture_sampler;
-
             // Create the staging buffer and copy the image inside
             createBuffer(image_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                         staging_buffer, staging_buffer_memory);
+                         staging_buffers[i], staging_buffers_memory[i]);
 
             // Map the buffer and transfer the image
             void *data;
-            vkMapMemory(l_device->getDevice(), staging_buffer_memory, 0, image_size, 0, &data);
+            vkMapMemory(l_device->getDevice(), staging_buffers_memory[i], 0, image_size, 0, &data);
 
             // Transfer the memory
             memcpy(data, pixels, static_cast<size_t>(image_size));
 
             // Unmap the memory
-            vkUnmapMemory(l_device->getDevice(), staging_buffer_memory);
+            vkUnmapMemory(l_device->getDevice(), staging_buffers_memory[i]);
 
             // Create the actual image in memory
             createImage(width, height, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
@@ -86,62 +113,67 @@ namespace framework
                         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
                         descriptor.texture_image, descriptor.texture_image_memory);
 
-            // Transition the image into the optimal transfer layout
-            transitionImageLayout(descriptor.texture_image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+            // Clean up the pixel array once copied
+            stbi_image_free(pixels);
+        }
 
-            // Copy the buffer into the image
-            copyBufferToImage(staging_buffer, descriptor.texture_image, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+        // Transition, copy and transition again every image with a single submission
+        uploadImages(staging_buffers, extents);
 
-            // Remove the intermediate created buffer
-            vkDestroyBuffer(l_device->getDevice(), staging_buffer, nullptr);
-            vkFreeMemory(l_device->getDevice(), staging_buffer_memory, nullptr);
+        for (size_t i = 0; i < filenames.size(); i++)
+        {
+            // Remove the intermediate created buffers
+            vkDestroyBuffer(l_device->getDevice(), staging_buffers[i], nullptr);
+            vkFreeMemory(l_device->getDevice(), staging_buffers_memory[i], nullptr);
 
-            // Transfer the layout to be read only optimal
-            transitionImageLayout(descriptor.texture_image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+            // Image structs
+            VkImageView texture_image_view;
+            VkSampler texture_sampler;
 
             // Create the image view
-            createImageView(descriptor.texture_image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, texture_image_view);
+            createImageView(textures[i].texture_image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, texture_image_view);
 
             // Create the texture sampler TODO make this more configurable
             createSampler(texture_sampler);
 
             // Set the image info
+            VkDescriptorImageInfo &image_info = image_infos[i];
             image_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
             image_info.imageView = texture_image_view;
             image_info.sampler = texture_sampler;
-
-            // Clean up the pixel array at the end
-            stbi_image_free(pixels);
         }
     }
 
     TextureCollection::~TextureCollection()
     {
-        for (size_t i = 0; i < textures.size(); i++)
-        {
-            TextureDescriptor &texture = textures[i];
-            VkDescriptorImageInfo &image_info = image_infos[i];
-
-            if (texture.texture_image != VK_NULL_HANDLE)
-            {
-                vkDestroyImage(l_device->getDevice(), texture.texture_image, nullptr);
-            }
-
-            if (texture.texture_image_memory != VK_NULL_HANDLE)
-            {
-                vkFreeMemory(l_device->getDevice(), texture.texture_image_memory, nullptr);
-            }
-
-            if (image_info.imageView != VK_NULL_HANDLE)
-            {
-                vkDestroyImageView(l_device->getDevice(), image_info.imageView, nullptr);
-            }
-
-            if (image_info.sampler != VK_NULL_HANDLE)
+        // The textures may be dropped while frames sampling them are in flight
+        l_device->destroyDeferred([textures = textures, image_infos = image_infos](VkDevice device)
+                                  {
+            for (size_t i = 0; i < textures.size(); i++)
             {
-                vkDestroySampler(l_device->getDevice(), image_info.sampler, nullptr);
-            }
-        }
+                const TextureDescriptor &texture = textures[i];
+                const VkDescriptorImageInfo &image_info = image_infos[i];
+
+                if (image_info.imageView != VK_NULL_HANDLE)
+                {
+                    vkDestroyImageView(device, image_info.imageView, nullptr);
+                }
+
+                if (image_info.sampler != VK_NULL_HANDLE)
+                {
+                    vkDestroySampler(device, image_info.sampler, nullptr);
+                }
+
+                if (texture.texture_image != VK_NULL_HANDLE)
+                {
+                    vkDestroyImage(device, texture.texture_image, nullptr);
+                }
+
+                if (texture.texture_image_memory != VK_NULL_HANDLE)
+                {
+                    vkFreeMemory(device, texture.texture_image_memory, nullptr);
+                }
+            } });
     }
 
     const VkDescriptorSetLayoutBinding TextureCollection::getDescriptorSetLayoutBinding()
@@ -243,7 +275,7 @@ namespace framework
         }
     }
 
-    void TextureCollection::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height)
+    void TextureCollection::uploadImages(const std::vector<VkBuffer> &staging_buffers, const std::vector<VkExtent2D> &extents)
     {
         // Reset the command buffer for new sequence of commands
         vkResetCommandBuffer(command_buffer->getCommandBuffer(), 0);
@@ -251,92 +283,72 @@ namespace framework
         // Start recording the command buffer
         command_buffer->beginRecording();
 
-        // Copy the buffer
-        VkBufferImageCopy region{};
-
-        region.bufferOffset = 0;
-        region.bufferRowLength = 0;
-        region.bufferImageHeight = 0;
-        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        region.imageSubresource.mipLevel = 0;
-        region.imageSubresource.baseArrayLayer = 0;
-        region.imageSubresource.layerCount = 1;
-        region.imageOffset = {0, 0, 0};
-        region.imageExtent = {width, height, 1};
-
-        // Assumes that the image has already been transitioned to the optimal layout
-        vkCmdCopyBufferToImage(command_buffer->getCommandBuffer(),
-                               buffer,
-                               image,
-                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                               1, &region);
-
-        // End the command buffer
-        command_buffer->stopRecording();
-
-        // Submit the queue and wait for idle operation
-        VkSubmitInfo submit_info{};
-        submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submit_info.commandBufferCount = 1;
-        submit_info.pCommandBuffers = &command_buffer->getCommandBuffer();
-
-        vkQueueSubmit(l_device->getGraphicsQueue(), 1, &submit_info, VK_NULL_HANDLE);
-        vkQueueWaitIdle(l_device->getGraphicsQueue());
-    }
-
-    void TextureCollection::transitionImageLayout(VkImage image, VkFormat format, VkImageLayout old_layout, VkImageLayout new_layout)
-    {
-        // Reset the command buffer for new sequence of commands
-        vkResetCommandBuffer(command_buffer->getCommandBuffer(), 0);
-
-        // Start recording the command buffer
-        command_buffer->beginRecording();
+        std::vector<VkImageMemoryBarrier> barriers(textures.size());
 
-        VkImageMemoryBarrier barrier{};
-
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.oldLayout = old_layout;
-        barrier.newLayout = new_layout;
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.image = image;
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        barrier.subresourceRange.baseMipLevel = 0;
-        barrier.subresourceRange.levelCount = 1;
-        barrier.subresourceRange.baseArrayLayer = 0;
-        barrier.subresourceRange.layerCount = 1;
-
-        VkPipelineStageFlags source_stage;
-        VkPipelineStageFlags destination_stage;
-
-        // Define the interesting transfers
-        if (old_layout == VK_IMAGE_LAYOUT_UNDEFINED && new_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
+        for (size_t i = 0; i < textures.size(); i++)
         {
+            VkImageMemoryBarrier &barrier = barriers[i];
+
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = textures[i].texture_image;
+            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            barrier.subresourceRange.baseMipLevel = 0;
+            barrier.subresourceRange.levelCount = 1;
+            barrier.subresourceRange.baseArrayLayer = 0;
+            barrier.subresourceRange.layerCount = 1;
             barrier.srcAccessMask = 0;
             barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        }
+
+        // One barrier call for all the images into the optimal transfer layout
+        vkCmdPipelineBarrier(command_buffer->getCommandBuffer(),
+                             VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0,
+                             0, nullptr,
+                             0, nullptr,
+                             static_cast<uint32_t>(barriers.size()), barriers.data());
 
-            source_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-            destination_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        for (size_t i = 0; i < textures.size(); i++)
+        {
+            // Copy the buffer
+            VkBufferImageCopy region{};
+
+            region.bufferOffset = 0;
+            region.bufferRowLength = 0;
+            region.bufferImageHeight = 0;
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel = 0;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount = 1;
+            region.imageOffset = {0, 0, 0};
+            region.imageExtent = {extents[i].width, extents[i].height, 1};
+
+            vkCmdCopyBufferToImage(command_buffer->getCommandBuffer(),
+                                   staging_buffers[i],
+                                   textures[i].texture_image,
+                                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                   1, &region);
         }
-        else if (old_layout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && new_layout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+
+        for (VkImageMemoryBarrier &barrier : barriers)
         {
+            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
             barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
             barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-            source_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-            destination_stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-        }
-        else
-        {
-            throw std::invalid_argument("[Texture] Unsupported layout transition!");
         }
 
+        // Transfer the layouts to be read only optimal
         vkCmdPipelineBarrier(command_buffer->getCommandBuffer(),
-                             source_stage, destination_stage,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
                              0,
                              0, nullptr,
                              0, nullptr,
-                             1, &barrier);
+                             static_cast<uint32_t>(barriers.size()), barriers.data());
 
         // End the command buffer
         command_buffer->stopRecording();
@@ -33,14 +33,9 @@ namespace framework
     void createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspect_flags, VkImageView &view);
 
     /**
-     * @brief Copies a buffer content into the specified image
+     * @brief Copies the staging buffers into the images, batching the layout transitions of all the images in a single submission
      */
-    void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
-
-    /**
-     * @brief Transforms the layout of an image into a new one
-     */
-    void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout old_layout, VkImageLayout new_layout);
+    void uploadImages(const std::vector<VkBuffer> &staging_buffers, const std::vector<VkExtent2D> &extents);
 
     /**
      * @brief Allocates the image inside the memory
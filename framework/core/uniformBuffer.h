@@ -82,15 +82,18 @@ namespace framework
     template <typename T>
     UniformBuffer<T>::~UniformBuffer()
     {
-        if (uniform_buffer != VK_NULL_HANDLE)
-        {
-            vkDestroyBuffer(l_device->getDevice(), uniform_buffer, nullptr);
-        }
+        // The buffer may still be bound by frames in flight
+        l_device->destroyDeferred([buffer = uniform_buffer, memory = uniform_buffer_memory](VkDevice device)
+                                  {
+            if (buffer != VK_NULL_HANDLE)
+            {
+                vkDestroyBuffer(device, buffer, nullptr);
+            }
 
-        if (uniform_buffer_memory != VK_NULL_HANDLE)
-        {
-            vkFreeMemory(l_device->getDevice(), uniform_buffer_memory, nullptr);
-        }
+            if (memory != VK_NULL_HANDLE)
+            {
+                vkFreeMemory(device, memory, nullptr);
+            } });
     }
 
     template <typename T>
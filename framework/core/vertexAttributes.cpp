@@ -1,7 +1,76 @@
 #include "vertexAttributes.h"
 
+#include <stdexcept>
+
 namespace framework
 {
+    uint32_t VertexAttributes::getStride()
+    {
+        uint32_t stride = 0;
+        for (size_t i = 0; i < attributes.size(); i++)
+        {
+            stride += getAttributeSize(attributes[i]);
+        }
+
+        return stride;
+    }
+
+    uint32_t VertexAttributes::getAttributeSize(DrawableAttribute attribute)
+    {
+        switch (attribute)
+        {
+        case DrawableAttribute::F1:
+        case DrawableAttribute::I1:
+        case DrawableAttribute::H2:
+        case DrawableAttribute::S16N2:
+        case DrawableAttribute::U16N2:
+        case DrawableAttribute::U8N4:
+        case DrawableAttribute::S8N4:
+        case DrawableAttribute::U1010102:
+        case DrawableAttribute::S1010102:
+            return 1 * sizeof(float);
+        case DrawableAttribute::F2:
+        case DrawableAttribute::H4:
+        case DrawableAttribute::S16N4:
+        case DrawableAttribute::U16N4:
+            return 2 * sizeof(float);
+        case DrawableAttribute::F3:
+            return 3 * sizeof(float);
+        case DrawableAttribute::F4:
+            return 4 * sizeof(float);
+        }
+
+        throw std::runtime_error("[VertexAttributes] Unknown attribute format");
+    }
+
+    uint32_t VertexAttributes::getAttributeComponents(DrawableAttribute attribute)
+    {
+        switch (attribute)
+        {
+        case DrawableAttribute::F1:
+        case DrawableAttribute::I1:
+            return 1;
+        case DrawableAttribute::F2:
+        case DrawableAttribute::H2:
+        case DrawableAttribute::S16N2:
+        case DrawableAttribute::U16N2:
+            return 2;
+        case DrawableAttribute::F3:
+            return 3;
+        case DrawableAttribute::F4:
+        case DrawableAttribute::H4:
+        case DrawableAttribute::S16N4:
+        case DrawableAttribute::U16N4:
+        case DrawableAttribute::U8N4:
+        case DrawableAttribute::S8N4:
+        case DrawableAttribute::U1010102:
+        case DrawableAttribute::S1010102:
+            return 4;
+        }
+
+        throw std::runtime_error("[VertexAttributes] Unknown attribute format");
+    }
+
     bool VertexAttributes::operator==(const std::vector<DrawableAttribute> &other)
     {
         // Check if the sizes differ
@@ -17,4 +86,4 @@ namespace framework
 
         return true;
     }
-}
\ No newline at end of file
+}
@@ -15,6 +15,18 @@ namespace framework
          * vec2: VK_FORMAT_R32G32_SFLOAT
          * vec3: VK_FORMAT_R32G32B32_SFLOAT
          * vec4: VK_FORMAT_R32G32B32A32_SFLOAT
+         *
+         * Compressed formats (every format is a multiple of 4 bytes so that vertices can still be stored as 32 bit words):
+         * half vec2: VK_FORMAT_R16G16_SFLOAT
+         * half vec4: VK_FORMAT_R16G16B16A16_SFLOAT
+         * snorm16 vec2: VK_FORMAT_R16G16_SNORM (also used for octahedral encoded normals/tangents)
+         * snorm16 vec4: VK_FORMAT_R16G16B16A16_SNORM
+         * unorm16 vec2: VK_FORMAT_R16G16_UNORM
+         * unorm16 vec4: VK_FORMAT_R16G16B16A16_UNORM
+         * unorm8 vec4: VK_FORMAT_R8G8B8A8_UNORM
+         * snorm8 vec4: VK_FORMAT_R8G8B8A8_SNORM
+         * unorm 10-10-10-2: VK_FORMAT_A2B10G10R10_UNORM_PACK32
+         * snorm 10-10-10-2: VK_FORMAT_A2B10G10R10_SNORM_PACK32
          */
         enum DrawableAttribute : uint32_t
         {
@@ -22,7 +34,17 @@ namespace framework
             F2 = VK_FORMAT_R32G32_SFLOAT,
             F3 = VK_FORMAT_R32G32B32_SFLOAT,
             F4 = VK_FORMAT_R32G32B32A32_SFLOAT,
-            I1 = VK_FORMAT_R32_UINT
+            I1 = VK_FORMAT_R32_UINT,
+            H2 = VK_FORMAT_R16G16_SFLOAT,
+            H4 = VK_FORMAT_R16G16B16A16_SFLOAT,
+            S16N2 = VK_FORMAT_R16G16_SNORM,
+            S16N4 = VK_FORMAT_R16G16B16A16_SNORM,
+            U16N2 = VK_FORMAT_R16G16_UNORM,
+            U16N4 = VK_FORMAT_R16G16B16A16_UNORM,
+            U8N4 = VK_FORMAT_R8G8B8A8_UNORM,
+            S8N4 = VK_FORMAT_R8G8B8A8_SNORM,
+            U1010102 = VK_FORMAT_A2B10G10R10_UNORM_PACK32,
+            S1010102 = VK_FORMAT_A2B10G10R10_SNORM_PACK32
         };
 
         VertexAttributes(const std::vector<DrawableAttribute> &vertex_attributes) : attributes(vertex_attributes) {}
@@ -31,10 +53,25 @@ namespace framework
 
         const std::vector<DrawableAttribute> &getVertexAttributes() { return attributes; }
 
+        /**
+         * @brief Returns the byte size of the sum of all the attributes (the vertex stride)
+         */
+        uint32_t getStride();
+
+        /**
+         * @brief Returns the size in bytes of the passed attribute format
+         */
+        static uint32_t getAttributeSize(DrawableAttribute attribute);
+
+        /**
+         * @brief Returns the number of components (shader side) of the passed attribute format
+         */
+        static uint32_t getAttributeComponents(DrawableAttribute attribute);
+
         bool operator==(const std::vector<DrawableAttribute> &other);
         bool operator==(const VertexAttributes &other) { return operator==(other.attributes); }
 
     private:
         std::vector<DrawableAttribute> attributes;
     };
-}
\ No newline at end of file
+}
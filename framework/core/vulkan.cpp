@@ -8,22 +8,25 @@
 
 namespace framework
 {
-    Vulkan::Vulkan(const char *application_name, const char *engine_name, const std::vector<const char *> &added_extensions, bool enable_layers)
+    Vulkan::Vulkan(const char *application_name, const char *engine_name, const std::vector<const char *> &added_extensions, bool enable_layers, bool headless)
     {
         if (application_name == nullptr || engine_name == nullptr)
         {
             throw std::runtime_error("[Vulkan] Nullptrs in application and engine names");
         }
 
-        const char **glfw_extensions;
+        const char **glfw_extensions = nullptr;
         uint32_t glfw_extension_count = 0;
 
-        // Gather the glfw info
-        glfw_extensions = glfwGetRequiredInstanceExtensions(&glfw_extension_count);
-
-        if (glfw_extensions == nullptr)
+        // Gather the glfw info, a headless instance does not present anything and needs no surface extension
+        if (!headless)
         {
-            throw std::runtime_error("[Vulkan] Impossible to enumerate instance extensions");
+            glfw_extensions = glfwGetRequiredInstanceExtensions(&glfw_extension_count);
+
+            if (glfw_extensions == nullptr)
+            {
+                throw std::runtime_error("[Vulkan] Impossible to enumerate instance extensions");
+            }
         }
 
         // Merge the extension names
@@ -49,7 +52,8 @@ namespace framework
         application_info.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
         application_info.pEngineName = engine_name;
         application_info.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-        application_info.apiVersion = VK_API_VERSION_1_0;
+        // 1.1 for vkGetPhysicalDeviceFeatures2, used to query the optional extension features
+        application_info.apiVersion = VK_API_VERSION_1_1;
 
         VkInstanceCreateInfo create_info{};
         create_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -18,8 +18,10 @@ namespace framework
          * @param application_name The name to communicate to the driver
          * @param engine_name The engine name to communicate to the driver
          * @param added_extensions Extensions to add to the engine
+         * @param headless Skips the GLFW surface extensions, so that the instance can be created without a window system
          */
-        Vulkan(const char *application_name, const char *engine_name, const std::vector<const char *> &added_extensions, bool enable_layers = false);
+        Vulkan(const char *application_name, const char *engine_name, const std::vector<const char *> &added_extensions, bool enable_layers = false,
+               bool headless = false);
         ~Vulkan();
 
         // Getters
@@ -21,8 +21,13 @@ namespace framework
         // Find the indices for appropriate queues if present
         QueueFamilyIndices indices = findQueueFamilies(surface);
 
-        // Create the set of queue indices
-        std::set<uint32_t> unique_queue_families = {indices.graphics_family.value(), indices.present_family.value()};
+        // Create the set of queue indices, a headless device has no present queue
+        std::set<uint32_t> unique_queue_families = {indices.graphics_family.value()};
+
+        if (surface != VK_NULL_HANDLE)
+        {
+            unique_queue_families.insert(indices.present_family.value());
+        }
 
         // Create the vector of queue create info structs
         std::vector<VkDeviceQueueCreateInfo> queue_create_infos;
@@ -48,8 +53,59 @@ namespace framework
         device_features.samplerAnisotropy = VK_TRUE;
         device_features.fillModeNonSolid = VK_TRUE; // Allows for wireframe
 
+        // Optional features
+        device_features.multiDrawIndirect = p_device->getFeatures().multiDrawIndirect;
+        device_features.drawIndirectFirstInstance = p_device->getFeatures().drawIndirectFirstInstance;
+        device_features.pipelineStatisticsQuery = p_device->getFeatures().pipelineStatisticsQuery;
+
+        // The synchronization2 and dynamic rendering features have to be enabled together with their extensions
+        VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2_features{};
+        synchronization2_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+
+        VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamic_rendering_features{};
+        dynamic_rendering_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+
+        if (p_device->getProperties().apiVersion >= VK_API_VERSION_1_1)
+        {
+            VkPhysicalDeviceFeatures2 features{};
+            features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+
+            if (p_device->isExtensionEnabled(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME))
+            {
+                synchronization2_features.pNext = features.pNext;
+                features.pNext = &synchronization2_features;
+            }
+
+            if (p_device->isExtensionEnabled(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME))
+            {
+                dynamic_rendering_features.pNext = features.pNext;
+                features.pNext = &dynamic_rendering_features;
+            }
+
+            if (features.pNext != nullptr)
+            {
+                vkGetPhysicalDeviceFeatures2(p_device->getDevice(), &features);
+            }
+        }
+
+        // Chain of the supported features only
+        void *enabled_features_chain = nullptr;
+
+        if (synchronization2_features.synchronization2)
+        {
+            synchronization2_features.pNext = enabled_features_chain;
+            enabled_features_chain = &synchronization2_features;
+        }
+
+        if (dynamic_rendering_features.dynamicRendering)
+        {
+            dynamic_rendering_features.pNext = enabled_features_chain;
+            enabled_features_chain = &dynamic_rendering_features;
+        }
+
         VkDeviceCreateInfo create_info{};
         create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        create_info.pNext = enabled_features_chain;
         create_info.queueCreateInfoCount = static_cast<uint32_t>(queue_create_infos.size());
         create_info.pQueueCreateInfos = queue_create_infos.data();
         create_info.pEnabledFeatures = &device_features;
@@ -63,18 +119,61 @@ namespace framework
             throw std::runtime_error("[LogicalDevice] Failed to create a logical device");
         }
 
+        enabled_features = device_features;
+
+        // Load the optional extensions entry points
+        if (p_device->isExtensionEnabled(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME))
+        {
+            draw_indexed_indirect_count = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(vkGetDeviceProcAddr(device, "vkCmdDrawIndexedIndirectCountKHR"));
+        }
+
+        if (synchronization2_features.synchronization2)
+        {
+            pipeline_barrier2 = reinterpret_cast<PFN_vkCmdPipelineBarrier2KHR>(vkGetDeviceProcAddr(device, "vkCmdPipelineBarrier2KHR"));
+        }
+
+        if (dynamic_rendering_features.dynamicRendering)
+        {
+            begin_rendering = reinterpret_cast<PFN_vkCmdBeginRenderingKHR>(vkGetDeviceProcAddr(device, "vkCmdBeginRenderingKHR"));
+            end_rendering = reinterpret_cast<PFN_vkCmdEndRenderingKHR>(vkGetDeviceProcAddr(device, "vkCmdEndRenderingKHR"));
+        }
+
         // Retrieve the created queue
         vkGetDeviceQueue(device, indices.graphics_family.value(), 0, &graphics_queue);
-        vkGetDeviceQueue(device, indices.present_family.value(), 0, &present_queue);
+
+        if (indices.present_family.has_value())
+        {
+            vkGetDeviceQueue(device, indices.present_family.value(), 0, &present_queue);
+        }
     }
 
-    QueueFamilyIndices LogicalDevice::findQueueFamilies(const VkSurfaceKHR &surface)
+    LogicalDevice::~LogicalDevice()
     {
-        if (surface == VK_NULL_HANDLE)
+        // The deferred objects must be destroyed before the device
+        vkDeviceWaitIdle(device);
+        deletion_queue.flushAll();
+
+        vkDestroyDevice(device, nullptr);
+    }
+
+    void LogicalDevice::destroyDeferred(std::function<void(VkDevice)> deleter, uint64_t frames_after)
+    {
+        uint64_t frame = submitted_frames.load();
+        resource_generation++;
+
+        // Nothing can be in flight before the first frame
+        if (frame == 0 && frames_after == 0)
         {
-            throw std::runtime_error("[LogicalDevice] Surface null handle");
+            deleter(device);
+            return;
         }
 
+        deletion_queue.push(frame + frames_after, [this, deleter = std::move(deleter)]
+                            { deleter(device); });
+    }
+
+    QueueFamilyIndices LogicalDevice::findQueueFamilies(const VkSurfaceKHR &surface)
+    {
         QueueFamilyIndices result;
         uint32_t count = 0;
 
@@ -94,7 +193,12 @@ namespace framework
                 result.graphics_family = i;
             }
 
-            // Check window surface compatibility
+            // Check window surface compatibility, without a surface (headless) only the graphics family is looked for
+            if (surface == VK_NULL_HANDLE)
+            {
+                continue;
+            }
+
             VkBool32 present_support = false;
             vkGetPhysicalDeviceSurfaceSupportKHR(p_device->getDevice(), i, surface, &present_support);
 
@@ -3,8 +3,11 @@
 #include <vulkan/vulkan.h>
 #include <devices/physicalDevice.h>
 #include <window/windowSurface.h>
+#include <core/deletionQueue.h>
 #include <optional>
 #include <memory>
+#include <atomic>
+#include <functional>
 
 namespace framework
 {
@@ -18,10 +21,11 @@ namespace framework
     {
     public:
         LogicalDevice(std::unique_ptr<PhysicalDevice> p, const VkSurfaceKHR &surface);
-        ~LogicalDevice() { vkDestroyDevice(device, nullptr); }
+        ~LogicalDevice();
 
         /**
-         * @brief Finds all the queues for the selected physical device and surface
+         * @brief Finds all the queues for the selected physical device and surface. With a VK_NULL_HANDLE surface
+         * (headless device) the present family is left empty
          *
          * TODO: make this method static
          *
@@ -34,17 +38,63 @@ namespace framework
          */
         inline void waitIdle() { vkDeviceWaitIdle(device); }
 
+        /**
+         * @brief Destroys the objects of the deleter once the GPU has completed the frames submitted so far (plus frames_after
+         * more), so that objects can be dropped at runtime without waiting for the device. The deleter runs immediately if no
+         * frame has been submitted yet, and at the latest when the device is destroyed. Callable by any thread
+         */
+        void destroyDeferred(std::function<void(VkDevice)> deleter, uint64_t frames_after = 0);
+
+        /**
+         * @brief Marks the submission of a frame, the tag of the following deferred destructions
+         * @return the number of the submitted frame (starting from 1)
+         */
+        inline uint64_t advanceFrame() { return ++submitted_frames; }
+
+        /**
+         * @brief Executes the deferred destructions of the frames up to the completed one. The value of a timeline semaphore
+         * signaled with the frame numbers can be passed as well
+         */
+        inline void completeFrames(uint64_t completed_frame) { deletion_queue.flush(completed_frame); }
+
         // Getters
         inline const VkDevice &getDevice() { return device; }
         inline const VkQueue &getGraphicsQueue() { return graphics_queue; }
+        // VK_NULL_HANDLE for a headless device
         inline const VkQueue &getPresentQueue() { return present_queue; }
         inline const std::unique_ptr<PhysicalDevice> &getPhysicalDevice() { return p_device; }
+        inline const VkPhysicalDeviceFeatures &getEnabledFeatures() { return enabled_features; }
+        inline uint64_t getSubmittedFrames() { return submitted_frames.load(); }
+        // Incremented by every destroyDeferred call: handles seen before a change may be recycled by the objects created after it
+        inline uint64_t getResourceGeneration() { return resource_generation.load(); }
+        // Extension entry point, nullptr if VK_KHR_draw_indirect_count is not supported
+        inline PFN_vkCmdDrawIndexedIndirectCountKHR getDrawIndexedIndirectCount() { return draw_indexed_indirect_count; }
+        // Extension entry point, nullptr if VK_KHR_synchronization2 is not supported
+        inline PFN_vkCmdPipelineBarrier2KHR getPipelineBarrier2() { return pipeline_barrier2; }
+        // Extension entry points, nullptr if VK_KHR_dynamic_rendering is not supported
+        inline PFN_vkCmdBeginRenderingKHR getBeginRendering() { return begin_rendering; }
+        inline PFN_vkCmdEndRenderingKHR getEndRendering() { return end_rendering; }
+        inline bool isDynamicRenderingEnabled() { return begin_rendering != nullptr; }
 
     private:
         std::unique_ptr<PhysicalDevice> p_device;
 
+        // Features the device has been created with (optional ones depend on the physical device)
+        VkPhysicalDeviceFeatures enabled_features{};
+
+        // Optional extensions function pointers
+        PFN_vkCmdDrawIndexedIndirectCountKHR draw_indexed_indirect_count = nullptr;
+        PFN_vkCmdPipelineBarrier2KHR pipeline_barrier2 = nullptr;
+        PFN_vkCmdBeginRenderingKHR begin_rendering = nullptr;
+        PFN_vkCmdEndRenderingKHR end_rendering = nullptr;
+
         VkDevice device = VK_NULL_HANDLE;
         VkQueue graphics_queue = VK_NULL_HANDLE;
         VkQueue present_queue = VK_NULL_HANDLE;
+
+        // Deferred destructions tagged with the frame number
+        DeletionQueue deletion_queue;
+        std::atomic<uint64_t> submitted_frames = 0;
+        std::atomic<uint64_t> resource_generation = 0;
     };
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <stdexcept>
 #include <vector>
 #include <set>
+#include <cstring>
 
 namespace framework
 {
@@ -12,11 +13,6 @@ namespace framework
             throw std::runtime_error("[PhysicalDevice] Null vulkan instance");
         }
 
-        if (surface == VK_NULL_HANDLE)
-        {
-            throw std::runtime_error("[PhysicalDevice] Null surface instance");
-        }
-
         uint32_t devices_number = getDevicesNumber();
 
         // Check parameter validity
@@ -25,8 +21,25 @@ namespace framework
             throw std::runtime_error("[PhysicalDevice] Index > #devices");
         }
 
-        // Init the extension list
-        device_extensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+        // Init the extension list, a headless device (null surface) renders offscreen and needs no swap chain
+        if (!isHeadless())
+        {
+            device_extensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+        }
+
+        // GPU driven draw count (core in Vulkan 1.2)
+        optional_extensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+
+        // Stage and access masks per barrier, used by the render graph (core in Vulkan 1.3)
+        optional_extensions.push_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+
+        // Rendering without render pass and frame buffer objects, with its dependencies (core in Vulkan 1.3)
+        optional_extensions.push_back(VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME);
+        optional_extensions.push_back(VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME);
+        optional_extensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+
+        // Heap usage and budget reported by the driver, shown by the statistics overlay
+        optional_extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
 
         // Vector in which insert the devices enumeration
         std::vector<VkPhysicalDevice> devices(devices_number);
@@ -43,6 +56,49 @@ namespace framework
         {
             throw std::runtime_error("[PhysicalDevice] Device not suited");
         }
+
+        // Optional features are enabled by the logical device only if present
+        vkGetPhysicalDeviceFeatures(p_device, &features);
+        vkGetPhysicalDeviceProperties(p_device, &properties);
+
+        addOptionalExtensions();
+    }
+
+    bool PhysicalDevice::isExtensionEnabled(const char *extension)
+    {
+        for (const char *enabled : device_extensions)
+        {
+            if (strcmp(enabled, extension) == 0)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void PhysicalDevice::addOptionalExtensions()
+    {
+        uint32_t extension_count;
+
+        // Get the number of extensions
+        vkEnumerateDeviceExtensionProperties(p_device, nullptr, &extension_count, nullptr);
+
+        // Enumerate the extensions
+        std::vector<VkExtensionProperties> available_extensions(extension_count);
+        vkEnumerateDeviceExtensionProperties(p_device, nullptr, &extension_count, available_extensions.data());
+
+        for (const char *extension : optional_extensions)
+        {
+            for (const VkExtensionProperties &available : available_extensions)
+            {
+                if (strcmp(available.extensionName, extension) == 0)
+                {
+                    device_extensions.push_back(extension);
+                    break;
+                }
+            }
+        }
     }
 
     uint32_t PhysicalDevice::getDevicesNumber()
@@ -71,9 +127,11 @@ namespace framework
         vkGetPhysicalDeviceProperties(device, &prop);
         vkGetPhysicalDeviceFeatures(device, &feat);
 
-        // Check device
-        bool device_physical = (prop.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU || prop.deviceType == VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU);
-        return device_physical && feat.geometryShader && feat.samplerAnisotropy && checkDeviceExtensionSupport(device) && checkSwapChainAdequate(device);
+        // Check device (CPU devices are software implementations, e.g. lavapipe, useful to validate the framework without a GPU)
+        bool device_physical = (prop.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU || prop.deviceType == VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU ||
+                                prop.deviceType == VK_PHYSICAL_DEVICE_TYPE_CPU);
+        return device_physical && feat.geometryShader && feat.samplerAnisotropy && checkDeviceExtensionSupport(device) &&
+               (isHeadless() || checkSwapChainAdequate(device));
     }
 
     bool PhysicalDevice::checkDeviceExtensionSupport(VkPhysicalDevice device)
@@ -112,6 +170,11 @@ namespace framework
             throw std::runtime_error("[PhysicalDevice] Null physical device instance");
         }
 
+        if (isHeadless())
+        {
+            throw std::runtime_error("[PhysicalDevice] Swap chain support queried on a headless device");
+        }
+
         SwapChainSupportDetails details;
 
         // Query the capabilities of the physical device
@@ -18,7 +18,8 @@ namespace framework
          * @brief Construct a new Physical Device object
          *
          * @param instance Vulkan instance
-         * @param surface The window surface that the device has to support
+         * @param surface The window surface that the device has to support, VK_NULL_HANDLE for a headless device
+         * that only renders offscreen (no swap chain extension nor presentation support required)
          * @param index Index of device to choose
          */
         PhysicalDevice(VkInstance instance, VkSurfaceKHR surface, uint32_t index);
@@ -26,7 +27,11 @@ namespace framework
         // Getters
         inline const VkPhysicalDevice &getDevice() { return p_device; }
         const std::vector<const char *> &getDeviceExtensions() { return device_extensions; }
+        bool isExtensionEnabled(const char *extension);
         SwapChainSupportDetails getSwapChainSupportDetails() { return querySwapChainSupport(p_device); }
+        inline const VkPhysicalDeviceFeatures &getFeatures() { return features; }
+        inline const VkPhysicalDeviceProperties &getProperties() { return properties; }
+        inline bool isHeadless() { return surface == VK_NULL_HANDLE; }
 
     private:
         /**
@@ -46,6 +51,11 @@ namespace framework
          */
         bool checkDeviceExtensionSupport(VkPhysicalDevice device);
 
+        /**
+         * @brief Adds to the device extensions the optional ones supported by the selected device
+         */
+        void addOptionalExtensions();
+
         /**
          * @brief Queries the swap chain support details that the physical device has
          */
@@ -64,7 +74,14 @@ namespace framework
         // Vector of needed supported extensions for the physical device
         std::vector<const char *> device_extensions;
 
+        // Extensions enabled only if supported, the framework checks them with isExtensionEnabled
+        std::vector<const char *> optional_extensions;
+
         // List of details that the physical device supports
         SwapChainSupportDetails swap_chain_support;
+
+        // Features and properties of the selected device
+        VkPhysicalDeviceFeatures features{};
+        VkPhysicalDeviceProperties properties{};
     };
 }
\ No newline at end of file
@@ -50,6 +50,8 @@ namespace framework
         // Getters
         inline glm::mat4 getLookAtMatrix() { return camera.getLookAtMatrix(); }
         inline glm::mat4 getPerspectiveMatrix(uint32_t width, uint32_t height) { return camera.getPerspectiveMatrix(width, height); }
+        inline Frustum getFrustum(uint32_t width, uint32_t height) { return camera.getFrustum(width, height); }
+        inline Ray getPickingRay(float x, float y, uint32_t width, uint32_t height) { return camera.getPickingRay(x, y, width, height); }
         inline glm::vec3 getPosition() { return camera.getPosition(); }
         inline glm::vec3 getDirection() { return camera.getDirection(); }
 
@@ -0,0 +1,509 @@
+#include "bvh.h"
+
+#include <utils/jobSystem.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace framework
+{
+    void Bvh::build(const BoundingBoxes &boxes)
+    {
+        positions.clear();
+        indices.clear();
+
+        primitive_bounds.resize(boxes.size());
+        centroids.resize(boxes.size());
+
+        for (size_t i = 0; i < boxes.size(); i++)
+        {
+            primitive_bounds[i].min = glm::vec3(boxes.min_x[i], boxes.min_y[i], boxes.min_z[i]);
+            primitive_bounds[i].max = glm::vec3(boxes.max_x[i], boxes.max_y[i], boxes.max_z[i]);
+            centroids[i] = (primitive_bounds[i].min + primitive_bounds[i].max) * 0.5f;
+        }
+
+        buildFromPrimitives();
+    }
+
+    void Bvh::build(const std::vector<glm::vec3> &positions, const std::vector<uint32_t> &indices)
+    {
+        if (indices.size() % 3 != 0)
+        {
+            throw std::runtime_error("[Bvh] The number of indices is not a multiple of 3");
+        }
+
+        for (uint32_t index : indices)
+        {
+            if (index >= positions.size())
+            {
+                throw std::runtime_error("[Bvh] Index out of the vertices range");
+            }
+        }
+
+        this->positions = positions;
+        this->indices = indices;
+
+        computeTriangleBounds();
+        buildFromPrimitives();
+    }
+
+    void Bvh::refit(const BoundingBoxes &boxes)
+    {
+        if (boxes.size() != primitive_bounds.size() || !indices.empty())
+        {
+            throw std::runtime_error("[Bvh] The boxes differ from the built ones");
+        }
+
+        for (size_t i = 0; i < boxes.size(); i++)
+        {
+            primitive_bounds[i].min = glm::vec3(boxes.min_x[i], boxes.min_y[i], boxes.min_z[i]);
+            primitive_bounds[i].max = glm::vec3(boxes.max_x[i], boxes.max_y[i], boxes.max_z[i]);
+        }
+
+        refitNodes();
+    }
+
+    void Bvh::refit(const std::vector<glm::vec3> &positions)
+    {
+        if (positions.size() != this->positions.size() || indices.empty())
+        {
+            throw std::runtime_error("[Bvh] The vertices differ from the built ones");
+        }
+
+        this->positions = positions;
+
+        computeTriangleBounds();
+        refitNodes();
+    }
+
+    void Bvh::computeTriangleBounds()
+    {
+        uint32_t triangles = indices.size() / 3;
+
+        primitive_bounds.resize(triangles);
+        centroids.resize(triangles);
+
+        JobSystem::getInstance().parallelFor(triangles, PARALLEL_BINNING_THRESHOLD, [this](size_t begin, size_t end)
+                                              {
+            for (size_t t = begin; t < end; t++)
+            {
+                Bounds bounds;
+                bounds.grow(positions[indices[t * 3]]);
+                bounds.grow(positions[indices[t * 3 + 1]]);
+                bounds.grow(positions[indices[t * 3 + 2]]);
+
+                primitive_bounds[t] = bounds;
+                centroids[t] = (bounds.min + bounds.max) * 0.5f;
+            } });
+    }
+
+    void Bvh::buildFromPrimitives()
+    {
+        uint32_t count = primitive_bounds.size();
+
+        nodes.clear();
+        primitive_indices.resize(count);
+
+        if (count == 0)
+        {
+            return;
+        }
+
+        // A binary tree with at least one primitive per leaf has at most 2n - 1 nodes
+        nodes.reserve(2 * count - 1);
+
+        Bounds bounds, centroid_bounds;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            primitive_indices[i] = i;
+            bounds.grow(primitive_bounds[i]);
+            centroid_bounds.grow(centroids[i]);
+        }
+
+        buildNode(0, count, bounds, centroid_bounds);
+    }
+
+    void Bvh::binPrimitives(uint32_t begin, uint32_t end, int axis, const Bounds &centroid_bounds, Bin *bins) const
+    {
+        float axis_min = centroid_bounds.min[axis];
+        float scale = BINS / (centroid_bounds.max[axis] - axis_min);
+
+        for (uint32_t i = begin; i < end; i++)
+        {
+            uint32_t primitive = primitive_indices[i];
+            uint32_t bin = std::min(static_cast<uint32_t>((centroids[primitive][axis] - axis_min) * scale), BINS - 1);
+
+            bins[bin].bounds.grow(primitive_bounds[primitive]);
+            bins[bin].centroid_bounds.grow(centroids[primitive]);
+            bins[bin].count++;
+        }
+    }
+
+    void Bvh::buildNode(uint32_t begin, uint32_t end, const Bounds &bounds, const Bounds &centroid_bounds)
+    {
+        uint32_t node_index = nodes.size();
+        uint32_t count = end - begin;
+
+        Node node{};
+        for (int axis = 0; axis < 3; axis++)
+        {
+            node.min[axis] = bounds.min[axis];
+            node.max[axis] = bounds.max[axis];
+        }
+        node.first_primitive = begin;
+        node.primitive_count = count;
+        nodes.push_back(node);
+
+        // Best split among the bin boundaries of the 3 axes
+        float best_cost = INTERSECTION_COST * count;
+        int best_axis = -1;
+        uint32_t best_split = 0;
+        Bin best_bins[BINS];
+
+        for (int axis = 0; axis < 3 && count > 2; axis++)
+        {
+            // Every centroid in the same position, no split along this axis
+            if (centroid_bounds.max[axis] <= centroid_bounds.min[axis])
+            {
+                continue;
+            }
+
+            Bin bins[BINS];
+
+            if (count >= PARALLEL_BINNING_THRESHOLD)
+            {
+                // Every chunk fills its own bins, merged afterwards
+                uint32_t grain = PARALLEL_BINNING_THRESHOLD / 4;
+                std::vector<std::array<Bin, BINS>> chunk_bins((count + grain - 1) / grain);
+
+                JobSystem::getInstance().parallelFor(count, grain, [&](size_t chunk_begin, size_t chunk_end)
+                                                      { binPrimitives(begin + chunk_begin, begin + chunk_end, axis, centroid_bounds, chunk_bins[chunk_begin / grain].data()); });
+
+                for (const auto &chunk : chunk_bins)
+                {
+                    for (uint32_t b = 0; b < BINS; b++)
+                    {
+                        bins[b].bounds.grow(chunk[b].bounds);
+                        bins[b].centroid_bounds.grow(chunk[b].centroid_bounds);
+                        bins[b].count += chunk[b].count;
+                    }
+                }
+            }
+            else
+            {
+                binPrimitives(begin, end, axis, centroid_bounds, bins);
+            }
+
+            // Sweep from the right to get the cost of every right side
+            float right_areas[BINS];
+            uint32_t right_counts[BINS];
+            Bounds right_bounds;
+            uint32_t right_count = 0;
+
+            for (uint32_t b = BINS - 1; b > 0; b--)
+            {
+                right_bounds.grow(bins[b].bounds);
+                right_count += bins[b].count;
+                right_areas[b] = right_bounds.area();
+                right_counts[b] = right_count;
+            }
+
+            Bounds left_bounds;
+            uint32_t left_count = 0;
+            float inverse_area = 1.0f / std::max(bounds.area(), FLT_MIN);
+
+            // Split between bin b - 1 and bin b
+            for (uint32_t b = 1; b < BINS; b++)
+            {
+                left_bounds.grow(bins[b - 1].bounds);
+                left_count += bins[b - 1].count;
+
+                if (left_count == 0 || right_counts[b] == 0)
+                {
+                    continue;
+                }
+
+                float cost = TRAVERSAL_COST + INTERSECTION_COST * (left_bounds.area() * left_count + right_areas[b] * right_counts[b]) * inverse_area;
+
+                if (cost < best_cost)
+                {
+                    best_cost = cost;
+                    best_axis = axis;
+                    best_split = b;
+                    std::copy(bins, bins + BINS, best_bins);
+                }
+            }
+        }
+
+        if (best_axis < 0)
+        {
+            // Creating a leaf is cheaper, unless it is too large (e.g. coincident centroids)
+            if (count <= MAX_LEAF_PRIMITIVES)
+            {
+                nodes[node_index].escape = nodes.size();
+                return;
+            }
+
+            // Median split by index, the children bounds are computed directly
+            uint32_t middle = begin + count / 2;
+            Bounds child_bounds[2], child_centroids[2];
+
+            for (uint32_t i = begin; i < end; i++)
+            {
+                uint32_t side = i < middle ? 0 : 1;
+                child_bounds[side].grow(primitive_bounds[primitive_indices[i]]);
+                child_centroids[side].grow(centroids[primitive_indices[i]]);
+            }
+
+            nodes[node_index].primitive_count = 0;
+            buildNode(begin, middle, child_bounds[0], child_centroids[0]);
+            buildNode(middle, end, child_bounds[1], child_centroids[1]);
+            nodes[node_index].escape = nodes.size();
+            return;
+        }
+
+        // Partition the primitives with the same binning used for the cost
+        float axis_min = centroid_bounds.min[best_axis];
+        float scale = BINS / (centroid_bounds.max[best_axis] - axis_min);
+
+        uint32_t *middle = std::partition(&primitive_indices[begin], &primitive_indices[0] + end, [&](uint32_t primitive)
+                                          { return std::min(static_cast<uint32_t>((centroids[primitive][best_axis] - axis_min) * scale), BINS - 1) < best_split; });
+
+        Bin left, right;
+        for (uint32_t b = 0; b < BINS; b++)
+        {
+            Bin &side = b < best_split ? left : right;
+            side.bounds.grow(best_bins[b].bounds);
+            side.centroid_bounds.grow(best_bins[b].centroid_bounds);
+        }
+
+        uint32_t split = middle - &primitive_indices[0];
+
+        // Inner node, the left child follows it and the right one follows the left subtree
+        nodes[node_index].primitive_count = 0;
+        buildNode(begin, split, left.bounds, left.centroid_bounds);
+        buildNode(split, end, right.bounds, right.centroid_bounds);
+        nodes[node_index].escape = nodes.size();
+    }
+
+    void Bvh::refitNodes()
+    {
+        // Children always follow their parent, a reverse pass visits them first
+        for (size_t i = nodes.size(); i-- > 0;)
+        {
+            Node &node = nodes[i];
+            Bounds bounds;
+
+            if (node.primitive_count > 0)
+            {
+                for (uint32_t p = node.first_primitive; p < node.first_primitive + node.primitive_count; p++)
+                {
+                    bounds.grow(primitive_bounds[primitive_indices[p]]);
+                }
+            }
+            else
+            {
+                const Node &left = nodes[i + 1];
+                const Node &right = nodes[left.escape];
+
+                bounds.min = glm::min(glm::vec3(left.min[0], left.min[1], left.min[2]), glm::vec3(right.min[0], right.min[1], right.min[2]));
+                bounds.max = glm::max(glm::vec3(left.max[0], left.max[1], left.max[2]), glm::vec3(right.max[0], right.max[1], right.max[2]));
+            }
+
+            for (int axis = 0; axis < 3; axis++)
+            {
+                node.min[axis] = bounds.min[axis];
+                node.max[axis] = bounds.max[axis];
+            }
+        }
+    }
+
+    bool Bvh::intersectBox(const float min[3], const float max[3], const glm::vec3 &origin, const glm::vec3 &inverse_direction, float t_min, float t_max, float &t_entry)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            float t0 = (min[axis] - origin[axis]) * inverse_direction[axis];
+            float t1 = (max[axis] - origin[axis]) * inverse_direction[axis];
+
+            // NaNs (0 * inf) are discarded by min/max ordering
+            t_min = std::max(t_min, std::min(t0, t1));
+            t_max = std::min(t_max, std::max(t0, t1));
+        }
+
+        t_entry = t_min;
+        return t_min <= t_max;
+    }
+
+    bool Bvh::intersectRay(const Ray &ray, RayHit &hit) const
+    {
+        hit = RayHit{};
+
+        glm::vec3 inverse_direction = 1.0f / ray.direction;
+        float t_max = ray.t_max;
+        uint32_t node_count = nodes.size();
+        uint32_t i = 0;
+
+        while (i < node_count)
+        {
+            const Node &node = nodes[i];
+            float t_entry;
+
+            if (!intersectBox(node.min, node.max, ray.origin, inverse_direction, ray.t_min, t_max, t_entry))
+            {
+                i = node.escape;
+                continue;
+            }
+
+            if (node.primitive_count == 0)
+            {
+                i++;
+                continue;
+            }
+
+            for (uint32_t p = node.first_primitive; p < node.first_primitive + node.primitive_count; p++)
+            {
+                uint32_t primitive = primitive_indices[p];
+
+                if (indices.empty())
+                {
+                    const Bounds &box = primitive_bounds[primitive];
+                    float box_min[3] = {box.min.x, box.min.y, box.min.z};
+                    float box_max[3] = {box.max.x, box.max.y, box.max.z};
+
+                    if (intersectBox(box_min, box_max, ray.origin, inverse_direction, ray.t_min, t_max, t_entry))
+                    {
+                        t_max = t_entry;
+                        hit.primitive = primitive;
+                        hit.distance = t_entry;
+                        hit.barycentrics = glm::vec2(0.0f);
+                    }
+
+                    continue;
+                }
+
+                // Moller-Trumbore, both faces are hit
+                const glm::vec3 &v0 = positions[indices[primitive * 3]];
+                glm::vec3 edge1 = positions[indices[primitive * 3 + 1]] - v0;
+                glm::vec3 edge2 = positions[indices[primitive * 3 + 2]] - v0;
+
+                glm::vec3 p_vector = glm::cross(ray.direction, edge2);
+                float determinant = glm::dot(edge1, p_vector);
+
+                if (std::abs(determinant) < 1e-12f)
+                {
+                    continue;
+                }
+
+                float inverse_determinant = 1.0f / determinant;
+                glm::vec3 t_vector = ray.origin - v0;
+                float u = glm::dot(t_vector, p_vector) * inverse_determinant;
+
+                if (u < 0.0f || u > 1.0f)
+                {
+                    continue;
+                }
+
+                glm::vec3 q_vector = glm::cross(t_vector, edge1);
+                float v = glm::dot(ray.direction, q_vector) * inverse_determinant;
+
+                if (v < 0.0f || u + v > 1.0f)
+                {
+                    continue;
+                }
+
+                float t = glm::dot(edge2, q_vector) * inverse_determinant;
+
+                if (t >= ray.t_min && t <= t_max)
+                {
+                    t_max = t;
+                    hit.primitive = primitive;
+                    hit.distance = t;
+                    hit.barycentrics = glm::vec2(u, v);
+                }
+            }
+
+            i = node.escape;
+        }
+
+        return hit.primitive != INVALID_PRIMITIVE;
+    }
+
+    void Bvh::querySphere(const glm::vec3 &center, float radius, std::vector<uint32_t> &result) const
+    {
+        float squared_radius = radius * radius;
+
+        auto intersects = [&](const glm::vec3 &min, const glm::vec3 &max)
+        {
+            glm::vec3 closest = glm::clamp(center, min, max);
+            glm::vec3 difference = closest - center;
+            return glm::dot(difference, difference) <= squared_radius;
+        };
+
+        uint32_t node_count = nodes.size();
+        uint32_t i = 0;
+
+        while (i < node_count)
+        {
+            const Node &node = nodes[i];
+
+            if (!intersects(glm::vec3(node.min[0], node.min[1], node.min[2]), glm::vec3(node.max[0], node.max[1], node.max[2])))
+            {
+                i = node.escape;
+                continue;
+            }
+
+            if (node.primitive_count == 0)
+            {
+                i++;
+                continue;
+            }
+
+            for (uint32_t p = node.first_primitive; p < node.first_primitive + node.primitive_count; p++)
+            {
+                const Bounds &bounds = primitive_bounds[primitive_indices[p]];
+
+                if (intersects(bounds.min, bounds.max))
+                {
+                    result.push_back(primitive_indices[p]);
+                }
+            }
+
+            i = node.escape;
+        }
+    }
+
+    void Bvh::queryFrustum(const Frustum &frustum, std::vector<uint32_t> &result) const
+    {
+        uint32_t node_count = nodes.size();
+        uint32_t i = 0;
+
+        while (i < node_count)
+        {
+            const Node &node = nodes[i];
+
+            if (!frustum.intersectsBox(glm::vec3(node.min[0], node.min[1], node.min[2]), glm::vec3(node.max[0], node.max[1], node.max[2])))
+            {
+                i = node.escape;
+                continue;
+            }
+
+            if (node.primitive_count == 0)
+            {
+                i++;
+                continue;
+            }
+
+            for (uint32_t p = node.first_primitive; p < node.first_primitive + node.primitive_count; p++)
+            {
+                const Bounds &bounds = primitive_bounds[primitive_indices[p]];
+
+                if (frustum.intersectsBox(bounds.min, bounds.max))
+                {
+                    result.push_back(primitive_indices[p]);
+                }
+            }
+
+            i = node.escape;
+        }
+    }
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <core/boundingBoxes.h>
+#include <utils/frustum.h>
+#include <utils/ray.h>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cfloat>
+#include <stdint.h>
+
+namespace framework
+{
+    struct RayHit
+    {
+        // Index of the hit primitive (box or triangle), INVALID_PRIMITIVE if nothing is hit
+        uint32_t primitive = UINT32_MAX;
+        float distance = 0.0f;
+        // Barycentric coordinates of the hit point relative to the 2nd and 3rd triangle vertices (zero for boxes)
+        glm::vec2 barycentrics{0.0f};
+    };
+
+    /**
+     * @brief Bounding volume hierarchy built with the binned surface area heuristic over boxes (e.g. the elements of a
+     * DrawableCollection) or triangles. Nodes are stored in depth first order with an escape index (the node following
+     * their subtree), so that all the queries are stackless and refitting is a single reverse pass.
+     * Large nodes are binned in parallel on the job system.
+     */
+    class Bvh
+    {
+    public:
+        static constexpr uint32_t INVALID_PRIMITIVE = UINT32_MAX;
+
+        struct Node
+        {
+            float min[3];
+            // Node visited after this subtree (equal to the number of nodes for the last one)
+            uint32_t escape;
+            float max[3];
+            // Leaves reference primitive_count entries of the primitive indices, inner nodes have zero primitives
+            uint32_t first_primitive;
+            uint32_t primitive_count;
+        };
+
+        /**
+         * @brief Builds the hierarchy over boxes, primitive i is the i-th box
+         */
+        void build(const BoundingBoxes &boxes);
+
+        /**
+         * @brief Builds the hierarchy over the triangles of an indexed mesh, primitive i is made of indices [3i, 3i + 3).
+         * The mesh is copied to answer the exact ray queries
+         * @throws Runtime Exception if the indices are not a multiple of 3 or reference missing vertices
+         */
+        void build(const std::vector<glm::vec3> &positions, const std::vector<uint32_t> &indices);
+
+        /**
+         * @brief Recomputes the node bounds after the primitives moved, keeping the topology (animated elements).
+         * Quality decreases with the motion, rebuild when the deformation is large
+         * @throws Runtime Exception if the number of primitives changed
+         */
+        void refit(const BoundingBoxes &boxes);
+        void refit(const std::vector<glm::vec3> &positions);
+
+        /**
+         * @brief Finds the closest primitive hit by the ray
+         * @return true if a primitive is hit, the hit is filled accordingly
+         */
+        bool intersectRay(const Ray &ray, RayHit &hit) const;
+
+        /**
+         * @brief Appends to result the primitives whose bounds intersect the sphere
+         */
+        void querySphere(const glm::vec3 &center, float radius, std::vector<uint32_t> &result) const;
+
+        /**
+         * @brief Appends to result the primitives whose bounds intersect the frustum
+         */
+        void queryFrustum(const Frustum &frustum, std::vector<uint32_t> &result) const;
+
+        // Getters
+        inline const std::vector<Node> &getNodes() const { return nodes; }
+        inline const std::vector<uint32_t> &getPrimitiveIndices() const { return primitive_indices; }
+        inline uint32_t getPrimitivesNumber() const { return primitive_indices.size(); }
+
+    private:
+        static constexpr uint32_t BINS = 16;
+        static constexpr uint32_t MAX_LEAF_PRIMITIVES = 8;
+        // Nodes with more primitives are binned across the job system
+        static constexpr uint32_t PARALLEL_BINNING_THRESHOLD = 16384;
+        // SAH costs of a node traversal and a primitive intersection
+        static constexpr float TRAVERSAL_COST = 1.0f;
+        static constexpr float INTERSECTION_COST = 1.0f;
+
+        struct Bounds
+        {
+            glm::vec3 min{FLT_MAX};
+            glm::vec3 max{-FLT_MAX};
+
+            inline void grow(const glm::vec3 &point)
+            {
+                min = glm::min(min, point);
+                max = glm::max(max, point);
+            }
+
+            inline void grow(const Bounds &other)
+            {
+                min = glm::min(min, other.min);
+                max = glm::max(max, other.max);
+            }
+
+            inline float area() const
+            {
+                glm::vec3 extent = glm::max(max - min, glm::vec3(0.0f));
+                return 2.0f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+            }
+        };
+
+        struct Bin
+        {
+            Bounds bounds;
+            Bounds centroid_bounds;
+            uint32_t count = 0;
+        };
+
+        /**
+         * @brief Builds the hierarchy from the primitive bounds and centroids
+         */
+        void buildFromPrimitives();
+
+        /**
+         * @brief Recursively creates the node of the primitive range [begin, end) and its subtree
+         */
+        void buildNode(uint32_t begin, uint32_t end, const Bounds &bounds, const Bounds &centroid_bounds);
+
+        /**
+         * @brief Bins the primitive range on the passed axis
+         */
+        void binPrimitives(uint32_t begin, uint32_t end, int axis, const Bounds &centroid_bounds, Bin *bins) const;
+
+        /**
+         * @brief Recomputes the nodes bounds from the primitive ones
+         */
+        void refitNodes();
+
+        /**
+         * @brief Computes the bounds and the centroid of every triangle
+         */
+        void computeTriangleBounds();
+
+        // Slab test, true if the box is hit inside [t_min, t_max] with the entry distance inside t_entry
+        static bool intersectBox(const float min[3], const float max[3], const glm::vec3 &origin, const glm::vec3 &inverse_direction, float t_min, float t_max, float &t_entry);
+
+        std::vector<Node> nodes;
+        std::vector<uint32_t> primitive_indices;
+
+        // Primitive bounds and centroids used by the build and the queries
+        std::vector<Bounds> primitive_bounds;
+        std::vector<glm::vec3> centroids;
+
+        // Triangle mesh (empty when built over boxes)
+        std::vector<glm::vec3> positions;
+        std::vector<uint32_t> indices;
+    };
+}
@@ -47,4 +47,28 @@ namespace framework
         prj[1][1] *= -1;
         return prj;
     }
-}
\ No newline at end of file
+
+    Frustum Camera::getFrustum(uint32_t width, uint32_t height)
+    {
+        return Frustum::fromMatrix(getPerspectiveMatrix(width, height) * getLookAtMatrix());
+    }
+
+    Ray Camera::getPickingRay(float x, float y, uint32_t width, uint32_t height)
+    {
+        glm::mat4 inverse = glm::inverse(getPerspectiveMatrix(width, height) * getLookAtMatrix());
+
+        // The projection already flips Y, so NDC Y grows downwards like the pixel coordinates
+        glm::vec2 ndc(x / width * 2.0f - 1.0f, y / height * 2.0f - 1.0f);
+
+        glm::vec4 near_point = inverse * glm::vec4(ndc, 0.0f, 1.0f);
+        glm::vec4 far_point = inverse * glm::vec4(ndc, 1.0f, 1.0f);
+        glm::vec3 near_position = glm::vec3(near_point) / near_point.w;
+        glm::vec3 far_position = glm::vec3(far_point) / far_point.w;
+
+        Ray ray;
+        ray.origin = near_position;
+        ray.direction = glm::normalize(far_position - near_position);
+        ray.t_max = glm::length(far_position - near_position);
+        return ray;
+    }
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <utils/frustum.h>
+#include <utils/ray.h>
+
 #include <glm/glm.hpp>
 
 namespace framework
@@ -24,6 +27,13 @@ namespace framework
         // Getters
         glm::mat4 getLookAtMatrix();
         glm::mat4 getPerspectiveMatrix(uint32_t width, uint32_t height);
+        Frustum getFrustum(uint32_t width, uint32_t height);
+
+        /**
+         * @brief Computes the world space ray passing through the passed pixel (origin in the top left corner),
+         * going from the near plane to the far plane with a normalized direction
+         */
+        Ray getPickingRay(float x, float y, uint32_t width, uint32_t height);
         glm::vec3 getPosition() { return position; }
         glm::vec3 getDirection() { return direction; }
 
@@ -1,5 +1,11 @@
 #include "defaultRenderer.h"
+#include <utils/jobSystem.h>
+#include <utils/traceProfiler.h>
+#include <utils/statisticsOverlay.h>
+
 #include <chrono>
+#include <algorithm>
+#include <cstring>
 
 namespace framework
 {
@@ -70,6 +76,9 @@ namespace framework
         image_available = std::make_unique<Semaphore>(l_device);
         render_finished = std::make_unique<Semaphore>(l_device);
         in_flight = std::make_unique<Fence>(l_device, true);
+
+        // Draw commands written by the CPU every frame
+        indirect_buffer = std::make_unique<IndirectBuffer>(l_device, INITIAL_INDIRECT_COMMANDS);
     }
 
     void DefaultRenderer::selectSwapChain(std::unique_ptr<SwapChain> s)
@@ -85,6 +94,18 @@ namespace framework
         }
 
         this->swap_chain = std::move(s);
+        invalidateCommandBuffers();
+    }
+
+    void DefaultRenderer::selectOffscreenTarget(std::unique_ptr<OffscreenTarget> t)
+    {
+        if (t == nullptr)
+        {
+            throw std::runtime_error("[DefaultRenderer] Null offscreen target instance");
+        }
+
+        this->offscreen_target = std::move(t);
+        invalidateCommandBuffers();
     }
 
     void DefaultRenderer::selectRenderPass(std::unique_ptr<RenderPass> r)
@@ -100,6 +121,36 @@ namespace framework
         }
 
         this->render_pass = std::move(r);
+        invalidateCommandBuffers();
+    }
+
+    void DefaultRenderer::selectDynamicRendering(const DynamicRenderingConfiguration &config)
+    {
+        if (l_device == nullptr)
+        {
+            throw std::runtime_error("[DefaultRenderer] Null logical device instance");
+        }
+
+        if (!l_device->isDynamicRenderingEnabled())
+        {
+            throw std::runtime_error("[DefaultRenderer] Dynamic rendering not supported by the device");
+        }
+
+        if (swap_chain == nullptr && offscreen_target == nullptr)
+        {
+            throw std::runtime_error("[DefaultRenderer] Swap chain or offscreen target needed before the dynamic rendering");
+        }
+
+        dynamic_rendering = true;
+        dynamic_rendering_config = config;
+        depth_attachment.reset();
+
+        if (config.depth != NONE)
+        {
+            depth_attachment = std::make_unique<Attachment>(l_device, getTargetExtent(), Attachment::depthConfiguration(config.depth));
+        }
+
+        invalidateCommandBuffers();
     }
 
     void DefaultRenderer::addPipeline(std::shared_ptr<Pipeline> p)
@@ -111,6 +162,56 @@ namespace framework
 
         // TODO check if not already present
         this->pipelines.push_back(std::move(p));
+        invalidateCommandBuffers();
+
+        if (gpu_profiler != nullptr)
+        {
+            registerPipelineScopes();
+        }
+    }
+
+    void DefaultRenderer::setGpuProfiler(const std::shared_ptr<GpuProfiler> &profiler)
+    {
+        // Collections keep measuring their uploads until they are detached
+        for (const std::shared_ptr<Pipeline> &pipeline : pipelines)
+        {
+            pipeline->getCollection()->setGpuProfiler(nullptr, 0);
+        }
+
+        gpu_profiler = profiler;
+        pipeline_scopes.clear();
+        invalidateCommandBuffers();
+
+        if (gpu_profiler == nullptr)
+        {
+            return;
+        }
+
+        frame_scope = gpu_profiler->registerScope("frame");
+        gui_scope = gpu_profiler->registerScope("imgui");
+        upload_scope = gpu_profiler->registerScope("uploads");
+
+        registerPipelineScopes();
+    }
+
+    void DefaultRenderer::registerPipelineScopes()
+    {
+        for (size_t p = pipeline_scopes.size(); p < pipelines.size(); p++)
+        {
+            pipeline_scopes.push_back(gpu_profiler->registerScope("pipeline " + std::to_string(p), true));
+            pipelines[p]->getCollection()->setGpuProfiler(gpu_profiler, upload_scope);
+        }
+    }
+
+    void DefaultRenderer::addGpuCulling(const std::shared_ptr<GpuCulling> &culling)
+    {
+        if (culling == nullptr)
+        {
+            throw std::runtime_error("[DefaultRenderer] Null GPU culling instance");
+        }
+
+        gpu_cullings[culling->getPipeline().get()] = culling;
+        invalidateCommandBuffers();
     }
 
     void DefaultRenderer::selectFrameBufferCollection(std::unique_ptr<FrameBufferCollection> c)
@@ -121,6 +222,7 @@ namespace framework
         }
 
         this->frame_buffer_collection = std::move(c);
+        invalidateCommandBuffers();
     }
 
     void DefaultRenderer::selectCommandBuffer(std::unique_ptr<CommandBuffer> b)
@@ -135,76 +237,674 @@ namespace framework
 
     void DefaultRenderer::recordCommandBuffer(uint32_t index, VkClearValue clear_color)
     {
-        if (render_pass == nullptr || frame_buffer_collection == nullptr || swap_chain == nullptr || command_buffer == nullptr)
+        if (command_buffer == nullptr)
         {
             throw std::runtime_error("[DefaultRenderer] graphics objects before recording the command buffer");
         }
 
-        if (index >= frame_buffer_collection->getFrameBuffers().size())
+        bool indirect = prepareDraws(index);
+        recordCommands(*command_buffer, index, clear_color, indirect);
+    }
+
+    bool DefaultRenderer::prepareDraws(uint32_t index)
+    {
+        TraceZone zone("DefaultRenderer::prepareDraws");
+
+        bool rendering_objects = dynamic_rendering || (render_pass != nullptr && frame_buffer_collection != nullptr);
+
+        if (!rendering_objects || (swap_chain == nullptr && offscreen_target == nullptr))
+        {
+            throw std::runtime_error("[DefaultRenderer] graphics objects before recording the command buffer");
+        }
+
+        if (index >= getTargetImageViews().size())
         {
             throw std::runtime_error("[DefaultRenderer] Index >= of the maximum size");
         }
 
-        command_buffer->beginRecording();
-        render_pass->begin(command_buffer->getCommandBuffer(), frame_buffer_collection->getFrameBuffers()[index], swap_chain->getExtent(), clear_color);
+        // Camera frustum in world space, shared by all the pipelines
+        bool culling = culling_camera != nullptr;
+        culling_frustum = Frustum{};
 
-        for (const std::shared_ptr<Pipeline> &pipeline : pipelines)
+        culling_statistics = CullingStatistics{};
+
+        if (culling)
+        {
+            culling_frustum = culling_camera->getFrustum(getTargetExtent().width, getTargetExtent().height);
+        }
+
+        if (culling && occlusion_culling != nullptr)
+        {
+            auto start = std::chrono::steady_clock::now();
+
+            occlusion_view_projection = culling_camera->getPerspectiveMatrix(getTargetExtent().width, getTargetExtent().height) * culling_camera->getLookAtMatrix();
+            occlusion_culling->render(occlusion_view_projection);
+
+            culling_statistics.time_to_occlude += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / 1000.f;
+        }
+
+        // Draws of every pipeline are collected before recording, so that the indirect buffer is written at once
+        pipeline_draws.resize(pipelines.size());
+        uint32_t total_draws = 0;
+
+        for (size_t p = 0; p < pipelines.size(); p++)
+        {
+            pipeline_draws[p].clear();
+
+            // GPU culled pipelines do not depend on the CPU
+            if (pipelines[p]->isVisible() && gpu_cullings.count(pipelines[p].get()) == 0)
+            {
+                collectDraws(pipelines[p], culling ? &culling_frustum : nullptr, pipeline_draws[p]);
+                total_draws += pipeline_draws[p].size();
+            }
+        }
+
+        frame_statistics.draws = total_draws;
+
+        // Without multi draw indirect the draw count is limited to 1, plain indexed draws are recorded instead
+        bool indirect = l_device->getEnabledFeatures().multiDrawIndirect && total_draws > 0;
+
+        if (indirect)
+        {
+            // The previous frame is completed (in flight fence), the buffer can be overwritten or reallocated
+            indirect_buffer->reserve(total_draws);
+            VkDrawIndexedIndirectCommand *commands = indirect_buffer->getCommands();
+
+            uint32_t command = 0;
+            for (size_t p = 0; p < pipelines.size(); p++)
+            {
+                for (const DrawRange &range : pipeline_draws[p])
+                {
+                    commands[command].indexCount = range.index_count;
+                    commands[command].instanceCount = pipelines[p]->getNumberOfInstances();
+                    commands[command].firstIndex = range.first_index;
+                    commands[command].vertexOffset = range.vertex_offset;
+                    commands[command].firstInstance = 0;
+                    command++;
+                }
+            }
+        }
+
+        // First indirect command of every pipeline inside the indirect buffer
+        pipeline_first_commands.resize(pipelines.size());
+        uint32_t first_command = 0;
+
+        for (size_t p = 0; p < pipelines.size(); p++)
+        {
+            pipeline_first_commands[p] = first_command;
+            first_command += pipeline_draws[p].size();
+        }
+
+        return indirect;
+    }
+
+    void DefaultRenderer::recordCommands(CommandBuffer &target, uint32_t index, VkClearValue clear_color, bool indirect)
+    {
+        TraceZone zone("DefaultRenderer::recordCommands");
+
+        target.beginRecording();
+
+        // The query reset happens outside of the render pass
+        if (gpu_profiler != nullptr)
+        {
+            gpu_profiler->recordReset(target.getCommandBuffer());
+            gpu_profiler->beginScope(target.getCommandBuffer(), frame_scope);
+        }
+
+        // Compute culling happens outside of the render pass
+        for (const auto &[pipeline, culling] : gpu_cullings)
         {
             if (pipeline->isVisible())
             {
-                // Bind the pipeline (TODO make the compute pipeline also possible)
-                vkCmdBindPipeline(command_buffer->getCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->getPipeline());
+                culling->recordCulling(target.getCommandBuffer(), culling_camera != nullptr && pipeline->isFrustumCullingEnabled() ? &culling_frustum : nullptr);
+            }
+        }
+
+        // Pipelines with something to draw, in the addition order
+        recorded_pipelines.clear();
+        for (size_t p = 0; p < pipelines.size(); p++)
+        {
+            if (pipelines[p]->isVisible() && (!pipeline_draws[p].empty() || gpu_cullings.count(pipelines[p].get()) > 0))
+            {
+                recorded_pipelines.push_back(p);
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        if (parallel_recording)
+        {
+            // Secondary command buffers are independent from the primary one, they are recorded before the render pass begins
+            std::vector<VkCommandBuffer> secondaries = recordSecondaryCommandBuffers(index, indirect);
+
+            beginRendering(target.getCommandBuffer(), index, clear_color, true);
+
+            // Executed in the pipelines order, whatever thread recorded them
+            if (!secondaries.empty())
+            {
+                vkCmdExecuteCommands(target.getCommandBuffer(), secondaries.size(), secondaries.data());
+            }
+        }
+        else
+        {
+            timings.time_to_record_secondaries.clear();
+
+            beginRendering(target.getCommandBuffer(), index, clear_color, false);
+
+            for (size_t p : recorded_pipelines)
+            {
+                recordPipeline(target.getCommandBuffer(), p, indirect);
+            }
+
+            // If present record also ImGui
+            if (im_gui_active)
+            {
+                recordGui(target.getCommandBuffer());
+            }
+        }
+
+        timings.time_to_record_pipelines = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / 1000.f;
+
+        endRendering(target.getCommandBuffer(), index);
+
+        if (gpu_profiler != nullptr)
+        {
+            gpu_profiler->endScope(target.getCommandBuffer(), frame_scope);
+        }
+
+        target.stopRecording();
+    }
 
-                // Set dynamics of viewport and scissors
-                VkViewport viewport{};
+    void DefaultRenderer::recordPipeline(const VkCommandBuffer &cmd, size_t p, bool indirect)
+    {
+        const std::shared_ptr<Pipeline> &pipeline = pipelines[p];
+        auto gpu_culling = gpu_cullings.find(pipeline.get());
 
-                viewport.x = 0;
-                viewport.y = 0;
-                viewport.width = static_cast<float>(swap_chain->getExtent().width);
-                viewport.height = static_cast<float>(swap_chain->getExtent().height);
-                viewport.minDepth = 0;
-                viewport.maxDepth = 1;
+        if (gpu_profiler != nullptr)
+        {
+            gpu_profiler->beginScope(cmd, pipeline_scopes[p]);
+        }
 
-                vkCmdSetViewport(command_buffer->getCommandBuffer(), 0, 1, &viewport);
+        // Bind the pipeline
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->getPipeline());
 
-                VkRect2D scissors{};
-                scissors.offset = {0, 0};
-                scissors.extent = swap_chain->getExtent();
+        // Set dynamics of viewport and scissors
+        VkViewport viewport{};
 
-                vkCmdSetScissor(command_buffer->getCommandBuffer(), 0, 1, &scissors);
+        viewport.x = 0;
+        viewport.y = 0;
+        viewport.width = static_cast<float>(getTargetExtent().width);
+        viewport.height = static_cast<float>(getTargetExtent().height);
+        viewport.minDepth = 0;
+        viewport.maxDepth = 1;
 
-                // Bind the drawable collection of vertices
-                VkBuffer vertex_buffers[] = {pipeline->getVertexBuffer()};
-                VkDeviceSize offset[] = {0};
-                vkCmdBindVertexBuffers(command_buffer->getCommandBuffer(), 0, 1, vertex_buffers, offset);
+        vkCmdSetViewport(cmd, 0, 1, &viewport);
 
-                // Bind the drawable collection of indices
-                vkCmdBindIndexBuffer(command_buffer->getCommandBuffer(), pipeline->getIndexBuffer(), 0, VK_INDEX_TYPE_UINT32);
+        VkRect2D scissors{};
+        scissors.offset = {0, 0};
+        scissors.extent = getTargetExtent();
 
-                // Bind the Uniform buffer and texture
-                if (pipeline->hasDescriptorSet())
+        vkCmdSetScissor(cmd, 0, 1, &scissors);
+
+        // Bind the drawable collection vertex streams consumed by the pipeline
+        for (uint32_t stream : pipeline->getVertexStreams())
+        {
+            VkBuffer vertex_buffers[] = {pipeline->getVertexBuffer(stream)};
+            VkDeviceSize offset[] = {0};
+            vkCmdBindVertexBuffers(cmd, stream, 1, vertex_buffers, offset);
+        }
+
+        // Per instance data read by every draw of the pipeline
+        if (pipeline->hasInstanceData())
+        {
+            VkDeviceSize offset[] = {0};
+            vkCmdBindVertexBuffers(cmd, pipeline->getInstanceBinding(), 1, &pipeline->getInstanceBuffer(), offset);
+        }
+
+        // Bind the drawable collection of indices
+        vkCmdBindIndexBuffer(cmd, pipeline->getIndexBuffer(), 0, pipeline->getIndexType());
+
+        // Bind the Uniform buffer and texture
+        if (pipeline->hasDescriptorSet())
+        {
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->getLayout(), 0, 1, &pipeline->getDescriptorSet(), 0, nullptr);
+        }
+
+        uint32_t draws = pipeline_draws[p].size();
+
+        if (gpu_culling != gpu_cullings.end())
+        {
+            gpu_culling->second->recordDraw(cmd);
+        }
+        else if (indirect)
+        {
+            // Split the commands in case the device limits the draw count
+            uint32_t max_draws = l_device->getPhysicalDevice()->getProperties().limits.maxDrawIndirectCount;
+
+            for (uint32_t recorded = 0; recorded < draws; recorded += max_draws)
+            {
+                vkCmdDrawIndexedIndirect(cmd, indirect_buffer->getBuffer(),
+                                         (pipeline_first_commands[p] + recorded) * sizeof(VkDrawIndexedIndirectCommand),
+                                         std::min(max_draws, draws - recorded), sizeof(VkDrawIndexedIndirectCommand));
+            }
+        }
+        else
+        {
+            for (const DrawRange &range : pipeline_draws[p])
+            {
+                vkCmdDrawIndexed(cmd, range.index_count, pipeline->getNumberOfInstances(), range.first_index, range.vertex_offset, 0);
+            }
+        }
+
+        if (gpu_profiler != nullptr)
+        {
+            gpu_profiler->endScope(cmd, pipeline_scopes[p]);
+        }
+    }
+
+    void DefaultRenderer::recordGui(const VkCommandBuffer &cmd)
+    {
+        if (gpu_profiler != nullptr)
+        {
+            gpu_profiler->beginScope(cmd, gui_scope);
+        }
+
+        ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), cmd);
+
+        if (gpu_profiler != nullptr)
+        {
+            gpu_profiler->endScope(cmd, gui_scope);
+        }
+    }
+
+    std::vector<VkCommandBuffer> DefaultRenderer::recordSecondaryCommandBuffers(uint32_t index, bool indirect)
+    {
+        // Secondaries inherit the render pass and frame buffer, or the attachment formats with dynamic rendering
+        VkFormat color_format = getTargetFormat();
+        VkCommandBufferInheritanceRenderingInfoKHR rendering_info{};
+
+        rendering_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO_KHR;
+        rendering_info.colorAttachmentCount = 1;
+        rendering_info.pColorAttachmentFormats = &color_format;
+        rendering_info.depthAttachmentFormat = depth_attachment != nullptr ? depth_attachment->getFormat() : VK_FORMAT_UNDEFINED;
+        rendering_info.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+        rendering_info.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+        // One slot per thread taking part to the recording, plus the ImGui one. Every image has its own slots, so that the
+        // secondaries executed by the cached command buffers of the other images are left untouched
+        uint32_t slots_number = JobSystem::getInstance().getWorkersNumber() + 1;
+
+        if (recording_slots.size() <= index)
+        {
+            recording_slots.resize(index + 1);
+        }
+
+        std::vector<RecordingSlot> &image_slots = recording_slots[index];
+
+        while (image_slots.size() < slots_number + 1)
+        {
+            RecordingSlot slot;
+            slot.pool = std::make_unique<CommandPool>(l_device, getSurface());
+            slot.buffer = std::make_unique<CommandBuffer>(l_device, slot.pool->getCommandPool(), VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+            image_slots.push_back(std::move(slot));
+        }
+
+        for (RecordingSlot &slot : image_slots)
+        {
+            slot.recorded = false;
+            slot.error = nullptr;
+            slot.time_to_record = 0;
+        }
+
+        // Contiguous partitions keep the pipelines order once the slots are executed in sequence
+        size_t grain = std::max<size_t>(1, (recorded_pipelines.size() + slots_number - 1) / slots_number);
+
+        auto record_slot = [&](RecordingSlot &slot, const std::function<void(const VkCommandBuffer &)> &commands)
+        {
+            TraceZone zone("DefaultRenderer::recordSecondary");
+            auto start = std::chrono::steady_clock::now();
+
+            try
+            {
+                // The previous frame is completed, the whole pool of the image can be recycled
+                slot.pool->reset();
+                if (dynamic_rendering)
+                {
+                    slot.buffer->beginRecording(rendering_info);
+                }
+                else
                 {
-                    vkCmdBindDescriptorSets(command_buffer->getCommandBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->getLayout(), 0, 1, &pipeline->getDescriptorSet(), 0, nullptr);
+                    slot.buffer->beginRecording(render_pass->getRenderPass(), 0, frame_buffer_collection->getFrameBuffers()[index]);
                 }
+                commands(slot.buffer->getCommandBuffer());
+                slot.buffer->stopRecording();
+                slot.recorded = true;
+            }
+            catch (...)
+            {
+                slot.error = std::current_exception();
+            }
+
+            slot.time_to_record = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / 1000.f;
+        };
+
+        JobSystem::getInstance().parallelFor(recorded_pipelines.size(), grain, [&](size_t begin, size_t end)
+                                              { record_slot(image_slots[begin / grain], [&](const VkCommandBuffer &cmd)
+                                                            {
+                for (size_t i = begin; i < end; i++)
+                {
+                    recordPipeline(cmd, recorded_pipelines[i], indirect);
+                } }); });
+
+        // ImGui is not thread safe, its secondary is recorded by the calling thread after the pipelines
+        if (im_gui_active)
+        {
+            record_slot(image_slots[slots_number], [this](const VkCommandBuffer &cmd)
+                        { recordGui(cmd); });
+        }
+
+        std::vector<VkCommandBuffer> secondaries;
+        timings.time_to_record_secondaries.clear();
+
+        for (RecordingSlot &slot : image_slots)
+        {
+            if (slot.error)
+            {
+                std::rethrow_exception(slot.error);
+            }
+
+            if (slot.recorded)
+            {
+                secondaries.push_back(slot.buffer->getCommandBuffer());
+                timings.time_to_record_secondaries.push_back(slot.time_to_record);
+            }
+        }
+
+        return secondaries;
+    }
+
+    CommandBuffer &DefaultRenderer::prepareCachedCommandBuffer(uint32_t index, VkClearValue clear_color)
+    {
+        if (command_buffer_pool == nullptr)
+        {
+            command_buffer_pool = std::make_unique<CommandPool>(l_device, getSurface());
+        }
+
+        // One command buffer per swap chain image, a single frame is in flight so none of them is pending here
+        while (cached_command_buffers.size() < getTargetImageViews().size())
+        {
+            cached_command_buffers.push_back(std::make_unique<CommandBuffer>(l_device, command_buffer_pool->getCommandPool()));
+            cached_signatures.push_back(INVALID_SIGNATURE);
+        }
+
+        // Culling and indirect commands are computed every frame, the commands only reference their results
+        bool indirect = prepareDraws(index);
+        uint64_t signature = computeFrameSignature(index, clear_color, indirect);
+
+        CommandBuffer &cached = *cached_command_buffers[index];
+        timings.command_buffer_reused = signature == cached_signatures[index];
 
-                // Draw command (TODO make the vertices and instances configurable)
-                vkCmdDrawIndexed(command_buffer->getCommandBuffer(), pipeline->getIndexSize(), pipeline->getNumberOfInstances(), 0, 0, 0);
+        if (!timings.command_buffer_reused)
+        {
+            vkResetCommandBuffer(cached.getCommandBuffer(), 0);
+            recordCommands(cached, index, clear_color, indirect);
+            cached_signatures[index] = signature;
+            countRecording();
+        }
+
+        return cached;
+    }
+
+    uint64_t DefaultRenderer::computeFrameSignature(uint32_t index, VkClearValue clear_color, bool indirect)
+    {
+        // FNV-1a on 64 bit words
+        uint64_t signature = 0xcbf29ce484222325ull;
+
+        auto combine = [&signature](const void *data, size_t size)
+        {
+            const uint8_t *bytes = static_cast<const uint8_t *>(data);
+            uint64_t word;
+
+            for (; size >= sizeof(word); size -= sizeof(word), bytes += sizeof(word))
+            {
+                memcpy(&word, bytes, sizeof(word));
+                signature = (signature ^ word) * 0x100000001b3ull;
+            }
+
+            for (; size > 0; size--, bytes++)
+            {
+                signature = (signature ^ *bytes) * 0x100000001b3ull;
+            }
+        };
+
+        auto combine_value = [&combine](const auto &value)
+        {
+            combine(&value, sizeof(value));
+        };
+
+        // Handles are not hashed: a destroyed object handle can be recycled by the next one. Objects replaced by the renderer
+        // invalidate the cached command buffers, the ones dropped elsewhere (buffers growing, collections, pipelines, cullings)
+        // are destroyed through the device deletion queue, which moves the resource generation
+        combine_value(l_device->getResourceGeneration());
+        combine_value(dynamic_rendering);
+        combine_value(getTargetExtent());
+        combine_value(clear_color);
+        combine_value(indirect);
+        combine_value(parallel_recording);
+
+        // The profiler pool follows the image index (see draw), so it does not change the recorded commands
+        bool profiled = gpu_profiler != nullptr;
+        combine_value(profiled);
+
+        bool gpu_culled = false;
+
+        for (size_t p = 0; p < pipelines.size(); p++)
+        {
+            const std::shared_ptr<Pipeline> &pipeline = pipelines[p];
+            bool visible = pipeline->isVisible();
+
+            combine_value(visible);
+
+            if (!visible)
+            {
+                continue;
+            }
+
+            // Every value recorded by recordPipeline, the bound objects are covered by the resource generation
+            combine_value(pipeline->getIndexType());
+            combine_value(pipeline->getNumberOfInstances());
+
+            uint32_t draws = pipeline_draws[p].size();
+            combine_value(draws);
+            combine(pipeline_draws[p].data(), draws * sizeof(DrawRange));
+
+            auto gpu_culling = gpu_cullings.find(pipeline.get());
+            bool pipeline_gpu_culled = gpu_culling != gpu_cullings.end();
+            combine_value(pipeline_gpu_culled);
+
+            if (pipeline_gpu_culled)
+            {
+                // Inputs of recordCulling: the frustum is moved in the model space and dropped without culling
+                bool frustum_culling = pipeline->isFrustumCullingEnabled();
+                combine_value(pipeline->getModelMatrix());
+                combine_value(frustum_culling);
+
+                gpu_culled |= frustum_culling;
             }
         }
 
-        // If present record also ImGui
+        // The GPU culling frustum is passed with push constants
+        if (gpu_culled && culling_camera != nullptr)
+        {
+            combine(culling_frustum.planes.data(), sizeof(culling_frustum.planes));
+        }
+
         if (im_gui_active)
         {
-            ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), command_buffer->getCommandBuffer());
+            uint64_t gui_signature = 0xcbf29ce484222325ull;
+            std::swap(signature, gui_signature);
+
+            // Draw lists content, the backend rewrites its vertex buffers every time it records
+            ImDrawData *draw_data = ImGui::GetDrawData();
+            if (draw_data != nullptr)
+            {
+                combine_value(draw_data->DisplayPos);
+                combine_value(draw_data->DisplaySize);
+                combine_value(draw_data->FramebufferScale);
+
+                for (int l = 0; l < draw_data->CmdListsCount; l++)
+                {
+                    const ImDrawList *list = draw_data->CmdLists[l];
+
+                    combine(list->VtxBuffer.Data, list->VtxBuffer.Size * sizeof(ImDrawVert));
+                    combine(list->IdxBuffer.Data, list->IdxBuffer.Size * sizeof(ImDrawIdx));
+
+                    for (const ImDrawCmd &command : list->CmdBuffer)
+                    {
+                        combine_value(command.ClipRect);
+                        combine_value(command.TextureId);
+                        combine_value(command.VtxOffset);
+                        combine_value(command.IdxOffset);
+                        combine_value(command.ElemCount);
+                        combine_value(command.UserCallback);
+                    }
+                }
+            }
+
+            std::swap(signature, gui_signature);
+
+            // Buffers recorded with the same draw data hold the same content whatever image recorded them,
+            // a new generation invalidates all the cached command buffers
+            if (gui_signature != gui_draw_data_signature)
+            {
+                gui_draw_data_signature = gui_signature;
+                gui_generation++;
+            }
+
+            combine_value(gui_generation);
         }
 
-        // Finish stopping the buffer recording
-        render_pass->end(command_buffer->getCommandBuffer());
-        command_buffer->stopRecording();
+        return signature == INVALID_SIGNATURE ? INVALID_SIGNATURE + 1 : signature;
+    }
+
+    void DefaultRenderer::invalidateCommandBuffers()
+    {
+        std::fill(cached_signatures.begin(), cached_signatures.end(), INVALID_SIGNATURE);
+    }
+
+    void DefaultRenderer::countRecording()
+    {
+        auto now = std::chrono::steady_clock::now();
+        recordings_in_window++;
+
+        float elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - recordings_window_start).count() / 1000000.f;
+
+        if (elapsed >= 1.0f)
+        {
+            timings.command_buffer_records_per_second = recordings_in_window / elapsed;
+            recordings_in_window = 0;
+            recordings_window_start = now;
+        }
+    }
+
+    void DefaultRenderer::collectDraws(const std::shared_ptr<Pipeline> &pipeline, const Frustum *frustum, std::vector<DrawRange> &draws)
+    {
+        // Instances placement is up to the shaders, the element bounds do not describe them
+        bool cull = frustum != nullptr && pipeline->isFrustumCullingEnabled() && pipeline->getNumberOfInstances() == 1;
+
+        // Whole collection, one draw per 16 bit addressable segment
+        if (!cull && !pipeline->hasDrawList())
+        {
+            draws = pipeline->getDrawRanges();
+            return;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        const std::vector<DrawRange> &ranges = pipeline->getElementRanges();
+
+        if (cull)
+        {
+            // Bounds are in local space, move the frustum there instead of transforming every box
+            Frustum local_frustum = frustum->transform(pipeline->getModelMatrix());
+
+            element_visibility.resize(pipeline->getElementBounds().size());
+            cullBoxes(local_frustum, pipeline->getElementBounds(), element_visibility.data());
+        }
+
+        bool occlude = cull && occlusion_culling != nullptr;
+
+        if (occlude)
+        {
+            auto occlusion_start = std::chrono::steady_clock::now();
+
+            element_frustum_visibility = element_visibility;
+            occlusion_culling->testBoxes(pipeline->getElementBounds(), occlusion_view_projection * pipeline->getModelMatrix(), element_visibility.data());
+
+            culling_statistics.time_to_occlude += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - occlusion_start).count() / 1000.f;
+        }
+
+        uint32_t tested_elements = 0, visible_elements = 0, occluded_elements = 0;
+
+        auto append_element = [&](uint32_t element)
+        {
+            tested_elements++;
+
+            if (cull && !element_visibility[element])
+            {
+                occluded_elements += occlude && element_frustum_visibility[element];
+                return;
+            }
+
+            visible_elements++;
+
+            if (ranges[element].index_count == 0)
+            {
+                return;
+            }
+
+            // Extend the previous draw when the element follows it inside the same segment
+            if (!draws.empty() && draws.back().vertex_offset == ranges[element].vertex_offset &&
+                draws.back().first_index + draws.back().index_count == ranges[element].first_index)
+            {
+                draws.back().index_count += ranges[element].index_count;
+            }
+            else
+            {
+                draws.push_back(ranges[element]);
+            }
+        };
+
+        if (pipeline->hasDrawList())
+        {
+            for (uint32_t element : pipeline->getDrawList())
+            {
+                append_element(element);
+            }
+        }
+        else
+        {
+            for (uint32_t element = 0; element < ranges.size(); element++)
+            {
+                append_element(element);
+            }
+        }
+
+        if (cull)
+        {
+            culling_statistics.tested_elements += tested_elements;
+            culling_statistics.drawn_elements += visible_elements;
+            culling_statistics.culled_elements += tested_elements - visible_elements;
+            culling_statistics.occluded_elements += occluded_elements;
+            culling_statistics.draw_calls += draws.size();
+            culling_statistics.time_to_cull += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / 1000.f;
+        }
     }
 
     VkResult DefaultRenderer::draw(VkClearValue clear_color)
     {
+        TraceZone zone("DefaultRenderer::draw");
+
         using clock = std::chrono::steady_clock;
         using micros = std::chrono::microseconds;
 
@@ -219,12 +919,24 @@ namespace framework
         // Record fence wait time
         timings.time_to_wait_fence = std::chrono::duration_cast<micros>(clock::now() - start).count() / 1000.f;
 
+        // Every submitted frame is completed, destroy the objects dropped meanwhile (e.g. replaced by the resizes)
+        l_device->completeFrames(l_device->getSubmittedFrames());
+
+        if (gpu_profiler != nullptr)
+        {
+            gpu_profiler->collect(l_device->getSubmittedFrames());
+        }
+
         // Start time for pipeline updates
         start = clock::now();
+        frame_statistics.uploaded_bytes = 0;
+
         for (const std::shared_ptr<Pipeline> &pipeline : pipelines)
         {
             // Update the pipeline drawable collection
+            uint64_t uploaded_bytes = pipeline->getCollection()->getUploadedBytes();
             pipeline->updateCollection();
+            frame_statistics.uploaded_bytes += pipeline->getCollection()->getUploadedBytes() - uploaded_bytes;
         }
 
         // Record pipeline update time
@@ -236,8 +948,18 @@ namespace framework
         // Start time for acquiring the next image
         start = clock::now();
 
-        // When the operation is complete the image_available semaphore is signaled
-        VkResult result = vkAcquireNextImageKHR(l_device->getDevice(), swap_chain->getSwapChain(), UINT64_MAX, image_available->getSemaphore(), VK_NULL_HANDLE, &image_index);
+        VkResult result = VK_SUCCESS;
+
+        if (offscreen_target != nullptr)
+        {
+            // The previous frame is completed (single frame in flight), the offscreen images are immediately available
+            image_index = offscreen_target->acquireNextImage();
+        }
+        else
+        {
+            // When the operation is complete the image_available semaphore is signaled
+            result = vkAcquireNextImageKHR(l_device->getDevice(), swap_chain->getSwapChain(), UINT64_MAX, image_available->getSemaphore(), VK_NULL_HANDLE, &image_index);
+        }
 
         // Record time to acquire image
         timings.time_to_acquire_image = std::chrono::duration_cast<micros>(clock::now() - start).count() / 1000.f;
@@ -251,9 +973,6 @@ namespace framework
         // Reset the fence
         in_flight->reset(1);
 
-        // Reset the command buffer
-        vkResetCommandBuffer(command_buffer->getCommandBuffer(), 0);
-
         // Recreate the new frame if gui is active
         if (im_gui_active)
         {
@@ -272,6 +991,11 @@ namespace framework
                 timings.time_to_describe_gui = std::chrono::duration_cast<micros>(clock::now() - start).count() / 1000.f;
             }
 
+            if (statistics_overlay != nullptr)
+            {
+                statistics_overlay->describe();
+            }
+
             // Create the rendered frame described by user
             ImGui::Render();
         }
@@ -279,8 +1003,32 @@ namespace framework
         // Start time for recording command buffer
         start = clock::now();
 
-        // Record the buffer
-        recordCommandBuffer(image_index, clear_color);
+        // Command buffer submitted for this frame
+        CommandBuffer *submitted = command_buffer.get();
+
+        // Cached command buffers write the timestamps into the pool they were recorded with, the image one
+        if (gpu_profiler != nullptr && command_buffer_caching)
+        {
+            gpu_profiler->beginFrame(image_index);
+        }
+        else if (gpu_profiler != nullptr)
+        {
+            gpu_profiler->beginFrame();
+        }
+
+        if (command_buffer_caching)
+        {
+            submitted = &prepareCachedCommandBuffer(image_index, clear_color);
+        }
+        else
+        {
+            // Reset the command buffer
+            vkResetCommandBuffer(command_buffer->getCommandBuffer(), 0);
+
+            // Record the buffer
+            recordCommandBuffer(image_index, clear_color);
+            countRecording();
+        }
 
         // Record time to record command buffer
         timings.time_to_record_command_buffer = std::chrono::duration_cast<micros>(clock::now() - start).count() / 1000.f;
@@ -296,17 +1044,69 @@ namespace framework
         submit_info.pWaitSemaphores = wait_semaphores;
         submit_info.pWaitDstStageMask = wait_stages;
         submit_info.commandBufferCount = 1;
-        submit_info.pCommandBuffers = &command_buffer->getCommandBuffer();
+        submit_info.pCommandBuffers = &submitted->getCommandBuffer();
 
         VkSemaphore signalSemaphores[] = {render_finished->getSemaphore()};
         submit_info.signalSemaphoreCount = 1;
         submit_info.pSignalSemaphores = signalSemaphores;
 
+        // Offscreen frames are neither acquired nor presented, the fence alone tracks their completion
+        if (offscreen_target != nullptr)
+        {
+            submit_info.waitSemaphoreCount = 0;
+            submit_info.signalSemaphoreCount = 0;
+        }
+
+        // A captured frame is presented once its copy completes, the copy submission signals the render semaphore
+        bool capture_frame = false;
+
+        if (frame_capture != nullptr)
+        {
+            if (swap_chain != nullptr && offscreen_target == nullptr && !swap_chain->isTransferSource())
+            {
+                throw std::runtime_error("[DefaultRenderer] Frame capture without transfer source swap chain images");
+            }
+
+            capture_frame = frame_capture->prepareFrame();
+        }
+
+        if (capture_frame)
+        {
+            submit_info.signalSemaphoreCount = 0;
+        }
+
         if (vkQueueSubmit(l_device->getGraphicsQueue(), 1, &submit_info, in_flight->getFence()) != VK_SUCCESS)
         {
             throw std::runtime_error("[DefaultRenderer] Failed tu submit draw command buffer to graphics queue");
         }
 
+        // Tags the objects dropped from now on
+        uint64_t frame = l_device->advanceFrame();
+
+        if (gpu_profiler != nullptr)
+        {
+            gpu_profiler->endFrame(frame);
+        }
+
+        if (capture_frame)
+        {
+            frame_capture->submitFrame(getTargetImages()[image_index], getTargetExtent(), getTargetFormat(), getColorFinalLayout(),
+                                       offscreen_target != nullptr ? VK_NULL_HANDLE : render_finished->getSemaphore());
+        }
+
+        if (offscreen_target != nullptr)
+        {
+            // Record time to draw
+            timings.time_to_draw = std::chrono::duration_cast<micros>(clock::now() - start_draw).count() / 1000.f;
+
+            if (statistics_overlay != nullptr)
+            {
+                statistics_overlay->addFrame(timings, culling_statistics, frame_statistics);
+            }
+
+            return VK_SUCCESS;
+        }
+
         // Presentation (retrieve the rendering result)
         VkPresentInfoKHR present_info{};
 
@@ -325,6 +1125,11 @@ namespace framework
         // Record time to draw
         timings.time_to_draw = std::chrono::duration_cast<micros>(clock::now() - start_draw).count() / 1000.f;
 
+        if (statistics_overlay != nullptr)
+        {
+            statistics_overlay->addFrame(timings, culling_statistics, frame_statistics);
+        }
+
         return VK_SUCCESS;
     }
 
@@ -343,6 +1148,10 @@ namespace framework
         {
             throw std::runtime_error("[DefaultRenderer] Null swapchain instance");
         }
+        if (dynamic_rendering)
+        {
+            throw std::runtime_error("[DefaultRenderer] ImGui needs the render pass path, not the dynamic rendering");
+        }
 
         // Create the ImGui context and internal state
         ImGui::CreateContext();
@@ -408,15 +1217,199 @@ namespace framework
         this->gui_descriptor = gui_descriptor;
     }
 
+    void DefaultRenderer::resizeOffscreenTarget(const VkExtent2D &extent)
+    {
+        if (offscreen_target == nullptr)
+        {
+            throw std::runtime_error("[DefaultRenderer] Null offscreen target instance");
+        }
+
+        // Recreate the offscreen images and frame buffers, the replaced ones are destroyed once the frame in flight completes
+        offscreen_target->recreateOffscreenTarget(extent, true);
+        invalidateCommandBuffers();
+
+        if (dynamic_rendering)
+        {
+            resizeAttachments();
+            return;
+        }
+
+        render_pass->recreateRenderPass(offscreen_target->getExtent(), offscreen_target->getFormat(), true);
+        frame_buffer_collection->recreateFrameBuffer(offscreen_target->getImageViews(), offscreen_target->getExtent(),
+                                                     render_pass->getDepthTestType(), render_pass->getDepthImageView(), render_pass->getRenderPass(), true);
+    }
+
+    const VkExtent2D &DefaultRenderer::getTargetExtent()
+    {
+        return offscreen_target != nullptr ? offscreen_target->getExtent() : swap_chain->getExtent();
+    }
+
+    const std::vector<VkImage> &DefaultRenderer::getTargetImages()
+    {
+        return offscreen_target != nullptr ? offscreen_target->getImages() : swap_chain->getImages();
+    }
+
+    const std::vector<VkImageView> &DefaultRenderer::getTargetImageViews()
+    {
+        return offscreen_target != nullptr ? offscreen_target->getImageViews() : swap_chain->getImageViews();
+    }
+
+    VkFormat DefaultRenderer::getTargetFormat()
+    {
+        return offscreen_target != nullptr ? offscreen_target->getFormat().format : swap_chain->getFormat().format;
+    }
+
+    VkImageLayout DefaultRenderer::getColorFinalLayout()
+    {
+        return dynamic_rendering ? dynamic_rendering_config.color_final_layout : render_pass->getColorFinalLayout();
+    }
+
+    AttachmentFormats DefaultRenderer::getAttachmentFormats()
+    {
+        if (swap_chain == nullptr && offscreen_target == nullptr)
+        {
+            throw std::runtime_error("[DefaultRenderer] Swap chain or offscreen target needed for the attachment formats");
+        }
+
+        AttachmentFormats formats;
+        formats.color = getTargetFormat();
+        formats.depth = dynamic_rendering_config.depth;
+
+        return formats;
+    }
+
+    void DefaultRenderer::resizeAttachments()
+    {
+        // Only the attachments follow the target extent, pipelines do not depend on it
+        if (depth_attachment != nullptr)
+        {
+            depth_attachment->resize(getTargetExtent());
+        }
+    }
+
+    void DefaultRenderer::beginRendering(const VkCommandBuffer &cmd, uint32_t index, VkClearValue clear_color, bool secondaries)
+    {
+        if (!dynamic_rendering)
+        {
+            render_pass->begin(cmd, frame_buffer_collection->getFrameBuffers()[index], getTargetExtent(), clear_color,
+                               secondaries ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+            return;
+        }
+
+        // Without a render pass the layout transitions are explicit, previous contents are discarded since both attachments are cleared
+        VkImageMemoryBarrier barriers[2]{};
+        uint32_t barrier_count = 1;
+
+        barriers[0].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barriers[0].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        barriers[0].newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        barriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barriers[0].image = getTargetImages()[index];
+        barriers[0].subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+        barriers[0].srcAccessMask = 0;
+        barriers[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+        VkPipelineStageFlags src_stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        VkPipelineStageFlags dst_stages = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+
+        if (depth_attachment != nullptr)
+        {
+            barriers[1].sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barriers[1].oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            barriers[1].newLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+            barriers[1].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barriers[1].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barriers[1].image = depth_attachment->getImage();
+            barriers[1].subresourceRange = {depth_attachment->getFormatAspects(), 0, 1, 0, 1};
+            barriers[1].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            barriers[1].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+            src_stages |= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+            dst_stages |= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+            barrier_count++;
+        }
+
+        vkCmdPipelineBarrier(cmd, src_stages, dst_stages, 0, 0, nullptr, 0, nullptr, barrier_count, barriers);
+
+        VkRenderingAttachmentInfoKHR color_attachment{};
+        color_attachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+        color_attachment.imageView = getTargetImageViews()[index];
+        color_attachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        color_attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        color_attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        color_attachment.clearValue = clear_color;
+
+        VkRenderingAttachmentInfoKHR depth{};
+        depth.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+        depth.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+        depth.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        depth.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depth.clearValue.depthStencil = {1.0f, 0};
+
+        VkRenderingInfoKHR rendering_info{};
+        rendering_info.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+        rendering_info.flags = secondaries ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT_KHR : 0;
+        rendering_info.renderArea.offset = {0, 0};
+        rendering_info.renderArea.extent = getTargetExtent();
+        rendering_info.layerCount = 1;
+        rendering_info.colorAttachmentCount = 1;
+        rendering_info.pColorAttachments = &color_attachment;
+
+        if (depth_attachment != nullptr)
+        {
+            depth.imageView = depth_attachment->getImageView();
+            rendering_info.pDepthAttachment = &depth;
+        }
+
+        l_device->getBeginRendering()(cmd, &rendering_info);
+    }
+
+    void DefaultRenderer::endRendering(const VkCommandBuffer &cmd, uint32_t index)
+    {
+        if (!dynamic_rendering)
+        {
+            render_pass->end(cmd);
+            return;
+        }
+
+        l_device->getEndRendering()(cmd);
+
+        // Final layout the render pass would have applied, made available to the following presentation or copy
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        barrier.newLayout = getColorFinalLayout();
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = getTargetImages()[index];
+        barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+        barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        barrier.dstAccessMask = 0;
+
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+
+    VkSurfaceKHR DefaultRenderer::getSurface()
+    {
+        // Headless renderers have no surface, the command pools only need the graphics family
+        return surface != nullptr ? surface->getSurface() : VK_NULL_HANDLE;
+    }
+
     void DefaultRenderer::manageResize(const std::shared_ptr<Window> &window)
     {
-        // Wait that the device is ready
-        l_device->waitIdle();
+        // No device wait: the replaced objects may still be used by the frame in flight, they are destroyed once it completes
+        swap_chain->recreateSwapChain(window, surface->getSurface(), true);
+        invalidateCommandBuffers();
+
+        if (dynamic_rendering)
+        {
+            resizeAttachments();
+            return;
+        }
 
-        // Recreate swapchain and frame buffers
-        swap_chain->recreateSwapChain(window, surface->getSurface());
-        render_pass->recreateRenderPass(swap_chain->getExtent(), swap_chain->getFormat());
+        render_pass->recreateRenderPass(swap_chain->getExtent(), swap_chain->getFormat(), true);
         frame_buffer_collection->recreateFrameBuffer(swap_chain->getImageViews(), swap_chain->getExtent(),
-                                                     render_pass->getDepthTestType(), render_pass->getDepthImageView(), render_pass->getRenderPass());
+                                                     render_pass->getDepthTestType(), render_pass->getDepthImageView(), render_pass->getRenderPass(), true);
     }
 }
\ No newline at end of file
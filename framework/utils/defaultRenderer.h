@@ -5,14 +5,22 @@
 #include <window/windowSurface.h>
 #include <core/vulkan.h>
 #include <core/swapChain.h>
+#include <core/offscreenTarget.h>
 #include <core/shader.h>
 #include <core/renderPass.h>
+#include <core/attachment.h>
 #include <core/pipeline.h>
 #include <core/frameBufferCollection.h>
 #include <core/commandBuffer.h>
 #include <core/commandPool.h>
 #include <core/semaphore.h>
 #include <core/fence.h>
+#include <core/indirectBuffer.h>
+#include <utils/camera.h>
+#include <utils/gpuCulling.h>
+#include <utils/occlusionCulling.h>
+#include <utils/frameCapture.h>
+#include <utils/gpuProfiler.h>
 
 #include <ImGui/imgui.h>
 #include <ImGui/backends/imgui_impl_glfw.h>
@@ -21,6 +29,11 @@
 #include <ImPlot/implot.h>
 
 #include <memory>
+#include <unordered_map>
+#include <vector>
+#include <exception>
+#include <functional>
+#include <chrono>
 
 namespace framework
 {
@@ -32,6 +45,46 @@ namespace framework
         float time_to_acquire_image = 0;
         float time_to_describe_gui = 0;
         float time_to_record_command_buffer = 0;
+        // Part of the command buffer recording spent on the pipelines and ImGui
+        float time_to_record_pipelines = 0;
+        // Recording time of every secondary command buffer (execution order) when recording in parallel
+        std::vector<float> time_to_record_secondaries;
+        // Command buffer caching: whether the frame reused the image command buffer and the recordings rate
+        bool command_buffer_reused = false;
+        float command_buffer_records_per_second = 0;
+    };
+
+    struct CullingStatistics
+    {
+        // Elements tested against the frustum, over all the culled pipelines
+        uint32_t tested_elements = 0;
+        uint32_t culled_elements = 0;
+        uint32_t drawn_elements = 0;
+        // Elements inside the frustum hidden by the occluders (included in culled_elements), the occluded fraction
+        // is occluded_elements / tested_elements
+        uint32_t occluded_elements = 0;
+        // Draws recorded after merging the contiguous visible elements
+        uint32_t draw_calls = 0;
+        float time_to_cull = 0;
+        // Occluders rasterization and occlusion tests (the tests are also part of time_to_cull)
+        float time_to_occlude = 0;
+    };
+
+    struct FrameStatistics
+    {
+        // Draw ranges collected on the CPU (GPU culled pipelines excluded), after culling and merging
+        uint32_t draws = 0;
+        // Bytes uploaded by the pipeline collections before the frame
+        uint64_t uploaded_bytes = 0;
+    };
+
+    class StatisticsOverlay;
+
+    struct DynamicRenderingConfiguration
+    {
+        DepthTestType depth = DepthTestType::NONE;
+        // Layout of the color image after the rendering: PRESENT_SRC for a swap chain, TRANSFER_SRC or SHADER_READ_ONLY for an offscreen target
+        VkImageLayout color_final_layout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
     };
 
     class DefaultRenderer
@@ -47,7 +100,7 @@ namespace framework
         selectInstance(const std::shared_ptr<Vulkan> &v);
 
         /**
-         * @brief Sets the window surface, which is mandatory to find the queue family
+         * @brief Sets the window surface, which is mandatory to find the present queue family (not needed when headless)
          */
         void selectSurface(std::unique_ptr<WindowSurface> s);
 
@@ -61,11 +114,25 @@ namespace framework
          */
         void selectSwapChain(std::unique_ptr<SwapChain> s);
 
+        /**
+         * @brief Sets the offscreen target rendered in place of the swap chain (headless mode). The draw API is unchanged, but
+         * frames are neither acquired nor presented: the fence alone tracks their completion. ImGui is not available
+         */
+        void selectOffscreenTarget(std::unique_ptr<OffscreenTarget> t);
+
         /**
          * @brief Sets the render pass to be used
          */
         void selectRenderPass(std::unique_ptr<RenderPass> r);
 
+        /**
+         * @brief Renders with VK_KHR_dynamic_rendering instead of the render pass and the frame buffer collection, which are not needed.
+         * The depth attachment is created with the target extent, so the swap chain or the offscreen target must be selected first.
+         * Pipelines must be created from getAttachmentFormats, a resize then only reallocates the depth attachment. ImGui is not available
+         * @throws Runtime Exception if the device does not support dynamic rendering
+         */
+        void selectDynamicRendering(const DynamicRenderingConfiguration &config);
+
         /**
          * @brief Sets the pipeline to be used in draw function
          */
@@ -82,6 +149,59 @@ namespace framework
          */
         void selectCommandBuffer(std::unique_ptr<CommandBuffer> b);
 
+        /**
+         * @brief Sets the camera whose frustum is used to cull the pipeline elements, nullptr disables the culling.
+         * Pipelines drawing more than one instance are never culled (the instance placement is up to the shaders)
+         */
+        void setCullingCamera(const std::shared_ptr<Camera> &camera) { culling_camera = camera; }
+
+        /**
+         * @brief Culls and draws the GPU culling pipeline with the compute stage instead of the CPU one.
+         * The pipeline must also be added with addPipeline
+         */
+        void addGpuCulling(const std::shared_ptr<GpuCulling> &culling);
+
+        /**
+         * @brief Tests the elements inside the culling camera frustum against the occluders depth buffer, which is rendered
+         * from the culling camera before collecting the draws. nullptr disables the occlusion culling
+         */
+        void setOcclusionCulling(const std::shared_ptr<OcclusionCulling> &culling) { occlusion_culling = culling; }
+
+        /**
+         * @brief Records the pipelines into secondary command buffers, one per job system thread (each with its own command pool)
+         * plus one for ImGui. Pipelines are split in contiguous groups and executed in the addition order
+         */
+        void setParallelRecording(bool enabled) { parallel_recording = enabled; }
+
+        /**
+         * @brief Keeps a recorded command buffer per swap chain image (instead of the selected one), recorded again only when
+         * the recorded state changes: pipelines and their buffers, visibility, drawn ranges (draw lists and culling), extent,
+         * clear color or ImGui draw data. Uniform and storage buffer contents can change freely. Objects are tracked through
+         * the renderer setters and the device resource generation, not their handles, which can be recycled once destroyed
+         */
+        void setCommandBufferCaching(bool enabled) { command_buffer_caching = enabled; }
+
+        /**
+         * @brief Copies the frames into the capture readback buffers while it is capturing, nullptr disables it.
+         * The swap chain images must support the transfer source usage (offscreen targets need the TRANSFER_SRC usage)
+         */
+        void setFrameCapture(const std::shared_ptr<FrameCapture> &capture) { frame_capture = capture; }
+
+        /**
+         * @brief Measures the GPU time of the frame, of every pipeline draws (scopes "pipeline <index>"), of the ImGui pass and of
+         * the collections uploads with the profiler, nullptr disables it. Results are collected after the frame fence wait.
+         * The pipeline scopes also collect the pipeline statistics, if enabled in the profiler configuration.
+         * With command buffer caching, every image uses the pool of its index (modulo the profiler frames in flight), so that
+         * its cached command buffer keeps writing the same pool
+         */
+        void setGpuProfiler(const std::shared_ptr<GpuProfiler> &profiler);
+
+        /**
+         * @brief Adds every frame timings and statistics to the overlay and, while ImGui is active, describes it after the user
+         * gui descriptor. nullptr disables it
+         */
+        void setStatisticsOverlay(const std::shared_ptr<StatisticsOverlay> &overlay) { statistics_overlay = overlay; }
+
         /**
          * @brief Records the command into the command buffer. The index is the swap chain used one
          */
@@ -99,19 +219,145 @@ namespace framework
 
         /**
          * @brief Called after an invalidation of the swap-chain (usually occurs after a resize).
-         * It recreates the swap chain and the frame buffer collection
+         * It recreates the swap chain (from the old one), the frame buffer collection and, only if their parameters changed,
+         * the depth image and the render pass, without waiting for the device
          */
         void manageResize(const std::shared_ptr<Window> &window);
 
+        /**
+         * @brief Recreates the offscreen target, the render pass and the frame buffer collection with the new extent (headless mode)
+         */
+        void resizeOffscreenTarget(const VkExtent2D &extent);
+
         // Getters
         const TimingMeasurement &getTimings() { return timings; }
+        const CullingStatistics &getCullingStatistics() { return culling_statistics; }
+        const FrameStatistics &getFrameStatistics() { return frame_statistics; }
+        const std::unique_ptr<OffscreenTarget> &getOffscreenTarget() { return offscreen_target; }
+        const std::shared_ptr<GpuProfiler> &getGpuProfiler() { return gpu_profiler; }
+        bool isHeadless() { return offscreen_target != nullptr; }
+        bool isDynamicRendering() { return dynamic_rendering; }
+        // Formats the pipelines are created from with dynamic rendering
+        AttachmentFormats getAttachmentFormats();
 
     private:
+        // Initial capacity of the indirect buffer, it grows with the number of draws
+        static constexpr uint32_t INITIAL_INDIRECT_COMMANDS = 64;
+
+        /**
+         * @brief Extent of the rendered images, the offscreen target one when headless or the swap chain one
+         */
+        const VkExtent2D &getTargetExtent();
+
+        /**
+         * @brief Window surface handle, VK_NULL_HANDLE when headless
+         */
+        VkSurfaceKHR getSurface();
+
+        /**
+         * @brief Rendered images, views and format, the offscreen target ones when headless or the swap chain ones
+         */
+        const std::vector<VkImage> &getTargetImages();
+        const std::vector<VkImageView> &getTargetImageViews();
+        VkFormat getTargetFormat();
+
+        /**
+         * @brief Layout of the color image after the frame commands
+         */
+        VkImageLayout getColorFinalLayout();
+
+        /**
+         * @brief Begins the render pass on the image frame buffer or, with dynamic rendering, transitions the attachments and begins
+         * the rendering on them
+         * @param secondaries Whether the contents are recorded in secondary command buffers
+         */
+        void beginRendering(const VkCommandBuffer &cmd, uint32_t index, VkClearValue clear_color, bool secondaries);
+
+        /**
+         * @brief Ends the render pass or the dynamic rendering, transitioning the color image to its final layout
+         */
+        void endRendering(const VkCommandBuffer &cmd, uint32_t index);
+
+        /**
+         * @brief Reallocates the dynamic rendering attachments with the target extent
+         */
+        void resizeAttachments();
+
+        /**
+         * @brief Registers the profiler scopes of the pipelines added so far and sets the upload scope on their collections
+         */
+        void registerPipelineScopes();
+
+        /**
+         * @brief Fills the draws vector with the index ranges of the pipeline draw list (or all the elements), skipping the
+         * ones outside the frustum (if not null) and merging elements that are contiguous inside the index buffer
+         */
+        void collectDraws(const std::shared_ptr<Pipeline> &pipeline, const Frustum *frustum, std::vector<DrawRange> &draws);
+
+        /**
+         * @brief Computes the frustum, culls the pipelines, collects their draws and fills the indirect buffer
+         * @return true if the draws are recorded as indirect ones
+         */
+        bool prepareDraws(uint32_t index);
+
+        /**
+         * @brief Records the prepared draws and ImGui inside the target command buffer
+         */
+        void recordCommands(CommandBuffer &target, uint32_t index, VkClearValue clear_color, bool indirect);
+
+        /**
+         * @brief Prepares the draws and records the image command buffer only if the frame signature changed
+         * @return The command buffer to be submitted
+         */
+        CommandBuffer &prepareCachedCommandBuffer(uint32_t index, VkClearValue clear_color);
+
+        /**
+         * @brief Hashes everything the recorded commands depend on
+         */
+        uint64_t computeFrameSignature(uint32_t index, VkClearValue clear_color, bool indirect);
+
+        /**
+         * @brief Records again every cached command buffer, called when an object they reference is replaced
+         */
+        void invalidateCommandBuffers();
+
+        /**
+         * @brief Counts a command buffer recording and updates the recordings per second every second
+         */
+        void countRecording();
+
+        /**
+         * @brief Records the bindings and the draws of the p-th pipeline inside the render pass. Safe to be called concurrently
+         * on different command buffers
+         */
+        void recordPipeline(const VkCommandBuffer &cmd, size_t p, bool indirect);
+
+        /**
+         * @brief Records the ImGui draw data inside the render pass
+         */
+        void recordGui(const VkCommandBuffer &cmd);
+
+        /**
+         * @brief Records the pipelines (and ImGui) inside the secondary command buffers using the job system
+         * @return The recorded secondary command buffers in execution order
+         */
+        std::vector<VkCommandBuffer> recordSecondaryCommandBuffers(uint32_t index, bool indirect);
+
+        struct RecordingSlot
+        {
+            std::unique_ptr<CommandPool> pool;
+            std::unique_ptr<CommandBuffer> buffer;
+            bool recorded = false;
+            std::exception_ptr error;
+            float time_to_record = 0;
+        };
+
         // Framework objects
         std::shared_ptr<Vulkan> vulkan;
         std::shared_ptr<LogicalDevice> l_device;
         std::unique_ptr<WindowSurface> surface;
         std::unique_ptr<SwapChain> swap_chain;
+        std::unique_ptr<OffscreenTarget> offscreen_target;
         std::unique_ptr<RenderPass> render_pass;
         std::vector<std::shared_ptr<Pipeline>> pipelines;
         std::unique_ptr<FrameBufferCollection> frame_buffer_collection;
@@ -120,8 +366,64 @@ namespace framework
         std::unique_ptr<Semaphore> render_finished;
         std::unique_ptr<Fence> in_flight;
 
+        // Dynamic rendering, in place of the render pass and the frame buffer collection
+        bool dynamic_rendering = false;
+        DynamicRenderingConfiguration dynamic_rendering_config;
+        std::unique_ptr<Attachment> depth_attachment;
+
         // Timing measurements
         TimingMeasurement timings;
+        FrameStatistics frame_statistics;
+        std::shared_ptr<StatisticsOverlay> statistics_overlay;
+
+        // Frustum culling
+        std::shared_ptr<Camera> culling_camera;
+        CullingStatistics culling_statistics;
+        std::vector<uint8_t> element_visibility;
+        Frustum culling_frustum{};
+
+        // Occlusion culling, with the camera projection * view of the rendered depth and the frustum visibility before the test
+        std::shared_ptr<OcclusionCulling> occlusion_culling;
+        glm::mat4 occlusion_view_projection{1.0f};
+        std::vector<uint8_t> element_frustum_visibility;
+
+        // Draws of every pipeline for the frame being recorded, packed inside the indirect buffer when multi draw indirect is supported
+        std::vector<std::vector<DrawRange>> pipeline_draws;
+        std::unique_ptr<IndirectBuffer> indirect_buffer;
+
+        // Indices of the pipelines recorded in the current frame and their first indirect command
+        std::vector<size_t> recorded_pipelines;
+        std::vector<uint32_t> pipeline_first_commands;
+
+        // Parallel recording, with the slots of every swap chain image
+        bool parallel_recording = false;
+        std::vector<std::vector<RecordingSlot>> recording_slots;
+
+        // Command buffer caching, with the signature of every image command buffer and the ImGui draw data generation
+        static constexpr uint64_t INVALID_SIGNATURE = 0;
+        bool command_buffer_caching = false;
+        std::unique_ptr<CommandPool> command_buffer_pool;
+        std::vector<std::unique_ptr<CommandBuffer>> cached_command_buffers;
+        std::vector<uint64_t> cached_signatures;
+        uint64_t gui_draw_data_signature = 0;
+        uint64_t gui_generation = 0;
+
+        // Recordings counted inside the current one second window
+        uint32_t recordings_in_window = 0;
+        std::chrono::steady_clock::time_point recordings_window_start = std::chrono::steady_clock::now();
+
+        // Frame readback, submitted after every captured frame
+        std::shared_ptr<FrameCapture> frame_capture;
+
+        // GPU timings, with the scope of every pipeline (same order of the pipelines)
+        std::shared_ptr<GpuProfiler> gpu_profiler;
+        uint32_t frame_scope = 0;
+        uint32_t gui_scope = 0;
+        uint32_t upload_scope = 0;
+        std::vector<uint32_t> pipeline_scopes;
+
+        // Pipelines culled on the GPU
+        std::unordered_map<Pipeline *, std::shared_ptr<GpuCulling>> gpu_cullings;
 
         // ImGui
         bool im_gui_active = false;
@@ -0,0 +1,490 @@
+#include "frameCapture.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <libs/stb_image_write.h>
+
+namespace framework
+{
+    FrameCapture::FrameCapture(const std::shared_ptr<LogicalDevice> &l_device, const FrameCaptureConfiguration &config)
+    {
+        if (l_device == nullptr)
+        {
+            throw std::runtime_error("[FrameCapture] Null logical device instance");
+        }
+
+        if (config.readback_buffers == 0)
+        {
+            throw std::runtime_error("[FrameCapture] At least one readback buffer is needed");
+        }
+
+        this->l_device = l_device;
+        this->config = config;
+
+        // Only the graphics family is needed, the copies are submitted on the graphics queue after the frames
+        command_pool = std::make_unique<CommandPool>(l_device, VK_NULL_HANDLE);
+
+        for (uint32_t i = 0; i < config.readback_buffers; i++)
+        {
+            std::unique_ptr<ReadbackBuffer> readback = std::make_unique<ReadbackBuffer>();
+            readback->command_buffer = std::make_unique<CommandBuffer>(l_device, command_pool->getCommandPool());
+            readback->fence = std::make_unique<Fence>(l_device, false);
+            buffers.push_back(std::move(readback));
+        }
+    }
+
+    FrameCapture::~FrameCapture()
+    {
+        stop();
+
+        for (auto &readback : buffers)
+        {
+            destroyBuffer(*readback);
+        }
+    }
+
+    void FrameCapture::start(uint32_t frames)
+    {
+        if (config.format != FrameCaptureFormat::PNG && stream == nullptr)
+        {
+            stream = fopen(config.path.c_str(), "wb");
+
+            if (stream == nullptr)
+            {
+                throw std::runtime_error("[FrameCapture] Impossible to open the stream file");
+            }
+        }
+
+        capturing = true;
+        frames_left = frames;
+    }
+
+    void FrameCapture::stop()
+    {
+        capturing = false;
+        frames_left = 0;
+
+        // A reserved buffer is never submitted at this point
+        if (reserved != nullptr)
+        {
+            reserved->state = BufferState::FREE;
+            reserved = nullptr;
+        }
+
+        collect(true);
+
+        // Also the buffers released by collect, whose last job may still be completing its counter
+        for (auto &readback : buffers)
+        {
+            JobSystem::getInstance().wait(readback->counter);
+
+            if (readback->state == BufferState::ENCODING)
+            {
+                readback->state = BufferState::FREE;
+            }
+        }
+
+        last_encoded = nullptr;
+
+        if (stream != nullptr)
+        {
+            fclose(stream);
+            stream = nullptr;
+            header_written = false;
+        }
+    }
+
+    bool FrameCapture::prepareFrame()
+    {
+        collect(false);
+
+        if (!capturing)
+        {
+            return false;
+        }
+
+        for (auto &readback : buffers)
+        {
+            if (readback->state == BufferState::FREE)
+            {
+                readback->state = BufferState::RESERVED;
+                reserved = readback.get();
+
+                // Stop once the requested frames are captured
+                if (frames_left > 0 && --frames_left == 0)
+                {
+                    capturing = false;
+                }
+
+                return true;
+            }
+        }
+
+        // Waiting for a buffer would stall the render loop
+        statistics.dropped_frames++;
+        return false;
+    }
+
+    void FrameCapture::submitFrame(const VkImage &image, const VkExtent2D &extent, VkFormat format, VkImageLayout layout, const VkSemaphore &signal)
+    {
+        if (reserved == nullptr)
+        {
+            throw std::runtime_error("[FrameCapture] Frame submitted without a reserved readback buffer");
+        }
+
+        bool bgra = false;
+
+        switch (format)
+        {
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+            break;
+        case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_SRGB:
+            bgra = true;
+            break;
+        default:
+            throw std::runtime_error("[FrameCapture] Unsupported image format");
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        ReadbackBuffer &readback = *reserved;
+        reserved = nullptr;
+
+        // Free buffers are not used by the device, they can be grown here
+        VkDeviceSize size = static_cast<VkDeviceSize>(extent.width) * extent.height * 4;
+
+        if (readback.size < size)
+        {
+            createBuffer(readback, size);
+        }
+
+        readback.frame = next_frame++;
+        readback.extent = extent;
+        readback.bgra = bgra;
+
+        const VkCommandBuffer &cmd = readback.command_buffer->getCommandBuffer();
+        vkResetCommandBuffer(cmd, 0);
+        readback.command_buffer->beginRecording();
+
+        // ALL_COMMANDS chains with the implicit render pass dependency (BOTTOM_OF_PIPE) performing the final layout transition
+        VkImageMemoryBarrier to_transfer{};
+        to_transfer.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        to_transfer.oldLayout = layout;
+        to_transfer.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        to_transfer.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        to_transfer.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        to_transfer.image = image;
+        to_transfer.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        to_transfer.subresourceRange.baseMipLevel = 0;
+        to_transfer.subresourceRange.levelCount = 1;
+        to_transfer.subresourceRange.baseArrayLayer = 0;
+        to_transfer.subresourceRange.layerCount = 1;
+        to_transfer.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        to_transfer.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &to_transfer);
+
+        // Tightly packed rows
+        VkBufferImageCopy region{};
+        region.bufferOffset = 0;
+        region.bufferRowLength = 0;
+        region.bufferImageHeight = 0;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = 0;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = {0, 0, 0};
+        region.imageExtent = {extent.width, extent.height, 1};
+
+        vkCmdCopyImageToBuffer(cmd, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readback.buffer, 1, &region);
+
+        // Back to the layout expected by the presentation (or the offscreen target users) and buffer writes visible to the host
+        VkImageMemoryBarrier to_previous = to_transfer;
+        to_previous.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        to_previous.newLayout = layout;
+        to_previous.srcAccessMask = 0;
+        to_previous.dstAccessMask = 0;
+
+        VkBufferMemoryBarrier to_host{};
+        to_host.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        to_host.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        to_host.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        to_host.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        to_host.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        to_host.buffer = readback.buffer;
+        to_host.offset = 0;
+        to_host.size = size;
+
+        // The next frame render pass dependency and the dynamic rendering barrier wait on the color attachment output stage,
+        // which makes them chain with the copy: the image is not cleared or transitioned while it is still read
+        uint32_t image_barriers = layout != VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL ? 1 : 0;
+        vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, 0, nullptr,
+                             1, &to_host, image_barriers, &to_previous);
+
+        readback.command_buffer->stopRecording();
+
+        VkSubmitInfo submit_info{};
+        submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submit_info.commandBufferCount = 1;
+        submit_info.pCommandBuffers = &cmd;
+        submit_info.signalSemaphoreCount = signal != VK_NULL_HANDLE ? 1 : 0;
+        submit_info.pSignalSemaphores = &signal;
+
+        readback.fence->reset(1);
+
+        if (vkQueueSubmit(l_device->getGraphicsQueue(), 1, &submit_info, readback.fence->getFence()) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[FrameCapture] Failed to submit the frame copy");
+        }
+
+        readback.state = BufferState::COPYING;
+
+        statistics.captured_frames++;
+        statistics.time_to_submit = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / 1000.f;
+    }
+
+    FrameCaptureStatistics FrameCapture::getStatistics()
+    {
+        FrameCaptureStatistics result = statistics;
+        result.written_frames = written_frames.load();
+        result.write_errors = write_errors.load();
+        result.time_to_encode = result.written_frames > 0 ? encode_microseconds.load() / 1000.f / result.written_frames : 0;
+        return result;
+    }
+
+    void FrameCapture::collect(bool wait)
+    {
+        std::vector<ReadbackBuffer *> copying;
+
+        for (auto &readback : buffers)
+        {
+            if (readback->state == BufferState::COPYING)
+            {
+                copying.push_back(readback.get());
+            }
+            else if (readback->state == BufferState::ENCODING && readback->counter.isDone())
+            {
+                readback->state = BufferState::FREE;
+            }
+        }
+
+        // Frames are handed to the workers in order, so that the stream ones are written in order
+        std::sort(copying.begin(), copying.end(), [](ReadbackBuffer *a, ReadbackBuffer *b)
+                  { return a->frame < b->frame; });
+
+        for (ReadbackBuffer *readback : copying)
+        {
+            VkResult status = wait ? vkWaitForFences(l_device->getDevice(), 1, &readback->fence->getFence(), VK_TRUE, UINT64_MAX)
+                                   : vkGetFenceStatus(l_device->getDevice(), readback->fence->getFence());
+
+            // The copies complete in submission order
+            if (status != VK_SUCCESS)
+            {
+                break;
+            }
+
+            if (!readback->coherent)
+            {
+                VkMappedMemoryRange range{};
+                range.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+                range.memory = readback->memory;
+                range.offset = 0;
+                range.size = VK_WHOLE_SIZE;
+                vkInvalidateMappedMemoryRanges(l_device->getDevice(), 1, &range);
+            }
+
+            readback->state = BufferState::ENCODING;
+            encode(*readback);
+        }
+    }
+
+    void FrameCapture::encode(ReadbackBuffer &readback)
+    {
+        JobSystem &jobs = JobSystem::getInstance();
+
+        auto job = [this, &readback]
+        { write(readback); };
+
+        // PNG frames are independent files, stream frames wait for the previous one to be written
+        if (config.format != FrameCaptureFormat::PNG && last_encoded != nullptr)
+        {
+            jobs.run(job, &readback.counter, last_encoded->counter);
+        }
+        else
+        {
+            jobs.run(job, &readback.counter);
+        }
+
+        last_encoded = &readback;
+    }
+
+    void FrameCapture::write(ReadbackBuffer &readback)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        const uint8_t *pixels = static_cast<const uint8_t *>(readback.mapped_memory);
+        uint32_t width = readback.extent.width;
+        uint32_t height = readback.extent.height;
+        size_t count = static_cast<size_t>(width) * height;
+
+        // Red and blue channels offsets inside the pixel
+        uint32_t r = readback.bgra ? 2 : 0;
+        uint32_t b = readback.bgra ? 0 : 2;
+
+        bool written = false;
+
+        if (config.format == FrameCaptureFormat::Y4M)
+        {
+            // Full range BT.601 planes, the stream extent is the one of the first frame
+            std::vector<uint8_t> planes(count * 3);
+
+            for (size_t i = 0; i < count; i++)
+            {
+                int32_t red = pixels[i * 4 + r];
+                int32_t green = pixels[i * 4 + 1];
+                int32_t blue = pixels[i * 4 + b];
+
+                planes[i] = static_cast<uint8_t>((77 * red + 150 * green + 29 * blue + 128) >> 8);
+                planes[count + i] = static_cast<uint8_t>(std::clamp(((-43 * red - 85 * green + 128 * blue + 128) >> 8) + 128, 0, 255));
+                planes[count * 2 + i] = static_cast<uint8_t>(std::clamp(((128 * red - 107 * green - 21 * blue + 128) >> 8) + 128, 0, 255));
+            }
+
+            if (!header_written)
+            {
+                fprintf(stream, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C444\n", width, height, config.frame_rate);
+                stream_extent = readback.extent;
+                header_written = true;
+            }
+
+            if (width == stream_extent.width && height == stream_extent.height)
+            {
+                written = fputs("FRAME\n", stream) >= 0 && fwrite(planes.data(), 1, planes.size(), stream) == planes.size();
+            }
+        }
+        else
+        {
+            std::vector<uint8_t> rgb(count * 3);
+
+            for (size_t i = 0; i < count; i++)
+            {
+                rgb[i * 3] = pixels[i * 4 + r];
+                rgb[i * 3 + 1] = pixels[i * 4 + 1];
+                rgb[i * 3 + 2] = pixels[i * 4 + b];
+            }
+
+            if (config.format == FrameCaptureFormat::PNG)
+            {
+                char suffix[32];
+                snprintf(suffix, sizeof(suffix), "_%06llu.png", static_cast<unsigned long long>(readback.frame));
+                written = stbi_write_png((config.path + suffix).c_str(), width, height, 3, rgb.data(), width * 3) != 0;
+            }
+            else
+            {
+                written = fwrite(rgb.data(), 1, rgb.size(), stream) == rgb.size();
+            }
+        }
+
+        if (written)
+        {
+            written_frames++;
+        }
+        else
+        {
+            write_errors++;
+        }
+
+        encode_microseconds += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void FrameCapture::createBuffer(ReadbackBuffer &readback, VkDeviceSize size)
+    {
+        destroyBuffer(readback);
+
+        VkBufferCreateInfo buffer_info{};
+        buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        buffer_info.size = size;
+        buffer_info.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        if (vkCreateBuffer(l_device->getDevice(), &buffer_info, nullptr, &readback.buffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[FrameCapture] Impossible to create the readback buffer");
+        }
+
+        VkMemoryRequirements memory_requirements;
+        vkGetBufferMemoryRequirements(l_device->getDevice(), readback.buffer, &memory_requirements);
+
+        // Cached memory makes the CPU reads fast, it may be not coherent
+        int32_t memory_type = findMemoryType(memory_requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+        readback.coherent = false;
+
+        if (memory_type < 0)
+        {
+            memory_type = findMemoryType(memory_requirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            readback.coherent = true;
+        }
+
+        if (memory_type < 0)
+        {
+            throw std::runtime_error("[FrameCapture] Unable to find a suitable memory type");
+        }
+
+        VkMemoryAllocateInfo alloc_info{};
+        alloc_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        alloc_info.allocationSize = memory_requirements.size;
+        alloc_info.memoryTypeIndex = memory_type;
+
+        if (vkAllocateMemory(l_device->getDevice(), &alloc_info, nullptr, &readback.memory) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[FrameCapture] Impossible to allocate the readback memory");
+        }
+
+        vkBindBufferMemory(l_device->getDevice(), readback.buffer, readback.memory, 0);
+
+        // Persistent memory mapping
+        vkMapMemory(l_device->getDevice(), readback.memory, 0, size, 0, &readback.mapped_memory);
+        readback.size = size;
+    }
+
+    void FrameCapture::destroyBuffer(ReadbackBuffer &readback)
+    {
+        if (readback.memory != VK_NULL_HANDLE)
+        {
+            vkUnmapMemory(l_device->getDevice(), readback.memory);
+            vkFreeMemory(l_device->getDevice(), readback.memory, nullptr);
+        }
+
+        if (readback.buffer != VK_NULL_HANDLE)
+        {
+            vkDestroyBuffer(l_device->getDevice(), readback.buffer, nullptr);
+        }
+
+        readback.buffer = VK_NULL_HANDLE;
+        readback.memory = VK_NULL_HANDLE;
+        readback.mapped_memory = nullptr;
+        readback.size = 0;
+    }
+
+    int32_t FrameCapture::findMemoryType(uint32_t type_filter, VkMemoryPropertyFlags properties)
+    {
+        VkPhysicalDeviceMemoryProperties memory_properties;
+
+        // Enumerate the memory properties
+        vkGetPhysicalDeviceMemoryProperties(l_device->getPhysicalDevice()->getDevice(), &memory_properties);
+
+        for (uint32_t i = 0; i < memory_properties.memoryTypeCount; i++)
+        {
+            if ((type_filter & (1 << i)) && (memory_properties.memoryTypes[i].propertyFlags & properties) == properties)
+            {
+                return i;
+            }
+        }
+
+        return -1;
+    }
+}
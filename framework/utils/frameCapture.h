@@ -0,0 +1,176 @@
+#pragma once
+
+#include <devices/logicalDevice.h>
+#include <core/commandPool.h>
+#include <core/commandBuffer.h>
+#include <core/fence.h>
+#include <utils/jobSystem.h>
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <stdio.h>
+
+namespace framework
+{
+    enum class FrameCaptureFormat : uint32_t
+    {
+        // One RGB PNG file per frame, named <path>_<frame>.png
+        PNG,
+        // Single file with the rgb24 frames one after the other (e.g. ffmpeg -f rawvideo -pix_fmt rgb24 -s WxH)
+        RAW,
+        // Single YUV4MPEG2 stream with full resolution chroma (C444)
+        Y4M
+    };
+
+    struct FrameCaptureConfiguration
+    {
+        FrameCaptureFormat format = FrameCaptureFormat::PNG;
+        // File prefix for PNG, file name for the streams
+        std::string path = "capture";
+        // Host visible buffers the frames are copied into, frames are dropped (not waited) when all of them are busy
+        uint32_t readback_buffers = 4;
+        // Frame rate written inside the Y4M header
+        uint32_t frame_rate = 60;
+    };
+
+    struct FrameCaptureStatistics
+    {
+        uint64_t captured_frames = 0;
+        // Frames requested while all the readback buffers were busy (GPU copy or encoding)
+        uint64_t dropped_frames = 0;
+        uint64_t written_frames = 0;
+        uint64_t write_errors = 0;
+        // Render thread cost of the last captured frame (copy recording and submission)
+        float time_to_submit = 0;
+        // Average encoding and writing time of a frame on the workers
+        float time_to_encode = 0;
+    };
+
+    /**
+     * @brief Copies the rendered images into a ring of persistently mapped readback buffers, with a separate submission after
+     * the frame one. Buffers are polled (never waited) at the next frames and, once copied, the frames are converted, encoded and
+     * written by the job system workers, so the render loop only pays the copy recording. Supports 8 bit RGBA and BGRA images.
+     * Used through DefaultRenderer::setFrameCapture, which needs a swap chain created with transfer source usage or an
+     * offscreen target with the TRANSFER_SRC usage.
+     */
+    class FrameCapture
+    {
+    public:
+        FrameCapture(const std::shared_ptr<LogicalDevice> &l_device, const FrameCaptureConfiguration &config);
+        ~FrameCapture();
+
+        /**
+         * @brief Captures the next frames (all of them until stop with 0). Streams are opened at the first start
+         * @throws Runtime Exception if the stream file cannot be opened
+         */
+        void start(uint32_t frames = 0);
+
+        /**
+         * @brief Stops capturing and waits for the pending frames to be written, closing the stream file
+         */
+        void stop();
+
+        /**
+         * @brief Collects the copied frames, handing them to the workers, and reserves a readback buffer for the frame
+         * about to be submitted. Never blocks
+         * @return true if the frame has to be captured with submitFrame
+         */
+        bool prepareFrame();
+
+        /**
+         * @brief Records and submits the copy of the image (left in the passed layout by the frame commands) into the reserved
+         * readback buffer. The copy waits for the color attachment writes of the previous submissions and signals the passed
+         * semaphore (if any), so that the presentation waits for it instead of the frame submission
+         * @throws Runtime Exception if the format is not supported or prepareFrame did not reserve a buffer
+         */
+        void submitFrame(const VkImage &image, const VkExtent2D &extent, VkFormat format, VkImageLayout layout, const VkSemaphore &signal);
+
+        // Getters
+        bool isCapturing() { return capturing; }
+        FrameCaptureStatistics getStatistics();
+
+    private:
+        enum class BufferState : uint32_t
+        {
+            FREE,
+            RESERVED,
+            COPYING,
+            ENCODING
+        };
+
+        struct ReadbackBuffer
+        {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            VkDeviceSize size = 0;
+            void *mapped_memory = nullptr;
+            // Memory needs an explicit invalidation before being read when not coherent
+            bool coherent = true;
+
+            std::unique_ptr<CommandBuffer> command_buffer;
+            std::unique_ptr<Fence> fence;
+            // Encoding job of the buffer frame, stream frames depend on the previous one to be written in order
+            JobCounter counter;
+
+            BufferState state = BufferState::FREE;
+            uint64_t frame = 0;
+            VkExtent2D extent{};
+            bool bgra = false;
+        };
+
+        /**
+         * @brief Hands the copied frames to the workers and releases the encoded ones
+         * @param wait Waits for the pending copies instead of polling them
+         */
+        void collect(bool wait);
+
+        /**
+         * @brief Schedules the conversion and the writing of the buffer frame
+         */
+        void encode(ReadbackBuffer &readback);
+
+        /**
+         * @brief Converts the frame to rgb24 and writes it to its file or to the stream. Executed by the workers, never throws
+         */
+        void write(ReadbackBuffer &readback);
+
+        /**
+         * @brief Creates the buffer with at least the passed size, destroying the previous one
+         */
+        void createBuffer(ReadbackBuffer &readback, VkDeviceSize size);
+        void destroyBuffer(ReadbackBuffer &readback);
+
+        /**
+         * @brief Looks for the memory on the GPU that suits the passed parameters
+         * @return the memory type index or -1 if none is found
+         */
+        int32_t findMemoryType(uint32_t type_filter, VkMemoryPropertyFlags flags);
+
+        std::shared_ptr<LogicalDevice> l_device;
+        FrameCaptureConfiguration config;
+
+        std::unique_ptr<CommandPool> command_pool;
+        std::vector<std::unique_ptr<ReadbackBuffer>> buffers;
+
+        bool capturing = false;
+        uint32_t frames_left = 0;
+        uint64_t next_frame = 0;
+        ReadbackBuffer *reserved = nullptr;
+        // Last frame handed to the workers, the next stream frame is written after it
+        ReadbackBuffer *last_encoded = nullptr;
+
+        // Stream file, written by one worker at a time
+        FILE *stream = nullptr;
+        bool header_written = false;
+        VkExtent2D stream_extent{};
+
+        // Statistics, the written ones are updated by the workers
+        FrameCaptureStatistics statistics;
+        std::atomic<uint64_t> written_frames = 0;
+        std::atomic<uint64_t> write_errors = 0;
+        std::atomic<uint64_t> encode_microseconds = 0;
+    };
+}
@@ -0,0 +1,178 @@
+#include "frustum.h"
+
+// The AVX kernel is compiled with a target attribute and selected at run time, the build flags do not enable AVX
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FRUSTUM_CULLING_AVX
+#endif
+
+#if defined(__SSE2__) || defined(FRUSTUM_CULLING_AVX)
+#include <immintrin.h>
+#endif
+
+namespace framework
+{
+    Frustum Frustum::fromMatrix(const glm::mat4 &matrix)
+    {
+        // Rows of the column major matrix
+        glm::vec4 rows[4];
+        for (int i = 0; i < 4; i++)
+        {
+            rows[i] = glm::vec4(matrix[0][i], matrix[1][i], matrix[2][i], matrix[3][i]);
+        }
+
+        Frustum frustum;
+
+        frustum.planes[0] = rows[3] + rows[0];
+        frustum.planes[1] = rows[3] - rows[0];
+        frustum.planes[2] = rows[3] + rows[1];
+        frustum.planes[3] = rows[3] - rows[1];
+        // Depth goes from 0 to 1 (GLM_FORCE_DEPTH_ZERO_TO_ONE), the near plane is the third row alone
+        frustum.planes[4] = rows[2];
+        frustum.planes[5] = rows[3] - rows[2];
+
+        for (glm::vec4 &plane : frustum.planes)
+        {
+            plane /= glm::length(glm::vec3(plane));
+        }
+
+        return frustum;
+    }
+
+    Frustum Frustum::transform(const glm::mat4 &model) const
+    {
+        Frustum result;
+
+        // Planes are covectors: plane * model
+        glm::mat4 transposed = glm::transpose(model);
+        for (int i = 0; i < 6; i++)
+        {
+            result.planes[i] = transposed * planes[i];
+        }
+
+        return result;
+    }
+
+    bool Frustum::intersectsBox(const glm::vec3 &min, const glm::vec3 &max) const
+    {
+        for (const glm::vec4 &plane : planes)
+        {
+            // Box corner farthest along the plane normal
+            glm::vec3 corner(plane.x > 0 ? max.x : min.x,
+                             plane.y > 0 ? max.y : min.y,
+                             plane.z > 0 ? max.z : min.z);
+
+            if (glm::dot(glm::vec3(plane), corner) + plane.w < 0)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+#ifdef FRUSTUM_CULLING_AVX
+    static const bool HAS_AVX = __builtin_cpu_supports("avx");
+
+    /**
+     * @brief Tests the boxes 8 at a time, returns the first box left to the narrower paths
+     */
+    __attribute__((target("avx"))) static size_t cullBoxesAvx(const Frustum &frustum, const float *const corner_x[6], const float *const corner_y[6],
+                                                             const float *const corner_z[6], size_t count, uint8_t *visible, uint32_t &visible_count)
+    {
+        size_t i = 0;
+
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+            for (int p = 0; p < 6; p++)
+            {
+                __m256 distance = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(corner_x[p] + i), _mm256_set1_ps(frustum.planes[p].x)),
+                                                _mm256_mul_ps(_mm256_loadu_ps(corner_y[p] + i), _mm256_set1_ps(frustum.planes[p].y)));
+                distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_loadu_ps(corner_z[p] + i), _mm256_set1_ps(frustum.planes[p].z)));
+                distance = _mm256_add_ps(distance, _mm256_set1_ps(frustum.planes[p].w));
+
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GE_OQ));
+            }
+
+            int mask = _mm256_movemask_ps(inside);
+            for (int k = 0; k < 8; k++)
+            {
+                visible[i + k] = (mask >> k) & 1;
+            }
+            visible_count += __builtin_popcount(mask);
+        }
+
+        return i;
+    }
+#endif
+
+    const char *getCullBoxesKernel()
+    {
+#ifdef FRUSTUM_CULLING_AVX
+        if (HAS_AVX)
+        {
+            return "avx";
+        }
+#endif
+#ifdef __SSE2__
+        return "sse2";
+#else
+        return "scalar";
+#endif
+    }
+
+    uint32_t cullBoxes(const Frustum &frustum, const BoundingBoxes &boxes, uint8_t *visible)
+    {
+        size_t count = boxes.size();
+        size_t i = 0;
+        uint32_t visible_count = 0;
+
+        // The farthest corner only depends on the plane normal signs, so the selection is done once per plane
+        const float *corner_x[6], *corner_y[6], *corner_z[6];
+        for (int p = 0; p < 6; p++)
+        {
+            corner_x[p] = frustum.planes[p].x > 0 ? boxes.max_x.data() : boxes.min_x.data();
+            corner_y[p] = frustum.planes[p].y > 0 ? boxes.max_y.data() : boxes.min_y.data();
+            corner_z[p] = frustum.planes[p].z > 0 ? boxes.max_z.data() : boxes.min_z.data();
+        }
+
+#ifdef FRUSTUM_CULLING_AVX
+        if (HAS_AVX)
+        {
+            i = cullBoxesAvx(frustum, corner_x, corner_y, corner_z, count, visible, visible_count);
+        }
+#endif
+#ifdef __SSE2__
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+            for (int p = 0; p < 6; p++)
+            {
+                __m128 distance = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(corner_x[p] + i), _mm_set1_ps(frustum.planes[p].x)),
+                                             _mm_mul_ps(_mm_loadu_ps(corner_y[p] + i), _mm_set1_ps(frustum.planes[p].y)));
+                distance = _mm_add_ps(distance, _mm_mul_ps(_mm_loadu_ps(corner_z[p] + i), _mm_set1_ps(frustum.planes[p].z)));
+                distance = _mm_add_ps(distance, _mm_set1_ps(frustum.planes[p].w));
+
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_setzero_ps()));
+            }
+
+            int mask = _mm_movemask_ps(inside);
+            for (int k = 0; k < 4; k++)
+            {
+                visible[i + k] = (mask >> k) & 1;
+            }
+            visible_count += __builtin_popcount(mask);
+        }
+#endif
+        for (; i < count; i++)
+        {
+            visible[i] = frustum.intersectsBox(glm::vec3(boxes.min_x[i], boxes.min_y[i], boxes.min_z[i]),
+                                               glm::vec3(boxes.max_x[i], boxes.max_y[i], boxes.max_z[i]));
+            visible_count += visible[i];
+        }
+
+        return visible_count;
+    }
+}
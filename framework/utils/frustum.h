@@ -0,0 +1,48 @@
+#pragma once
+
+#include <core/boundingBoxes.h>
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <stdint.h>
+
+namespace framework
+{
+    /**
+     * @brief View frustum made of 6 planes (left, right, bottom, top, near, far). Every plane is stored as
+     * (normal, distance) with the normal pointing inside, a point p is inside when dot(normal, p) + distance >= 0
+     */
+    struct Frustum
+    {
+        std::array<glm::vec4, 6> planes;
+
+        /**
+         * @brief Extracts the normalized planes from a projection * view (* model) matrix with [0, 1] depth range
+         */
+        static Frustum fromMatrix(const glm::mat4 &matrix);
+
+        /**
+         * @brief Returns the frustum expressed in the space transformed by the passed model matrix, so that local space
+         * boxes can be tested directly. Planes are not normalized again, only the sign of the distances is preserved.
+         */
+        Frustum transform(const glm::mat4 &model) const;
+
+        /**
+         * @brief Conservative box test: true if the box is not completely outside one of the planes
+         */
+        bool intersectsBox(const glm::vec3 &min, const glm::vec3 &max) const;
+    };
+
+    /**
+     * @brief Tests all the boxes against the frustum, 8 (AVX, when the CPU supports it) or 4 (SSE2) boxes at a time.
+     * visible[i] is set to 1 if the i-th box intersects the frustum, 0 otherwise.
+     * @return The number of visible boxes
+     */
+    uint32_t cullBoxes(const Frustum &frustum, const BoundingBoxes &boxes, uint8_t *visible);
+
+    /**
+     * @brief Name of the widest cullBoxes kernel selected at run time: avx, sse2 or scalar
+     */
+    const char *getCullBoxesKernel();
+}
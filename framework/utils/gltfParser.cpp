@@ -0,0 +1,670 @@
+#include "gltfParser.h"
+
+#include <utils/vertexCompression.h>
+#include <utils/traceProfiler.h>
+
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+#include <fstream>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+// Images are loaded by the texture collection through the returned paths
+#define TINYGLTF_IMPLEMENTATION
+#define TINYGLTF_NO_STB_IMAGE
+#define TINYGLTF_NO_STB_IMAGE_WRITE
+#define TINYGLTF_NO_EXTERNAL_IMAGE
+#include <libs/tiny_gltf.h>
+
+using namespace std;
+
+namespace framework
+{
+    /**
+     * @brief Strided view of an accessor inside the tiny_gltf owned buffer memory
+     */
+    struct AccessorView
+    {
+        const unsigned char *data = nullptr;
+        size_t count = 0;
+        uint32_t stride = 0;
+        int component_type = 0;
+        uint32_t components = 0;
+        uint32_t element_size = 0;
+        bool normalized = false;
+    };
+
+    /**
+     * @brief Returns the folder path into which it is stored the passed file
+     */
+    std::string getGltfFolderPath(const std::string &filename)
+    {
+        size_t index = filename.find_last_of("/\\");
+        return index == std::string::npos ? "./" : filename.substr(0, index + 1);
+    }
+
+    /**
+     * @brief Builds the accessor view
+     * @throws Runtime Exception in case of sparse accessors or out of bounds views
+     */
+    AccessorView getAccessorView(const tinygltf::Model &model, int accessor_index)
+    {
+        if (accessor_index < 0 || accessor_index >= static_cast<int>(model.accessors.size()))
+        {
+            throw runtime_error("[GltfParser] Accessor index out of bounds");
+        }
+
+        const tinygltf::Accessor &accessor = model.accessors[accessor_index];
+
+        if (accessor.sparse.isSparse)
+        {
+            throw runtime_error("[GltfParser] Sparse accessors are not supported");
+        }
+
+        if (accessor.bufferView < 0 || accessor.bufferView >= static_cast<int>(model.bufferViews.size()))
+        {
+            throw runtime_error("[GltfParser] Accessor without a valid buffer view");
+        }
+
+        const tinygltf::BufferView &buffer_view = model.bufferViews[accessor.bufferView];
+        const tinygltf::Buffer &buffer = model.buffers.at(buffer_view.buffer);
+
+        const unsigned char *buffer_data = buffer.data.data();
+        size_t buffer_size = buffer.data.size();
+
+        AccessorView view;
+        view.component_type = accessor.componentType;
+        view.components = tinygltf::GetNumComponentsInType(static_cast<uint32_t>(accessor.type));
+        view.element_size = tinygltf::GetComponentSizeInBytes(static_cast<uint32_t>(accessor.componentType)) * view.components;
+        view.normalized = accessor.normalized;
+        view.count = accessor.count;
+
+        int stride = accessor.ByteStride(buffer_view);
+        if (stride <= 0 || view.components > 4)
+        {
+            throw runtime_error("[GltfParser] Unsupported accessor layout");
+        }
+        view.stride = stride;
+
+        size_t offset = buffer_view.byteOffset + accessor.byteOffset;
+        if (view.count > 0 && offset + (view.count - 1) * view.stride + view.element_size > buffer_size)
+        {
+            throw runtime_error("[GltfParser] Accessor exceeds its buffer");
+        }
+
+        view.data = buffer_data + offset;
+        return view;
+    }
+
+    /**
+     * @brief Reads the component of the i-th element as float, applying the normalization if needed
+     */
+    inline float readComponent(const AccessorView &view, size_t i, uint32_t component)
+    {
+        const unsigned char *p = view.data + i * view.stride;
+        switch (view.component_type)
+        {
+        case TINYGLTF_COMPONENT_TYPE_FLOAT:
+        {
+            float v;
+            memcpy(&v, p + component * 4, 4);
+            return v;
+        }
+        case TINYGLTF_COMPONENT_TYPE_BYTE:
+        {
+            float v = static_cast<int8_t>(p[component]);
+            return view.normalized ? std::max(v / 127.0f, -1.0f) : v;
+        }
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+        {
+            float v = p[component];
+            return view.normalized ? v / 255.0f : v;
+        }
+        case TINYGLTF_COMPONENT_TYPE_SHORT:
+        {
+            int16_t s;
+            memcpy(&s, p + component * 2, 2);
+            return view.normalized ? std::max(s / 32767.0f, -1.0f) : s;
+        }
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+        {
+            uint16_t s;
+            memcpy(&s, p + component * 2, 2);
+            return view.normalized ? s / 65535.0f : s;
+        }
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+        {
+            uint32_t u;
+            memcpy(&u, p + component * 4, 4);
+            return static_cast<float>(u);
+        }
+        }
+
+        throw runtime_error("[GltfParser] Unsupported accessor component type");
+    }
+
+    /**
+     * @brief Returns the vertex format that stores the accessor elements as they are. Non normalized
+     * integer accessors (or with unsupported sizes) have no matching format and are converted to floats
+     */
+    bool getMatchingFormat(const AccessorView &view, VertexAttributes::DrawableAttribute &format)
+    {
+        if (view.component_type == TINYGLTF_COMPONENT_TYPE_FLOAT)
+        {
+            const VertexAttributes::DrawableAttribute formats[] = {VertexAttributes::DrawableAttribute::F1, VertexAttributes::DrawableAttribute::F2,
+                                                                   VertexAttributes::DrawableAttribute::F3, VertexAttributes::DrawableAttribute::F4};
+            format = formats[view.components - 1];
+            return true;
+        }
+
+        if (!view.normalized)
+        {
+            return false;
+        }
+
+        switch (view.component_type)
+        {
+        case TINYGLTF_COMPONENT_TYPE_SHORT:
+            format = view.components <= 2 ? VertexAttributes::DrawableAttribute::S16N2 : VertexAttributes::DrawableAttribute::S16N4;
+            return true;
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+            format = view.components <= 2 ? VertexAttributes::DrawableAttribute::U16N2 : VertexAttributes::DrawableAttribute::U16N4;
+            return true;
+        case TINYGLTF_COMPONENT_TYPE_BYTE:
+            format = VertexAttributes::DrawableAttribute::S8N4;
+            return true;
+        case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+            format = VertexAttributes::DrawableAttribute::U8N4;
+            return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Copies the accessor elements without conversions inside the interleaved vertices.
+     * Missing components are zero, or the maximum normalized value when pad_one is set (e.g. color alpha)
+     */
+    void copyAccessor(const AccessorView &view, VertexAttributes::DrawableAttribute format, float *dst, uint32_t dst_stride, bool pad_one)
+    {
+        uint32_t words = VertexAttributes::getAttributeSize(format) / sizeof(float);
+        uint32_t component_size = view.element_size / view.components;
+        uint32_t format_components = VertexAttributes::getAttributeComponents(format);
+
+        unsigned char padding[4 * sizeof(float)]{};
+        if (pad_one)
+        {
+            for (uint32_t c = view.components; c < format_components; c++)
+            {
+                if (view.component_type == TINYGLTF_COMPONENT_TYPE_FLOAT)
+                {
+                    float one = 1.0f;
+                    memcpy(padding + c * component_size, &one, sizeof(float));
+                }
+                else
+                {
+                    // Signed types are filled with 0x7F.., unsigned with 0xFF..
+                    memset(padding + c * component_size, 0xFF, component_size);
+                    if (view.component_type == TINYGLTF_COMPONENT_TYPE_BYTE || view.component_type == TINYGLTF_COMPONENT_TYPE_SHORT)
+                    {
+                        padding[c * component_size + component_size - 1] = 0x7F;
+                    }
+                }
+            }
+        }
+
+        for (size_t i = 0; i < view.count; i++)
+        {
+            unsigned char *vertex = reinterpret_cast<unsigned char *>(dst + i * dst_stride);
+            memcpy(vertex, padding, words * sizeof(float));
+            memcpy(vertex, view.data + i * view.stride, view.element_size);
+        }
+    }
+
+    /**
+     * @brief Computes the local transform of the node (matrix or TRS)
+     */
+    glm::mat4 getNodeMatrix(const tinygltf::Node &node)
+    {
+        if (node.matrix.size() == 16)
+        {
+            float m[16];
+            for (int i = 0; i < 16; i++)
+            {
+                m[i] = static_cast<float>(node.matrix[i]);
+            }
+
+            // glTF matrices are column major as glm ones
+            return glm::make_mat4(m);
+        }
+
+        glm::mat4 result(1.0f);
+        if (node.translation.size() == 3)
+        {
+            result = glm::translate(result, glm::vec3(node.translation[0], node.translation[1], node.translation[2]));
+        }
+        if (node.rotation.size() == 4)
+        {
+            result = result * glm::mat4_cast(glm::quat(static_cast<float>(node.rotation[3]), static_cast<float>(node.rotation[0]),
+                                                       static_cast<float>(node.rotation[1]), static_cast<float>(node.rotation[2])));
+        }
+        if (node.scale.size() == 3)
+        {
+            result = glm::scale(result, glm::vec3(node.scale[0], node.scale[1], node.scale[2]));
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Visits the node hierarchy collecting every mesh instance with its world matrix
+     */
+    void collectMeshInstances(const tinygltf::Model &model, int node_index, const glm::mat4 &parent, uint32_t depth,
+                              std::vector<std::pair<int, glm::mat4>> &instances)
+    {
+        // Malformed files could contain cycles
+        if (node_index < 0 || node_index >= static_cast<int>(model.nodes.size()) || depth > model.nodes.size())
+        {
+            throw runtime_error("[GltfParser] Invalid node hierarchy");
+        }
+
+        const tinygltf::Node &node = model.nodes[node_index];
+        glm::mat4 world = parent * getNodeMatrix(node);
+
+        if (node.mesh >= 0)
+        {
+            instances.push_back({node.mesh, world});
+        }
+
+        for (int child : node.children)
+        {
+            collectMeshInstances(model, child, world, depth + 1, instances);
+        }
+    }
+
+    /**
+     * @brief Returns the ordered base color texture paths of the materials (empty for embedded images)
+     */
+    std::vector<std::string> getGltfTexturePaths(const std::string &folder, const tinygltf::Model &model)
+    {
+        std::vector<std::string> result;
+
+        for (const auto &material : model.materials)
+        {
+            std::string path = "";
+            int texture = material.pbrMetallicRoughness.baseColorTexture.index;
+
+            if (texture >= 0 && texture < static_cast<int>(model.textures.size()))
+            {
+                int source = model.textures[texture].source;
+                if (source >= 0 && source < static_cast<int>(model.images.size()))
+                {
+                    const std::string &uri = model.images[source].uri;
+                    if (uri != "" && uri.rfind("data:", 0) != 0)
+                    {
+                        path = folder + uri;
+                    }
+                }
+            }
+
+            // Replace \ path with /
+            std::replace(path.begin(), path.end(), '\\', '/');
+            result.push_back(path);
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Image loader that skips the decoding (textures are loaded by the framework from the paths)
+     */
+    bool skipImageLoading(tinygltf::Image *, const int, std::string *, std::string *, int, int, const unsigned char *, int, void *)
+    {
+        return true;
+    }
+
+    /**
+     * @brief Given a triangle primitive and its world matrix, produces the drawable element
+     */
+    std::shared_ptr<DefaultDrawableElement> getParsedGltfElement(const tinygltf::Model &model, const tinygltf::Primitive &primitive,
+                                                                     const glm::mat4 &world, const GltfParserConfiguration &config)
+    {
+        auto position = primitive.attributes.find("POSITION");
+        if (position == primitive.attributes.end())
+        {
+            throw runtime_error("[GltfParser] Primitive without positions");
+        }
+
+        AccessorView positions = getAccessorView(model, position->second);
+        size_t vertices_number = positions.count;
+
+        // Collect the optional attributes views
+        auto getOptionalView = [&](const char *name, bool enabled, AccessorView &view)
+        {
+            auto attribute = primitive.attributes.find(name);
+            if (!enabled || attribute == primitive.attributes.end())
+            {
+                return false;
+            }
+
+            view = getAccessorView(model, attribute->second);
+            if (view.count != vertices_number)
+            {
+                throw runtime_error("[GltfParser] Attribute " + std::string(name) + " count differs from the positions one");
+            }
+            return true;
+        };
+
+        AccessorView textures, normals, tangents, colors;
+        bool has_textures = getOptionalView("TEXCOORD_0", config.has_texture, textures);
+        bool has_normals = getOptionalView("NORMAL", config.has_normals, normals);
+        bool has_tangents = getOptionalView("TANGENT", config.has_tangents, tangents);
+        bool has_colors = getOptionalView("COLOR_0", config.has_colors, colors);
+
+        // Select the formats, raw copied attributes keep their accessor format
+        VertexAttributes::DrawableAttribute texture_format = VertexAttributes::DrawableAttribute::F2;
+        VertexAttributes::DrawableAttribute normal_format = VertexAttributes::DrawableAttribute::F3;
+        VertexAttributes::DrawableAttribute tangent_format = VertexAttributes::DrawableAttribute::F4;
+        VertexAttributes::DrawableAttribute color_format = VertexAttributes::DrawableAttribute::F4;
+        bool copy_textures = has_textures && config.keep_accessor_formats && getMatchingFormat(textures, texture_format);
+        bool copy_colors = has_colors && config.keep_accessor_formats && getMatchingFormat(colors, color_format);
+
+        // Normals and tangents are transformed, they are stored in the matching format after the transformation
+        VertexAttributes::DrawableAttribute matching;
+        if (has_normals && config.keep_accessor_formats && normals.component_type != TINYGLTF_COMPONENT_TYPE_FLOAT && getMatchingFormat(normals, matching))
+        {
+            normal_format = matching == VertexAttributes::DrawableAttribute::S8N4 ? matching : VertexAttributes::DrawableAttribute::S16N4;
+        }
+        if (has_tangents && config.keep_accessor_formats && tangents.component_type != TINYGLTF_COMPONENT_TYPE_FLOAT && getMatchingFormat(tangents, matching))
+        {
+            tangent_format = matching == VertexAttributes::DrawableAttribute::S8N4 ? matching : VertexAttributes::DrawableAttribute::S16N4;
+        }
+
+        std::vector<VertexAttributes::DrawableAttribute> vertex_attributes;
+        vertex_attributes.push_back(VertexAttributes::DrawableAttribute::F3); // XYZ coordinates
+        if (config.has_texture)
+        {
+            vertex_attributes.push_back(texture_format); // UV coordinates
+        }
+        if (config.has_normals)
+        {
+            vertex_attributes.push_back(normal_format); // Normals
+        }
+        if (config.has_tangents)
+        {
+            vertex_attributes.push_back(tangent_format); // Tangents (w is the bitangent sign)
+        }
+        if (config.has_colors)
+        {
+            vertex_attributes.push_back(color_format); // Vertex colors
+        }
+        if (config.has_texture)
+        {
+            vertex_attributes.push_back(VertexAttributes::DrawableAttribute::I1); // Material index
+        }
+
+        uint32_t vertex_size = VertexAttributes(vertex_attributes).getStride() / sizeof(float);
+        std::vector<float> vertices(vertices_number * vertex_size, 0.0f);
+        uint32_t offset = 0;
+
+        // Mirror the X axis to move from the glTF right handed reference
+        float flip = config.right_handed_ref ? -1.0f : 1.0f;
+        glm::mat3 normal_matrix = glm::transpose(glm::inverse(glm::mat3(world)));
+
+        // Positions are decoded and transformed straight into the vertices
+        for (size_t i = 0; i < vertices_number; i++)
+        {
+            glm::vec4 p(readComponent(positions, i, 0), readComponent(positions, i, 1), readComponent(positions, i, 2), 1.0f);
+            p = world * p;
+
+            float *vertex = &vertices[i * vertex_size];
+            vertex[0] = flip * p.x * config.multiplication_factor;
+            vertex[1] = p.y * config.multiplication_factor;
+            vertex[2] = p.z * config.multiplication_factor;
+        }
+        offset += 3;
+
+        if (config.has_texture)
+        {
+            if (copy_textures)
+            {
+                copyAccessor(textures, texture_format, vertices.data() + offset, vertex_size, false);
+            }
+            else if (has_textures)
+            {
+                for (size_t i = 0; i < vertices_number; i++)
+                {
+                    vertices[i * vertex_size + offset + 0] = readComponent(textures, i, 0);
+                    vertices[i * vertex_size + offset + 1] = readComponent(textures, i, 1);
+                }
+            }
+
+            offset += VertexAttributes::getAttributeSize(texture_format) / sizeof(float);
+        }
+
+        if (config.has_normals)
+        {
+            if (has_normals)
+            {
+                std::vector<float> transformed(vertices_number * 3);
+                for (size_t i = 0; i < vertices_number; i++)
+                {
+                    glm::vec3 n = normal_matrix * glm::vec3(readComponent(normals, i, 0), readComponent(normals, i, 1), readComponent(normals, i, 2));
+                    float length = glm::length(n);
+                    n = length > 0 ? n / length : n;
+
+                    transformed[i * 3 + 0] = flip * n.x;
+                    transformed[i * 3 + 1] = n.y;
+                    transformed[i * 3 + 2] = n.z;
+                }
+
+                encodeVertexAttribute(normal_format, transformed.data(), 3, vertices_number, vertices.data() + offset, vertex_size);
+            }
+
+            offset += VertexAttributes::getAttributeSize(normal_format) / sizeof(float);
+        }
+
+        if (config.has_tangents)
+        {
+            if (has_tangents)
+            {
+                std::vector<float> transformed(vertices_number * 4);
+                for (size_t i = 0; i < vertices_number; i++)
+                {
+                    glm::vec3 t = glm::mat3(world) * glm::vec3(readComponent(tangents, i, 0), readComponent(tangents, i, 1), readComponent(tangents, i, 2));
+                    float length = glm::length(t);
+                    t = length > 0 ? t / length : t;
+
+                    // Mirroring changes the handedness of the tangent space
+                    transformed[i * 4 + 0] = flip * t.x;
+                    transformed[i * 4 + 1] = t.y;
+                    transformed[i * 4 + 2] = t.z;
+                    transformed[i * 4 + 3] = flip * (tangents.components == 4 ? readComponent(tangents, i, 3) : 1.0f);
+                }
+
+                encodeVertexAttribute(tangent_format, transformed.data(), 4, vertices_number, vertices.data() + offset, vertex_size);
+            }
+
+            offset += VertexAttributes::getAttributeSize(tangent_format) / sizeof(float);
+        }
+
+        if (config.has_colors)
+        {
+            if (copy_colors)
+            {
+                copyAccessor(colors, color_format, vertices.data() + offset, vertex_size, true);
+            }
+            else
+            {
+                for (size_t i = 0; i < vertices_number; i++)
+                {
+                    for (uint32_t c = 0; c < 4; c++)
+                    {
+                        vertices[i * vertex_size + offset + c] = has_colors && c < colors.components ? readComponent(colors, i, c) : 1.0f;
+                    }
+                }
+            }
+
+            offset += VertexAttributes::getAttributeSize(color_format) / sizeof(float);
+        }
+
+        // Material index and transparency (same rules of the object parser)
+        bool has_transparency = false;
+        uint32_t material_index = primitive.material >= 0 ? primitive.material : 0;
+        if (primitive.material >= 0 && primitive.material < static_cast<int>(model.materials.size()))
+        {
+            const tinygltf::Material &material = model.materials[primitive.material];
+            const std::vector<double> &factor = material.pbrMetallicRoughness.baseColorFactor;
+            has_transparency = material.alphaMode == "BLEND" || (factor.size() == 4 && factor[3] < 1);
+        }
+
+        if (config.has_texture)
+        {
+            uint32_t material_data = (has_transparency ? 0x1 << 31 : 0x0) | material_index;
+            for (size_t i = 0; i < vertices_number; i++)
+            {
+                memcpy(&vertices[i * vertex_size + offset], &material_data, sizeof(uint32_t));
+            }
+        }
+
+        // Indices (non indexed primitives draw the vertices in order)
+        std::vector<uint32_t> indices;
+        if (primitive.indices >= 0)
+        {
+            AccessorView view = getAccessorView(model, primitive.indices);
+            indices.resize(view.count);
+
+            for (size_t i = 0; i < view.count; i++)
+            {
+                const unsigned char *p = view.data + i * view.stride;
+                switch (view.component_type)
+                {
+                case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+                    indices[i] = p[0];
+                    break;
+                case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+                {
+                    uint16_t index;
+                    memcpy(&index, p, sizeof(uint16_t));
+                    indices[i] = index;
+                    break;
+                }
+                case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+                    memcpy(&indices[i], p, sizeof(uint32_t));
+                    break;
+                default:
+                    throw runtime_error("[GltfParser] Unsupported index component type");
+                }
+
+                if (indices[i] >= vertices_number)
+                {
+                    throw runtime_error("[GltfParser] Index out of the vertices bounds");
+                }
+            }
+        }
+        else
+        {
+            indices.resize(vertices_number);
+            for (size_t i = 0; i < vertices_number; i++)
+            {
+                indices[i] = i;
+            }
+        }
+
+        // Both the mirroring and a negative scale invert the triangles winding
+        bool swap_winding = config.right_handed_ref != (glm::determinant(glm::mat3(world)) < 0);
+        if (swap_winding)
+        {
+            for (size_t i = 0; i + 2 < indices.size(); i += 3)
+            {
+                std::swap(indices[i + 1], indices[i + 2]);
+            }
+        }
+
+        return std::make_shared<DefaultDrawableElement>(vertices, vertex_attributes, indices, has_transparency);
+    }
+
+    std::vector<std::shared_ptr<DefaultDrawableElement>> parseGltfFile(const char *filename, const GltfParserConfiguration &config, std::vector<std::string> &tex_paths)
+    {
+        TraceZone zone("parseGltfFile");
+
+        if (filename == nullptr)
+        {
+            throw runtime_error("[GltfParser] Null filename");
+        }
+
+        if (config.multiplication_factor <= 0)
+        {
+            throw runtime_error("[GltfParser] Bad multiplication factor (<= 0)");
+        }
+
+        std::string folder = getGltfFolderPath(filename);
+
+        // Binary files start with the "glTF" magic, tiny_gltf copies their BIN chunk inside the model buffers
+        char magic[4] = {};
+        std::ifstream file(filename, std::ios::binary);
+        if (!file)
+        {
+            throw runtime_error("[GltfParser] Unable to open the file " + std::string(filename));
+        }
+        file.read(magic, sizeof(magic));
+        file.close();
+
+        tinygltf::TinyGLTF loader;
+        tinygltf::Model model;
+        std::string warn, err;
+        loader.SetImageLoader(skipImageLoading, nullptr);
+
+        bool loaded = memcmp(magic, "glTF", sizeof(magic)) == 0 ? loader.LoadBinaryFromFile(&model, &err, &warn, filename)
+                                                                : loader.LoadASCIIFromFile(&model, &err, &warn, filename);
+
+        if (!loaded)
+        {
+            throw runtime_error("[GltfParser] Error from tiny-glTF: " + warn + err);
+        }
+
+        // Collect the mesh instances from the scene hierarchy
+        std::vector<std::pair<int, glm::mat4>> instances;
+        if (config.apply_node_transforms && model.scenes.size() > 0)
+        {
+            int scene = model.defaultScene >= 0 && model.defaultScene < static_cast<int>(model.scenes.size()) ? model.defaultScene : 0;
+            for (int node : model.scenes[scene].nodes)
+            {
+                collectMeshInstances(model, node, glm::mat4(1.0f), 0, instances);
+            }
+        }
+        else
+        {
+            for (int i = 0; i < static_cast<int>(model.meshes.size()); i++)
+            {
+                instances.push_back({i, glm::mat4(1.0f)});
+            }
+        }
+
+        // Get all the texture paths
+        tex_paths = getGltfTexturePaths(folder, model);
+
+        std::vector<std::shared_ptr<DefaultDrawableElement>> result;
+        for (const auto &instance : instances)
+        {
+            for (const tinygltf::Primitive &primitive : model.meshes.at(instance.first).primitives)
+            {
+                // Only triangle lists are supported (-1 is the default mode)
+                if (primitive.mode != TINYGLTF_MODE_TRIANGLES && primitive.mode != -1)
+                {
+                    continue;
+                }
+
+                result.push_back(getParsedGltfElement(model, primitive, instance.second, config));
+            }
+        }
+
+        return result;
+    }
+}
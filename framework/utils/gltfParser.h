@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+#include <string>
+#include <memory>
+
+#include <core/drawableElement.h>
+#include <core/vertexAttributes.h>
+
+namespace framework
+{
+    struct GltfParserConfiguration
+    {
+        bool has_texture = true;
+        bool has_normals = true;
+        bool has_tangents = false;
+        bool has_colors = false;
+        bool right_handed_ref = true;
+        bool apply_node_transforms = true;
+        // Keeps the accessor (normalized/quantized) formats, otherwise every attribute is stored as float.
+        // Elements inside the same collection need the same formats, disable it when mixing assets with different quantizations
+        bool keep_accessor_formats = true;
+        float multiplication_factor = 1.0f;
+    };
+
+    /**
+     * @brief The method parses a glTF 2.0 file (.gltf or binary .glb) with the passed configuration, producing
+     * a drawable element for every triangle primitive instanced by the scene nodes.
+     * The vertex layout is the same of the object parser: positions (F3), texture coordinates, normals, tangents,
+     * colors and the material index (I1, present if has_texture). Missing attributes are filled with zeros,
+     * except colors that default to opaque white (components missing from the accessor are 1, e.g. the alpha of RGB colors).
+     * Texture coordinates and colors keep the matching VertexAttributes format of their accessor
+     * (e.g. normalized unsigned short UVs become U16N2, normalized bytes become U8N4). Quantized normals and tangents are
+     * transformed first, then encoded again as S8N4 (byte accessors) or S16N4 (short accessors).
+     *
+     * @param tex_paths is a user vector that is modified by the method to include the base color texture
+     * paths in material order. Textures embedded inside buffers produce an empty path.
+     * @throws Runtime Exception if the file cannot be opened or parsed, or it contains sparse accessors
+     */
+    std::vector<std::shared_ptr<DefaultDrawableElement>> parseGltfFile(const char *filename, const GltfParserConfiguration &config, std::vector<std::string> &tex_paths);
+}
@@ -0,0 +1,242 @@
+#include "gpuCulling.h"
+
+#include <stdexcept>
+
+namespace framework
+{
+    /**
+     * @brief Storage buffer descriptor of an existing buffer, so that buffers owned by other systems
+     * can be bound at the binding and stage expected by the culling shader
+     */
+    class StorageBufferBinding : public DescriptorElement
+    {
+    public:
+        StorageBufferBinding(uint32_t binding_index, const VkBuffer &buffer) : DescriptorElement(binding_index)
+        {
+            buffer_info.buffer = buffer;
+            buffer_info.offset = 0;
+            buffer_info.range = VK_WHOLE_SIZE;
+        }
+
+        const VkDescriptorSetLayoutBinding getDescriptorSetLayoutBinding() override
+        {
+            VkDescriptorSetLayoutBinding layout_binding{};
+
+            layout_binding.binding = binding_index;
+            layout_binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            layout_binding.descriptorCount = 1;
+            layout_binding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+            layout_binding.pImmutableSamplers = nullptr;
+
+            return layout_binding;
+        }
+
+        const VkDescriptorPoolSize getPoolSize() override
+        {
+            VkDescriptorPoolSize pool_size{};
+
+            pool_size.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            pool_size.descriptorCount = 1;
+
+            return pool_size;
+        }
+
+        const VkWriteDescriptorSet getWriteDescriptorSet() override
+        {
+            VkWriteDescriptorSet descriptor_write{};
+
+            descriptor_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptor_write.dstBinding = binding_index;
+            descriptor_write.dstArrayElement = 0;
+            descriptor_write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            descriptor_write.descriptorCount = 1;
+            descriptor_write.pBufferInfo = &buffer_info;
+
+            return descriptor_write;
+        }
+
+    private:
+        VkDescriptorBufferInfo buffer_info{};
+    };
+
+    GpuCulling::GpuCulling(const std::shared_ptr<LogicalDevice> &l_device, const std::shared_ptr<Pipeline> &pipeline, const GpuCullingConfiguration &config)
+    {
+        if (l_device == nullptr)
+        {
+            throw std::runtime_error("[GpuCulling] Null logical device instance");
+        }
+
+        if (pipeline == nullptr)
+        {
+            throw std::runtime_error("[GpuCulling] Null pipeline instance");
+        }
+
+        this->l_device = l_device;
+        this->pipeline = pipeline;
+
+        element_count = pipeline->getElementRanges().size();
+
+        if (element_count == 0)
+        {
+            throw std::runtime_error("[GpuCulling] The pipeline collection is not allocated");
+        }
+
+        // Without the count the draw covers all the command slots
+        if (l_device->getDrawIndexedIndirectCount() == nullptr && !l_device->getEnabledFeatures().multiDrawIndirect && element_count > 1)
+        {
+            throw std::runtime_error("[GpuCulling] The device supports neither draw indirect count nor multi draw indirect");
+        }
+
+        if (element_count > l_device->getPhysicalDevice()->getProperties().limits.maxDrawIndirectCount)
+        {
+            throw std::runtime_error("[GpuCulling] More elements than the maximum indirect draw count");
+        }
+
+        if (config.instance_transforms != nullptr)
+        {
+            if (config.instance_transforms->getElementsNumber() < element_count)
+            {
+                throw std::runtime_error("[GpuCulling] Fewer instance transforms than elements");
+            }
+
+            instance_transforms = config.instance_transforms;
+            flags |= USE_INSTANCE_TRANSFORMS;
+        }
+        else
+        {
+            // Placeholder, the binding must be valid even if the shader does not read it
+            instance_transforms = std::make_shared<StorageBuffer<glm::mat4>>(l_device, StorageBufferConfiguration{});
+        }
+
+        if (l_device->getEnabledFeatures().drawIndirectFirstInstance)
+        {
+            flags |= WRITE_FIRST_INSTANCE;
+        }
+
+        StorageBufferConfiguration elements_config{};
+        elements_config.elements = element_count;
+        elements = std::make_shared<StorageBuffer<Element>>(l_device, elements_config);
+
+        // Written and read only by the GPU
+        StorageBufferConfiguration commands_config{};
+        commands_config.elements = element_count;
+        commands_config.additional_usage = VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        commands_config.host_visible = false;
+        commands = std::make_shared<StorageBuffer<VkDrawIndexedIndirectCommand>>(l_device, commands_config);
+
+        // Copied back by the validations of the visible count
+        StorageBufferConfiguration count_config{};
+        count_config.additional_usage = VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        count_config.host_visible = false;
+        count = std::make_shared<StorageBuffer<uint32_t>>(l_device, count_config);
+
+        updateElements();
+
+        // Bindings as declared inside the shader
+        std::vector<std::shared_ptr<DescriptorElement>> bindings = {
+            std::make_shared<StorageBufferBinding>(0, elements->getStorageBuffer()),
+            std::make_shared<StorageBufferBinding>(1, instance_transforms->getStorageBuffer()),
+            std::make_shared<StorageBufferBinding>(2, commands->getStorageBuffer()),
+            std::make_shared<StorageBufferBinding>(3, count->getStorageBuffer())};
+
+        ComputePipelineConfiguration compute_config{};
+        compute_config.push_constants_size = sizeof(PushConstants);
+
+        std::shared_ptr<Shader> shader = std::make_shared<Shader>(l_device, config.shader_path.c_str(), ShaderType::COMPUTE);
+        compute_pipeline = std::make_unique<ComputePipeline>(l_device, shader, std::make_unique<DescriptorSet>(l_device, bindings), compute_config);
+    }
+
+    void GpuCulling::updateElements()
+    {
+        const BoundingBoxes &bounds = pipeline->getElementBounds();
+        const std::vector<DrawRange> &ranges = pipeline->getElementRanges();
+
+        if (ranges.size() != element_count)
+        {
+            throw std::runtime_error("[GpuCulling] The number of elements changed");
+        }
+
+        Element *data = elements->getMappedData();
+
+        for (uint32_t i = 0; i < element_count; i++)
+        {
+            data[i].bounds_min = glm::vec4(bounds.min_x[i], bounds.min_y[i], bounds.min_z[i], 0.0f);
+            data[i].bounds_max = glm::vec4(bounds.max_x[i], bounds.max_y[i], bounds.max_z[i], 0.0f);
+            data[i].first_index = ranges[i].first_index;
+            data[i].index_count = ranges[i].index_count;
+            data[i].vertex_offset = ranges[i].vertex_offset;
+            data[i].padding = 0;
+        }
+    }
+
+    void GpuCulling::recordCulling(const VkCommandBuffer &command_buffer, const Frustum *frustum)
+    {
+        // Reset the counter, without the count extension all the slots are cleared so that the unused ones draw nothing
+        vkCmdFillBuffer(command_buffer, count->getStorageBuffer(), 0, VK_WHOLE_SIZE, 0);
+
+        if (l_device->getDrawIndexedIndirectCount() == nullptr)
+        {
+            vkCmdFillBuffer(command_buffer, commands->getStorageBuffer(), 0, VK_WHOLE_SIZE, 0);
+        }
+
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        PushConstants constants{};
+        constants.element_count = element_count;
+        constants.flags = flags;
+        constants.instance_count = pipeline->getNumberOfInstances();
+
+        // An element index as first instance would offset the per instance attributes, or overlap the following elements instances
+        if (pipeline->hasInstanceData() || constants.instance_count != 1)
+        {
+            constants.flags &= ~WRITE_FIRST_INSTANCE;
+        }
+
+        if (frustum != nullptr)
+        {
+            // Planes in the pipeline model space, the instance transforms are applied by the shader
+            Frustum local_frustum = frustum->transform(pipeline->getModelMatrix());
+
+            for (int i = 0; i < 6; i++)
+            {
+                constants.planes[i] = local_frustum.planes[i];
+            }
+        }
+        else
+        {
+            // Planes that every box passes
+            for (int i = 0; i < 6; i++)
+            {
+                constants.planes[i] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+            }
+        }
+
+        compute_pipeline->dispatch(command_buffer, (element_count + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1, &constants);
+
+        // Commands and count are consumed by the indirect draw
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+
+        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    void GpuCulling::recordDraw(const VkCommandBuffer &command_buffer)
+    {
+        PFN_vkCmdDrawIndexedIndirectCountKHR draw_indexed_indirect_count = l_device->getDrawIndexedIndirectCount();
+
+        if (draw_indexed_indirect_count != nullptr)
+        {
+            draw_indexed_indirect_count(command_buffer, commands->getStorageBuffer(), 0, count->getStorageBuffer(), 0,
+                                        element_count, sizeof(VkDrawIndexedIndirectCommand));
+        }
+        else
+        {
+            vkCmdDrawIndexedIndirect(command_buffer, commands->getStorageBuffer(), 0, element_count, sizeof(VkDrawIndexedIndirectCommand));
+        }
+    }
+}
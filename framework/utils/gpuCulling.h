@@ -0,0 +1,106 @@
+#pragma once
+
+#include <devices/logicalDevice.h>
+#include <core/pipeline.h>
+#include <core/computePipeline.h>
+#include <core/storageBuffer.h>
+#include <utils/frustum.h>
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <memory>
+
+namespace framework
+{
+    struct GpuCullingConfiguration
+    {
+        // SPIR-V compiled from framework/shaders/frustumCulling.comp
+        std::string shader_path = "framework/shaders/frustumCulling.spv";
+        // Optional per element transforms (element i uses matrix i) applied after the pipeline model matrix,
+        // e.g. the output buffer of a TransformHierarchy. It must hold at least one matrix per element
+        std::shared_ptr<StorageBuffer<glm::mat4>> instance_transforms;
+    };
+
+    /**
+     * @brief Moves the per-element frustum culling of a pipeline on the GPU. A compute shader tests the element bounds,
+     * compacts the visible elements into indirect draw commands and counts them, then the draw is issued with
+     * vkCmdDrawIndexedIndirectCount, so that the CPU cost does not depend on the number of elements.
+     * Without VK_KHR_draw_indirect_count the commands buffer is cleared every frame and all its slots are drawn
+     * (culled slots have zero indices). Every command draws the pipeline number of instances, as the CPU culled draws.
+     * If the device supports drawIndirectFirstInstance and the pipeline draws a single instance without an instance binding,
+     * the first instance of every command is the element index, so that shaders can fetch per element data through
+     * gl_InstanceIndex. Otherwise the first instance is zero, so that per instance vertex attributes start from the first one.
+     */
+    class GpuCulling
+    {
+    public:
+        /**
+         * @throws Runtime Exception if the collection is not allocated, the device supports neither draw indirect count
+         * nor multi draw indirect, the elements exceed the indirect draw count limit or the instance transforms are fewer than the elements
+         */
+        GpuCulling(const std::shared_ptr<LogicalDevice> &l_device, const std::shared_ptr<Pipeline> &pipeline, const GpuCullingConfiguration &config);
+
+        /**
+         * @brief Uploads the element bounds and index ranges again (e.g. after the collection elements have been updated)
+         */
+        void updateElements();
+
+        /**
+         * @brief Records the counter reset and the culling dispatch. Must be recorded outside of the render pass.
+         * A null frustum keeps all the elements
+         */
+        void recordCulling(const VkCommandBuffer &command_buffer, const Frustum *frustum);
+
+        /**
+         * @brief Records the indirect draw of the visible elements. The pipeline and its buffers must be already bound
+         */
+        void recordDraw(const VkCommandBuffer &command_buffer);
+
+        // Getters
+        const std::shared_ptr<Pipeline> &getPipeline() { return pipeline; }
+        const VkBuffer &getElementsBuffer() { return elements->getStorageBuffer(); }
+        const VkBuffer &getCommandsBuffer() { return commands->getStorageBuffer(); }
+        const VkBuffer &getCountBuffer() { return count->getStorageBuffer(); }
+
+    private:
+        static constexpr uint32_t WORKGROUP_SIZE = 64;
+
+        // Shader flags
+        static constexpr uint32_t USE_INSTANCE_TRANSFORMS = 1;
+        static constexpr uint32_t WRITE_FIRST_INSTANCE = 2;
+
+        // std430 layouts of the shader
+        struct Element
+        {
+            glm::vec4 bounds_min;
+            glm::vec4 bounds_max;
+            uint32_t first_index;
+            uint32_t index_count;
+            int32_t vertex_offset;
+            uint32_t padding;
+        };
+
+        struct PushConstants
+        {
+            glm::vec4 planes[6];
+            uint32_t element_count;
+            uint32_t flags;
+            uint32_t instance_count;
+            uint32_t padding;
+        };
+
+        std::shared_ptr<LogicalDevice> l_device;
+        std::shared_ptr<Pipeline> pipeline;
+
+        uint32_t element_count = 0;
+        uint32_t flags = 0;
+
+        std::shared_ptr<StorageBuffer<Element>> elements;
+        std::shared_ptr<StorageBuffer<glm::mat4>> instance_transforms;
+        std::shared_ptr<StorageBuffer<VkDrawIndexedIndirectCommand>> commands;
+        std::shared_ptr<StorageBuffer<uint32_t>> count;
+
+        std::unique_ptr<ComputePipeline> compute_pipeline;
+    };
+}
@@ -0,0 +1,367 @@
+#include "gpuProfiler.h"
+
+#include <stdexcept>
+#include <algorithm>
+
+namespace framework
+{
+    GpuProfiler::GpuProfiler(const std::shared_ptr<LogicalDevice> &l_device, const GpuProfilerConfiguration &config)
+    {
+        if (l_device == nullptr)
+        {
+            throw std::runtime_error("[GpuProfiler] Null logical device instance");
+        }
+
+        if (config.frames_in_flight == 0 || config.max_scopes == 0 || config.history == 0)
+        {
+            throw std::runtime_error("[GpuProfiler] Null frames in flight, scopes or history");
+        }
+
+        if (config.pipeline_statistics && !l_device->getEnabledFeatures().pipelineStatisticsQuery)
+        {
+            throw std::runtime_error("[GpuProfiler] Pipeline statistics queries not supported by the device");
+        }
+
+        this->l_device = l_device;
+        this->config = config;
+
+        // Timestamps are written on the graphics queue
+        VkPhysicalDevice physical_device = l_device->getPhysicalDevice()->getDevice();
+        uint32_t family = l_device->findQueueFamilies(VK_NULL_HANDLE).graphics_family.value();
+        uint32_t family_count = 0;
+
+        vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &family_count, nullptr);
+        std::vector<VkQueueFamilyProperties> families(family_count);
+        vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &family_count, families.data());
+
+        uint32_t valid_bits = families[family].timestampValidBits;
+
+        if (valid_bits == 0)
+        {
+            throw std::runtime_error("[GpuProfiler] Timestamps not supported by the graphics queue");
+        }
+
+        timestamp_mask = valid_bits >= 64 ? ~0ull : (1ull << valid_bits) - 1;
+        timestamp_period = l_device->getPhysicalDevice()->getProperties().limits.timestampPeriod;
+
+        frame_pools.resize(config.frames_in_flight);
+
+        for (FramePool &frame_pool : frame_pools)
+        {
+            frame_pool.pool = createQueryPool(VK_QUERY_TYPE_TIMESTAMP);
+
+            if (config.pipeline_statistics)
+            {
+                frame_pool.statistics_pool = createQueryPool(VK_QUERY_TYPE_PIPELINE_STATISTICS);
+            }
+        }
+
+        immediate_pool = createQueryPool(VK_QUERY_TYPE_TIMESTAMP);
+    }
+
+    GpuProfiler::~GpuProfiler()
+    {
+        std::vector<VkQueryPool> pools{immediate_pool};
+
+        for (const FramePool &frame_pool : frame_pools)
+        {
+            pools.push_back(frame_pool.pool);
+
+            if (frame_pool.statistics_pool != VK_NULL_HANDLE)
+            {
+                pools.push_back(frame_pool.statistics_pool);
+            }
+        }
+
+        // The last frames may still write their timestamps
+        l_device->destroyDeferred([pools](VkDevice device)
+                                  {
+            for (VkQueryPool pool : pools)
+            {
+                vkDestroyQueryPool(device, pool, nullptr);
+            } });
+    }
+
+    uint32_t GpuProfiler::registerScope(const std::string &name, bool pipeline_statistics)
+    {
+        auto found = std::find(names.begin(), names.end(), name);
+
+        if (found != names.end())
+        {
+            uint32_t scope = static_cast<uint32_t>(found - names.begin());
+
+            if (pipeline_statistics && config.pipeline_statistics && !histories[scope].pipeline_statistics)
+            {
+                histories[scope].pipeline_statistics = true;
+                histories[scope].statistics.resize(config.history);
+            }
+
+            return scope;
+        }
+
+        if (names.size() >= config.max_scopes)
+        {
+            throw std::runtime_error("[GpuProfiler] Maximum number of scopes exceeded");
+        }
+
+        ScopeHistory history;
+        history.samples.resize(config.history);
+        history.pipeline_statistics = pipeline_statistics && config.pipeline_statistics;
+
+        if (history.pipeline_statistics)
+        {
+            history.statistics.resize(config.history);
+        }
+
+        names.push_back(name);
+        histories.push_back(std::move(history));
+
+        return static_cast<uint32_t>(names.size() - 1);
+    }
+
+    void GpuProfiler::beginFrame()
+    {
+        beginFrame(current_slot + 1);
+    }
+
+    void GpuProfiler::beginFrame(uint32_t slot)
+    {
+        current_slot = slot % frame_pools.size();
+
+        // Not completed in time, the pool is reset by the new frame
+        if (frame_pools[current_slot].pending)
+        {
+            frame_pools[current_slot].pending = false;
+            dropped_frames++;
+        }
+    }
+
+    void GpuProfiler::recordReset(const VkCommandBuffer &cmd)
+    {
+        vkCmdResetQueryPool(cmd, frame_pools[current_slot].pool, 0, config.max_scopes * 2);
+
+        if (frame_pools[current_slot].statistics_pool != VK_NULL_HANDLE)
+        {
+            vkCmdResetQueryPool(cmd, frame_pools[current_slot].statistics_pool, 0, config.max_scopes);
+        }
+    }
+
+    void GpuProfiler::beginScope(const VkCommandBuffer &cmd, uint32_t scope)
+    {
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame_pools[current_slot].pool, scope * 2);
+
+        if (histories[scope].pipeline_statistics)
+        {
+            vkCmdBeginQuery(cmd, frame_pools[current_slot].statistics_pool, scope, 0);
+        }
+    }
+
+    void GpuProfiler::endScope(const VkCommandBuffer &cmd, uint32_t scope)
+    {
+        if (histories[scope].pipeline_statistics)
+        {
+            vkCmdEndQuery(cmd, frame_pools[current_slot].statistics_pool, scope);
+        }
+
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame_pools[current_slot].pool, scope * 2 + 1);
+    }
+
+    void GpuProfiler::endFrame(uint64_t frame)
+    {
+        frame_pools[current_slot].pending = true;
+        frame_pools[current_slot].frame = frame;
+    }
+
+    void GpuProfiler::collect(uint64_t completed_frame)
+    {
+        for (FramePool &frame_pool : frame_pools)
+        {
+            if (!frame_pool.pending || frame_pool.frame > completed_frame)
+            {
+                continue;
+            }
+
+            // Scopes not recorded in the frame stay unavailable
+            for (uint32_t scope = 0; scope < names.size(); scope++)
+            {
+                float duration;
+
+                if (readScope(frame_pool.pool, scope, false, duration))
+                {
+                    addSample(scope, duration);
+                }
+
+                PipelineStatistics statistics;
+
+                if (histories[scope].pipeline_statistics && readStatistics(frame_pool.statistics_pool, scope, statistics))
+                {
+                    addStatistics(scope, statistics);
+                }
+            }
+
+            frame_pool.pending = false;
+        }
+    }
+
+    void GpuProfiler::beginImmediateScope(const VkCommandBuffer &cmd, uint32_t scope)
+    {
+        vkCmdResetQueryPool(cmd, immediate_pool, scope * 2, 2);
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, immediate_pool, scope * 2);
+    }
+
+    void GpuProfiler::endImmediateScope(const VkCommandBuffer &cmd, uint32_t scope)
+    {
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, immediate_pool, scope * 2 + 1);
+    }
+
+    void GpuProfiler::resolveImmediateScope(uint32_t scope)
+    {
+        // The submission is already completed, the wait does not stall
+        float duration;
+
+        if (readScope(immediate_pool, scope, true, duration))
+        {
+            addSample(scope, duration);
+        }
+    }
+
+    GpuScopeStatistics GpuProfiler::getStatistics(uint32_t scope)
+    {
+        GpuScopeStatistics statistics;
+        const ScopeHistory &history = histories.at(scope);
+
+        if (history.statistics_count > 0)
+        {
+            PipelineStatistics total;
+
+            for (uint32_t i = 0; i < history.statistics_count; i++)
+            {
+                total.input_assembly_primitives += history.statistics[i].input_assembly_primitives;
+                total.vertex_invocations += history.statistics[i].vertex_invocations;
+                total.clipping_primitives += history.statistics[i].clipping_primitives;
+                total.fragment_invocations += history.statistics[i].fragment_invocations;
+            }
+
+            statistics.average_pipeline_statistics.input_assembly_primitives = total.input_assembly_primitives / history.statistics_count;
+            statistics.average_pipeline_statistics.vertex_invocations = total.vertex_invocations / history.statistics_count;
+            statistics.average_pipeline_statistics.clipping_primitives = total.clipping_primitives / history.statistics_count;
+            statistics.average_pipeline_statistics.fragment_invocations = total.fragment_invocations / history.statistics_count;
+
+            // The last one is right before the next slot
+            statistics.last_pipeline_statistics = history.statistics[(history.statistics_next + history.statistics.size() - 1) % history.statistics.size()];
+            statistics.pipeline_statistics_samples = history.statistics_count;
+        }
+
+        if (history.count == 0)
+        {
+            return statistics;
+        }
+
+        std::vector<float> sorted(history.samples.begin(), history.samples.begin() + history.count);
+        std::sort(sorted.begin(), sorted.end());
+
+        float total = 0;
+        for (float sample : sorted)
+        {
+            total += sample;
+        }
+
+        statistics.last = history.last;
+        statistics.min = sorted.front();
+        statistics.average = total / sorted.size();
+        statistics.p99 = sorted[(sorted.size() - 1) * 99 / 100];
+        statistics.samples = history.count;
+
+        return statistics;
+    }
+
+    VkQueryPool GpuProfiler::createQueryPool(VkQueryType type)
+    {
+        VkQueryPoolCreateInfo pool_info{};
+        pool_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        pool_info.queryType = type;
+
+        if (type == VK_QUERY_TYPE_PIPELINE_STATISTICS)
+        {
+            pool_info.queryCount = config.max_scopes;
+            pool_info.pipelineStatistics = STATISTICS;
+        }
+        else
+        {
+            pool_info.queryCount = config.max_scopes * 2;
+        }
+
+        VkQueryPool pool;
+
+        if (vkCreateQueryPool(l_device->getDevice(), &pool_info, nullptr, &pool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("[GpuProfiler] Error creating the query pool");
+        }
+
+        return pool;
+    }
+
+    bool GpuProfiler::readScope(VkQueryPool pool, uint32_t scope, bool wait, float &duration)
+    {
+        // Every timestamp is followed by its availability
+        uint64_t results[4] = {0, 0, 0, 0};
+        VkQueryResultFlags flags = VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT;
+
+        if (wait)
+        {
+            flags |= VK_QUERY_RESULT_WAIT_BIT;
+        }
+
+        VkResult result = vkGetQueryPoolResults(l_device->getDevice(), pool, scope * 2, 2, sizeof(results), results, sizeof(uint64_t) * 2, flags);
+
+        if ((result != VK_SUCCESS && result != VK_NOT_READY) || results[1] == 0 || results[3] == 0)
+        {
+            return false;
+        }
+
+        uint64_t ticks = ((results[2] & timestamp_mask) - (results[0] & timestamp_mask)) & timestamp_mask;
+        duration = static_cast<float>(ticks * static_cast<double>(timestamp_period) / 1e6);
+
+        return true;
+    }
+
+    bool GpuProfiler::readStatistics(VkQueryPool pool, uint32_t scope, PipelineStatistics &statistics)
+    {
+        // The four counters followed by the availability
+        uint64_t results[5] = {0, 0, 0, 0, 0};
+        VkQueryResultFlags flags = VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT;
+
+        VkResult result = vkGetQueryPoolResults(l_device->getDevice(), pool, scope, 1, sizeof(results), results, sizeof(results), flags);
+
+        if ((result != VK_SUCCESS && result != VK_NOT_READY) || results[4] == 0)
+        {
+            return false;
+        }
+
+        statistics.input_assembly_primitives = results[0];
+        statistics.vertex_invocations = results[1];
+        statistics.clipping_primitives = results[2];
+        statistics.fragment_invocations = results[3];
+
+        return true;
+    }
+
+    void GpuProfiler::addSample(uint32_t scope, float duration)
+    {
+        ScopeHistory &history = histories[scope];
+
+        history.samples[history.next] = duration;
+        history.next = (history.next + 1) % history.samples.size();
+        history.count = std::min<uint32_t>(history.count + 1, history.samples.size());
+        history.last = duration;
+    }
+
+    void GpuProfiler::addStatistics(uint32_t scope, const PipelineStatistics &statistics)
+    {
+        ScopeHistory &history = histories[scope];
+
+        history.statistics[history.statistics_next] = statistics;
+        history.statistics_next = (history.statistics_next + 1) % history.statistics.size();
+        history.statistics_count = std::min<uint32_t>(history.statistics_count + 1, history.statistics.size());
+    }
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <devices/logicalDevice.h>
+
+#include <vulkan/vulkan.h>
+#include <vector>
+#include <string>
+#include <memory>
+
+namespace framework
+{
+    struct GpuProfilerConfiguration
+    {
+        // Query pools, one per frame in flight: a pool is read back only once its frame is completed
+        uint32_t frames_in_flight = 2;
+        // Maximum number of scopes, each one uses two timestamp queries per pool
+        uint32_t max_scopes = 64;
+        // Samples of every scope kept for the rolling statistics
+        uint32_t history = 240;
+        // Pipeline statistics queries inside the scopes registered with them (needs the pipelineStatisticsQuery feature)
+        bool pipeline_statistics = false;
+    };
+
+    struct PipelineStatistics
+    {
+        uint64_t input_assembly_primitives = 0;
+        uint64_t vertex_invocations = 0;
+        uint64_t clipping_primitives = 0;
+        uint64_t fragment_invocations = 0;
+    };
+
+    struct GpuScopeStatistics
+    {
+        // GPU durations in milliseconds, over the last samples of the scope
+        float last = 0;
+        float min = 0;
+        float average = 0;
+        float p99 = 0;
+        uint32_t samples = 0;
+        // Pipeline statistics of the last sample and their average over the kept samples (zero without statistics)
+        PipelineStatistics last_pipeline_statistics;
+        PipelineStatistics average_pipeline_statistics;
+        uint32_t pipeline_statistics_samples = 0;
+    };
+
+    /**
+     * @brief Measures the GPU time of named scopes with timestamp queries. Frame scopes are written inside the frame command
+     * buffers into the pool of the current frame, which is read back (never waited) once the frame is known to be completed.
+     * Immediate scopes are written inside separately submitted command buffers (e.g. uploads) and read back after the caller
+     * waited for their submission. Timestamps are converted with the device timestampPeriod.
+     * Frame scopes can also count primitives and shader invocations with pipeline statistics queries, read back in the same way.
+     * Those scopes must begin and end inside the same subpass and must not be nested between each other.
+     * Scopes must be registered before recording, scope commands can then be recorded concurrently on different command buffers.
+     */
+    class GpuProfiler
+    {
+    public:
+        /**
+         * @throws Runtime Exception if the graphics queue does not support timestamps or the pipeline statistics are requested
+         * without the pipelineStatisticsQuery feature
+         */
+        GpuProfiler(const std::shared_ptr<LogicalDevice> &l_device, const GpuProfilerConfiguration &config);
+        ~GpuProfiler();
+
+        /**
+         * @brief Registers a scope, or finds the one with the same name
+         * @param pipeline_statistics Whether the frame scope also collects pipeline statistics (if enabled in the configuration)
+         * @return The scope index, to be passed to the scope commands
+         * @throws Runtime Exception if the maximum number of scopes is exceeded
+         */
+        uint32_t registerScope(const std::string &name, bool pipeline_statistics = false);
+
+        /**
+         * @brief Moves to the pool of the next frame. The results of the pool not collected yet are dropped
+         */
+        void beginFrame();
+
+        /**
+         * @brief Moves to the pool of the passed slot (modulo the frames in flight), for command buffers recorded once and
+         * submitted many times (e.g. one per swap chain image). The results of the pool not collected yet are dropped
+         */
+        void beginFrame(uint32_t slot);
+
+        /**
+         * @brief Records the reset of the current frame pool. Must be recorded outside of the render pass before any frame scope
+         */
+        void recordReset(const VkCommandBuffer &cmd);
+
+        /**
+         * @brief Records the timestamps of the scope inside the current frame pool, and its pipeline statistics query
+         */
+        void beginScope(const VkCommandBuffer &cmd, uint32_t scope);
+        void endScope(const VkCommandBuffer &cmd, uint32_t scope);
+
+        /**
+         * @brief Marks the current pool as submitted with the passed frame number (e.g. LogicalDevice::advanceFrame)
+         */
+        void endFrame(uint64_t frame);
+
+        /**
+         * @brief Reads back, without waiting, the pools of the frames up to the completed one and adds their samples
+         */
+        void collect(uint64_t completed_frame);
+
+        /**
+         * @brief Records the reset and the first timestamp of the scope inside a command buffer submitted on its own.
+         * Immediate scopes share their queries, submissions must be completed and resolved one at a time
+         */
+        void beginImmediateScope(const VkCommandBuffer &cmd, uint32_t scope);
+        void endImmediateScope(const VkCommandBuffer &cmd, uint32_t scope);
+
+        /**
+         * @brief Adds the sample of the immediate scope, once the caller waited for its submission
+         */
+        void resolveImmediateScope(uint32_t scope);
+
+        /**
+         * @brief Rolling statistics of the scope samples
+         */
+        GpuScopeStatistics getStatistics(uint32_t scope);
+
+        // Getters
+        const std::vector<std::string> &getScopeNames() { return names; }
+        uint32_t getFrameSlot() { return current_slot; }
+        uint64_t getDroppedFrames() { return dropped_frames; }
+
+    private:
+        // Counters of the pipeline statistics pools, the results follow the bits order
+        static constexpr VkQueryPipelineStatisticFlags STATISTICS = VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+                                                                    VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+                                                                    VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+                                                                    VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+        struct FramePool
+        {
+            VkQueryPool pool = VK_NULL_HANDLE;
+            // One query per scope, VK_NULL_HANDLE without pipeline statistics
+            VkQueryPool statistics_pool = VK_NULL_HANDLE;
+            bool pending = false;
+            uint64_t frame = 0;
+        };
+
+        struct ScopeHistory
+        {
+            std::vector<float> samples;
+            uint32_t next = 0;
+            uint32_t count = 0;
+            float last = 0;
+
+            bool pipeline_statistics = false;
+            std::vector<PipelineStatistics> statistics;
+            uint32_t statistics_next = 0;
+            uint32_t statistics_count = 0;
+        };
+
+        /**
+         * @brief Creates a query pool with two timestamp queries or one pipeline statistics query per scope
+         */
+        VkQueryPool createQueryPool(VkQueryType type);
+
+        /**
+         * @brief Reads the two timestamps of the scope, without waiting unless requested
+         * @return true if both are available, with the duration in milliseconds
+         */
+        bool readScope(VkQueryPool pool, uint32_t scope, bool wait, float &duration);
+
+        /**
+         * @brief Reads the pipeline statistics of the scope without waiting
+         * @return true if they are available
+         */
+        bool readStatistics(VkQueryPool pool, uint32_t scope, PipelineStatistics &statistics);
+
+        /**
+         * @brief Adds the duration to the scope history ring
+         */
+        void addSample(uint32_t scope, float duration);
+
+        /**
+         * @brief Adds the pipeline statistics to the scope history ring
+         */
+        void addStatistics(uint32_t scope, const PipelineStatistics &statistics);
+
+        std::shared_ptr<LogicalDevice> l_device;
+        GpuProfilerConfiguration config;
+
+        // Nanoseconds per timestamp tick and mask of the valid timestamp bits
+        float timestamp_period = 1;
+        uint64_t timestamp_mask = ~0ull;
+
+        std::vector<FramePool> frame_pools;
+        uint32_t current_slot = 0;
+        uint64_t dropped_frames = 0;
+
+        VkQueryPool immediate_pool = VK_NULL_HANDLE;
+
+        std::vector<std::string> names;
+        std::vector<ScopeHistory> histories;
+    };
+}
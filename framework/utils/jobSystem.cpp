@@ -0,0 +1,337 @@
+#include "jobSystem.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace framework
+{
+    // Index of the worker deque owned by the calling thread, -1 for the threads outside of the job system
+    static thread_local int32_t worker_index = -1;
+
+    JobSystem::JobSystem()
+    {
+        main_thread = std::this_thread::get_id();
+
+        // The waiting threads execute jobs too, one less worker than the hardware threads
+        uint32_t threads = std::thread::hardware_concurrency();
+
+        for (uint32_t i = 1; i < threads; i++)
+        {
+            queues.push_back(std::make_unique<WorkerQueue>());
+        }
+
+        for (uint32_t i = 0; i < queues.size(); i++)
+        {
+            workers.emplace_back(&JobSystem::workerLoop, this, i);
+        }
+    }
+
+    JobSystem::~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            stop = true;
+        }
+        sleep_condition.notify_all();
+
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    void JobSystem::run(std::function<void()> job, JobCounter *counter)
+    {
+        if (counter != nullptr)
+        {
+            counter->pending++;
+        }
+
+        schedule([this, job = std::move(job), counter]
+                 {
+            job();
+            complete(counter); });
+    }
+
+    void JobSystem::run(std::function<void()> job, JobCounter *counter, JobCounter &dependency)
+    {
+        if (counter != nullptr)
+        {
+            counter->pending++;
+        }
+
+        std::function<void()> wrapped = [this, job = std::move(job), counter]
+        {
+            job();
+            complete(counter);
+        };
+
+        {
+            std::lock_guard<std::mutex> lock(dependency.mutex);
+
+            // The dependency completes under its mutex, so the job is either stored before or scheduled here
+            if (dependency.pending.load() != 0)
+            {
+                dependency.dependents.push_back(std::move(wrapped));
+                return;
+            }
+        }
+
+        schedule(std::move(wrapped));
+    }
+
+    void JobSystem::runOnMainThread(std::function<void()> job, JobCounter *counter)
+    {
+        if (isMainThread())
+        {
+            job();
+            return;
+        }
+
+        if (counter != nullptr)
+        {
+            counter->pending++;
+        }
+
+        std::lock_guard<std::mutex> lock(main_mutex);
+        main_jobs.push_back([this, job = std::move(job), counter]
+                            {
+            job();
+            complete(counter); });
+    }
+
+    void JobSystem::pumpMainThread()
+    {
+        if (!isMainThread())
+        {
+            throw std::runtime_error("[JobSystem] Main thread jobs pumped by another thread");
+        }
+
+        std::vector<std::function<void()>> jobs;
+
+        {
+            std::lock_guard<std::mutex> lock(main_mutex);
+            jobs.swap(main_jobs);
+        }
+
+        for (auto &job : jobs)
+        {
+            job();
+        }
+    }
+
+    void JobSystem::wait(JobCounter &counter)
+    {
+        bool main = isMainThread();
+
+        while (!counter.isDone())
+        {
+            // The counter may depend on main thread jobs
+            if (main)
+            {
+                pumpMainThread();
+            }
+
+            if (!executeOne())
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        // The last job decrements the counter under its mutex, wait for it to release the counter before returning
+        std::lock_guard<std::mutex> lock(counter.mutex);
+    }
+
+    void JobSystem::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &function)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        if (grain == 0)
+        {
+            grain = std::max<size_t>(1, count / ((workers.size() + 1) * CHUNKS_PER_THREAD));
+        }
+
+        // Not worth waking the workers
+        if (count <= grain || workers.empty())
+        {
+            function(0, count);
+            return;
+        }
+
+        struct Range
+        {
+            const std::function<void(size_t, size_t)> *function;
+            size_t count;
+            size_t grain;
+            size_t chunks;
+            std::atomic<size_t> next_chunk = 0;
+
+            void runChunks()
+            {
+                for (size_t chunk = next_chunk++; chunk < chunks; chunk = next_chunk++)
+                {
+                    size_t begin = chunk * grain;
+                    (*function)(begin, std::min(begin + grain, count));
+                }
+            }
+        };
+
+        Range range;
+        range.function = &function;
+        range.count = count;
+        range.grain = grain;
+        range.chunks = (count + grain - 1) / grain;
+
+        // Every helper job runs chunks until the range is exhausted, the calling thread takes part too
+        JobCounter counter;
+        size_t helpers = std::min<size_t>(range.chunks - 1, workers.size());
+
+        for (size_t i = 0; i < helpers; i++)
+        {
+            run([&range]
+                { range.runChunks(); },
+                &counter);
+        }
+
+        range.runChunks();
+
+        // The range lives on this stack, the helpers must be completed before returning
+        wait(counter);
+    }
+
+    bool JobSystem::isMainThread()
+    {
+        return std::this_thread::get_id() == main_thread;
+    }
+
+    void JobSystem::schedule(std::function<void()> job)
+    {
+        // A single core machine runs everything inline
+        if (queues.empty())
+        {
+            job();
+            return;
+        }
+
+        uint32_t index = worker_index >= 0 ? worker_index : next_queue++ % queues.size();
+
+        {
+            std::lock_guard<std::mutex> lock(queues[index]->mutex);
+            queues[index]->jobs.push_back(std::move(job));
+            queued_jobs++;
+        }
+
+        // Pairs with the sleeping workers increment before checking the queued jobs
+        if (sleeping_workers.load() > 0)
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            sleep_condition.notify_one();
+        }
+    }
+
+    bool JobSystem::tryGetJob(std::function<void()> &job)
+    {
+        if (queued_jobs.load() == 0)
+        {
+            return false;
+        }
+
+        // The owner pops the most recent job (hot in cache) from the back
+        if (worker_index >= 0)
+        {
+            WorkerQueue &own = *queues[worker_index];
+            std::lock_guard<std::mutex> lock(own.mutex);
+
+            if (!own.jobs.empty())
+            {
+                job = std::move(own.jobs.back());
+                own.jobs.pop_back();
+                queued_jobs--;
+                return true;
+            }
+        }
+
+        // Thieves take the oldest jobs from the front, starting from a different victim every thread
+        uint32_t first = worker_index >= 0 ? worker_index + 1 : next_queue.load();
+
+        for (uint32_t i = 0; i < queues.size(); i++)
+        {
+            WorkerQueue &victim = *queues[(first + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+
+            if (!victim.jobs.empty())
+            {
+                job = std::move(victim.jobs.front());
+                victim.jobs.pop_front();
+                queued_jobs--;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void JobSystem::complete(JobCounter *counter)
+    {
+        if (counter == nullptr)
+        {
+            return;
+        }
+
+        std::vector<std::function<void()>> ready;
+
+        {
+            std::lock_guard<std::mutex> lock(counter->mutex);
+
+            if (--counter->pending == 0)
+            {
+                ready.swap(counter->dependents);
+            }
+        }
+
+        for (auto &job : ready)
+        {
+            schedule(std::move(job));
+        }
+    }
+
+    bool JobSystem::executeOne()
+    {
+        std::function<void()> job;
+
+        if (!tryGetJob(job))
+        {
+            return false;
+        }
+
+        job();
+        return true;
+    }
+
+    void JobSystem::workerLoop(uint32_t index)
+    {
+        worker_index = index;
+
+        while (true)
+        {
+            if (executeOne())
+            {
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            sleeping_workers++;
+            sleep_condition.wait(lock, [this]
+                                 { return stop || queued_jobs.load() > 0; });
+            sleeping_workers--;
+
+            if (stop)
+            {
+                return;
+            }
+        }
+    }
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <utils/singleton.h>
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+
+namespace framework
+{
+    /**
+     * @brief Number of pending jobs associated to it. Jobs increment it when submitted and decrement it once completed,
+     * other jobs can depend on it and are scheduled when it reaches zero. It must outlive the jobs that reference it
+     */
+    class JobCounter
+    {
+        friend class JobSystem;
+
+    public:
+        JobCounter() = default;
+        JobCounter(const JobCounter &) = delete;
+        JobCounter &operator=(const JobCounter &) = delete;
+
+        // Getters
+        inline bool isDone() const { return pending.load() == 0; }
+        inline uint32_t getPending() const { return pending.load(); }
+
+    private:
+        std::atomic<uint32_t> pending = 0;
+
+        // Jobs waiting for the counter to reach zero, protected by mutex
+        std::mutex mutex;
+        std::vector<std::function<void()>> dependents;
+    };
+
+    /**
+     * @brief Work stealing job system shared by the whole framework. Every worker (one less than the hardware threads)
+     * owns a deque: it pushes and pops its own jobs from the back while idle workers steal from the front of the others.
+     * Threads waiting for a counter execute jobs meanwhile, so nested parallel loops do not deadlock and a single core machine
+     * simply runs everything inline. The thread that first uses the job system is the main one: jobs submitted with
+     * runOnMainThread (e.g. GLFW calls) are executed only there, when pumpMainThread is called or while it waits.
+     */
+    class JobSystem : public Singleton<JobSystem>
+    {
+        friend Singleton<JobSystem>;
+
+    public:
+        ~JobSystem();
+
+        /**
+         * @brief Schedules the job, incrementing the counter (if any) until it completes. The job must not throw
+         */
+        void run(std::function<void()> job, JobCounter *counter = nullptr);
+
+        /**
+         * @brief Schedules the job once the dependency counter reaches zero (immediately if it already did)
+         */
+        void run(std::function<void()> job, JobCounter *counter, JobCounter &dependency);
+
+        /**
+         * @brief Queues the job for the main thread, incrementing the counter (if any) until it completes.
+         * If called by the main thread the job is executed immediately
+         */
+        void runOnMainThread(std::function<void()> job, JobCounter *counter = nullptr);
+
+        /**
+         * @brief Executes the jobs queued for the main thread. Called once per frame by Window::run
+         * @throws Runtime Exception if not called by the main thread
+         */
+        void pumpMainThread();
+
+        /**
+         * @brief Returns once the counter reaches zero, executing other jobs meanwhile
+         */
+        void wait(JobCounter &counter);
+
+        /**
+         * @brief Splits the [0, count) range in chunks of grain elements and runs function(begin, end) on every chunk
+         * using the workers and the calling thread. Returns when all the chunks are completed. With grain 0 the chunk size
+         * is chosen so that every thread gets a few chunks to balance the load. The function must not throw.
+         */
+        void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)> &function);
+
+        // Getters
+        inline uint32_t getWorkersNumber() { return workers.size(); }
+        bool isMainThread();
+
+    private:
+        JobSystem();
+
+        // Chunks assigned to every thread with automatic grain, more than one so that faster threads steal the remaining ones
+        static constexpr size_t CHUNKS_PER_THREAD = 4;
+
+        struct alignas(64) WorkerQueue
+        {
+            std::mutex mutex;
+            std::deque<std::function<void()>> jobs;
+        };
+
+        /**
+         * @brief Pushes the job in the deque of the calling worker, or of a worker picked round robin for other threads
+         */
+        void schedule(std::function<void()> job);
+
+        /**
+         * @brief Pops a job from the calling worker deque or steals one from the others
+         * @return true if a job has been found
+         */
+        bool tryGetJob(std::function<void()> &job);
+
+        /**
+         * @brief Decrements the counter and schedules its dependents once it reaches zero
+         */
+        void complete(JobCounter *counter);
+
+        /**
+         * @brief Executes one pending job if there is any (main thread jobs first when called by the main thread)
+         * @return true if a job has been executed
+         */
+        bool executeOne();
+
+        /**
+         * @brief Executes jobs until stopped, sleeping when none is available
+         */
+        void workerLoop(uint32_t index);
+
+        std::vector<std::thread> workers;
+        std::vector<std::unique_ptr<WorkerQueue>> queues;
+
+        // Jobs inside the deques, used to put the workers to sleep
+        std::atomic<size_t> queued_jobs = 0;
+        std::atomic<uint32_t> sleeping_workers = 0;
+        std::atomic<uint32_t> next_queue = 0;
+        std::mutex sleep_mutex;
+        std::condition_variable sleep_condition;
+        bool stop = false;
+
+        std::thread::id main_thread;
+        std::mutex main_mutex;
+        std::vector<std::function<void()>> main_jobs;
+    };
+}
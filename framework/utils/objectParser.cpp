@@ -6,6 +6,10 @@
 #include <iostream>
 #include <sstream>
 #include <algorithm>
+#include <cstring>
+
+#include <utils/vertexCompression.h>
+#include <utils/traceProfiler.h>
 
 #define TINYOBJLOADER_IMPLEMENTATION
 #include <libs/tiny_obj_loader.h>
@@ -63,11 +67,16 @@ namespace framework
     }
 
     /**
-     * @brief Given the tinyobj shape, the method parses its vertices/indices producing
-     * a final drawable element which can be then rendered by the framework.
+     * @brief Checks that the passed format is one of the allowed ones for the attribute
+     * @throws Runtime Exception if the format is not allowed
      */
-    std::shared_ptr<DefaultDrawableElement> getParsedDrawableElement(uint32_t vertex_size,
-                                                                     const tinyobj::shape_t &shape,
+    void checkAttributeFormat(VertexAttributes::DrawableAttribute format, const std::vector<VertexAttributes::DrawableAttribute> &allowed, const std::string &name)
+    {
+        if (std::find(allowed.begin(), allowed.end(), format) == allowed.end())
+            throw runtime_error("[ObjectParser] Unsupported " + name + " format");
+    }
+
+    std::shared_ptr<DefaultDrawableElement> getParsedDrawableElement(const tinyobj::shape_t &shape,
                                                                      const tinyobj::attrib_t &attrib,
                                                                      const std::vector<tinyobj::material_t> &materials,
                                                                      const ObjectParserConfiguration &config)
@@ -78,13 +87,13 @@ namespace framework
         bool has_transparency = false;
 
         // Add the vertex attributes depending on the config file
-        vertex_attributes.push_back(VertexAttributes::DrawableAttribute::F3); // XYZ coordinates
+        vertex_attributes.push_back(config.position_format); // XYZ coordinates
         if (config.has_texture)
-            vertex_attributes.push_back(VertexAttributes::DrawableAttribute::F2); // UV coordinates
+            vertex_attributes.push_back(config.texture_format); // UV coordinates
         if (config.has_normals)
-            vertex_attributes.push_back(VertexAttributes::DrawableAttribute::F3); // Normals
+            vertex_attributes.push_back(config.normal_format); // Normals
         if (config.add_medians)
-            vertex_attributes.push_back(VertexAttributes::DrawableAttribute::F3); // Medians added by user
+            vertex_attributes.push_back(config.median_format); // Medians added by user
         if (config.has_texture)
             vertex_attributes.push_back(VertexAttributes::DrawableAttribute::I1); // In case of multiple textures, include the texture index
 
@@ -98,53 +107,64 @@ namespace framework
             break;
         }
 
-        for (size_t i = 0; i < shape.mesh.indices.size(); i++)
+        size_t vertices_number = shape.mesh.indices.size();
+        bool unorm_texture = config.texture_format == VertexAttributes::DrawableAttribute::U16N2;
+
+        // Attribute streams
+        std::vector<float> positions, textures, normals, medians;
+        std::vector<uint32_t> material_indices;
+
+        positions.reserve(vertices_number * 3);
+        if (config.has_texture)
+        {
+            textures.reserve(vertices_number * 2);
+            material_indices.reserve(vertices_number);
+        }
+        if (config.has_normals)
+            normals.reserve(vertices_number * 3);
+        if (config.add_medians)
+            medians.resize(vertices_number * 3, 0.0f);
+        indices.reserve(vertices_number);
+
+        for (size_t i = 0; i < vertices_number; i++)
         {
             const tinyobj::index_t &index = shape.mesh.indices[i];
 
             // Insert the vertex
-            vertices.push_back((config.right_handed_ref ? -1 : 1) * attrib.vertices[3 * index.vertex_index + 0] * config.multiplication_factor);
-            vertices.push_back(attrib.vertices[3 * index.vertex_index + 1] * config.multiplication_factor);
-            vertices.push_back(attrib.vertices[3 * index.vertex_index + 2] * config.multiplication_factor);
+            positions.push_back((config.right_handed_ref ? -1 : 1) * attrib.vertices[3 * index.vertex_index + 0] * config.multiplication_factor);
+            positions.push_back(attrib.vertices[3 * index.vertex_index + 1] * config.multiplication_factor);
+            positions.push_back(attrib.vertices[3 * index.vertex_index + 2] * config.multiplication_factor);
 
             if (config.has_texture)
             {
-                // Insert the texture coordinates
-                vertices.push_back(attrib.texcoords[2 * index.texcoord_index + 0]);
-                vertices.push_back((config.invert_texture ? -1 : 1) * attrib.texcoords[2 * index.texcoord_index + 1]);
+                // Insert the texture coordinates (unorm formats cannot store negative values, 1 - v is the same with repeat sampling)
+                float v = attrib.texcoords[2 * index.texcoord_index + 1];
+                textures.push_back(attrib.texcoords[2 * index.texcoord_index + 0]);
+                textures.push_back(config.invert_texture ? (unorm_texture ? 1.0f - v : -v) : v);
+
+                uint16_t material_index = shape.mesh.material_ids[i / 3];
+
+                // Insert the material index inside the vertex (/3 because it is the same for every vertex in the same triangle)
+                material_indices.push_back((has_transparency ? 0x1 << 31 : 0x0) | material_index);
             }
 
             if (config.has_normals)
             {
                 // Insert the normal coordinates
-                vertices.push_back((config.right_handed_ref ? -1 : 1) * attrib.normals[3 * index.normal_index + 0]);
-                vertices.push_back(attrib.normals[3 * index.normal_index + 1]);
-                vertices.push_back(attrib.normals[3 * index.normal_index + 2]);
+                normals.push_back((config.right_handed_ref ? -1 : 1) * attrib.normals[3 * index.normal_index + 0]);
+                normals.push_back(attrib.normals[3 * index.normal_index + 1]);
+                normals.push_back(attrib.normals[3 * index.normal_index + 2]);
             }
 
             if (config.add_medians)
             {
                 // Insert point with 1 on the axis of this index % 3
-                std::vector<float> med;
-                med.insert(med.end(), {0, 0, 0});
-
                 // Total length is 1 and the position depends on the vertex in the triangle
-                med[indices.size() % 3] = 1.0f;
-
-                // Insert the median inside the vertices
-                vertices.push_back(med[0]);
-                vertices.push_back(med[1]);
-                vertices.push_back(med[2]);
+                medians[i * 3 + indices.size() % 3] = 1.0f;
             }
 
-            uint16_t material_index = shape.mesh.material_ids[i / 3];
-            uint32_t material_data = (has_transparency ? 0x1 << 31 : 0x0) | material_index;
-
-            // Insert the material index inside the vertex (/3 because it is the same for every vertex in the same triangle)
-            vertices.push_back(*reinterpret_cast<float *>(&material_data));
-
             // Insert the index
-            indices.push_back((vertices.size() / vertex_size) - 1);
+            indices.push_back(i);
 
             // If just finished to insert a triangle, when it is a right handed reference, swap the indices
             if (config.right_handed_ref && indices.size() % 3 == 0)
@@ -155,12 +175,46 @@ namespace framework
             }
         }
 
+        // Encode the streams inside the interleaved vertex buffer
+        uint32_t vertex_size = VertexAttributes(vertex_attributes).getStride() / sizeof(float);
+        uint32_t offset = 0;
+        vertices.resize(vertices_number * vertex_size);
+
+        encodeVertexAttribute(config.position_format, positions.data(), 3, vertices_number, vertices.data() + offset, vertex_size, 1.0f);
+        offset += VertexAttributes::getAttributeSize(config.position_format) / sizeof(float);
+
+        if (config.has_texture)
+        {
+            encodeVertexAttribute(config.texture_format, textures.data(), 2, vertices_number, vertices.data() + offset, vertex_size);
+            offset += VertexAttributes::getAttributeSize(config.texture_format) / sizeof(float);
+        }
+
+        if (config.has_normals)
+        {
+            encodeVertexAttribute(config.normal_format, normals.data(), 3, vertices_number, vertices.data() + offset, vertex_size);
+            offset += VertexAttributes::getAttributeSize(config.normal_format) / sizeof(float);
+        }
+
+        if (config.add_medians)
+        {
+            encodeVertexAttribute(config.median_format, medians.data(), 3, vertices_number, vertices.data() + offset, vertex_size);
+            offset += VertexAttributes::getAttributeSize(config.median_format) / sizeof(float);
+        }
+
+        if (config.has_texture)
+        {
+            for (size_t i = 0; i < vertices_number; i++)
+                memcpy(&vertices[i * vertex_size + offset], &material_indices[i], sizeof(uint32_t));
+        }
+
         // Create the result drawable object
         return std::make_shared<DefaultDrawableElement>(vertices, vertex_attributes, indices, has_transparency);
     }
 
     std::vector<std::shared_ptr<DefaultDrawableElement>> parseObjFile(const char *filename, const ObjectParserConfiguration &config, std::vector<std::string> &tex_paths)
     {
+        TraceZone zone("parseObjFile");
+
         if (filename == nullptr)
             throw runtime_error("[ObjectParser] Null filename");
 
@@ -183,15 +237,18 @@ namespace framework
         if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filename, mtl_file_folder.c_str()))
             throw std::runtime_error("[ObjectParser] Error from tiny-OBJ: " + warn + err);
 
-        // The last +1 is for the material index (TODO use uint for material index)
-        uint32_t vertex_size = 3 + (config.has_texture ? 2 : 0) + (config.has_normals ? 3 : 0) + (config.add_medians ? 3 : 0) + (config.has_texture ? 1 : 0);
+        // Check the requested vertex formats
+        checkAttributeFormat(config.position_format, {VertexAttributes::DrawableAttribute::F3, VertexAttributes::DrawableAttribute::H4}, "position");
+        checkAttributeFormat(config.texture_format, {VertexAttributes::DrawableAttribute::F2, VertexAttributes::DrawableAttribute::H2, VertexAttributes::DrawableAttribute::U16N2}, "texture");
+        checkAttributeFormat(config.normal_format, {VertexAttributes::DrawableAttribute::F3, VertexAttributes::DrawableAttribute::S16N4, VertexAttributes::DrawableAttribute::S1010102, VertexAttributes::DrawableAttribute::S16N2}, "normal");
+        checkAttributeFormat(config.median_format, {VertexAttributes::DrawableAttribute::F3, VertexAttributes::DrawableAttribute::U8N4}, "median");
 
         // Get all the texture paths
         tex_paths = getTexturePaths(mtl_file_folder, materials);
 
         // Parse all the shapes
         for (const auto &shape : shapes)
-            result.push_back(getParsedDrawableElement(vertex_size, shape, attrib, materials, config));
+            result.push_back(getParsedDrawableElement(shape, attrib, materials, config));
 
         return result;
     }
@@ -8,6 +8,13 @@
 #include <core/drawableElement.h>
 #include <core/vertexAttributes.h>
 
+namespace tinyobj
+{
+    struct shape_t;
+    struct attrib_t;
+    struct material_t;
+}
+
 namespace framework
 {
     struct ObjectParserConfiguration
@@ -18,6 +25,16 @@ namespace framework
         bool add_medians = false;
         bool invert_texture = false;
         float multiplication_factor = 1.0f;
+
+        // Vertex formats of the parsed attributes, compressed formats reduce the vertex size
+        // Positions: F3, H4 (w = 1)
+        VertexAttributes::DrawableAttribute position_format = VertexAttributes::DrawableAttribute::F3;
+        // Texture coordinates: F2, H2, U16N2 (only for coordinates inside [0, 1])
+        VertexAttributes::DrawableAttribute texture_format = VertexAttributes::DrawableAttribute::F2;
+        // Normals: F3, S16N4, S1010102, S16N2 (octahedral encoded, see encodeVertexAttribute)
+        VertexAttributes::DrawableAttribute normal_format = VertexAttributes::DrawableAttribute::F3;
+        // Medians: F3, U8N4
+        VertexAttributes::DrawableAttribute median_format = VertexAttributes::DrawableAttribute::F3;
     };
 
     /**
@@ -31,4 +48,16 @@ namespace framework
      * to keep the initial object ordering.
      */
     std::vector<std::shared_ptr<DefaultDrawableElement>> parseObjFile(const char *filename, const ObjectParserConfiguration &config, std::vector<std::string> &tex_paths);
+
+    /**
+     * @brief Given the tinyobj shape, the method parses its vertices/indices producing
+     * a final drawable element which can be then rendered by the framework.
+     * The attributes are first collected into separated float streams and then encoded in batches
+     * (using the configuration formats) directly inside the interleaved vertex buffer.
+     * @warning The configuration formats are not checked, parseObjFile does it before parsing the shapes
+     */
+    std::shared_ptr<DefaultDrawableElement> getParsedDrawableElement(const tinyobj::shape_t &shape,
+                                                                     const tinyobj::attrib_t &attrib,
+                                                                     const std::vector<tinyobj::material_t> &materials,
+                                                                     const ObjectParserConfiguration &config);
 }
\ No newline at end of file
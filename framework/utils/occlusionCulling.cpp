@@ -0,0 +1,411 @@
+#include "occlusionCulling.h"
+
+#include <utils/jobSystem.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// The AVX kernel is compiled with a target attribute and selected at run time, the build flags do not enable AVX
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define OCCLUSION_CULLING_AVX
+#endif
+
+namespace framework
+{
+    OcclusionCulling::OcclusionCulling(const OcclusionCullingConfiguration &config)
+    {
+        if (config.width == 0 || config.height == 0)
+        {
+            throw std::runtime_error("[OcclusionCulling] Null depth buffer resolution");
+        }
+
+        tiles_x = (config.width + TILE_WIDTH - 1) / TILE_WIDTH;
+        tiles_y = (config.height + TILE_HEIGHT - 1) / TILE_HEIGHT;
+        width = tiles_x * TILE_WIDTH;
+        height = tiles_y * TILE_HEIGHT;
+        blocks_x = width / BLOCK_SIZE;
+
+        depth.assign(width * height, 1.0f);
+        block_depth.assign(blocks_x * (height / BLOCK_SIZE), 1.0f);
+        tile_triangles.resize(tiles_x * tiles_y);
+    }
+
+    uint32_t OcclusionCulling::addOccluder(const std::vector<glm::vec3> &positions, const std::vector<uint32_t> &indices, const glm::mat4 &model)
+    {
+        if (indices.size() % 3 != 0)
+        {
+            throw std::runtime_error("[OcclusionCulling] The number of indices is not a multiple of 3");
+        }
+
+        for (uint32_t index : indices)
+        {
+            if (index >= positions.size())
+            {
+                throw std::runtime_error("[OcclusionCulling] Index out of the vertices range");
+            }
+        }
+
+        occluders.push_back(Occluder{positions, indices, model});
+        return occluders.size() - 1;
+    }
+
+    void OcclusionCulling::setOccluderTransform(uint32_t occluder, const glm::mat4 &model)
+    {
+        if (occluder >= occluders.size())
+        {
+            throw std::runtime_error("[OcclusionCulling] Occluder index out of range");
+        }
+
+        occluders[occluder].model = model;
+    }
+
+    void OcclusionCulling::render(const glm::mat4 &view_projection)
+    {
+        triangles.clear();
+        for (auto &bin : tile_triangles)
+        {
+            bin.clear();
+        }
+
+        for (const auto &occluder : occluders)
+        {
+            setupOccluder(occluder, view_projection);
+        }
+
+        // Tiles own disjoint pixels, no synchronization is needed
+        JobSystem::getInstance().parallelFor(tile_triangles.size(), 1, [this](size_t begin, size_t end)
+                                              {
+            for (size_t tile = begin; tile < end; tile++)
+            {
+                rasterizeTile(tile);
+            } });
+    }
+
+    void OcclusionCulling::setupOccluder(const Occluder &occluder, const glm::mat4 &view_projection)
+    {
+        glm::mat4 model_view_projection = view_projection * occluder.model;
+
+        clip_vertices.resize(occluder.positions.size());
+        for (size_t i = 0; i < occluder.positions.size(); i++)
+        {
+            clip_vertices[i] = model_view_projection * glm::vec4(occluder.positions[i], 1.0f);
+        }
+
+        for (size_t i = 0; i < occluder.indices.size(); i += 3)
+        {
+            float x[3], y[3], z[3];
+            bool valid = true;
+
+            for (int v = 0; v < 3; v++)
+            {
+                const glm::vec4 &clip = clip_vertices[occluder.indices[i + v]];
+
+                // Behind or too close to the near plane, dropping the triangle can only reduce the occlusion
+                if (clip.w < MIN_W || clip.z < 0.0f)
+                {
+                    valid = false;
+                    break;
+                }
+
+                // The projection already flips Y, NDC and pixel rows grow in the same direction
+                x[v] = (clip.x / clip.w * 0.5f + 0.5f) * width;
+                y[v] = (clip.y / clip.w * 0.5f + 0.5f) * height;
+                z[v] = clip.z / clip.w;
+            }
+
+            if (!valid || (z[0] > 1.0f && z[1] > 1.0f && z[2] > 1.0f))
+            {
+                continue;
+            }
+
+            float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+
+            if (std::abs(area) < 1e-6f)
+            {
+                continue;
+            }
+
+            // Double sided, the clockwise triangles are flipped
+            if (area < 0.0f)
+            {
+                std::swap(x[1], x[2]);
+                std::swap(y[1], y[2]);
+                std::swap(z[1], z[2]);
+                area = -area;
+            }
+
+            ScreenTriangle triangle;
+            triangle.min_x = std::max(static_cast<int32_t>(std::floor(std::min({x[0], x[1], x[2]}))), 0);
+            triangle.min_y = std::max(static_cast<int32_t>(std::floor(std::min({y[0], y[1], y[2]}))), 0);
+            triangle.max_x = std::min(static_cast<int32_t>(std::ceil(std::max({x[0], x[1], x[2]}))), static_cast<int32_t>(width) - 1);
+            triangle.max_y = std::min(static_cast<int32_t>(std::ceil(std::max({y[0], y[1], y[2]}))), static_cast<int32_t>(height) - 1);
+
+            if (triangle.min_x > triangle.max_x || triangle.min_y > triangle.max_y)
+            {
+                continue;
+            }
+
+            // Edge e is opposite to the vertex e, its function is the barycentric weight of that vertex times the area
+            triangle.depth_a = triangle.depth_b = triangle.depth_c = 0.0f;
+            for (int e = 0; e < 3; e++)
+            {
+                int a = (e + 1) % 3, b = (e + 2) % 3;
+
+                triangle.edge_a[e] = y[a] - y[b];
+                triangle.edge_b[e] = x[b] - x[a];
+                triangle.edge_c[e] = x[a] * y[b] - x[b] * y[a];
+
+                triangle.depth_a += triangle.edge_a[e] * z[e] / area;
+                triangle.depth_b += triangle.edge_b[e] * z[e] / area;
+                triangle.depth_c += triangle.edge_c[e] * z[e] / area;
+            }
+
+            uint32_t index = triangles.size();
+            triangles.push_back(triangle);
+
+            for (int32_t tile_y = triangle.min_y / TILE_HEIGHT; tile_y <= triangle.max_y / static_cast<int32_t>(TILE_HEIGHT); tile_y++)
+            {
+                for (int32_t tile_x = triangle.min_x / TILE_WIDTH; tile_x <= triangle.max_x / static_cast<int32_t>(TILE_WIDTH); tile_x++)
+                {
+                    tile_triangles[tile_y * tiles_x + tile_x].push_back(index);
+                }
+            }
+        }
+    }
+
+    void OcclusionCulling::rasterizeTile(uint32_t tile)
+    {
+        int32_t tile_x = (tile % tiles_x) * TILE_WIDTH;
+        int32_t tile_y = (tile / tiles_x) * TILE_HEIGHT;
+
+        for (uint32_t row = 0; row < TILE_HEIGHT; row++)
+        {
+            std::fill_n(&depth[(tile_y + row) * width + tile_x], TILE_WIDTH, 1.0f);
+        }
+
+        for (uint32_t index : tile_triangles[tile])
+        {
+            const ScreenTriangle &triangle = triangles[index];
+
+            int32_t x_begin = std::max(triangle.min_x, tile_x) & ~static_cast<int32_t>(7);
+            int32_t x_end = std::min(triangle.max_x + 1, tile_x + static_cast<int32_t>(TILE_WIDTH));
+            int32_t y_begin = std::max(triangle.min_y, tile_y);
+            int32_t y_end = std::min(triangle.max_y + 1, tile_y + static_cast<int32_t>(TILE_HEIGHT));
+
+            // Whole groups of 8 pixels, the tile width is a multiple of 8
+            x_end = (x_end + 7) & ~static_cast<int32_t>(7);
+
+            rasterizeTriangle(triangle, x_begin, x_end, y_begin, y_end);
+        }
+
+        // Farthest depth of every block inside the tile
+        for (uint32_t by = 0; by < TILE_HEIGHT; by += BLOCK_SIZE)
+        {
+            for (uint32_t bx = 0; bx < TILE_WIDTH; bx += BLOCK_SIZE)
+            {
+                float farthest = 0.0f;
+                for (uint32_t y = 0; y < BLOCK_SIZE; y++)
+                {
+                    const float *row = &depth[(tile_y + by + y) * width + tile_x + bx];
+                    farthest = std::max(farthest, *std::max_element(row, row + BLOCK_SIZE));
+                }
+
+                block_depth[((tile_y + by) / BLOCK_SIZE) * blocks_x + (tile_x + bx) / BLOCK_SIZE] = farthest;
+            }
+        }
+    }
+
+#ifdef OCCLUSION_CULLING_AVX
+    static const bool HAS_AVX = __builtin_cpu_supports("avx");
+
+    /**
+     * @brief Rasterizes the row 8 pixels at a time from x, returns the first pixel left to the narrower paths
+     */
+    __attribute__((target("avx"))) static int32_t rasterizeRowAvx(const float edge_a[3], const float row_edges[3], float depth_a, float row_depth,
+                                                                 float *row, int32_t x, int32_t x_end)
+    {
+        const __m256 lanes = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+        const __m256 zero = _mm256_setzero_ps();
+
+        for (; x + 8 <= x_end; x += 8)
+        {
+            __m256 px = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), lanes);
+
+            __m256 e0 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(edge_a[0]), px), _mm256_set1_ps(row_edges[0]));
+            __m256 e1 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(edge_a[1]), px), _mm256_set1_ps(row_edges[1]));
+            __m256 e2 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(edge_a[2]), px), _mm256_set1_ps(row_edges[2]));
+
+            __m256 inside = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(e0, zero, _CMP_GE_OQ), _mm256_cmp_ps(e1, zero, _CMP_GE_OQ)),
+                                          _mm256_cmp_ps(e2, zero, _CMP_GE_OQ));
+
+            if (_mm256_movemask_ps(inside) == 0)
+            {
+                continue;
+            }
+
+            __m256 z = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(depth_a), px), _mm256_set1_ps(row_depth));
+            __m256 current = _mm256_loadu_ps(row + x);
+            _mm256_storeu_ps(row + x, _mm256_blendv_ps(current, _mm256_min_ps(current, z), inside));
+        }
+
+        return x;
+    }
+#endif
+
+    void OcclusionCulling::rasterizeTriangle(const ScreenTriangle &triangle, int32_t x_begin, int32_t x_end, int32_t y_begin, int32_t y_end)
+    {
+        for (int32_t y = y_begin; y < y_end; y++)
+        {
+            // Pixel centers
+            float py = y + 0.5f;
+            float row_edges[3];
+            for (int e = 0; e < 3; e++)
+            {
+                row_edges[e] = triangle.edge_b[e] * py + triangle.edge_c[e];
+            }
+            float row_depth = triangle.depth_b * py + triangle.depth_c;
+
+            float *row = &depth[y * width];
+            int32_t x = x_begin;
+
+#ifdef OCCLUSION_CULLING_AVX
+            if (HAS_AVX)
+            {
+                x = rasterizeRowAvx(triangle.edge_a, row_edges, triangle.depth_a, row_depth, row, x, x_end);
+            }
+#endif
+#ifdef __SSE2__
+            const __m128 sse_lanes = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+            const __m128 sse_zero = _mm_setzero_ps();
+
+            for (; x + 4 <= x_end; x += 4)
+            {
+                __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), sse_lanes);
+
+                __m128 e0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(triangle.edge_a[0]), px), _mm_set1_ps(row_edges[0]));
+                __m128 e1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(triangle.edge_a[1]), px), _mm_set1_ps(row_edges[1]));
+                __m128 e2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(triangle.edge_a[2]), px), _mm_set1_ps(row_edges[2]));
+
+                __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, sse_zero), _mm_cmpge_ps(e1, sse_zero)), _mm_cmpge_ps(e2, sse_zero));
+
+                if (_mm_movemask_ps(inside) == 0)
+                {
+                    continue;
+                }
+
+                __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(triangle.depth_a), px), _mm_set1_ps(row_depth));
+                __m128 current = _mm_loadu_ps(row + x);
+                __m128 nearest = _mm_min_ps(current, z);
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, current)));
+            }
+#endif
+            for (; x < x_end; x++)
+            {
+                float px = x + 0.5f;
+
+                if (triangle.edge_a[0] * px + row_edges[0] >= 0.0f && triangle.edge_a[1] * px + row_edges[1] >= 0.0f &&
+                    triangle.edge_a[2] * px + row_edges[2] >= 0.0f)
+                {
+                    row[x] = std::min(row[x], triangle.depth_a * px + row_depth);
+                }
+            }
+        }
+    }
+
+    bool OcclusionCulling::isBoxVisible(const glm::vec3 &min, const glm::vec3 &max, const glm::mat4 &model_view_projection) const
+    {
+        float min_x = FLT_MAX, min_y = FLT_MAX, max_x = -FLT_MAX, max_y = -FLT_MAX, min_z = FLT_MAX;
+
+        for (int corner = 0; corner < 8; corner++)
+        {
+            glm::vec4 clip = model_view_projection * glm::vec4(corner & 1 ? max.x : min.x, corner & 2 ? max.y : min.y, corner & 4 ? max.z : min.z, 1.0f);
+
+            if (clip.w < MIN_W)
+            {
+                return true;
+            }
+
+            float x = (clip.x / clip.w * 0.5f + 0.5f) * width;
+            float y = (clip.y / clip.w * 0.5f + 0.5f) * height;
+
+            min_x = std::min(min_x, x);
+            max_x = std::max(max_x, x);
+            min_y = std::min(min_y, y);
+            max_y = std::max(max_y, y);
+            min_z = std::min(min_z, clip.z / clip.w);
+        }
+
+        // Every pixel touched by the projected box
+        int32_t x_begin = std::max(static_cast<int32_t>(std::floor(std::max(min_x, -1.0f))), 0);
+        int32_t y_begin = std::max(static_cast<int32_t>(std::floor(std::max(min_y, -1.0f))), 0);
+        int32_t x_end = std::min(static_cast<int32_t>(std::ceil(std::min(max_x, width + 1.0f))), static_cast<int32_t>(width));
+        int32_t y_end = std::min(static_cast<int32_t>(std::ceil(std::min(max_y, height + 1.0f))), static_cast<int32_t>(height));
+
+        if (x_begin >= x_end || y_begin >= y_end || min_z >= 1.0f)
+        {
+            return true;
+        }
+
+        for (int32_t by = y_begin / BLOCK_SIZE; by <= (y_end - 1) / static_cast<int32_t>(BLOCK_SIZE); by++)
+        {
+            for (int32_t bx = x_begin / BLOCK_SIZE; bx <= (x_end - 1) / static_cast<int32_t>(BLOCK_SIZE); bx++)
+            {
+                // The whole block is closer than the box
+                if (block_depth[by * blocks_x + bx] < min_z)
+                {
+                    continue;
+                }
+
+                int32_t y_last = std::min(y_end, (by + 1) * static_cast<int32_t>(BLOCK_SIZE));
+                int32_t x_last = std::min(x_end, (bx + 1) * static_cast<int32_t>(BLOCK_SIZE));
+
+                for (int32_t y = std::max(y_begin, by * static_cast<int32_t>(BLOCK_SIZE)); y < y_last; y++)
+                {
+                    for (int32_t x = std::max(x_begin, bx * static_cast<int32_t>(BLOCK_SIZE)); x < x_last; x++)
+                    {
+                        if (depth[y * width + x] >= min_z)
+                        {
+                            return true;
+                        }
+                    }
+                }
+            }
+        }
+
+        return false;
+    }
+
+    uint32_t OcclusionCulling::testBoxes(const BoundingBoxes &boxes, const glm::mat4 &model_view_projection, uint8_t *visible) const
+    {
+        if (triangles.empty())
+        {
+            return 0;
+        }
+
+        std::atomic<uint32_t> occluded = 0;
+
+        JobSystem::getInstance().parallelFor(boxes.size(), BOXES_GRAIN, [&](size_t begin, size_t end)
+                                              {
+            uint32_t chunk_occluded = 0;
+
+            for (size_t i = begin; i < end; i++)
+            {
+                if (visible[i] && !isBoxVisible({boxes.min_x[i], boxes.min_y[i], boxes.min_z[i]}, {boxes.max_x[i], boxes.max_y[i], boxes.max_z[i]}, model_view_projection))
+                {
+                    visible[i] = 0;
+                    chunk_occluded++;
+                }
+            }
+
+            occluded += chunk_occluded; });
+
+        return occluded;
+    }
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <core/boundingBoxes.h>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <stdint.h>
+
+namespace framework
+{
+    struct OcclusionCullingConfiguration
+    {
+        // Depth buffer resolution, rounded up to the tile size
+        uint32_t width = 320;
+        uint32_t height = 192;
+    };
+
+    /**
+     * @brief CPU occlusion culling. Designated occluder meshes are rasterized (8 pixels at a time with AVX, 4 with SSE)
+     * into a low resolution depth buffer split in tiles, which are processed in parallel on the job system.
+     * Every tile also stores the farthest depth of its 8x8 pixel blocks, so that boxes are rejected block by block
+     * and single pixels are read only where the coarse test is inconclusive.
+     * Depth follows the Vulkan [0, 1] convention, closer is smaller. Occluders are double sided.
+     */
+    class OcclusionCulling
+    {
+    public:
+        OcclusionCulling(const OcclusionCullingConfiguration &config);
+
+        /**
+         * @brief Adds an occluder mesh, usually a simplified and slightly shrunk version of a large element
+         * @return The occluder index
+         * @throws Runtime Exception if the indices are not a multiple of 3 or reference missing vertices
+         */
+        uint32_t addOccluder(const std::vector<glm::vec3> &positions, const std::vector<uint32_t> &indices, const glm::mat4 &model = glm::mat4(1.0f));
+
+        /**
+         * @brief Sets the model matrix of the occluder
+         * @throws Runtime Exception if the occluder does not exist
+         */
+        void setOccluderTransform(uint32_t occluder, const glm::mat4 &model);
+
+        /**
+         * @brief Clears the depth buffer and rasterizes all the occluders seen through the projection * view matrix.
+         * Triangles crossing the near plane are dropped, so that the depth buffer never occludes more than the real scene
+         */
+        void render(const glm::mat4 &view_projection);
+
+        /**
+         * @brief Tests the boxes whose visible flag is set against the depth buffer, clearing the flag of the occluded ones.
+         * Boxes crossing the near plane or outside the screen are left to the frustum culling.
+         * @return The number of occluded boxes
+         */
+        uint32_t testBoxes(const BoundingBoxes &boxes, const glm::mat4 &model_view_projection, uint8_t *visible) const;
+
+        /**
+         * @brief Conservative test of a single box, true if part of it can be visible
+         */
+        bool isBoxVisible(const glm::vec3 &min, const glm::vec3 &max, const glm::mat4 &model_view_projection) const;
+
+        // Getters
+        inline uint32_t getWidth() const { return width; }
+        inline uint32_t getHeight() const { return height; }
+        inline const std::vector<float> &getDepthBuffer() const { return depth; }
+        inline uint32_t getOccludersNumber() const { return occluders.size(); }
+        inline uint32_t getRasterizedTrianglesNumber() const { return triangles.size(); }
+
+    private:
+        static constexpr uint32_t TILE_WIDTH = 64;
+        static constexpr uint32_t TILE_HEIGHT = 32;
+        static constexpr uint32_t BLOCK_SIZE = 8;
+        // Vertices closer than this clip space w are considered behind the near plane
+        static constexpr float MIN_W = 1e-5f;
+        static constexpr uint32_t BOXES_GRAIN = 256;
+
+        struct Occluder
+        {
+            std::vector<glm::vec3> positions;
+            std::vector<uint32_t> indices;
+            glm::mat4 model;
+        };
+
+        // Counter clockwise screen space triangle with its edge functions A * x + B * y + C (positive inside) and depth plane
+        struct ScreenTriangle
+        {
+            float edge_a[3], edge_b[3], edge_c[3];
+            float depth_a, depth_b, depth_c;
+            int32_t min_x, min_y, max_x, max_y;
+        };
+
+        /**
+         * @brief Transforms the occluder and appends its triangles that can be rasterized safely
+         */
+        void setupOccluder(const Occluder &occluder, const glm::mat4 &view_projection);
+
+        /**
+         * @brief Rasterizes the tile triangles and computes the tile blocks depth
+         */
+        void rasterizeTile(uint32_t tile);
+
+        /**
+         * @brief Writes the nearest depth of the triangle inside the pixel rectangle, x_begin is a multiple of 8
+         */
+        void rasterizeTriangle(const ScreenTriangle &triangle, int32_t x_begin, int32_t x_end, int32_t y_begin, int32_t y_end);
+
+        uint32_t width = 0, height = 0;
+        uint32_t tiles_x = 0, tiles_y = 0;
+        uint32_t blocks_x = 0;
+
+        std::vector<Occluder> occluders;
+
+        // Triangles of the current frame and their indices binned per tile
+        std::vector<ScreenTriangle> triangles;
+        std::vector<std::vector<uint32_t>> tile_triangles;
+        std::vector<glm::vec4> clip_vertices;
+
+        // Full resolution depth (row major) and farthest depth of every block
+        std::vector<float> depth;
+        std::vector<float> block_depth;
+    };
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cfloat>
+
+namespace framework
+{
+    /**
+     * @brief Half line origin + t * direction, only the hits with t inside [t_min, t_max] are considered
+     */
+    struct Ray
+    {
+        glm::vec3 origin{0.0f};
+        glm::vec3 direction{0.0f, 0.0f, 1.0f};
+        float t_min = 0.0f;
+        float t_max = FLT_MAX;
+    };
+}
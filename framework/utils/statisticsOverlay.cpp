@@ -0,0 +1,295 @@
+#include "statisticsOverlay.h"
+
+#include <ImGui/imgui.h>
+#include <ImPlot/implot.h>
+
+#include <stdexcept>
+#include <algorithm>
+#include <stdio.h>
+
+namespace framework
+{
+    // Labels in the series order
+    static const char *SERIES_NAMES[] = {"frame interval", "draw", "fence wait", "pipelines update", "image acquisition", "gui description",
+                                         "recording", "pipelines recording", "slowest secondary", "reused command buffers", "recordings/s",
+                                         "draws", "drawn elements", "culled elements", "uploaded KB"};
+
+    StatisticsOverlay::StatisticsOverlay(const std::shared_ptr<LogicalDevice> &l_device, const StatisticsOverlayConfiguration &config)
+    {
+        if (l_device == nullptr)
+        {
+            throw std::runtime_error("[StatisticsOverlay] Null logical device instance");
+        }
+
+        if (config.history == 0 || config.refresh_interval == 0 || config.histogram_bins == 0)
+        {
+            throw std::runtime_error("[StatisticsOverlay] Null history, refresh interval or histogram bins");
+        }
+
+        this->l_device = l_device;
+        this->config = config;
+
+        // Every buffer is allocated once
+        for (uint32_t s = 0; s < SERIES_NUMBER; s++)
+        {
+            series[s].resize(config.history);
+            plotted[s].resize(config.history);
+        }
+
+        frames.resize(config.history);
+        stacked.resize(STACKED_NUMBER + 2, std::vector<float>(config.history));
+        scratch.resize(config.history);
+
+        for (uint32_t i = 0; i < config.history; i++)
+        {
+            frames[i] = static_cast<float>(i);
+        }
+
+        // Properties2 needs Vulkan 1.1
+        memory_budget = l_device->getPhysicalDevice()->isExtensionEnabled(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) &&
+                        l_device->getPhysicalDevice()->getProperties().apiVersion >= VK_API_VERSION_1_1;
+
+        queryMemory();
+    }
+
+    void StatisticsOverlay::addFrame(const TimingMeasurement &timings, const CullingStatistics &culling, const FrameStatistics &frame)
+    {
+        auto now = std::chrono::steady_clock::now();
+        float interval = first_frame ? timings.time_to_draw : std::chrono::duration_cast<std::chrono::microseconds>(now - last_frame).count() / 1000.f;
+
+        last_frame = now;
+        first_frame = false;
+
+        float slowest_secondary = 0;
+        for (float time : timings.time_to_record_secondaries)
+        {
+            slowest_secondary = std::max(slowest_secondary, time);
+        }
+
+        series[FRAME_INTERVAL][next] = interval;
+        series[DRAW][next] = timings.time_to_draw;
+        series[WAIT_FENCE][next] = timings.time_to_wait_fence;
+        series[UPDATE_PIPELINES][next] = timings.time_to_update_pipelines;
+        series[ACQUIRE_IMAGE][next] = timings.time_to_acquire_image;
+        series[DESCRIBE_GUI][next] = timings.time_to_describe_gui;
+        series[RECORD_COMMAND_BUFFER][next] = timings.time_to_record_command_buffer;
+        series[RECORD_PIPELINES][next] = timings.time_to_record_pipelines;
+        series[SLOWEST_SECONDARY][next] = slowest_secondary;
+        series[COMMAND_BUFFER_REUSED][next] = timings.command_buffer_reused ? 1.0f : 0.0f;
+        series[RECORDS_PER_SECOND][next] = timings.command_buffer_records_per_second;
+        series[DRAWS][next] = static_cast<float>(frame.draws);
+        series[DRAWN_ELEMENTS][next] = static_cast<float>(culling.drawn_elements);
+        series[CULLED_ELEMENTS][next] = static_cast<float>(culling.culled_elements);
+        series[UPLOADED_KILOBYTES][next] = frame.uploaded_bytes / 1024.0f;
+
+        next = (next + 1) % config.history;
+        count = std::min(count + 1, config.history);
+
+        if (++frames_since_refresh >= config.refresh_interval)
+        {
+            refresh();
+            frames_since_refresh = 0;
+        }
+    }
+
+    void StatisticsOverlay::describe()
+    {
+        if (!visible)
+        {
+            return;
+        }
+
+        if (!ImGui::Begin("Frame statistics"))
+        {
+            ImGui::End();
+            return;
+        }
+
+        linearize();
+
+        const SeriesSummary &interval = summaries[FRAME_INTERVAL];
+        ImGui::Text("Frame %.2f ms (%.0f FPS), p50 %.2f ms, p95 %.2f ms, p99 %.2f ms", interval.average,
+                    interval.average > 0 ? 1000.0f / interval.average : 0.0f, interval.p50, interval.p95, interval.p99);
+
+        int samples = static_cast<int>(count);
+
+        // CPU side of the frame, the components stacked one over the other
+        if (ImPlot::BeginPlot("CPU frame time", ImVec2(-1, 200), ImPlotFlags_NoBoxSelect))
+        {
+            ImPlot::SetupAxes("frame", "ms", ImPlotAxisFlags_NoTickLabels, ImPlotAxisFlags_AutoFit | ImPlotAxisFlags_LockMin);
+            ImPlot::SetupAxisLimits(ImAxis_X1, 0, config.history, ImPlotCond_Always);
+
+            for (uint32_t s = 0; s < STACKED_NUMBER; s++)
+            {
+                ImPlot::PlotShaded(SERIES_NAMES[STACKED[s]], frames.data(), stacked[s].data(), stacked[s + 1].data(), samples);
+            }
+
+            ImPlot::PlotShaded("other", frames.data(), stacked[STACKED_NUMBER].data(), stacked[STACKED_NUMBER + 1].data(), samples);
+            ImPlot::PlotLine(SERIES_NAMES[FRAME_INTERVAL], frames.data(), plotted[FRAME_INTERVAL].data(), samples);
+            ImPlot::EndPlot();
+        }
+
+        if (ImPlot::BeginPlot("Frame interval histogram", ImVec2(-1, 150), ImPlotFlags_NoLegend | ImPlotFlags_NoBoxSelect))
+        {
+            ImPlot::SetupAxes("ms", "frames", ImPlotAxisFlags_AutoFit, ImPlotAxisFlags_AutoFit);
+            ImPlot::PlotHistogram(SERIES_NAMES[FRAME_INTERVAL], plotted[FRAME_INTERVAL].data(), samples, config.histogram_bins);
+            ImPlot::EndPlot();
+        }
+
+        if (ImPlot::BeginPlot("Draws and uploads", ImVec2(-1, 150), ImPlotFlags_NoBoxSelect))
+        {
+            ImPlot::SetupAxes("frame", nullptr, ImPlotAxisFlags_NoTickLabels, ImPlotAxisFlags_AutoFit | ImPlotAxisFlags_LockMin);
+            ImPlot::SetupAxisLimits(ImAxis_X1, 0, config.history, ImPlotCond_Always);
+
+            for (Series s : {DRAWS, DRAWN_ELEMENTS, CULLED_ELEMENTS, UPLOADED_KILOBYTES})
+            {
+                ImPlot::PlotLine(SERIES_NAMES[s], frames.data(), plotted[s].data(), samples);
+            }
+
+            ImPlot::EndPlot();
+        }
+
+        // Device local memory
+        if (memory_budget)
+        {
+            char overlay[64];
+            snprintf(overlay, sizeof(overlay), "%.0f / %.0f MB", memory_usage / 1048576.0, memory_budget_bytes / 1048576.0);
+            ImGui::Text("Device memory");
+            ImGui::ProgressBar(memory_budget_bytes > 0 ? static_cast<float>(memory_usage) / memory_budget_bytes : 0.0f, ImVec2(-1, 0), overlay);
+        }
+        else
+        {
+            ImGui::Text("Device memory %.0f MB (usage needs VK_EXT_memory_budget)", memory_size / 1048576.0);
+        }
+
+        // Every series with its averages and percentiles over the history
+        if (ImGui::BeginTable("Series", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit))
+        {
+            for (const char *header : {"series", "last", "avg", "p50", "p95", "p99"})
+            {
+                ImGui::TableSetupColumn(header);
+            }
+
+            ImGui::TableHeadersRow();
+
+            uint32_t last = (next + config.history - 1) % config.history;
+
+            for (uint32_t s = 0; s < SERIES_NUMBER; s++)
+            {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(SERIES_NAMES[s]);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", count > 0 ? series[s][last] : 0.0f);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", summaries[s].average);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", summaries[s].p50);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", summaries[s].p95);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", summaries[s].p99);
+            }
+
+            ImGui::EndTable();
+        }
+
+        ImGui::End();
+    }
+
+    void StatisticsOverlay::linearize()
+    {
+        // Oldest sample first
+        uint32_t first = count < config.history ? 0 : next;
+
+        for (uint32_t s = 0; s < SERIES_NUMBER; s++)
+        {
+            const std::vector<float> &ring = series[s];
+            std::vector<float> &linear = plotted[s];
+
+            for (uint32_t i = 0; i < count; i++)
+            {
+                linear[i] = ring[(first + i) % config.history];
+            }
+        }
+
+        // Lower bound of the first component, then the upper bound of every component and of the remaining draw time
+        for (uint32_t i = 0; i < count; i++)
+        {
+            float total = 0;
+            stacked[0][i] = 0;
+
+            for (uint32_t s = 0; s < STACKED_NUMBER; s++)
+            {
+                total += plotted[STACKED[s]][i];
+                stacked[s + 1][i] = total;
+            }
+
+            stacked[STACKED_NUMBER + 1][i] = std::max(total, plotted[DRAW][i]);
+        }
+    }
+
+    void StatisticsOverlay::refresh()
+    {
+        for (uint32_t s = 0; s < SERIES_NUMBER; s++)
+        {
+            // Percentiles do not depend on the samples order, the ring is copied as it is
+            std::copy(series[s].begin(), series[s].begin() + count, scratch.begin());
+            std::sort(scratch.begin(), scratch.begin() + count);
+
+            float total = 0;
+            for (uint32_t i = 0; i < count; i++)
+            {
+                total += scratch[i];
+            }
+
+            summaries[s].average = total / count;
+            summaries[s].p50 = scratch[(count - 1) * 50 / 100];
+            summaries[s].p95 = scratch[(count - 1) * 95 / 100];
+            summaries[s].p99 = scratch[(count - 1) * 99 / 100];
+        }
+
+        queryMemory();
+    }
+
+    void StatisticsOverlay::queryMemory()
+    {
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budget{};
+        budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+        VkPhysicalDeviceMemoryProperties2 properties{};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+        properties.pNext = memory_budget ? &budget : nullptr;
+
+        if (memory_budget)
+        {
+            vkGetPhysicalDeviceMemoryProperties2(l_device->getPhysicalDevice()->getDevice(), &properties);
+        }
+        else
+        {
+            vkGetPhysicalDeviceMemoryProperties(l_device->getPhysicalDevice()->getDevice(), &properties.memoryProperties);
+        }
+
+        memory_usage = 0;
+        memory_budget_bytes = 0;
+        memory_size = 0;
+
+        const VkPhysicalDeviceMemoryProperties &memory = properties.memoryProperties;
+
+        for (uint32_t heap = 0; heap < memory.memoryHeapCount; heap++)
+        {
+            if ((memory.memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) == 0)
+            {
+                continue;
+            }
+
+            memory_size += memory.memoryHeaps[heap].size;
+
+            if (memory_budget)
+            {
+                memory_usage += budget.heapUsage[heap];
+                memory_budget_bytes += budget.heapBudget[heap];
+            }
+        }
+    }
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <devices/logicalDevice.h>
+#include <utils/defaultRenderer.h>
+
+#include <vector>
+#include <array>
+#include <memory>
+#include <chrono>
+
+namespace framework
+{
+    struct StatisticsOverlayConfiguration
+    {
+        // Frames kept inside the history
+        uint32_t history = 512;
+        // Frames between two updates of the percentiles, of the averages and of the memory usage
+        uint32_t refresh_interval = 30;
+        uint32_t histogram_bins = 40;
+    };
+
+    /**
+     * @brief ImPlot window with the rolling history of the renderer timings and statistics: stacked CPU frame time, frame
+     * interval percentiles and histogram, draws, uploads and device memory usage (with VK_EXT_memory_budget).
+     * The history is a fixed size ring per series (structure of arrays), nothing is allocated after the construction and the
+     * percentiles are refreshed every few frames, so that the overlay cost stays negligible.
+     * Used through DefaultRenderer::setStatisticsOverlay, which adds the frames and describes the window inside its ImGui frame
+     */
+    class StatisticsOverlay
+    {
+    public:
+        StatisticsOverlay(const std::shared_ptr<LogicalDevice> &l_device, const StatisticsOverlayConfiguration &config);
+
+        /**
+         * @brief Adds the measurements of a drawn frame to the history
+         */
+        void addFrame(const TimingMeasurement &timings, const CullingStatistics &culling, const FrameStatistics &frame);
+
+        /**
+         * @brief Describes the overlay window. Must be called inside an ImGui frame (between NewFrame and Render)
+         */
+        void describe();
+
+        // Setters
+        void setVisibility(bool v) { visible = v; }
+
+    private:
+        // Series of the history, one ring each
+        enum Series : uint32_t
+        {
+            FRAME_INTERVAL,
+            DRAW,
+            WAIT_FENCE,
+            UPDATE_PIPELINES,
+            ACQUIRE_IMAGE,
+            DESCRIBE_GUI,
+            RECORD_COMMAND_BUFFER,
+            RECORD_PIPELINES,
+            SLOWEST_SECONDARY,
+            COMMAND_BUFFER_REUSED,
+            RECORDS_PER_SECOND,
+            DRAWS,
+            DRAWN_ELEMENTS,
+            CULLED_ELEMENTS,
+            UPLOADED_KILOBYTES,
+            SERIES_NUMBER
+        };
+
+        // Components of the stacked CPU frame time, the remaining part of the draw time is stacked on top
+        static constexpr Series STACKED[] = {WAIT_FENCE, UPDATE_PIPELINES, ACQUIRE_IMAGE, DESCRIBE_GUI, RECORD_COMMAND_BUFFER};
+        static constexpr uint32_t STACKED_NUMBER = sizeof(STACKED) / sizeof(STACKED[0]);
+
+        struct SeriesSummary
+        {
+            float average = 0;
+            float p50 = 0;
+            float p95 = 0;
+            float p99 = 0;
+        };
+
+        /**
+         * @brief Copies the rings in chronological order inside the plotted arrays and stacks the frame time components
+         */
+        void linearize();
+
+        /**
+         * @brief Updates the series averages and percentiles and the memory usage
+         */
+        void refresh();
+
+        /**
+         * @brief Sums the usage and the budget of the device local heaps
+         */
+        void queryMemory();
+
+        std::shared_ptr<LogicalDevice> l_device;
+        StatisticsOverlayConfiguration config;
+        bool visible = true;
+
+        // History rings, one array per series, with the next written slot and the valid samples
+        std::array<std::vector<float>, SERIES_NUMBER> series;
+        uint32_t next = 0;
+        uint32_t count = 0;
+        uint32_t frames_since_refresh = 0;
+        std::chrono::steady_clock::time_point last_frame;
+        bool first_frame = true;
+
+        // Chronological copies for the plots, the frame indices and the stacked bounds (STACKED_NUMBER + 2 arrays)
+        std::array<std::vector<float>, SERIES_NUMBER> plotted;
+        std::vector<float> frames;
+        std::vector<std::vector<float>> stacked;
+        std::vector<float> scratch;
+
+        std::array<SeriesSummary, SERIES_NUMBER> summaries{};
+
+        // Device local heaps, the usage is known only with the memory budget extension
+        bool memory_budget = false;
+        uint64_t memory_usage = 0;
+        uint64_t memory_budget_bytes = 0;
+        uint64_t memory_size = 0;
+    };
+}
@@ -0,0 +1,248 @@
+#include "traceProfiler.h"
+
+#include <stdexcept>
+
+namespace framework
+{
+    thread_local TraceProfiler::ThreadBuffer *TraceProfiler::thread_buffer = nullptr;
+
+    TraceProfiler::~TraceProfiler()
+    {
+        stop();
+    }
+
+    void TraceProfiler::start(const TraceProfilerConfiguration &config)
+    {
+        if (file != nullptr)
+        {
+            throw std::runtime_error("[TraceProfiler] Trace session already active");
+        }
+
+        if (config.events_per_thread == 0)
+        {
+            throw std::runtime_error("[TraceProfiler] Null events per thread");
+        }
+
+        file = fopen(config.path.c_str(), "wb");
+
+        if (file == nullptr)
+        {
+            throw std::runtime_error("[TraceProfiler] Impossible to open the trace file");
+        }
+
+        this->config = config;
+
+        uint64_t capacity = 1;
+        while (capacity < config.events_per_thread)
+        {
+            capacity <<= 1;
+        }
+
+        buffer_capacity = capacity;
+
+        {
+            // Zones of the previous session are discarded, threads are named again inside the new file
+            std::lock_guard<std::mutex> lock(buffers_mutex);
+
+            for (auto &buffer : buffers)
+            {
+                buffer->tail.store(buffer->head.load(std::memory_order_acquire), std::memory_order_release);
+                buffer->dropped = 0;
+                buffer->name_written = false;
+            }
+        }
+
+        fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", file);
+        first_event = true;
+        written_events = 0;
+        session_start = now();
+        stopping = false;
+
+        enabled = true;
+        flush_thread = std::thread(&TraceProfiler::flushLoop, this);
+    }
+
+    void TraceProfiler::stop()
+    {
+        if (file == nullptr)
+        {
+            return;
+        }
+
+        enabled = false;
+
+        {
+            std::lock_guard<std::mutex> lock(stop_mutex);
+            stopping = true;
+        }
+
+        stop_condition.notify_all();
+        flush_thread.join();
+
+        // Zones closed meanwhile
+        flush();
+
+        std::lock_guard<std::mutex> lock(flush_mutex);
+        fputs("\n]}\n", file);
+        fclose(file);
+        file = nullptr;
+    }
+
+    void TraceProfiler::setThreadName(const std::string &name)
+    {
+        ThreadBuffer &buffer = getThreadBuffer();
+
+        // The flush reads the name under the same mutex
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        buffer.name = name;
+        buffer.name_written = false;
+    }
+
+    void TraceProfiler::record(const char *name, uint64_t begin, uint64_t end)
+    {
+        ThreadBuffer &buffer = getThreadBuffer();
+
+        uint64_t head = buffer.head.load(std::memory_order_relaxed);
+
+        if (head - buffer.tail.load(std::memory_order_acquire) > buffer.mask)
+        {
+            buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        buffer.events[head & buffer.mask] = {name, begin, end};
+        buffer.head.store(head + 1, std::memory_order_release);
+    }
+
+    uint64_t TraceProfiler::getDroppedEvents()
+    {
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        uint64_t dropped = 0;
+
+        for (auto &buffer : buffers)
+        {
+            dropped += buffer->dropped.load();
+        }
+
+        return dropped;
+    }
+
+    TraceProfiler::ThreadBuffer &TraceProfiler::getThreadBuffer()
+    {
+        if (thread_buffer != nullptr)
+        {
+            return *thread_buffer;
+        }
+
+        uint64_t capacity = buffer_capacity.load();
+
+        std::unique_ptr<ThreadBuffer> buffer = std::make_unique<ThreadBuffer>();
+        buffer->events.resize(capacity);
+        buffer->mask = capacity - 1;
+
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+        buffer->thread_id = buffers.size() + 1;
+        buffer->name = "thread " + std::to_string(buffer->thread_id);
+
+        thread_buffer = buffer.get();
+        buffers.push_back(std::move(buffer));
+
+        return *thread_buffer;
+    }
+
+    void TraceProfiler::flush()
+    {
+        std::lock_guard<std::mutex> flush_lock(flush_mutex);
+
+        if (file == nullptr)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(buffers_mutex);
+
+        for (auto &buffer : buffers)
+        {
+            uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+            uint64_t head = buffer->head.load(std::memory_order_acquire);
+
+            if (!buffer->name_written && head != tail)
+            {
+                fprintf(file, "%s\n{\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":", first_event ? "" : ",", buffer->thread_id);
+                writeString(buffer->name.c_str());
+                fputs("}}", file);
+
+                buffer->name_written = true;
+                first_event = false;
+            }
+
+            for (; tail != head; tail++)
+            {
+                const TraceEvent &event = buffer->events[tail & buffer->mask];
+
+                // Zones opened before the session started are clamped to its beginning
+                uint64_t begin = event.begin > session_start ? event.begin - session_start : 0;
+                uint64_t end = event.end > session_start ? event.end - session_start : 0;
+
+                fprintf(file, "%s\n{\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"name\":", first_event ? "" : ",", buffer->thread_id,
+                        begin / 1000.0, (end - begin) / 1000.0);
+                writeString(event.name);
+                fputc('}', file);
+
+                first_event = false;
+                written_events++;
+            }
+
+            buffer->tail.store(head, std::memory_order_release);
+        }
+
+        fflush(file);
+    }
+
+    void TraceProfiler::flushLoop()
+    {
+        std::unique_lock<std::mutex> lock(stop_mutex);
+
+        while (!stopping)
+        {
+            stop_condition.wait_for(lock, std::chrono::milliseconds(config.flush_interval_ms), [this]
+                                    { return stopping; });
+
+            lock.unlock();
+            flush();
+            lock.lock();
+        }
+    }
+
+    void TraceProfiler::writeString(const char *string)
+    {
+        fputc('"', file);
+
+        for (const char *c = string; *c != '\0'; c++)
+        {
+            switch (*c)
+            {
+            case '"':
+                fputs("\\\"", file);
+                break;
+            case '\\':
+                fputs("\\\\", file);
+                break;
+            case '\n':
+                fputs("\\n", file);
+                break;
+            default:
+                if (static_cast<unsigned char>(*c) < 0x20)
+                {
+                    fprintf(file, "\\u%04x", *c);
+                }
+                else
+                {
+                    fputc(*c, file);
+                }
+            }
+        }
+
+        fputc('"', file);
+    }
+}
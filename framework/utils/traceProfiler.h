@@ -0,0 +1,183 @@
+#pragma once
+
+#include <utils/singleton.h>
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <stdio.h>
+#include <stdint.h>
+
+namespace framework
+{
+    struct TraceProfilerConfiguration
+    {
+        // Chrome trace JSON file, to be opened with Perfetto or chrome://tracing
+        std::string path = "trace.json";
+        // Events buffered by every thread (rounded up to a power of two), zones are dropped when the buffer is full.
+        // Buffers keep the capacity of the session that created them
+        uint32_t events_per_thread = 1 << 16;
+        // Period of the background flush
+        uint32_t flush_interval_ms = 100;
+    };
+
+    /**
+     * @brief Records CPU zones into a Chrome trace. Every thread writes its zones (name, nanosecond begin and end) into its own
+     * single producer single consumer ring, without locks, and a background thread periodically drains the rings and streams
+     * them to the file as complete events. Recording costs two clock reads while a session is active and a flag check otherwise.
+     * Zones are recorded through TraceZone
+     */
+    class TraceProfiler : public Singleton<TraceProfiler>
+    {
+        friend Singleton<TraceProfiler>;
+
+    public:
+        ~TraceProfiler();
+
+        /**
+         * @brief Opens the trace file and starts the background flush. Zones recorded before are discarded
+         * @throws Runtime Exception if a session is already active or the file cannot be opened
+         */
+        void start(const TraceProfilerConfiguration &config);
+
+        /**
+         * @brief Flushes the remaining zones, completes the JSON and closes the file. Does nothing without an active session
+         */
+        void stop();
+
+        /**
+         * @brief Names the calling thread inside the trace
+         */
+        void setThreadName(const std::string &name);
+
+        /**
+         * @brief Adds a zone of the calling thread. The name must outlive the session (e.g. a string literal)
+         */
+        void record(const char *name, uint64_t begin, uint64_t end);
+
+        /**
+         * @brief Nanoseconds of the profiler clock
+         */
+        static inline uint64_t now()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        // Getters
+        inline bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+        inline uint64_t getWrittenEvents() { return written_events.load(); }
+        uint64_t getDroppedEvents();
+
+    private:
+        TraceProfiler() = default;
+
+        struct TraceEvent
+        {
+            const char *name;
+            uint64_t begin;
+            uint64_t end;
+        };
+
+        struct ThreadBuffer
+        {
+            uint32_t thread_id = 0;
+            std::string name;
+            bool name_written = false;
+
+            // Ring written by the owning thread (head) and drained by the flush (tail)
+            std::vector<TraceEvent> events;
+            uint64_t mask = 0;
+            alignas(64) std::atomic<uint64_t> head = 0;
+            alignas(64) std::atomic<uint64_t> tail = 0;
+            std::atomic<uint64_t> dropped = 0;
+        };
+
+        /**
+         * @brief Buffer of the calling thread, created at its first use
+         */
+        ThreadBuffer &getThreadBuffer();
+
+        /**
+         * @brief Drains every thread buffer into the file
+         */
+        void flush();
+
+        /**
+         * @brief Periodically flushes until the session stops
+         */
+        void flushLoop();
+
+        /**
+         * @brief Writes the string as a JSON string, escaping the reserved characters
+         */
+        void writeString(const char *string);
+
+        // Buffer of the calling thread, owned by the profiler
+        static thread_local ThreadBuffer *thread_buffer;
+
+        TraceProfilerConfiguration config;
+        std::atomic<bool> enabled = false;
+        // Ring capacity of the buffers created from now on
+        std::atomic<uint64_t> buffer_capacity = 1 << 16;
+
+        // Thread buffers are never released, threads keep a pointer to theirs. Protected by buffers_mutex
+        std::mutex buffers_mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+        // Session file, written only by the flush (under flush_mutex)
+        std::mutex flush_mutex;
+        FILE *file = nullptr;
+        bool first_event = true;
+        uint64_t session_start = 0;
+        std::atomic<uint64_t> written_events = 0;
+
+        std::thread flush_thread;
+        std::mutex stop_mutex;
+        std::condition_variable stop_condition;
+        bool stopping = false;
+    };
+
+    /**
+     * @brief Records the zone between its construction and its destruction on the calling thread, if a trace session is active.
+     * The name must outlive the session (e.g. a string literal)
+     *
+     * \code
+     * void Foo::update()
+     * {
+     *     TraceZone zone("Foo::update");
+     *     ...
+     * }
+     * \endcode
+     */
+    class TraceZone
+    {
+    public:
+        explicit TraceZone(const char *name) : name(name)
+        {
+            if (TraceProfiler::getInstance().isEnabled())
+            {
+                begin = TraceProfiler::now();
+            }
+        }
+
+        ~TraceZone()
+        {
+            if (begin != 0)
+            {
+                TraceProfiler::getInstance().record(name, begin, TraceProfiler::now());
+            }
+        }
+
+        TraceZone(const TraceZone &) = delete;
+        TraceZone &operator=(const TraceZone &) = delete;
+
+    private:
+        const char *name;
+        uint64_t begin = 0;
+    };
+}
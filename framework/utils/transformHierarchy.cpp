@@ -0,0 +1,342 @@
+#include "transformHierarchy.h"
+
+#include <utils/jobSystem.h>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cstring>
+#include <stdexcept>
+
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+
+namespace framework
+{
+#ifdef __SSE2__
+    /**
+     * @brief Column major 4x4 product a * b stored unaligned into result (which may be GPU mapped memory)
+     */
+    static inline void multiplyMatrices(const glm::mat4 &a, const glm::mat4 &b, glm::mat4 &result)
+    {
+        __m128 a0 = _mm_loadu_ps(&a[0][0]);
+        __m128 a1 = _mm_loadu_ps(&a[1][0]);
+        __m128 a2 = _mm_loadu_ps(&a[2][0]);
+        __m128 a3 = _mm_loadu_ps(&a[3][0]);
+
+        for (int c = 0; c < 4; c++)
+        {
+            __m128 column = _mm_mul_ps(a0, _mm_set1_ps(b[c][0]));
+            column = _mm_add_ps(column, _mm_mul_ps(a1, _mm_set1_ps(b[c][1])));
+            column = _mm_add_ps(column, _mm_mul_ps(a2, _mm_set1_ps(b[c][2])));
+            column = _mm_add_ps(column, _mm_mul_ps(a3, _mm_set1_ps(b[c][3])));
+            _mm_storeu_ps(&result[c][0], column);
+        }
+    }
+#else
+    static inline void multiplyMatrices(const glm::mat4 &a, const glm::mat4 &b, glm::mat4 &result)
+    {
+        result = a * b;
+    }
+#endif
+
+    uint32_t TransformHierarchy::addNode(uint32_t parent)
+    {
+        uint32_t node = parents.size();
+
+        // Parents preceding their children is what allows the single pass propagation
+        if (parent != NO_PARENT && parent >= node)
+        {
+            throw std::runtime_error("[TransformHierarchy] Parent node does not exist");
+        }
+
+        translation_x.push_back(0);
+        translation_y.push_back(0);
+        translation_z.push_back(0);
+        rotation_x.push_back(0);
+        rotation_y.push_back(0);
+        rotation_z.push_back(0);
+        rotation_w.push_back(1);
+        scale_x.push_back(1);
+        scale_y.push_back(1);
+        scale_z.push_back(1);
+
+        parents.push_back(parent);
+        dirty.push_back(1);
+
+        uint32_t level = parent == NO_PARENT ? 0 : node_levels[parent] + 1;
+        node_levels.push_back(level);
+
+        if (level >= levels.size())
+        {
+            levels.resize(level + 1);
+        }
+        levels[level].push_back(node);
+
+        local_matrices.push_back(glm::mat4(1.0f));
+        world_matrices.push_back(glm::mat4(1.0f));
+
+        return node;
+    }
+
+    void TransformHierarchy::reserve(uint32_t nodes)
+    {
+        for (auto *component : {&translation_x, &translation_y, &translation_z,
+                                &rotation_x, &rotation_y, &rotation_z, &rotation_w,
+                                &scale_x, &scale_y, &scale_z})
+        {
+            component->reserve(nodes);
+        }
+
+        parents.reserve(nodes);
+        dirty.reserve(nodes);
+        node_levels.reserve(nodes);
+        local_matrices.reserve(nodes);
+        world_matrices.reserve(nodes);
+    }
+
+    void TransformHierarchy::bindOutputBuffer(const std::shared_ptr<StorageBuffer<glm::mat4>> &buffer)
+    {
+        if (buffer != nullptr && buffer->getMappedData() == nullptr)
+        {
+            throw std::runtime_error("[TransformHierarchy] The output buffer is not host visible");
+        }
+
+        output_buffer = buffer;
+
+        // The new buffer has to receive every matrix
+        std::fill(dirty.begin(), dirty.end(), 1);
+    }
+
+    void TransformHierarchy::update()
+    {
+        size_t nodes = parents.size();
+
+        if (nodes == 0)
+        {
+            return;
+        }
+
+        glm::mat4 *output = nullptr;
+
+        if (output_buffer != nullptr)
+        {
+            if (output_buffer->getElementsNumber() < nodes)
+            {
+                throw std::runtime_error("[TransformHierarchy] Output buffer smaller than the number of nodes");
+            }
+
+            output = output_buffer->getMappedData();
+        }
+
+        // Parents have lower indices, their flag is final when the child is reached
+        bool any_dirty = false;
+        for (size_t i = 0; i < nodes; i++)
+        {
+            if (parents[i] != NO_PARENT && dirty[parents[i]])
+            {
+                dirty[i] = 1;
+            }
+
+            any_dirty |= dirty[i] != 0;
+        }
+
+        if (!any_dirty)
+        {
+            return;
+        }
+
+        JobSystem &jobs = JobSystem::getInstance();
+
+        size_t blocks = (nodes + 3) / 4;
+        jobs.parallelFor(blocks, NODES_GRAIN / 4, [this](size_t begin, size_t end)
+                         { computeLocalMatrices(begin, end); });
+
+        // Every level only reads the world matrices of the previous one
+        for (const auto &level : levels)
+        {
+            jobs.parallelFor(level.size(), NODES_GRAIN, [this, &level, output](size_t begin, size_t end)
+                             { computeWorldMatrices(level, begin, end, output); });
+        }
+
+        std::memset(dirty.data(), 0, nodes);
+    }
+
+    void TransformHierarchy::computeLocalMatrices(size_t first_block, size_t last_block)
+    {
+        size_t nodes = parents.size();
+
+        for (size_t block = first_block; block < last_block; block++)
+        {
+            size_t first = block * 4;
+
+#ifdef __SSE2__
+            if (first + 4 <= nodes)
+            {
+                uint32_t block_dirty;
+                std::memcpy(&block_dirty, &dirty[first], sizeof(uint32_t));
+
+                if (block_dirty == 0)
+                {
+                    continue;
+                }
+
+                // Every register holds the same component of 4 consecutive nodes
+                __m128 x = _mm_loadu_ps(&rotation_x[first]);
+                __m128 y = _mm_loadu_ps(&rotation_y[first]);
+                __m128 z = _mm_loadu_ps(&rotation_z[first]);
+                __m128 w = _mm_loadu_ps(&rotation_w[first]);
+                __m128 sx = _mm_loadu_ps(&scale_x[first]);
+                __m128 sy = _mm_loadu_ps(&scale_y[first]);
+                __m128 sz = _mm_loadu_ps(&scale_z[first]);
+
+                __m128 one = _mm_set1_ps(1.0f);
+                __m128 two = _mm_set1_ps(2.0f);
+
+                __m128 xx = _mm_mul_ps(x, x), yy = _mm_mul_ps(y, y), zz = _mm_mul_ps(z, z);
+                __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+                __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+
+                // Scaled rotation matrix, rows of every column
+                __m128 columns[4][4];
+                columns[0][0] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+                columns[0][1] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+                columns[0][2] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+                columns[1][0] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+                columns[1][1] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+                columns[1][2] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+                columns[2][0] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+                columns[2][1] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+                columns[2][2] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+                columns[0][3] = columns[1][3] = columns[2][3] = _mm_setzero_ps();
+                columns[3][0] = _mm_loadu_ps(&translation_x[first]);
+                columns[3][1] = _mm_loadu_ps(&translation_y[first]);
+                columns[3][2] = _mm_loadu_ps(&translation_z[first]);
+                columns[3][3] = one;
+
+                // After the transpose every register is the column of a single node
+                for (int c = 0; c < 4; c++)
+                {
+                    _MM_TRANSPOSE4_PS(columns[c][0], columns[c][1], columns[c][2], columns[c][3]);
+
+                    for (int n = 0; n < 4; n++)
+                    {
+                        _mm_storeu_ps(&local_matrices[first + n][c][0], columns[c][n]);
+                    }
+                }
+
+                continue;
+            }
+#endif
+            // Scalar path for the last partial block
+            for (size_t i = first; i < std::min(first + 4, nodes); i++)
+            {
+                if (!dirty[i])
+                {
+                    continue;
+                }
+
+                glm::quat rotation(rotation_w[i], rotation_x[i], rotation_y[i], rotation_z[i]);
+
+                local_matrices[i] = glm::translate(glm::mat4(1.0f), glm::vec3(translation_x[i], translation_y[i], translation_z[i])) *
+                                    glm::mat4_cast(rotation) *
+                                    glm::scale(glm::mat4(1.0f), glm::vec3(scale_x[i], scale_y[i], scale_z[i]));
+            }
+        }
+    }
+
+    void TransformHierarchy::computeWorldMatrices(const std::vector<uint32_t> &nodes, size_t begin, size_t end, glm::mat4 *output)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            uint32_t node = nodes[i];
+
+            if (!dirty[node])
+            {
+                continue;
+            }
+
+            if (parents[node] == NO_PARENT)
+            {
+                world_matrices[node] = local_matrices[node];
+            }
+            else
+            {
+                multiplyMatrices(world_matrices[parents[node]], local_matrices[node], world_matrices[node]);
+            }
+
+            // Write only, the GPU visible memory is never read back
+            if (output != nullptr)
+            {
+                std::memcpy(&output[node], &world_matrices[node], sizeof(glm::mat4));
+            }
+        }
+    }
+
+    void TransformHierarchy::checkNode(uint32_t node)
+    {
+        if (node >= parents.size())
+        {
+            throw std::runtime_error("[TransformHierarchy] Node index out of range");
+        }
+    }
+
+    void TransformHierarchy::setTranslation(uint32_t node, const glm::vec3 &translation)
+    {
+        checkNode(node);
+
+        translation_x[node] = translation.x;
+        translation_y[node] = translation.y;
+        translation_z[node] = translation.z;
+        dirty[node] = 1;
+    }
+
+    void TransformHierarchy::setRotation(uint32_t node, const glm::quat &rotation)
+    {
+        checkNode(node);
+
+        // The matrix construction assumes unit quaternions
+        glm::quat normalized = glm::normalize(rotation);
+
+        rotation_x[node] = normalized.x;
+        rotation_y[node] = normalized.y;
+        rotation_z[node] = normalized.z;
+        rotation_w[node] = normalized.w;
+        dirty[node] = 1;
+    }
+
+    void TransformHierarchy::setScale(uint32_t node, const glm::vec3 &scale)
+    {
+        checkNode(node);
+
+        scale_x[node] = scale.x;
+        scale_y[node] = scale.y;
+        scale_z[node] = scale.z;
+        dirty[node] = 1;
+    }
+
+    void TransformHierarchy::setTransform(uint32_t node, const glm::vec3 &translation, const glm::quat &rotation, const glm::vec3 &scale)
+    {
+        setTranslation(node, translation);
+        setRotation(node, rotation);
+        setScale(node, scale);
+    }
+
+    glm::vec3 TransformHierarchy::getTranslation(uint32_t node)
+    {
+        checkNode(node);
+        return glm::vec3(translation_x[node], translation_y[node], translation_z[node]);
+    }
+
+    glm::quat TransformHierarchy::getRotation(uint32_t node)
+    {
+        checkNode(node);
+        return glm::quat(rotation_w[node], rotation_x[node], rotation_y[node], rotation_z[node]);
+    }
+
+    glm::vec3 TransformHierarchy::getScale(uint32_t node)
+    {
+        checkNode(node);
+        return glm::vec3(scale_x[node], scale_y[node], scale_z[node]);
+    }
+}
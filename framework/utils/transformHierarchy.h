@@ -0,0 +1,105 @@
+#pragma once
+
+#include <core/storageBuffer.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <vector>
+#include <memory>
+#include <stdint.h>
+
+namespace framework
+{
+    /**
+     * @brief Scene transform system. Local translation, rotation and scale of every node are stored as structure of arrays
+     * and parents always precede their children, so that dirty flags propagate in a single linear pass.
+     * Local matrices are rebuilt 4 nodes at a time with SIMD, world matrices are computed level by level across the
+     * job system and, if an output buffer is bound, written straight into it at the node index.
+     */
+    class TransformHierarchy
+    {
+    public:
+        static constexpr uint32_t NO_PARENT = UINT32_MAX;
+
+        TransformHierarchy() {}
+
+        /**
+         * @brief Adds a node with identity transform and returns its index
+         * @throws Runtime Exception if the parent does not exist
+         */
+        uint32_t addNode(uint32_t parent = NO_PARENT);
+
+        /**
+         * @brief Reserves the space for the passed number of nodes
+         */
+        void reserve(uint32_t nodes);
+
+        /**
+         * @brief Binds the per-instance buffer where world matrices are written at every update. All nodes are
+         * flagged as dirty so that the whole buffer content gets written. The buffer is written in place, not per frame slot,
+         * so update must run only when no submitted frame reads it (e.g. after the DefaultRenderer fence wait, single frame in flight)
+         * @throws Runtime Exception if the buffer is not host visible
+         */
+        void bindOutputBuffer(const std::shared_ptr<StorageBuffer<glm::mat4>> &buffer);
+
+        /**
+         * @brief Propagates the dirty flags and recomputes the local and world matrices of the modified nodes
+         * together with their descendants. The bound output buffer must not be read by a pending frame
+         * @throws Runtime Exception if the bound output buffer is smaller than the number of nodes
+         */
+        void update();
+
+        // Setters
+        void setTranslation(uint32_t node, const glm::vec3 &translation);
+        void setRotation(uint32_t node, const glm::quat &rotation);
+        void setScale(uint32_t node, const glm::vec3 &scale);
+        void setTransform(uint32_t node, const glm::vec3 &translation, const glm::quat &rotation, const glm::vec3 &scale);
+
+        // Getters
+        glm::vec3 getTranslation(uint32_t node);
+        glm::quat getRotation(uint32_t node);
+        glm::vec3 getScale(uint32_t node);
+        inline uint32_t getParent(uint32_t node) { return parents.at(node); }
+        inline const glm::mat4 &getLocalMatrix(uint32_t node) { return local_matrices.at(node); }
+        inline const glm::mat4 &getWorldMatrix(uint32_t node) { return world_matrices.at(node); }
+        inline const std::vector<glm::mat4> &getWorldMatrices() { return world_matrices; }
+        inline uint32_t getNodesNumber() { return parents.size(); }
+
+    private:
+        // Nodes processed by every job system chunk
+        static constexpr size_t NODES_GRAIN = 1024;
+
+        /**
+         * @brief Throws a runtime exception if the node does not exist
+         */
+        void checkNode(uint32_t node);
+
+        /**
+         * @brief Rebuilds the local matrices of the blocks of 4 nodes in [first_block, last_block) containing a dirty node
+         */
+        void computeLocalMatrices(size_t first_block, size_t last_block);
+
+        /**
+         * @brief Computes the world matrices of the dirty nodes in [begin, end) of the passed level
+         */
+        void computeWorldMatrices(const std::vector<uint32_t> &nodes, size_t begin, size_t end, glm::mat4 *output);
+
+        // Local TRS (structure of arrays)
+        std::vector<float> translation_x, translation_y, translation_z;
+        std::vector<float> rotation_x, rotation_y, rotation_z, rotation_w;
+        std::vector<float> scale_x, scale_y, scale_z;
+
+        std::vector<uint32_t> parents;
+        std::vector<uint8_t> dirty;
+
+        // Nodes grouped by depth, nodes of the same level are independent from each other
+        std::vector<std::vector<uint32_t>> levels;
+        std::vector<uint32_t> node_levels;
+
+        std::vector<glm::mat4> local_matrices;
+        std::vector<glm::mat4> world_matrices;
+
+        std::shared_ptr<StorageBuffer<glm::mat4>> output_buffer;
+    };
+}
@@ -0,0 +1,439 @@
+#include "vertexCompression.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <stdexcept>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// The F16C conversion is compiled with a target attribute and selected at run time, the build flags do not enable F16C
+#if defined(__SSE2__) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VERTEX_COMPRESSION_F16C
+#endif
+
+namespace framework
+{
+    /**
+     * @brief Scales the clamped value and rounds it to the nearest integer, halves to even like the SIMD conversions
+     * (_mm_cvtps_epi32 in the default rounding mode), so that a value is encoded the same way in the batches and in the tails
+     */
+    static inline int32_t quantize(float value, float min, float max, float scale)
+    {
+        return static_cast<int32_t>(std::nearbyint(std::min(std::max(value, min), max) * scale));
+    }
+
+    /**
+     * @brief Converts a float into a half, rounding to nearest even like the SIMD conversions (glm::packHalf1x16 rounds the ties up)
+     */
+    static inline uint16_t floatToHalf(float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+
+        uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+        uint32_t abs_bits = bits & 0x7FFFFFFF;
+
+        // Overflow, infinity and NaN
+        if (abs_bits >= (127 + 16) << 23)
+        {
+            return sign | (abs_bits > 0x7F800000 ? 0x7e00 : 0x7c00);
+        }
+
+        // Subnormal result: let the FPU round the mantissa
+        if (abs_bits < (127 - 14) << 23)
+        {
+            const uint32_t magic_bits = ((127 - 15) + (23 - 10) + 1) << 23;
+            float magic;
+            memcpy(&magic, &magic_bits, sizeof(magic));
+
+            float subnormal = std::abs(value) + magic;
+            uint32_t subnormal_bits;
+            memcpy(&subnormal_bits, &subnormal, sizeof(subnormal_bits));
+
+            return sign | static_cast<uint16_t>(subnormal_bits - magic_bits);
+        }
+
+        // Normal result: rebias the exponent and round to nearest even
+        uint32_t mantissa_odd = (abs_bits >> 13) & 1;
+        return sign | static_cast<uint16_t>((abs_bits + 0xfff - ((127 - 15) << 23) + mantissa_odd) >> 13);
+    }
+
+#if defined(VERTEX_COMPRESSION_F16C)
+    static const bool HAS_F16C = __builtin_cpu_supports("f16c");
+
+    /**
+     * @brief Converts 8 floats at a time from i with the F16C instructions (round to nearest even), returns the first value left
+     */
+    __attribute__((target("f16c"))) static size_t encodeHalfF16C(const float *src, size_t i, size_t count, uint16_t *dst)
+    {
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i lo = _mm_cvtps_ph(_mm_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+            __m128i hi = _mm_cvtps_ph(_mm_loadu_ps(src + i + 4), _MM_FROUND_TO_NEAREST_INT);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_unpacklo_epi64(lo, hi));
+        }
+
+        return i;
+    }
+#endif
+
+#if defined(__SSE2__)
+    /**
+     * @brief Converts 4 floats into 4 halfs (round to nearest even) stored into the 32 bit lanes.
+     * Negative results are sign extended so that they survive a signed saturated pack.
+     */
+    static inline __m128i floatToHalfSSE(__m128 f)
+    {
+        const __m128i mask_sign = _mm_set1_epi32(0x80000000u);
+        const __m128i f16_max = _mm_set1_epi32((127 + 16) << 23);
+        const __m128i nan_bit = _mm_set1_epi32(0x200);
+        const __m128i infinity = _mm_set1_epi32(0x7c00);
+        const __m128i min_normal = _mm_set1_epi32((127 - 14) << 23);
+        const __m128i subnormal_magic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+        const __m128i normal_bias = _mm_set1_epi32(0xfff - ((127 - 15) << 23));
+
+        __m128 just_sign = _mm_and_ps(_mm_castsi128_ps(mask_sign), f);
+        __m128 abs_f = _mm_xor_ps(f, just_sign);
+        __m128i abs_int = _mm_castps_si128(abs_f);
+
+        __m128 is_nan = _mm_cmpunord_ps(abs_f, abs_f);
+        __m128i is_regular = _mm_cmpgt_epi32(f16_max, abs_int);
+        __m128i inf_or_nan = _mm_or_si128(_mm_and_si128(_mm_castps_si128(is_nan), nan_bit), infinity);
+        __m128i is_subnormal = _mm_cmpgt_epi32(min_normal, abs_int);
+
+        // Subnormal result: let the FPU round the mantissa
+        __m128 subnormal_float = _mm_add_ps(abs_f, _mm_castsi128_ps(subnormal_magic));
+        __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(subnormal_float), subnormal_magic);
+
+        // Normal result: rebias the exponent and round to nearest even
+        __m128i mantissa_odd = _mm_srai_epi32(_mm_slli_epi32(abs_int, 31 - 13), 31);
+        __m128i rounded = _mm_sub_epi32(_mm_add_epi32(abs_int, normal_bias), mantissa_odd);
+        __m128i normal = _mm_srli_epi32(rounded, 13);
+
+        __m128i non_special = _mm_or_si128(_mm_and_si128(subnormal, is_subnormal), _mm_andnot_si128(is_subnormal, normal));
+        __m128i joined = _mm_or_si128(_mm_and_si128(non_special, is_regular), _mm_andnot_si128(is_regular, inf_or_nan));
+
+        return _mm_or_si128(joined, _mm_srai_epi32(_mm_castps_si128(just_sign), 16));
+    }
+
+    /**
+     * @brief Returns +1 or -1 with the sign of the passed values (0 is considered positive)
+     */
+    static inline __m128 signNotZeroSSE(__m128 v)
+    {
+        return _mm_or_ps(_mm_and_ps(v, _mm_set1_ps(-0.0f)), _mm_set1_ps(1.0f));
+    }
+#endif
+
+    void encodeHalf(const float *src, size_t count, uint16_t *dst)
+    {
+        size_t i = 0;
+#if defined(VERTEX_COMPRESSION_F16C)
+        if (HAS_F16C)
+        {
+            i = encodeHalfF16C(src, i, count, dst);
+        }
+#endif
+#if defined(__SSE2__)
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128i lo = floatToHalfSSE(_mm_loadu_ps(src + i));
+            __m128i hi = floatToHalfSSE(_mm_loadu_ps(src + i + 4));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packs_epi32(lo, hi));
+        }
+#endif
+        for (; i < count; i++)
+        {
+            dst[i] = floatToHalf(src[i]);
+        }
+    }
+
+    void encodeSnorm16(const float *src, size_t count, int16_t *dst)
+    {
+        size_t i = 0;
+#if defined(__SSE2__)
+        const __m128 scale = _mm_set1_ps(32767.0f);
+        const __m128 min = _mm_set1_ps(-1.0f);
+        const __m128 max = _mm_set1_ps(1.0f);
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128 a = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), min), max);
+            __m128 b = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 4), min), max);
+            __m128i lo = _mm_cvtps_epi32(_mm_mul_ps(a, scale));
+            __m128i hi = _mm_cvtps_epi32(_mm_mul_ps(b, scale));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packs_epi32(lo, hi));
+        }
+#endif
+        for (; i < count; i++)
+        {
+            dst[i] = static_cast<int16_t>(quantize(src[i], -1.0f, 1.0f, 32767.0f));
+        }
+    }
+
+    void encodeUnorm16(const float *src, size_t count, uint16_t *dst)
+    {
+        size_t i = 0;
+#if defined(__SSE2__)
+        const __m128 scale = _mm_set1_ps(65535.0f);
+        const __m128 min = _mm_set1_ps(0.0f);
+        const __m128 max = _mm_set1_ps(1.0f);
+        const __m128i bias = _mm_set1_epi32(32768);
+        const __m128i unbias = _mm_set1_epi16(static_cast<short>(0x8000));
+        for (; i + 8 <= count; i += 8)
+        {
+            __m128 a = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), min), max);
+            __m128 b = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 4), min), max);
+
+            // SSE2 has only the signed saturated pack, move the range to [-32768, 32767] and back
+            __m128i lo = _mm_sub_epi32(_mm_cvtps_epi32(_mm_mul_ps(a, scale)), bias);
+            __m128i hi = _mm_sub_epi32(_mm_cvtps_epi32(_mm_mul_ps(b, scale)), bias);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_xor_si128(_mm_packs_epi32(lo, hi), unbias));
+        }
+#endif
+        for (; i < count; i++)
+        {
+            dst[i] = static_cast<uint16_t>(quantize(src[i], 0.0f, 1.0f, 65535.0f));
+        }
+    }
+
+    void encodeSnorm8(const float *src, size_t count, int8_t *dst)
+    {
+        size_t i = 0;
+#if defined(__SSE2__)
+        const __m128 scale = _mm_set1_ps(127.0f);
+        const __m128 min = _mm_set1_ps(-1.0f);
+        const __m128 max = _mm_set1_ps(1.0f);
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i v[4];
+            for (int j = 0; j < 4; j++)
+            {
+                __m128 a = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + j * 4), min), max);
+                v[j] = _mm_cvtps_epi32(_mm_mul_ps(a, scale));
+            }
+
+            __m128i packed = _mm_packs_epi16(_mm_packs_epi32(v[0], v[1]), _mm_packs_epi32(v[2], v[3]));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), packed);
+        }
+#endif
+        for (; i < count; i++)
+        {
+            dst[i] = static_cast<int8_t>(quantize(src[i], -1.0f, 1.0f, 127.0f));
+        }
+    }
+
+    void encodeUnorm8(const float *src, size_t count, uint8_t *dst)
+    {
+        size_t i = 0;
+#if defined(__SSE2__)
+        const __m128 scale = _mm_set1_ps(255.0f);
+        const __m128 min = _mm_set1_ps(0.0f);
+        const __m128 max = _mm_set1_ps(1.0f);
+        for (; i + 16 <= count; i += 16)
+        {
+            __m128i v[4];
+            for (int j = 0; j < 4; j++)
+            {
+                __m128 a = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + j * 4), min), max);
+                v[j] = _mm_cvtps_epi32(_mm_mul_ps(a, scale));
+            }
+
+            __m128i packed = _mm_packus_epi16(_mm_packs_epi32(v[0], v[1]), _mm_packs_epi32(v[2], v[3]));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), packed);
+        }
+#endif
+        for (; i < count; i++)
+        {
+            dst[i] = static_cast<uint8_t>(quantize(src[i], 0.0f, 1.0f, 255.0f));
+        }
+    }
+
+    void encode1010102(const float *src, size_t count, bool is_signed, uint32_t *dst)
+    {
+        size_t i = 0;
+#if defined(__SSE2__)
+        const __m128 min = _mm_set1_ps(is_signed ? -1.0f : 0.0f);
+        const __m128 max = _mm_set1_ps(1.0f);
+        const __m128 xyz_scale = _mm_set1_ps(is_signed ? 511.0f : 1023.0f);
+        const __m128 w_scale = _mm_set1_ps(is_signed ? 1.0f : 3.0f);
+        const __m128i xyz_mask = _mm_set1_epi32(0x3FF);
+        const __m128i w_mask = _mm_set1_epi32(0x3);
+        for (; i + 4 <= count; i += 4)
+        {
+            // Transpose 4 vectors so that every register contains the same component
+            __m128 x = _mm_loadu_ps(src + i * 4 + 0);
+            __m128 y = _mm_loadu_ps(src + i * 4 + 4);
+            __m128 z = _mm_loadu_ps(src + i * 4 + 8);
+            __m128 w = _mm_loadu_ps(src + i * 4 + 12);
+            _MM_TRANSPOSE4_PS(x, y, z, w);
+
+            __m128i xi = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(x, min), max), xyz_scale));
+            __m128i yi = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(y, min), max), xyz_scale));
+            __m128i zi = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(z, min), max), xyz_scale));
+            __m128i wi = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(w, min), max), w_scale));
+
+            __m128i packed = _mm_and_si128(xi, xyz_mask);
+            packed = _mm_or_si128(packed, _mm_slli_epi32(_mm_and_si128(yi, xyz_mask), 10));
+            packed = _mm_or_si128(packed, _mm_slli_epi32(_mm_and_si128(zi, xyz_mask), 20));
+            packed = _mm_or_si128(packed, _mm_slli_epi32(_mm_and_si128(wi, w_mask), 30));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), packed);
+        }
+#endif
+        for (; i < count; i++)
+        {
+            float min = is_signed ? -1.0f : 0.0f;
+            float xyz_scale = is_signed ? 511.0f : 1023.0f;
+            float w_scale = is_signed ? 1.0f : 3.0f;
+
+            dst[i] = (static_cast<uint32_t>(quantize(src[i * 4 + 0], min, 1.0f, xyz_scale)) & 0x3FF) |
+                     ((static_cast<uint32_t>(quantize(src[i * 4 + 1], min, 1.0f, xyz_scale)) & 0x3FF) << 10) |
+                     ((static_cast<uint32_t>(quantize(src[i * 4 + 2], min, 1.0f, xyz_scale)) & 0x3FF) << 20) |
+                     ((static_cast<uint32_t>(quantize(src[i * 4 + 3], min, 1.0f, w_scale)) & 0x3) << 30);
+        }
+    }
+
+    void encodeOctahedral(const float *src, size_t count, float *dst)
+    {
+        size_t i = 0;
+#if defined(__SSE2__)
+        const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 epsilon = _mm_set1_ps(1e-20f);
+        for (; i + 4 <= count; i += 4)
+        {
+            const float *p = src + i * 3;
+            __m128 x = _mm_setr_ps(p[0], p[3], p[6], p[9]);
+            __m128 y = _mm_setr_ps(p[1], p[4], p[7], p[10]);
+            __m128 z = _mm_setr_ps(p[2], p[5], p[8], p[11]);
+
+            // Project the vector on the octahedron |x| + |y| + |z| = 1
+            __m128 l1 = _mm_add_ps(_mm_add_ps(_mm_and_ps(x, abs_mask), _mm_and_ps(y, abs_mask)), _mm_and_ps(z, abs_mask));
+            __m128 inv = _mm_div_ps(one, _mm_max_ps(l1, epsilon));
+            x = _mm_mul_ps(x, inv);
+            y = _mm_mul_ps(y, inv);
+
+            // Fold the lower hemisphere over the diagonals
+            __m128 folded_x = _mm_mul_ps(_mm_sub_ps(one, _mm_and_ps(y, abs_mask)), signNotZeroSSE(x));
+            __m128 folded_y = _mm_mul_ps(_mm_sub_ps(one, _mm_and_ps(x, abs_mask)), signNotZeroSSE(y));
+            __m128 lower = _mm_cmplt_ps(z, _mm_setzero_ps());
+            x = _mm_or_ps(_mm_and_ps(lower, folded_x), _mm_andnot_ps(lower, x));
+            y = _mm_or_ps(_mm_and_ps(lower, folded_y), _mm_andnot_ps(lower, y));
+
+            _mm_storeu_ps(dst + i * 2 + 0, _mm_unpacklo_ps(x, y));
+            _mm_storeu_ps(dst + i * 2 + 4, _mm_unpackhi_ps(x, y));
+        }
+#endif
+        for (; i < count; i++)
+        {
+            float x = src[i * 3 + 0];
+            float y = src[i * 3 + 1];
+            float z = src[i * 3 + 2];
+            float l1 = std::max(std::abs(x) + std::abs(y) + std::abs(z), 1e-20f);
+            x /= l1;
+            y /= l1;
+
+            if (z < 0)
+            {
+                float folded_x = (1.0f - std::abs(y)) * (x >= 0 ? 1.0f : -1.0f);
+                float folded_y = (1.0f - std::abs(x)) * (y >= 0 ? 1.0f : -1.0f);
+                x = folded_x;
+                y = folded_y;
+            }
+
+            dst[i * 2 + 0] = x;
+            dst[i * 2 + 1] = y;
+        }
+    }
+
+    void encodeVertexAttribute(VertexAttributes::DrawableAttribute format, const float *src, uint32_t components, size_t count,
+                               float *dst, uint32_t dst_stride, float padding)
+    {
+        if (src == nullptr || dst == nullptr)
+        {
+            throw std::runtime_error("[VertexCompression] Null source or destination stream");
+        }
+
+        if (format == VertexAttributes::DrawableAttribute::I1)
+        {
+            throw std::runtime_error("[VertexCompression] Integer formats cannot be encoded from floats");
+        }
+
+        uint32_t format_components = VertexAttributes::getAttributeComponents(format);
+        uint32_t words = VertexAttributes::getAttributeSize(format) / sizeof(float);
+        bool octahedral = format == VertexAttributes::DrawableAttribute::S16N2 && components == 3;
+
+        if (components > format_components && !octahedral)
+        {
+            throw std::runtime_error("[VertexCompression] The format cannot store all the passed components");
+        }
+
+        // Expand the stream to the format number of components (or octahedral encode it)
+        std::vector<float> expanded;
+        const float *stream = src;
+        if (octahedral)
+        {
+            expanded.resize(count * 2);
+            encodeOctahedral(src, count, expanded.data());
+            stream = expanded.data();
+        }
+        else if (components != format_components)
+        {
+            expanded.resize(count * format_components, padding);
+            for (size_t i = 0; i < count; i++)
+            {
+                memcpy(&expanded[i * format_components], &src[i * components], components * sizeof(float));
+            }
+            stream = expanded.data();
+        }
+
+        // Encode the whole stream at once so that the batch encoders can use SIMD registers
+        std::vector<uint32_t> packed(count * words);
+        size_t scalars = count * format_components;
+        switch (format)
+        {
+        case VertexAttributes::DrawableAttribute::F1:
+        case VertexAttributes::DrawableAttribute::F2:
+        case VertexAttributes::DrawableAttribute::F3:
+        case VertexAttributes::DrawableAttribute::F4:
+            memcpy(packed.data(), stream, scalars * sizeof(float));
+            break;
+        case VertexAttributes::DrawableAttribute::H2:
+        case VertexAttributes::DrawableAttribute::H4:
+            encodeHalf(stream, scalars, reinterpret_cast<uint16_t *>(packed.data()));
+            break;
+        case VertexAttributes::DrawableAttribute::S16N2:
+        case VertexAttributes::DrawableAttribute::S16N4:
+            encodeSnorm16(stream, scalars, reinterpret_cast<int16_t *>(packed.data()));
+            break;
+        case VertexAttributes::DrawableAttribute::U16N2:
+        case VertexAttributes::DrawableAttribute::U16N4:
+            encodeUnorm16(stream, scalars, reinterpret_cast<uint16_t *>(packed.data()));
+            break;
+        case VertexAttributes::DrawableAttribute::U8N4:
+            encodeUnorm8(stream, scalars, reinterpret_cast<uint8_t *>(packed.data()));
+            break;
+        case VertexAttributes::DrawableAttribute::S8N4:
+            encodeSnorm8(stream, scalars, reinterpret_cast<int8_t *>(packed.data()));
+            break;
+        case VertexAttributes::DrawableAttribute::U1010102:
+        case VertexAttributes::DrawableAttribute::S1010102:
+            encode1010102(stream, count, format == VertexAttributes::DrawableAttribute::S1010102, packed.data());
+            break;
+        default:
+            throw std::runtime_error("[VertexCompression] Unsupported attribute format");
+        }
+
+        // Scatter the packed words inside the interleaved vertex buffer
+        for (size_t i = 0; i < count; i++)
+        {
+            memcpy(&dst[i * dst_stride], &packed[i * words], words * sizeof(uint32_t));
+        }
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <core/vertexAttributes.h>
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace framework
+{
+    /**
+     * @brief Encodes a stream of float vectors into the passed vertex attribute format, writing the result
+     * inside an interleaved vertex buffer made of 32 bit words (the DrawableElement vertex storage).
+     * Missing components are filled with the padding value (e.g. w = 1 for positions stored as H4).
+     * A 3 components stream encoded as S16N2 is octahedral encoded (normals/tangents), the shader decodes it with:
+     * n = vec3(e.xy, 1 - |e.x| - |e.y|); if (n.z < 0) n.xy = (1 - |n.yx|) * sign(n.xy); n = normalize(n)
+     *
+     * @param src stream of count vectors, each one made of components floats
+     * @param dst destination buffer, the i-th encoded vector is written starting from dst[i * dst_stride]
+     * @param dst_stride distance in 32 bit words between two consecutive vertices
+     * @throws Runtime Exception if the format is an integer one or it cannot store the passed components
+     */
+    void encodeVertexAttribute(VertexAttributes::DrawableAttribute format, const float *src, uint32_t components, size_t count,
+                               float *dst, uint32_t dst_stride, float padding = 0.0f);
+
+    /**
+     * @brief Octahedral encoding of count normalized vectors (3 floats each) into 2 floats each in [-1, 1]
+     */
+    void encodeOctahedral(const float *src, size_t count, float *dst);
+
+    /**
+     * @brief Batch encoders, count is the number of scalar values. Uses SIMD instructions when available.
+     * Normalized formats clamp the input to [-1, 1] (signed) or [0, 1] (unsigned) before rounding. Every path rounds to nearest
+     * even, so a value is encoded the same way wherever it is inside the batch.
+     */
+    void encodeHalf(const float *src, size_t count, uint16_t *dst);
+    void encodeSnorm16(const float *src, size_t count, int16_t *dst);
+    void encodeUnorm16(const float *src, size_t count, uint16_t *dst);
+    void encodeSnorm8(const float *src, size_t count, int8_t *dst);
+    void encodeUnorm8(const float *src, size_t count, uint8_t *dst);
+
+    /**
+     * @brief Packs count vectors (4 floats each) into the 10-10-10-2 layout of VK_FORMAT_A2B10G10R10_*_PACK32
+     */
+    void encode1010102(const float *src, size_t count, bool is_signed, uint32_t *dst);
+}
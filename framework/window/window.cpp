@@ -1,4 +1,5 @@
 #include "window.h"
+#include <utils/jobSystem.h>
 #include <stdexcept>
 
 namespace framework
@@ -63,6 +64,9 @@ namespace framework
             // Update the events
             glfwPollEvents();
 
+            // Execute the jobs that need the main thread (GLFW calls from the workers)
+            JobSystem::getInstance().pumpMainThread();
+
             int previousWidth = width;
             int previousHeight = height;
 